@@ -36,6 +36,65 @@ namespace Falcor
         mRtDesc.resize(Fbo::getMaxColorTargetCount());
     }
 
+    BlendState::BlendState(const Desc& Desc) : mDesc(Desc)
+    {
+        mHash = 0;
+        for(const auto& rt : mDesc.mRtDesc)
+        {
+            hashCombine(mHash, rt.blendEnabled);
+            hashCombine(mHash, (uint32_t)rt.rgbBlendOp);
+            hashCombine(mHash, (uint32_t)rt.alphaBlendOp);
+            hashCombine(mHash, (uint32_t)rt.srcRgbFunc);
+            hashCombine(mHash, (uint32_t)rt.srcAlphaFunc);
+            hashCombine(mHash, (uint32_t)rt.dstRgbFunc);
+            hashCombine(mHash, (uint32_t)rt.dstAlphaFunc);
+            hashCombine(mHash, rt.writeMask.writeRed);
+            hashCombine(mHash, rt.writeMask.writeGreen);
+            hashCombine(mHash, rt.writeMask.writeBlue);
+            hashCombine(mHash, rt.writeMask.writeAlpha);
+        }
+        hashCombine(mHash, mDesc.mEnableIndependentBlend);
+        hashCombine(mHash, mDesc.mAlphaToCoverageEnabled);
+        for(uint32_t i = 0; i < 4; i++)
+        {
+            hashCombine(mHash, mDesc.mBlendFactor[i]);
+        }
+    }
+
+    bool BlendState::isEquivalent(const BlendState& other) const
+    {
+        if(this == &other)
+        {
+            return true;
+        }
+
+        const Desc& o = other.mDesc;
+        if((mHash != other.mHash) || (mDesc.mRtDesc.size() != o.mRtDesc.size()))
+        {
+            return false;
+        }
+
+        for(size_t i = 0; i < mDesc.mRtDesc.size(); i++)
+        {
+            const auto& a = mDesc.mRtDesc[i];
+            const auto& b = o.mRtDesc[i];
+            bool equal = (a.blendEnabled == b.blendEnabled) &&
+                (a.rgbBlendOp == b.rgbBlendOp) && (a.alphaBlendOp == b.alphaBlendOp) &&
+                (a.srcRgbFunc == b.srcRgbFunc) && (a.srcAlphaFunc == b.srcAlphaFunc) &&
+                (a.dstRgbFunc == b.dstRgbFunc) && (a.dstAlphaFunc == b.dstAlphaFunc) &&
+                (a.writeMask.writeRed == b.writeMask.writeRed) && (a.writeMask.writeGreen == b.writeMask.writeGreen) &&
+                (a.writeMask.writeBlue == b.writeMask.writeBlue) && (a.writeMask.writeAlpha == b.writeMask.writeAlpha);
+            if(equal == false)
+            {
+                return false;
+            }
+        }
+
+        return (mDesc.mEnableIndependentBlend == o.mEnableIndependentBlend) &&
+            (mDesc.mAlphaToCoverageEnabled == o.mAlphaToCoverageEnabled) &&
+            (mDesc.mBlendFactor == o.mBlendFactor);
+    }
+
     BlendState::Desc& BlendState::Desc::setRtParams(uint32_t rtIndex, BlendOp rgbOp, BlendOp alphaOp, BlendFunc srcRgbFunc, BlendFunc dstRgbFunc, BlendFunc srcAlphaFunc, BlendFunc dstAlphaFunc)
     {
         if(rtIndex >= mRtDesc.size())
@@ -181,9 +181,18 @@ namespace Falcor
         /** Get the API handle
         */
         BlendStateHandle getApiHandle() const;
+
+        /** Get a hash of the state description. Equivalent states have the same hash.
+        */
+        size_t getHash() const { return mHash; }
+
+        /** Check if another state object describes the same API state. Used by the render-context to filter redundant binds.
+        */
+        bool isEquivalent(const BlendState& other) const;
     private:
-        BlendState(const Desc& Desc) : mDesc(Desc) {}
+        BlendState(const Desc& Desc);
         const Desc mDesc;
         BlendStateHandle mApiHandle;
+        size_t mHash;
     };
 }
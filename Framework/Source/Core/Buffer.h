@@ -47,6 +47,7 @@ namespace Falcor
             Dynamic     = 1, ///< Buffer will be updated using Buffer#updateData().
             MapRead     = 2, ///< Buffer will mapped for CPU read.
             MapWrite    = 4, ///< Buffer will mapped for CPU Write.
+            MapPersistent = 8, ///< Buffer can stay mapped while the GPU uses it. Use with MapWrite. Writes become visible to the GPU without unmapping. Ignored in DX11, which can't use a mapped buffer.
         };
 
         /** Buffer GPU access flags.
@@ -137,9 +138,21 @@ namespace Falcor
         */
         size_t getSize() const { return mSize; }
 
+        /** Get the access flags the buffer was created with
+        */
+        AccessFlags getAccessFlags() const { return mAccessFlags; }
+
         /** Map the buffer
         */
-        void* map(MapType Type);
+        void* map(MapType Type) { return map(Type, 0, mSize); }
+
+        /** Map a range of the buffer. Depending on the API, the entire buffer might be mapped.
+            \param[in] Type The map type
+            \param[in] offset Byte offset of the range
+            \param[in] size Size of the range in bytes
+            \return A pointer to the start of the range
+        */
+        void* map(MapType Type, size_t offset, size_t size);
 
         /** Unmap the buffer
         */
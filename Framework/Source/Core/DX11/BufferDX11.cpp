@@ -148,7 +148,7 @@ namespace Falcor
         return 0;
     }
 
-    void* Buffer::map(MapType type)
+    void* Buffer::map(MapType type, size_t offset, size_t size)
     {
         if(mIsMapped)
         {
@@ -156,6 +156,12 @@ namespace Falcor
             return nullptr;
         }
 
+        if(offset + size > mSize)
+        {
+            Logger::log(Logger::Level::Error, "Buffer::Map() error. Range is out of the buffer bounds");
+            return nullptr;
+        }
+
         D3D11_MAP dxFlag;
         switch(type)
         {
@@ -173,6 +179,7 @@ namespace Falcor
             break;
         case MapType::WriteNoOverwrite:
             dxFlag = D3D11_MAP_WRITE_NO_OVERWRITE;
+            break;
         default:
             should_not_get_here();
         }
@@ -180,7 +187,8 @@ namespace Falcor
         mIsMapped = true;
         D3D11_MAPPED_SUBRESOURCE mapData;
         dx11_call(getD3D11ImmediateContext()->Map(mApiHandle, 0, dxFlag, 0, &mapData));
-        return mapData.pData;
+        // DX11 maps the entire buffer
+        return (uint8_t*)mapData.pData + offset;
     }
 
     void Buffer::unmap()
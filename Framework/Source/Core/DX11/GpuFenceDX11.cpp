@@ -0,0 +1,79 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#ifdef FALCOR_DX11
+#include "Core/GpuFence.h"
+
+namespace Falcor
+{
+    GpuFence::SharedPtr GpuFence::create()
+    {
+        return SharedPtr(new GpuFence);
+    }
+
+    GpuFence::~GpuFence()
+    {
+        if(mApiHandle)
+        {
+            ((ID3D11Query*)mApiHandle)->Release();
+        }
+    }
+
+    void GpuFence::insert()
+    {
+        if(mApiHandle == nullptr)
+        {
+            D3D11_QUERY_DESC desc;
+            desc.Query = D3D11_QUERY_EVENT;
+            desc.MiscFlags = 0;
+            ID3D11Query* pQuery = nullptr;
+            dx11_call(getD3D11Device()->CreateQuery(&desc, &pQuery));
+            mApiHandle = pQuery;
+        }
+        getD3D11ImmediateContext()->End((ID3D11Query*)mApiHandle);
+    }
+
+    bool GpuFence::isSignaled() const
+    {
+        if(mApiHandle == nullptr)
+        {
+            return true;
+        }
+        return getD3D11ImmediateContext()->GetData((ID3D11Query*)mApiHandle, nullptr, 0, D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK;
+    }
+
+    void GpuFence::wait() const
+    {
+        if(mApiHandle == nullptr)
+        {
+            return;
+        }
+        while(getD3D11ImmediateContext()->GetData((ID3D11Query*)mApiHandle, nullptr, 0, 0) != S_OK);
+    }
+}
+#endif //#ifdef FALCOR_DX11
@@ -101,6 +101,7 @@ namespace Falcor
         uint32_t strides[D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT] = {0};
         ID3D11Buffer* pVB[D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT] = {nullptr};
         ID3D11Buffer* pIB = nullptr;
+        DXGI_FORMAT ibFormat = DXGI_FORMAT_R32_UINT;
         ID3D11InputLayout* pLayout = nullptr;
         
         const auto pVao = mState.pVao;
@@ -115,10 +116,11 @@ namespace Falcor
 
             // Get the index buffer
             pIB = pVao->getIndexBuffer() ? pVao->getIndexBuffer()->getApiHandle() : nullptr;
+            ibFormat = getDxgiFormat(pVao->getIndexBufferFormat());
 
         }
 
-        pCtx->IASetIndexBuffer(pIB, DXGI_FORMAT_R32_UINT, 0);
+        pCtx->IASetIndexBuffer(pIB, ibFormat, 0);
         pCtx->IASetVertexBuffers(0, arraysize(pVB), pVB, strides, offsets);
     }
 
@@ -245,22 +247,39 @@ namespace Falcor
 
     void RenderContext::draw(uint32_t vertexCount, uint32_t startVertexLocation)
     {
-        prepareForDraw();
+        prepareForDraw(vertexCount, 1);
         getD3D11ImmediateContext()->Draw(vertexCount, startVertexLocation);
     }
 
     void RenderContext::drawIndexed(uint32_t indexCount, uint32_t startIndexLocation, int baseVertexLocation)
     {
-        prepareForDraw();
+        prepareForDraw(indexCount, 1);
         getD3D11ImmediateContext()->DrawIndexed(indexCount, startIndexLocation, baseVertexLocation);
     }
 
     void RenderContext::drawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndexLocation, int baseVertexLocation, uint32_t startInstanceLocation)
     {
-        prepareForDraw();
+        prepareForDraw(indexCount, instanceCount);
         getD3D11ImmediateContext()->DrawIndexedInstanced(indexCount, instanceCount, startIndexLocation, baseVertexLocation, startInstanceLocation);
     }
 
+    void RenderContext::multiDrawIndexed(const uint32_t* pIndexCounts, const uint32_t* pStartIndexLocations, uint32_t drawCount, int baseVertexLocation)
+    {
+        uint32_t totalIndexCount = 0;
+        for(uint32_t i = 0; i < drawCount; i++)
+        {
+            totalIndexCount += pIndexCounts[i];
+        }
+        prepareForDraw(totalIndexCount, 1);
+
+        // D3D11 doesn't have a multi-draw, the state is set once and the ranges are drawn one by one
+        ID3D11DeviceContextPtr pCtx = getD3D11ImmediateContext();
+        for(uint32_t i = 0; i < drawCount; i++)
+        {
+            pCtx->DrawIndexed(pIndexCounts[i], pStartIndexLocations[i], baseVertexLocation);
+        }
+    }
+
     void RenderContext::applyViewport(uint32_t index) const
     {
         static_assert(offsetof(Viewport, originX) == offsetof(D3D11_VIEWPORT, TopLeftX), "VP TopLeftX offset");
@@ -142,11 +142,18 @@ namespace Falcor
         {
             for(uint32_t mip = 0; mip < mipLevels; mip++)
             {
+                // Pitches are in blocks, so that compressed mip levels smaller than a block are handled
+                const uint32_t blockWidth = getFormatWidthCompressionRatio(format);
+                const uint32_t blockHeight = getFormatHeightCompressionRatio(format);
+                const uint32_t mipWidth = max(1U, width >> mip);
+                const uint32_t mipHeight = max(1U, height >> mip);
+                const uint32_t mipDepth = max(1U, depth >> mip);
+
                 auto& data = initData[D3D11CalcSubresource(mip, array, mipLevels)];
                 data.pSysMem = pSrc;
-                data.SysMemPitch = getFormatBytesPerBlock(format) * (width >> mip);
-                data.SysMemSlicePitch = data.SysMemPitch * (height >> mip);
-                pSrc += data.SysMemSlicePitch * depth;
+                data.SysMemPitch = getFormatBytesPerBlock(format) * ((mipWidth + blockWidth - 1) / blockWidth);
+                data.SysMemSlicePitch = data.SysMemPitch * ((mipHeight + blockHeight - 1) / blockHeight);
+                pSrc += data.SysMemSlicePitch * mipDepth;
             }
         }
 
@@ -30,6 +30,54 @@
 
 namespace Falcor
 {
+    static void hashStencilDesc(size_t& hash, const DepthStencilState::StencilDesc& desc)
+    {
+        hashCombine(hash, (uint32_t)desc.func);
+        hashCombine(hash, (uint32_t)desc.stencilFailOp);
+        hashCombine(hash, (uint32_t)desc.depthFailOp);
+        hashCombine(hash, (uint32_t)desc.depthStencilPassOp);
+    }
+
+    static bool isStencilDescEqual(const DepthStencilState::StencilDesc& a, const DepthStencilState::StencilDesc& b)
+    {
+        return (a.func == b.func) && (a.stencilFailOp == b.stencilFailOp) && (a.depthFailOp == b.depthFailOp) && (a.depthStencilPassOp == b.depthStencilPassOp);
+    }
+
+    DepthStencilState::DepthStencilState(const Desc& Desc) : mDesc(Desc)
+    {
+        mHash = 0;
+        hashCombine(mHash, mDesc.mDepthEnabled);
+        hashCombine(mHash, mDesc.mWriteDepth);
+        hashCombine(mHash, (uint32_t)mDesc.mDepthFunc);
+        hashCombine(mHash, mDesc.mStencilEnabled);
+        hashStencilDesc(mHash, mDesc.mStencilFront);
+        hashStencilDesc(mHash, mDesc.mStencilBack);
+        hashCombine(mHash, (uint32_t)mDesc.mStencilReadMask);
+        hashCombine(mHash, (uint32_t)mDesc.mStencilWriteMask);
+    }
+
+    bool DepthStencilState::isEquivalent(const DepthStencilState& other) const
+    {
+        if(this == &other)
+        {
+            return true;
+        }
+        if(mHash != other.mHash)
+        {
+            return false;
+        }
+
+        const Desc& o = other.mDesc;
+        return (mDesc.mDepthEnabled == o.mDepthEnabled) &&
+            (mDesc.mWriteDepth == o.mWriteDepth) &&
+            (mDesc.mDepthFunc == o.mDepthFunc) &&
+            (mDesc.mStencilEnabled == o.mStencilEnabled) &&
+            isStencilDescEqual(mDesc.mStencilFront, o.mStencilFront) &&
+            isStencilDescEqual(mDesc.mStencilBack, o.mStencilBack) &&
+            (mDesc.mStencilReadMask == o.mStencilReadMask) &&
+            (mDesc.mStencilWriteMask == o.mStencilWriteMask);
+    }
+
     DepthStencilState::Desc& DepthStencilState::Desc::setStencilWriteMask(uint8_t mask)
     {
         mStencilWriteMask = mask;
@@ -171,9 +171,18 @@ namespace Falcor
         */
         DepthStencilStateHandle getApiHandle() const;
 
+        /** Get a hash of the state description. Equivalent states have the same hash.
+        */
+        size_t getHash() const { return mHash; }
+
+        /** Check if another state object describes the same API state. Used by the render-context to filter redundant binds.
+        */
+        bool isEquivalent(const DepthStencilState& other) const;
+
     private:
         DepthStencilStateHandle mApiHandle;
-        DepthStencilState(const Desc& Desc) : mDesc(Desc) {}
+        DepthStencilState(const Desc& Desc);
         Desc mDesc;
+        size_t mHash;
     };
 }
\ No newline at end of file
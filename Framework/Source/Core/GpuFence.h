@@ -0,0 +1,66 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <memory>
+
+namespace Falcor
+{
+    /** Abstracts GPU fences.\n
+        A fence is inserted into the GPU command stream and is signaled when the GPU finished executing all the commands issued before it. Used to synchronize CPU writes to resources the GPU might still be reading.
+    */
+    class GpuFence : public std::enable_shared_from_this<GpuFence>
+    {
+    public:
+        using SharedPtr = std::shared_ptr<GpuFence>;
+        using SharedConstPtr = std::shared_ptr<const GpuFence>;
+
+        /** Create a new object
+        */
+        static SharedPtr create();
+
+        /** Destroy the object
+        */
+        ~GpuFence();
+
+        /** Insert the fence into the command stream. If the fence was already inserted, the previous one is discarded.
+        */
+        void insert();
+
+        /** Check if the GPU reached the fence. Doesn't block. A fence which was never inserted is considered signaled.
+        */
+        bool isSignaled() const;
+
+        /** Block until the GPU reaches the fence
+        */
+        void wait() const;
+
+    private:
+        GpuFence() = default;
+        void* mApiHandle = nullptr;
+    };
+}
@@ -0,0 +1,129 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "GpuRingBuffer.h"
+
+namespace Falcor
+{
+    GpuRingBuffer::UniquePtr GpuRingBuffer::create(const Buffer::SharedPtr& pBuffer)
+    {
+        return UniquePtr(new GpuRingBuffer(pBuffer));
+    }
+
+    GpuRingBuffer::GpuRingBuffer(const Buffer::SharedPtr& pBuffer) : mpBuffer(pBuffer), mAllocator(pBuffer->getSize())
+    {
+#ifndef FALCOR_DX11
+        if((pBuffer->getAccessFlags() & Buffer::AccessFlags::MapPersistent) != Buffer::AccessFlags::None)
+        {
+            mpPersistentData = (uint8_t*)mpBuffer->map(Buffer::MapType::WriteNoOverwrite);
+        }
+#endif
+    }
+
+    GpuRingBuffer::~GpuRingBuffer()
+    {
+        if(mpPersistentData)
+        {
+            mpBuffer->unmap();
+        }
+    }
+
+    void GpuRingBuffer::releaseCompletedFrames(bool waitForOldest)
+    {
+        if(waitForOldest && mFences.size())
+        {
+            mFences.front()->wait();
+        }
+
+        // Fence values are the frame index, so the value of the oldest fence is known from the number of fences in flight
+        uint64_t completedValue = mFenceValue - mFences.size();
+        while(mFences.size() && mFences.front()->isSignaled())
+        {
+            mFreeFences.push_back(mFences.front());
+            mFences.pop_front();
+            completedValue++;
+        }
+        mAllocator.releaseFrames(completedValue);
+    }
+
+    void* GpuRingBuffer::map(size_t size, size_t alignment, size_t& offset)
+    {
+        if(size > mAllocator.getCapacity())
+        {
+            Logger::log(Logger::Level::Error, "GpuRingBuffer::map() - requested size is larger than the buffer size");
+            return nullptr;
+        }
+
+        releaseCompletedFrames(false);
+        offset = mAllocator.allocate(size, alignment);
+        while(offset == RingBufferAllocator::kInvalidOffset)
+        {
+            if(mFences.empty())
+            {
+                // All the space is used by the current frame
+                Logger::log(Logger::Level::Error, "GpuRingBuffer::map() - buffer is too small for the data written in a single frame");
+                return nullptr;
+            }
+            releaseCompletedFrames(true);
+            offset = mAllocator.allocate(size, alignment);
+        }
+
+        if(mpPersistentData)
+        {
+            return mpPersistentData + offset;
+        }
+        return mpBuffer->map(Buffer::MapType::WriteNoOverwrite, offset, size);
+    }
+
+    void GpuRingBuffer::unmap()
+    {
+        if(mpPersistentData == nullptr)
+        {
+            mpBuffer->unmap();
+        }
+    }
+
+    void GpuRingBuffer::endFrame()
+    {
+        GpuFence::SharedPtr pFence;
+        if(mFreeFences.size())
+        {
+            pFence = mFreeFences.back();
+            mFreeFences.pop_back();
+        }
+        else
+        {
+            pFence = GpuFence::create();
+        }
+        pFence->insert();
+        mFences.push_back(pFence);
+
+        mFenceValue++;
+        mAllocator.endFrame(mFenceValue);
+    }
+}
@@ -0,0 +1,89 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <deque>
+#include <vector>
+#include "Core/Buffer.h"
+#include "Core/GpuFence.h"
+#include "Utils/RingBufferAllocator.h"
+
+namespace Falcor
+{
+    /** Streams data written by the CPU every frame into a GPU buffer.\n
+        The buffer is used as a ring. The ranges written during a frame are protected by a fence, and are only reused after the GPU finished the frame. This avoids both driver-side copies and stalls, as long as the buffer is large enough to hold a few frames of data.\n
+        If the buffer was created with Buffer#AccessFlags#MapPersistent, it is mapped once when the object is created. map() then only sub-allocates a range of the mapping and unmap() does nothing.
+    */
+    class GpuRingBuffer
+    {
+    public:
+        using UniquePtr = std::unique_ptr<GpuRingBuffer>;
+        using UniqueConstPtr = std::unique_ptr<const GpuRingBuffer>;
+
+        /** Create a new object
+            \param[in] pBuffer The buffer to stream into. Must be created with Buffer#AccessFlags#MapWrite. The content of the buffer isn't preserved.
+        */
+        static UniquePtr create(const Buffer::SharedPtr& pBuffer);
+
+        ~GpuRingBuffer();
+
+        /** Allocate a range and map it for writing. If the buffer is full, will wait until the GPU finishes using older frames.
+            \param[in] size The number of bytes to allocate
+            \param[in] alignment The required alignment of the range's offset. Must be a power of 2.
+            \param[out] offset The offset of the allocated range inside the buffer
+            \return A pointer to the start of the range, or nullptr if the size is larger than the buffer
+        */
+        void* map(size_t size, size_t alignment, size_t& offset);
+
+        /** Unmap the buffer. Must be called before issuing draw calls which use the data.
+        */
+        void unmap();
+
+        /** Insert a fence protecting all the ranges allocated since the last call. Call it after issuing the draw calls which use the data.
+        */
+        void endFrame();
+
+        /** Get the buffer
+        */
+        const Buffer::SharedPtr& getBuffer() const { return mpBuffer; }
+
+        /** Get the number of bytes allocated since the last call to endFrame()
+        */
+        size_t getFrameSize() const { return mAllocator.getFrameSize(); }
+
+    private:
+        GpuRingBuffer(const Buffer::SharedPtr& pBuffer);
+        void releaseCompletedFrames(bool waitForOldest);
+
+        Buffer::SharedPtr mpBuffer;
+        uint8_t* mpPersistentData = nullptr;            ///< The mapping of a persistently mapped buffer
+        RingBufferAllocator mAllocator;
+        std::deque<GpuFence::SharedPtr> mFences;        ///< The fences of the frames in flight, oldest first
+        std::vector<GpuFence::SharedPtr> mFreeFences;
+        uint64_t mFenceValue = 0;
+    };
+}
@@ -0,0 +1,152 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#ifdef FALCOR_NULL
+#include "Core/Buffer.h"
+#include "Core/Null/NullCommandStream.h"
+
+namespace Falcor
+{
+    using Command = NullCommandStream::Command;
+    using CommandType = NullCommandStream::CommandType;
+
+    Buffer::SharedPtr Buffer::create(size_t size, BindFlags usage, AccessFlags access, const void* pInitData)
+    {
+        SharedPtr pBuffer = SharedPtr(new Buffer(size, usage, access));
+        pBuffer->mApiHandle = std::make_shared<NullBuffer>();
+        pBuffer->mApiHandle->id = createNullApiHandle();
+        pBuffer->mApiHandle->data.resize(size);
+        if(pInitData)
+        {
+            memcpy(pBuffer->mApiHandle->data.data(), pInitData, size);
+        }
+        return pBuffer;
+    }
+
+    Buffer::~Buffer() = default;
+
+    void Buffer::copy(Buffer* pDst) const
+    {
+        if(mSize != pDst->mSize)
+        {
+            Logger::log(Logger::Level::Error, "Error in Buffer::Copy().\nSource buffer size is " + std::to_string(mSize) + ", Destination buffer size is " + std::to_string(pDst->mSize) + ".\nBuffers should have the same size.");
+            return;
+        }
+        copy(pDst, 0, 0, mSize);
+    }
+
+    void Buffer::copy(Buffer* pDst, size_t srcOffset, size_t dstOffset, size_t count) const
+    {
+        if(mSize < srcOffset + count || pDst->mSize < dstOffset + count)
+        {
+            Logger::log(Logger::Level::Error, "Error in Buffer::Copy().\nSource buffer size is " + std::to_string(mSize) + ", Destination buffer size is " + std::to_string(pDst->mSize) + ", Copy offsets are " + std::to_string(srcOffset) + ", " + std::to_string(dstOffset) + ", Copy size is " + std::to_string(count) + ".\nBuffers are too small to perform copy.");
+            return;
+        }
+
+        memmove(pDst->mApiHandle->data.data() + dstOffset, mApiHandle->data.data() + srcOffset, count);
+
+        Command cmd(CommandType::CopyBuffer, pDst->mApiHandle->id);
+        cmd.elementCount = (uint32_t)count;
+        cmd.startLocation = (uint32_t)dstOffset;
+        getNullCommandStream()->record(cmd);
+    }
+
+    void Buffer::updateData(const void* pData, size_t offset, size_t size, bool forceUpdate)
+    {
+        if((size + offset) > mSize)
+        {
+            std::string Error = "Buffer::updateData called with data larger then the buffer size. Buffer size = " + std::to_string(mSize) + " , Data size = " + std::to_string(size) + ".";
+            Logger::log(Logger::Level::Error, Error);
+            return;
+        }
+
+        memcpy(mApiHandle->data.data() + offset, pData, size);
+
+        Command cmd(CommandType::UpdateBuffer, mApiHandle->id);
+        cmd.elementCount = (uint32_t)size;
+        cmd.startLocation = (uint32_t)offset;
+        getNullCommandStream()->record(cmd);
+    }
+
+    void Buffer::readData(void* pData, size_t offset, size_t size) const
+    {
+        if(size + offset > mSize)
+        {
+            std::string Error = "Buffer::readData called with data larger then the buffer size. Buffer size = " + std::to_string(mSize) + " , Data size = " + std::to_string(size) + ".";
+            Logger::log(Logger::Level::Error, Error);
+            return;
+        }
+        memcpy(pData, mApiHandle->data.data() + offset, size);
+    }
+
+    uint64_t Buffer::getBindlessHandle()
+    {
+        UNSUPPORTED_IN_NULL("Buffer::getBindlessHandle()");
+        return 0;
+    }
+
+    void* Buffer::map(MapType type, size_t offset, size_t size)
+    {
+        if(mIsMapped)
+        {
+            Logger::log(Logger::Level::Error, "Buffer::Map() error. Buffer is already mapped");
+            return nullptr;
+        }
+
+        if(offset + size > mSize)
+        {
+            Logger::log(Logger::Level::Error, "Buffer::Map() error. Range is out of the buffer bounds");
+            return nullptr;
+        }
+
+        mIsMapped = true;
+        return mApiHandle->data.data() + offset;
+    }
+
+    void Buffer::unmap()
+    {
+        if(mIsMapped == false)
+        {
+            Logger::log(Logger::Level::Error, "Buffer::Unmap() error. Buffer is not mapped");
+            return;
+        }
+        mIsMapped = false;
+    }
+
+    uint64_t Buffer::makeResident(Buffer::GpuAccessFlags flags/* = Buffer::GpuAccessFlags::ReadOnly*/) const
+    {
+        UNSUPPORTED_IN_NULL("Buffer::makeResident()");
+        return 0;
+    }
+
+    void Buffer::makeNonResident() const
+    {
+        UNSUPPORTED_IN_NULL("Buffer::makeNonResident()");
+    }
+}
+#endif //#ifdef FALCOR_NULL
@@ -0,0 +1,80 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <vector>
+#include "Core/Formats.h"
+
+namespace Falcor
+{
+    /*!
+    *  \addtogroup Falcor
+    *  @{
+    */
+
+    /** Buffer object of the null backend. There is no GPU behind the backend, so buffers keep a CPU copy of their data which can be mapped, updated and read back.
+    */
+    struct NullBuffer
+    {
+        uint32_t id = 0;
+        std::vector<uint8_t> data;
+    };
+
+    using NullBufferPtr = std::shared_ptr<NullBuffer>;
+
+    /** Create a new API handle. Handles are never recycled and are never 0, so 0 can be used as the 'no object' handle like in GL.
+    */
+    uint32_t createNullApiHandle();
+
+    class NullCommandStream;
+    /** Get the command stream draws and state changes are recorded into. This is the null backend's equivalent of the immediate context.
+    */
+    NullCommandStream* getNullCommandStream();
+
+    using TextureHandle             = uint32_t;
+    using BufferHandle              = NullBufferPtr;
+    using VaoHandle                 = uint32_t;
+    using VertexShaderHandle        = uint32_t;
+    using FragmentShaderHandle      = uint32_t;
+    using DomainShaderHandle        = uint32_t;
+    using HullShaderHandle          = uint32_t;
+    using GeometryShaderHandle      = uint32_t;
+    using ComputeShaderHandle       = uint32_t;
+    using ProgramHandle             = uint32_t;
+    using DepthStencilStateHandle   = uint32_t;
+    using RasterizerStateHandle     = uint32_t;
+    using BlendStateHandle          = uint32_t;
+    using SamplerApiHandle          = uint32_t;
+    using ShaderResourceViewHandle  = uint32_t;
+
+    /*! @} */
+}
+
+#define DEFAULT_API_MAJOR_VERSION 1
+#define DEFAULT_API_MINOR_VERSION 0
+
+#define UNSUPPORTED_IN_NULL(msg_) {Falcor::Logger::log(Falcor::Logger::Level::Warning, msg_ + std::string(" is not supported in the null backend. Ignoring call."));}
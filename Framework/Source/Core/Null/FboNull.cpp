@@ -0,0 +1,144 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#ifdef FALCOR_NULL
+#include "Core/FBO.h"
+#include "Core/Texture.h"
+#include "Core/Null/NullCommandStream.h"
+
+namespace Falcor
+{
+    Fbo::Fbo(bool initApiHandle)
+    {
+        mColorAttachments.resize(getMaxColorTargetCount());
+        if(initApiHandle)
+        {
+            mApiHandle = createNullApiHandle();
+        }
+    }
+
+    Fbo::~Fbo() = default;
+
+    uint32_t Fbo::getApiHandle() const
+    {
+        return mApiHandle;
+    }
+
+    uint32_t Fbo::getMaxColorTargetCount()
+    {
+        return 8;
+    }
+
+    void Fbo::applyColorAttachment(uint32_t rtIndex)
+    {
+    }
+
+    void Fbo::applyDepthAttachment()
+    {
+        mHasDepthAttachment = (mDepthStencil.pTexture != nullptr);
+    }
+
+    bool Fbo::checkStatus() const
+    {
+        if(mIsDirty)
+        {
+            if(calcAndValidateProperties() == false)
+            {
+                return false;
+            }
+            mIsDirty = false;
+        }
+        return true;
+    }
+
+    static void recordColorClear(const Fbo* pFbo, uint32_t rtIndex)
+    {
+        getNullCommandStream()->record(NullCommandStream::Command(NullCommandStream::CommandType::ClearColorTarget, pFbo->getApiHandle(), rtIndex));
+    }
+
+    void Fbo::clearColorTarget(uint32_t rtIndex, const glm::vec4& color) const
+    {
+        if(checkStatus())
+        {
+            recordColorClear(this, rtIndex);
+        }
+    }
+
+    void Fbo::clearColorTarget(uint32_t rtIndex, const glm::uvec4& color) const
+    {
+        if(checkStatus())
+        {
+            recordColorClear(this, rtIndex);
+        }
+    }
+
+    void Fbo::clearColorTarget(uint32_t rtIndex, const glm::ivec4& color) const
+    {
+        if(checkStatus())
+        {
+            recordColorClear(this, rtIndex);
+        }
+    }
+
+    void Fbo::clearDepthStencil(float depth, uint8_t stencil, bool clearDepth, bool clearStencil) const
+    {
+        if(!checkStatus())
+        {
+            return;
+        }
+
+        if(mHasDepthAttachment && (clearDepth || clearStencil))
+        {
+            getNullCommandStream()->record(NullCommandStream::Command(NullCommandStream::CommandType::ClearDepthStencil, mApiHandle));
+        }
+    }
+
+    void Fbo::captureToFile(uint32_t rtIndex, const std::string& filename, Bitmap::FileFormat fileFormat)
+    {
+        UNSUPPORTED_IN_NULL("Fbo::captureToFile()");
+    }
+
+    void Fbo::setZeroAttachments(uint32_t width, uint32_t height, uint32_t layers, uint32_t samples, bool fixedSampleLocs)
+    {
+        if(mApiHandle != 0)
+        {
+            mWidth = width;
+            mHeight = height;
+            mDepth = layers;
+            mIsLayered = (layers > 1);
+            mSampleCount = samples;
+            mIsDirty = true;
+            mIsZeroAttachment = true;
+        }
+        else
+        {
+            Logger::log(Logger::Level::Error, "Can't create zero-attachment with the default FBO. Ignoring call");
+        }
+    }
+}
+#endif //#ifdef FALCOR_NULL
@@ -0,0 +1,62 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#ifdef FALCOR_NULL
+#include "NullCommandStream.h"
+
+namespace Falcor
+{
+    NullCommandStream::NullCommandStream()
+    {
+        clear();
+    }
+
+    void NullCommandStream::record(const Command& command)
+    {
+        mCommandCount[(uint32_t)command.type]++;
+        if(mRecordingEnabled)
+        {
+            mCommands.push_back(command);
+        }
+    }
+
+    uint64_t NullCommandStream::getDrawCount() const
+    {
+        return getCommandCount(CommandType::Draw) + getCommandCount(CommandType::DrawIndexed) + getCommandCount(CommandType::DrawIndexedInstanced);
+    }
+
+    void NullCommandStream::clear()
+    {
+        mCommands.clear();
+        for(uint32_t i = 0; i < arraysize(mCommandCount); i++)
+        {
+            mCommandCount[i] = 0;
+        }
+    }
+}
+#endif //#ifdef FALCOR_NULL
@@ -0,0 +1,153 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <vector>
+#include <string>
+
+namespace Falcor
+{
+    /** In-memory command stream of the null backend.
+        The null backend doesn't execute any work. Draws and state changes issued through the render-context and the API objects are recorded into this stream instead, so that tests and CPU benchmarks can inspect what was submitted.\n
+        The per-type counters are always updated. Storing the commands themselves can be disabled for long benchmark runs.\n
+        The stream is not thread-safe. Like any other API call, commands should be issued from the thread which owns the render-context.
+    */
+    class NullCommandStream
+    {
+    public:
+        /** Recorded command types
+        */
+        enum class CommandType
+        {
+            SetFbo,
+            SetVao,
+            SetProgram,
+            SetTopology,
+            SetRasterizerState,
+            SetDepthStencilState,
+            SetBlendState,
+            SetUniformBuffer,
+            SetShaderStorageBuffer,
+            SetViewport,
+            SetScissor,
+            Draw,
+            DrawIndexed,
+            DrawIndexedInstanced,
+            ClearColorTarget,
+            ClearDepthStencil,
+            BlitFbo,
+            UpdateBuffer,
+            CopyBuffer,
+            UploadTexture,
+
+            Count
+        };
+
+        /** A recorded command. Fields which are not relevant to the command type are 0.
+        */
+        struct Command
+        {
+            CommandType type;
+            uint32_t objectID = 0;              ///< API handle of the object the command refers to. For state changes, this is the bound object (0 when unbinding). For clears and uploads, this is the target object.
+            uint32_t slot = 0;                  ///< Binding slot for buffers, viewports and scissors. Render-target index for color clears.
+            uint32_t elementCount = 0;          ///< Vertex/index count for draws, byte count for buffer updates and copies.
+            uint32_t instanceCount = 0;         ///< Instance count for draws.
+            uint32_t startLocation = 0;         ///< First vertex/index for draws, byte offset for buffer updates and copies.
+            int32_t baseVertexLocation = 0;     ///< Base vertex for indexed draws.
+            uint32_t startInstanceLocation = 0; ///< First instance for instanced draws.
+
+            Command(CommandType t, uint32_t object = 0, uint32_t s = 0) : type(t), objectID(object), slot(s) {}
+        };
+
+        NullCommandStream();
+
+        /** Record a command
+        */
+        void record(const Command& command);
+
+        /** Get the recorded commands, in submission order
+        */
+        const std::vector<Command>& getCommands() const { return mCommands; }
+
+        /** Get the number of commands of a specific type recorded since the last call to clear(). Includes commands which were not stored because recording was disabled.
+        */
+        uint64_t getCommandCount(CommandType type) const { return mCommandCount[(uint32_t)type]; }
+
+        /** Get the number of draw calls of all types recorded since the last call to clear()
+        */
+        uint64_t getDrawCount() const;
+
+        /** Remove all recorded commands and reset the counters
+        */
+        void clear();
+
+        /** Control whether commands are stored. When disabled, only the counters are updated.
+        */
+        void setRecordingEnabled(bool enabled) { mRecordingEnabled = enabled; }
+
+        /** Check if commands are stored
+        */
+        bool isRecordingEnabled() const { return mRecordingEnabled; }
+
+    private:
+        std::vector<Command> mCommands;
+        uint64_t mCommandCount[(uint32_t)CommandType::Count];
+        bool mRecordingEnabled = true;
+    };
+
+    inline const std::string to_string(NullCommandStream::CommandType type)
+    {
+#define type_2_string(a) case NullCommandStream::CommandType::a: return #a;
+        switch(type)
+        {
+        type_2_string(SetFbo);
+        type_2_string(SetVao);
+        type_2_string(SetProgram);
+        type_2_string(SetTopology);
+        type_2_string(SetRasterizerState);
+        type_2_string(SetDepthStencilState);
+        type_2_string(SetBlendState);
+        type_2_string(SetUniformBuffer);
+        type_2_string(SetShaderStorageBuffer);
+        type_2_string(SetViewport);
+        type_2_string(SetScissor);
+        type_2_string(Draw);
+        type_2_string(DrawIndexed);
+        type_2_string(DrawIndexedInstanced);
+        type_2_string(ClearColorTarget);
+        type_2_string(ClearDepthStencil);
+        type_2_string(BlitFbo);
+        type_2_string(UpdateBuffer);
+        type_2_string(CopyBuffer);
+        type_2_string(UploadTexture);
+        default:
+            should_not_get_here();
+            return "";
+        }
+#undef type_2_string
+    }
+}
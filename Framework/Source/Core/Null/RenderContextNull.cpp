@@ -0,0 +1,193 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#ifdef FALCOR_NULL
+#include "Core/RenderContext.h"
+#include "Core/RasterizerState.h"
+#include "Core/BlendState.h"
+#include "Core/FBO.h"
+#include "Core/ProgramVersion.h"
+#include "Core/VAO.h"
+#include "Core/UniformBuffer.h"
+#include "Core/Buffer.h"
+#include "Core/ShaderStorageBuffer.h"
+#include "Core/Null/NullCommandStream.h"
+
+namespace Falcor
+{
+    using Command = NullCommandStream::Command;
+    using CommandType = NullCommandStream::CommandType;
+
+    // The null backend reports the limits of a typical GL 4.5 implementation
+    static const uint32_t kViewportCount = 16;
+    static const uint32_t kUniformBlockCount = 72;
+    static const uint32_t kShaderStorageBlockCount = 16;
+
+    RenderContext::~RenderContext() = default;
+
+    RenderContext::SharedPtr RenderContext::create()
+    {
+        auto pCtx = SharedPtr(new RenderContext(kViewportCount));
+        pCtx->mState.pUniformBuffers.assign(kUniformBlockCount, nullptr);
+        pCtx->mState.pShaderStorageBuffers.assign(kShaderStorageBlockCount, nullptr);
+        return pCtx;
+    }
+
+    void RenderContext::applyDepthStencilState() const
+    {
+        getNullCommandStream()->record(Command(CommandType::SetDepthStencilState, mState.pDsState->getApiHandle()));
+    }
+
+    void RenderContext::applyRasterizerState() const
+    {
+        getNullCommandStream()->record(Command(CommandType::SetRasterizerState, mState.pRastState->getApiHandle()));
+    }
+
+    void RenderContext::applyBlendState() const
+    {
+        getNullCommandStream()->record(Command(CommandType::SetBlendState, mState.pBlendState->getApiHandle()));
+    }
+
+    void RenderContext::applyProgram() const
+    {
+        const auto pProgram = mState.pProgram;
+        uint32_t apiHandle = pProgram ? pProgram->getApiHandle() : 0;
+        getNullCommandStream()->record(Command(CommandType::SetProgram, apiHandle));
+    }
+
+    void RenderContext::applyVao() const
+    {
+        const auto pVao = mState.pVao;
+        uint32_t apiHandle = pVao ? pVao->getApiHandle() : 0;
+        getNullCommandStream()->record(Command(CommandType::SetVao, apiHandle));
+    }
+
+    void RenderContext::applyFbo() const
+    {
+        auto pFbo = mState.pFbo;
+        if(pFbo->checkStatus())
+        {
+            getNullCommandStream()->record(Command(CommandType::SetFbo, pFbo->getApiHandle()));
+        }
+    }
+
+    void RenderContext::blitFbo(const Fbo* pSource, const Fbo* pTarget, const glm::ivec4& srcRegion, const glm::ivec4& dstRegion, const bool useLinearFiltering, const FboAttachmentType copyFlags, uint32_t srcIdx, uint32_t dstIdx)
+    {
+        assert(copyFlags != FboAttachmentType::None);
+        pTarget = pTarget ? pTarget : mState.pFbo.get();
+        getNullCommandStream()->record(Command(CommandType::BlitFbo, pTarget->getApiHandle(), dstIdx));
+    }
+
+    void RenderContext::applyUniformBuffer(uint32_t index) const
+    {
+        const auto pBuffer = mState.pUniformBuffers[index];
+        uint32_t apiHandle = (pBuffer && pBuffer->getBuffer()) ? pBuffer->getBuffer()->getApiHandle()->id : 0;
+        getNullCommandStream()->record(Command(CommandType::SetUniformBuffer, apiHandle, index));
+    }
+
+    void RenderContext::applyShaderStorageBuffer(uint32_t index) const
+    {
+        const auto pBuffer = mState.pShaderStorageBuffers[index];
+        uint32_t apiHandle = (pBuffer && pBuffer->getBuffer()) ? pBuffer->getBuffer()->getApiHandle()->id : 0;
+        getNullCommandStream()->record(Command(CommandType::SetShaderStorageBuffer, apiHandle, index));
+    }
+
+    void RenderContext::applyTopology() const
+    {
+        getNullCommandStream()->record(Command(CommandType::SetTopology, (uint32_t)mState.topology));
+    }
+
+    void RenderContext::draw(uint32_t vertexCount, uint32_t startVertexLocation)
+    {
+        prepareForDraw(vertexCount, 1);
+        Command cmd(CommandType::Draw);
+        cmd.elementCount = vertexCount;
+        cmd.instanceCount = 1;
+        cmd.startLocation = startVertexLocation;
+        getNullCommandStream()->record(cmd);
+    }
+
+    void RenderContext::drawIndexed(uint32_t indexCount, uint32_t startIndexLocation, int baseVertexLocation)
+    {
+        prepareForDraw(indexCount, 1);
+        Command cmd(CommandType::DrawIndexed);
+        cmd.elementCount = indexCount;
+        cmd.instanceCount = 1;
+        cmd.startLocation = startIndexLocation;
+        cmd.baseVertexLocation = baseVertexLocation;
+        getNullCommandStream()->record(cmd);
+    }
+
+    void RenderContext::drawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndexLocation, int baseVertexLocation, uint32_t startInstanceLocation)
+    {
+        prepareForDraw(indexCount, instanceCount);
+        Command cmd(CommandType::DrawIndexedInstanced);
+        cmd.elementCount = indexCount;
+        cmd.instanceCount = instanceCount;
+        cmd.startLocation = startIndexLocation;
+        cmd.baseVertexLocation = baseVertexLocation;
+        cmd.startInstanceLocation = startInstanceLocation;
+        getNullCommandStream()->record(cmd);
+    }
+
+    void RenderContext::multiDrawIndexed(const uint32_t* pIndexCounts, const uint32_t* pStartIndexLocations, uint32_t drawCount, int baseVertexLocation)
+    {
+        uint32_t totalIndexCount = 0;
+        for(uint32_t i = 0; i < drawCount; i++)
+        {
+            totalIndexCount += pIndexCounts[i];
+        }
+        prepareForDraw(totalIndexCount, 1);
+
+        // Recorded as the equivalent sequence of indexed draws
+        for(uint32_t i = 0; i < drawCount; i++)
+        {
+            Command cmd(CommandType::DrawIndexed);
+            cmd.elementCount = pIndexCounts[i];
+            cmd.instanceCount = 1;
+            cmd.startLocation = pStartIndexLocations[i];
+            cmd.baseVertexLocation = baseVertexLocation;
+            getNullCommandStream()->record(cmd);
+        }
+    }
+
+    void RenderContext::applyViewport(uint32_t index) const
+    {
+        getNullCommandStream()->record(Command(CommandType::SetViewport, 0, index));
+    }
+
+    void RenderContext::applyScissor(uint32_t index) const
+    {
+        getNullCommandStream()->record(Command(CommandType::SetScissor, 0, index));
+    }
+
+    void RenderContext::prepareForDrawApi() const
+    {
+    }
+}
+#endif //#ifdef FALCOR_NULL
@@ -0,0 +1,73 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#ifdef FALCOR_NULL
+#include "Core/Shader.h"
+
+namespace Falcor
+{
+    struct ShaderData
+    {
+        uint32_t apiHandle = 0;
+        std::string source;
+    };
+
+    template<>
+    VertexShaderHandle Shader::getApiHandle<VertexShaderHandle>() const
+    {
+        return ((ShaderData*)mpPrivateData)->apiHandle;
+    }
+
+    const std::string& Shader::getSource() const
+    {
+        return ((ShaderData*)mpPrivateData)->source;
+    }
+
+    Shader::Shader(ShaderType shaderType) : mType(shaderType)
+    {
+        ShaderData* pData = new ShaderData;
+        pData->apiHandle = createNullApiHandle();
+        mpPrivateData = pData;
+    }
+
+    Shader::~Shader()
+    {
+        ShaderData* pData = (ShaderData*)mpPrivateData;
+        safe_delete(pData);
+    }
+
+    Shader::SharedPtr Shader::create(const std::string& shaderString, ShaderType shaderType, std::string& log)
+    {
+        // There is no compiler behind the null backend. The source is kept so that the program can extract the buffer declarations from it.
+        auto pShader = SharedPtr(new Shader(shaderType));
+        ((ShaderData*)pShader->mpPrivateData)->source = shaderString;
+        log.clear();
+        return pShader;
+    }
+}
+#endif //#ifdef FALCOR_NULL
@@ -0,0 +1,108 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#ifdef FALCOR_NULL
+#include "ShaderReflectionNull.h"
+#include <regex>
+
+namespace Falcor
+{
+    namespace ShaderReflection
+    {
+        static uint32_t findFreeSlot(const BufferDescMap& descMap, BufferDesc::Type type)
+        {
+            uint32_t slot = 0;
+            bool found = false;
+            while(found == false)
+            {
+                found = true;
+                for(const auto& desc : descMap)
+                {
+                    if(desc.second.type == type && desc.second.bufferSlot == slot)
+                    {
+                        slot++;
+                        found = false;
+                        break;
+                    }
+                }
+            }
+            return slot;
+        }
+
+        void reflectBuffers(const std::string& source, BufferDescMap& descMap)
+        {
+            // Matches "[layout(...)] uniform|buffer BlockName {"
+            static const std::regex kBlockRegex(R"((?:layout\s*\(([^)]*)\)\s*)?(?:\w+\s+)*?\b(uniform|buffer)\s+(\w+)\s*\{)");
+            static const std::regex kBindingRegex(R"(binding\s*=\s*(\d+))");
+
+            // Declarations are collected first, so that blocks with an explicit binding are assigned before the rest
+            struct Declaration
+            {
+                std::string name;
+                BufferDesc::Type type;
+                int32_t binding;
+            };
+            std::vector<Declaration> declarations;
+
+            for(auto it = std::sregex_iterator(source.begin(), source.end(), kBlockRegex); it != std::sregex_iterator(); it++)
+            {
+                const std::smatch& match = *it;
+                Declaration decl;
+                decl.name = match[3].str();
+                decl.type = (match[2].str() == "uniform") ? BufferDesc::Type::Uniform : BufferDesc::Type::ShaderStorage;
+                decl.binding = -1;
+
+                std::smatch bindingMatch;
+                const std::string layout = match[1].str();
+                if(std::regex_search(layout, bindingMatch, kBindingRegex))
+                {
+                    decl.binding = std::stoi(bindingMatch[1].str());
+                }
+                declarations.push_back(decl);
+            }
+
+            for(int pass = 0; pass < 2; pass++)
+            {
+                for(const auto& decl : declarations)
+                {
+                    bool hasBinding = (decl.binding >= 0);
+                    if(hasBinding != (pass == 0) || descMap.find(decl.name) != descMap.end())
+                    {
+                        continue;
+                    }
+
+                    BufferDesc desc;
+                    desc.type = decl.type;
+                    desc.bufferSlot = hasBinding ? (uint32_t)decl.binding : findFreeSlot(descMap, decl.type);
+                    descMap[decl.name] = desc;
+                }
+            }
+        }
+    }
+}
+#endif //#ifdef FALCOR_NULL
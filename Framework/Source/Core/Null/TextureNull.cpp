@@ -0,0 +1,209 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#ifdef FALCOR_NULL
+#include "Core/Texture.h"
+#include "Core/Null/NullCommandStream.h"
+
+namespace Falcor
+{
+    // Null textures don't have storage. Only the description is kept, which is enough for the code which sizes render-targets and uploads data.
+    Texture::~Texture() = default;
+
+    uint64_t Texture::makeResident(const Sampler* pSampler) const
+    {
+        UNSUPPORTED_IN_NULL("Texture::makeResident()");
+        return 0;
+    }
+
+    void Texture::makeNonResident(const Sampler* pSampler) const
+    {
+        UNSUPPORTED_IN_NULL("Texture::makeNonResident()");
+    }
+
+    static Texture::SharedPtr initTexture(Texture::SharedPtr pTexture, const void* pData)
+    {
+        if(pData)
+        {
+            NullCommandStream::Command cmd(NullCommandStream::CommandType::UploadTexture, pTexture->getApiHandle());
+            cmd.elementCount = pTexture->getMipLevelDataSize(0) * pTexture->getArraySize();
+            getNullCommandStream()->record(cmd);
+        }
+        return pTexture;
+    }
+
+    Texture::SharedPtr Texture::create1D(uint32_t width, ResourceFormat format, uint32_t arraySize, uint32_t mipLevels, const void* pData)
+    {
+        auto pResource = SharedPtr(new Texture(width, 1, 1, arraySize, mipLevels, 1, format, Texture::Type::Texture1D));
+        pResource->mApiHandle = createNullApiHandle();
+        return initTexture(pResource, pData);
+    }
+
+    Texture::SharedPtr Texture::create2D(uint32_t width, uint32_t height, ResourceFormat format, uint32_t arraySize, uint32_t mipLevels, const void* pData)
+    {
+        auto pResource = SharedPtr(new Texture(width, height, 1, arraySize, mipLevels, 1, format, Texture::Type::Texture2D));
+        pResource->mApiHandle = createNullApiHandle();
+        return initTexture(pResource, pData);
+    }
+
+    Texture::SharedPtr Texture::create3D(uint32_t width, uint32_t height, uint32_t depth, ResourceFormat format, uint32_t mipLevels, const void* pData, bool isSparse)
+    {
+        auto pResource = SharedPtr(new Texture(width, height, depth, 1, mipLevels, 1, format, Texture::Type::Texture3D));
+        pResource->mApiHandle = createNullApiHandle();
+        pResource->mIsSparse = isSparse;
+        return initTexture(pResource, pData);
+    }
+
+    Texture::SharedPtr Texture::createCube(uint32_t width, uint32_t height, ResourceFormat format, uint32_t arraySize, uint32_t mipLevels, const void* pData)
+    {
+        auto pResource = SharedPtr(new Texture(width, height, 1, arraySize, mipLevels, 1, format, Texture::Type::TextureCube));
+        pResource->mApiHandle = createNullApiHandle();
+        return initTexture(pResource, pData);
+    }
+
+    Texture::SharedPtr Texture::create2DMS(uint32_t width, uint32_t height, ResourceFormat format, uint32_t sampleCount, uint32_t arraySize, bool useFixedSampleLocations)
+    {
+        auto pResource = SharedPtr(new Texture(width, height, 1, arraySize, 1, sampleCount, format, Texture::Type::Texture2DMultisample));
+        pResource->mApiHandle = createNullApiHandle();
+        pResource->mHasFixedSampleLocations = useFixedSampleLocations;
+        return pResource;
+    }
+
+    Texture::SharedPtr Texture::create2DFromView(uint32_t apiHandle, uint32_t width, uint32_t height, ResourceFormat format)
+    {
+        auto pResource = SharedPtr(new Texture(width, height, 1u, 1u, 1u, 1u, format, Texture::Type::Texture2D));
+        pResource->mApiHandle = apiHandle;
+        return pResource;
+    }
+
+    void Texture::getMipLevelImageSize(uint32_t mipLevel, uint32_t& width, uint32_t& height, uint32_t& depth) const
+    {
+        if(mipLevel >= mMipLevels)
+        {
+            Logger::log(Logger::Level::Error, "Texture::getMipLevelImageSize() - Requested mip level " + std::to_string(mipLevel) + " is out-of-bound. Texture has " + std::to_string(mMipLevels) + " mip-levels.");
+        }
+
+        width = max(1U, mWidth >> mipLevel);
+        height = max(1U, mHeight >> mipLevel);
+        depth = max(1U, mDepth >> mipLevel);
+    }
+
+    uint32_t Texture::getMipLevelDataSize(uint32_t mipLevel) const
+    {
+        if(mipLevel >= mMipLevels)
+        {
+            Logger::log(Logger::Level::Error, "Texture::getMipLevelDataSize() - Requested mip level " + std::to_string(mipLevel) + " is out-of-bound. Texture has " + std::to_string(mMipLevels) + " mip-levels.");
+            return 0;
+        }
+
+        uint32_t width, height, depth;
+        getMipLevelImageSize(mipLevel, width, height, depth);
+        return width * height * depth * getFormatBytesPerBlock(mFormat) / getFormatPixelsPerBlock(mFormat);
+    }
+
+    void Texture::readSubresourceData(void* pData, uint32_t dataSize, uint32_t mipLevel, uint32_t arraySlice) const
+    {
+        if(dataSize != getMipLevelDataSize(mipLevel))
+        {
+            Logger::log(Logger::Level::Error, "Error when reading texture data. Buffer size should be equal to Texture::getMipLevelDataSize(). Ignoring call.");
+            return;
+        }
+        // There is no storage to read from
+        memset(pData, 0, dataSize);
+    }
+
+    void Texture::uploadSubresourceData(const void* pData, uint32_t dataSize, uint32_t mipLevel, uint32_t arraySlice)
+    {
+        if(mipLevel >= mMipLevels)
+        {
+            Logger::log(Logger::Level::Error, "Texture::uploadSubresourceData() - Requested mip level " + std::to_string(mipLevel) + " is out-of-bound. Texture has " + std::to_string(mMipLevels) + "mip-levels. Ignoring call.");
+            return;
+        }
+
+        if(arraySlice >= mArraySize)
+        {
+            Logger::log(Logger::Level::Error, "Texture::uploadSubresourceData() - Requested array slice " + std::to_string(arraySlice) + " is out-of-bound. Texture has " + std::to_string(mArraySize) + "array slices. Ignoring call.");
+            return;
+        }
+
+        NullCommandStream::Command cmd(NullCommandStream::CommandType::UploadTexture, mApiHandle, arraySlice);
+        cmd.elementCount = dataSize;
+        cmd.startLocation = mipLevel;
+        getNullCommandStream()->record(cmd);
+    }
+
+    void Texture::captureToPng(uint32_t mipLevel, uint32_t arraySlice, const std::string& filename) const
+    {
+        UNSUPPORTED_IN_NULL("Texture::captureToPng()");
+    }
+
+    void Texture::compress2DTexture()
+    {
+        UNSUPPORTED_IN_NULL("Texture::compress2DTexture()");
+    }
+
+    void Texture::generateMips() const
+    {
+    }
+
+    ShaderResourceViewHandle Texture::getShaderResourceView() const
+    {
+        return mApiHandle;
+    }
+
+    void Texture::copySubresource(const Texture* pDst, uint32_t srcMipLevel, uint32_t srcArraySlice, uint32_t dstMipLevel, uint32_t dstArraySlice) const
+    {
+    }
+
+    Texture::SharedPtr Texture::createView(uint32_t firstArraySlice, uint32_t arraySize, uint32_t mostDetailedMip, uint32_t mipCount) const
+    {
+        if(firstArraySlice + arraySize > mArraySize)
+        {
+            Logger::log(Logger::Level::Error, "Texture::createView() - (firstArraySlice + arraySize) larger than texture array size");
+            return nullptr;
+        }
+
+        if(mostDetailedMip + mipCount > mMipLevels)
+        {
+            Logger::log(Logger::Level::Error, "Texture::createView() - (mostDetailedMip + mipCount) larger than texture mip levels");
+            return nullptr;
+        }
+
+        uint32_t width, height, depth;
+        getMipLevelImageSize(mostDetailedMip, width, height, depth);
+        auto pView = SharedPtr(new Texture(width, height, depth, arraySize, mipCount, mSampleCount, mFormat, mType));
+        pView->mApiHandle = createNullApiHandle();
+        return pView;
+    }
+
+    void Texture::setSparseResidencyPageIndex(bool isResident, uint32_t mipLevel, uint32_t pageX, uint32_t pageY, uint32_t pageZ, uint32_t width, uint32_t height, uint32_t depth)
+    {
+        assert(mIsSparse);
+    }
+}
+#endif //#ifdef FALCOR_NULL
@@ -0,0 +1,148 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#ifdef FALCOR_NULL
+#include "Core/Window.h"
+#include "Core/Texture.h"
+#include "Core/FBO.h"
+#include "Core/Null/NullCommandStream.h"
+#include <atomic>
+
+namespace Falcor
+{
+    // The null window is headless. It only owns the default FBO and runs the frame loop until shutdown() is called.
+    struct WindowData
+    {
+        bool shouldClose = false;
+    };
+
+    uint32_t createNullApiHandle()
+    {
+        static std::atomic<uint32_t> nextHandle(1);
+        return nextHandle++;
+    }
+
+    NullCommandStream* getNullCommandStream()
+    {
+        static NullCommandStream commandStream;
+        return &commandStream;
+    }
+
+    bool checkExtensionSupport(const std::string& name)
+    {
+        return false;
+    }
+
+    ResourceFormat getSwapChainColorFormat(bool isSrgb)
+    {
+        return isSrgb ? ResourceFormat::RGBA8UnormSrgb : ResourceFormat::RGBA8Unorm;
+    }
+
+    ResourceFormat getSwapChainDepthFormat()
+    {
+        return ResourceFormat::D24UnormS8;
+    }
+
+    Window::Window(ICallbacks* pCallbacks) : mpCallbacks(pCallbacks)
+    {
+        mpPrivateData = new WindowData;
+    }
+
+    Window::~Window()
+    {
+        WindowData* pData = (WindowData*)mpPrivateData;
+        safe_delete(pData);
+        mpPrivateData = nullptr;
+    }
+
+    void Window::shutdown()
+    {
+        ((WindowData*)mpPrivateData)->shouldClose = true;
+    }
+
+    Window::UniquePtr Window::create(const Desc& desc, ICallbacks* pCallbacks)
+    {
+        auto pWindow = UniquePtr(new Window(pCallbacks));
+        const SwapChainDesc& swapChainDesc = desc.swapChainDesc;
+        pWindow->updateDefaultFBO(swapChainDesc.width, swapChainDesc.height, swapChainDesc.sampleCount, getSwapChainColorFormat(swapChainDesc.isSrgb), getSwapChainDepthFormat());
+        return pWindow;
+    }
+
+    void Window::updateDefaultFBO(uint32_t width, uint32_t height, uint32_t sampleCount, ResourceFormat colorFormat, ResourceFormat depthFormat)
+    {
+        releaseDefaultFboResources();
+        sampleCount = max(1u, sampleCount);
+        auto pColorTex = Texture::SharedPtr(new Texture(width, height, 1, 1, 1, sampleCount, colorFormat, sampleCount > 1 ? Texture::Type::Texture2DMultisample : Texture::Type::Texture2D));
+        auto pDepthTex = Texture::SharedPtr(new Texture(width, height, 1, 1, 1, sampleCount, depthFormat, sampleCount > 1 ? Texture::Type::Texture2DMultisample : Texture::Type::Texture2D));
+        attachDefaultFboResources(pColorTex, pDepthTex);
+        mMouseScale.x = 1 / float(width);
+        mMouseScale.y = 1 / float(height);
+    }
+
+    void Window::setVSync(bool enable)
+    {
+    }
+
+    void Window::resize(uint32_t width, uint32_t height)
+    {
+        if(mpDefaultFBO->getWidth() != width || mpDefaultFBO->getHeight() != height)
+        {
+            const Texture* pColor = mpDefaultFBO->getColorTexture(0).get();
+            const Texture* pDepth = mpDefaultFBO->getDepthStencilTexture().get();
+            updateDefaultFBO(width, height, pColor->getSampleCount(), pColor->getFormat(), pDepth->getFormat());
+            mpCallbacks->handleFrameBufferSizeChange(mpDefaultFBO);
+        }
+    }
+
+    void Window::msgLoop()
+    {
+        PROFILE(msgLoop);
+        WindowData* pData = (WindowData*)mpPrivateData;
+        while(pData->shouldClose == false)
+        {
+            mpCallbacks->renderFrame();
+            {
+                PROFILE(present);
+                swapBuffers();
+            }
+        }
+    }
+
+    void Window::swapBuffers()
+    {
+    }
+
+    void Window::pollForEvents()
+    {
+    }
+
+    void Window::setWindowTitle(std::string title)
+    {
+    }
+}
+#endif //#ifdef FALCOR_NULL
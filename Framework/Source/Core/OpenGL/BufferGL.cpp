@@ -38,6 +38,7 @@ namespace Falcor
         glFlags |= ((flags & Buffer::AccessFlags::Dynamic) != Buffer::AccessFlags::None) ? GL_DYNAMIC_STORAGE_BIT : 0;
         glFlags |= ((flags & Buffer::AccessFlags::MapRead) != Buffer::AccessFlags::None) ? GL_MAP_READ_BIT : 0;
         glFlags |= ((flags & Buffer::AccessFlags::MapWrite) != Buffer::AccessFlags::None) ? GL_MAP_WRITE_BIT : 0;
+        glFlags |= ((flags & Buffer::AccessFlags::MapPersistent) != Buffer::AccessFlags::None) ? (GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT) : 0;
 
         return glFlags;
     }
@@ -119,7 +120,7 @@ namespace Falcor
         return mBindlessHandle;
     }
 
-    void* Buffer::map(MapType Type)
+    void* Buffer::map(MapType Type, size_t offset, size_t size)
     {
         if(mIsMapped)
         {
@@ -127,6 +128,12 @@ namespace Falcor
             return nullptr;
         }
 
+        if(offset + size > mSize)
+        {
+            Logger::log(Logger::Level::Error, "Buffer::map() error. Range is out of the buffer bounds");
+            return nullptr;
+        }
+
         GLenum flags = 0;
         switch(Type)
         {
@@ -134,9 +141,11 @@ namespace Falcor
             flags = GL_MAP_READ_BIT;
             break;
         case MapType::Write:
-        case MapType::WriteNoOverwrite:
             flags = GL_MAP_WRITE_BIT;
             break;
+        case MapType::WriteNoOverwrite:
+            flags = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+            break;
         case MapType::ReadWrite:
             flags = GL_MAP_READ_BIT | GL_MAP_WRITE_BIT;
             break;
@@ -148,7 +157,12 @@ namespace Falcor
             return nullptr;
         }
 
-        void* pData = gl_call(glMapNamedBufferRange(mApiHandle, 0, mSize, flags));
+        if((mAccessFlags & Buffer::AccessFlags::MapPersistent) != Buffer::AccessFlags::None)
+        {
+            flags |= GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        }
+
+        void* pData = gl_call(glMapNamedBufferRange(mApiHandle, offset, size, flags));
         mIsMapped = true;
         return pData;
     }
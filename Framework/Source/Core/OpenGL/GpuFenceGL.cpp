@@ -0,0 +1,90 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#ifdef FALCOR_GL
+#include "Core/GpuFence.h"
+
+namespace Falcor
+{
+    GpuFence::SharedPtr GpuFence::create()
+    {
+        return SharedPtr(new GpuFence);
+    }
+
+    GpuFence::~GpuFence()
+    {
+        if(mApiHandle)
+        {
+            glDeleteSync((GLsync)mApiHandle);
+        }
+    }
+
+    void GpuFence::insert()
+    {
+        if(mApiHandle)
+        {
+            glDeleteSync((GLsync)mApiHandle);
+        }
+        mApiHandle = gl_call(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    }
+
+    bool GpuFence::isSignaled() const
+    {
+        if(mApiHandle == nullptr)
+        {
+            return true;
+        }
+        GLint status;
+        gl_call(glGetSynciv((GLsync)mApiHandle, GL_SYNC_STATUS, sizeof(status), nullptr, &status));
+        return status == GL_SIGNALED;
+    }
+
+    void GpuFence::wait() const
+    {
+        if(mApiHandle == nullptr)
+        {
+            return;
+        }
+        // Flush the command stream on the first wait, otherwise the fence might never be submitted
+        GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+        while(true)
+        {
+            GLenum result = gl_call(glClientWaitSync((GLsync)mApiHandle, flags, 1000000));
+            if(result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED)
+            {
+                if(result == GL_WAIT_FAILED)
+                {
+                    Logger::log(Logger::Level::Error, "GpuFence::wait() - glClientWaitSync() failed");
+                }
+                return;
+            }
+            flags = 0;
+        }
+    }
+}
+#endif //#ifdef FALCOR_GL
@@ -487,27 +487,66 @@ namespace Falcor
 
     void RenderContext::draw(uint32_t vertexCount, uint32_t startVertexLocation)
     {
-        prepareForDraw();
+        prepareForDraw(vertexCount, 1);
         GLenum glTopology = getGlTopology(mState.topology);
         gl_call(glDrawArrays(glTopology, startVertexLocation, vertexCount));
     }
 
+    static GLenum getGlIndexType(ResourceFormat format)
+    {
+        switch(format)
+        {
+        case ResourceFormat::R16Uint:
+            return GL_UNSIGNED_SHORT;
+        case ResourceFormat::R32Uint:
+            return GL_UNSIGNED_INT;
+        default:
+            should_not_get_here();
+            return GL_NONE;
+        }
+    }
+
     void RenderContext::drawIndexed(uint32_t indexCount, uint32_t startIndexLocation, int baseVertexLocation)
     {
-        prepareForDraw();
+        prepareForDraw(indexCount, 1);
         GLenum glTopology = getGlTopology(mState.topology);
-        uint32_t offset = sizeof(uint32_t) * startIndexLocation;
+        ResourceFormat indexFormat = mState.pVao->getIndexBufferFormat();
+        uintptr_t offset = getFormatBytesPerBlock(indexFormat) * (uintptr_t)startIndexLocation;
 
-        gl_call(glDrawElementsBaseVertex(glTopology, indexCount, GL_UNSIGNED_INT, (void*)(uintptr_t)offset, baseVertexLocation));
+        gl_call(glDrawElementsBaseVertex(glTopology, indexCount, getGlIndexType(indexFormat), (void*)offset, baseVertexLocation));
     }
 
     void RenderContext::drawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndexLocation, int baseVertexLocation, uint32_t startInstanceLocation)
     {
-        prepareForDraw();
+        prepareForDraw(indexCount, instanceCount);
+        GLenum glTopology = getGlTopology(mState.topology);
+        ResourceFormat indexFormat = mState.pVao->getIndexBufferFormat();
+        uintptr_t offset = getFormatBytesPerBlock(indexFormat) * (uintptr_t)startIndexLocation;
+
+        gl_call(glDrawElementsInstancedBaseVertexBaseInstance(glTopology, indexCount, getGlIndexType(indexFormat), (void*)offset, instanceCount, baseVertexLocation, startInstanceLocation));
+    }
+
+    void RenderContext::multiDrawIndexed(const uint32_t* pIndexCounts, const uint32_t* pStartIndexLocations, uint32_t drawCount, int baseVertexLocation)
+    {
+        uint32_t totalIndexCount = 0;
+        for(uint32_t i = 0; i < drawCount; i++)
+        {
+            totalIndexCount += pIndexCounts[i];
+        }
+        prepareForDraw(totalIndexCount, 1);
+
         GLenum glTopology = getGlTopology(mState.topology);
-        uint32_t offset = sizeof(uint32_t) * startIndexLocation;
+        ResourceFormat indexFormat = mState.pVao->getIndexBufferFormat();
+        uintptr_t indexSize = getFormatBytesPerBlock(indexFormat);
+        std::vector<GLsizei> counts(pIndexCounts, pIndexCounts + drawCount);
+        std::vector<const void*> offsets(drawCount);
+        std::vector<GLint> baseVertices(drawCount, baseVertexLocation);
+        for(uint32_t i = 0; i < drawCount; i++)
+        {
+            offsets[i] = (const void*)(indexSize * pStartIndexLocations[i]);
+        }
 
-        gl_call(glDrawElementsInstancedBaseVertexBaseInstance(glTopology, indexCount, GL_UNSIGNED_INT, (void*)(uintptr_t)offset, instanceCount, baseVertexLocation, startInstanceLocation));
+        gl_call(glMultiDrawElementsBaseVertex(glTopology, counts.data(), getGlIndexType(indexFormat), offsets.data(), drawCount, baseVertices.data()));
     }
 
     void RenderContext::applyViewport(uint32_t index) const
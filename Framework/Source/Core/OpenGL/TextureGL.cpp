@@ -157,10 +157,10 @@ namespace Falcor
 				uint8_t *data = (uint8_t*)pData;
 				for (uint32_t i = 0; i < mipLevels; ++i) 
 				{
+					// The mip levels are packed one after the other
 					gl_call(glGetTextureLevelParameteriv(apiHandle, i, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, (int*)&requiredSize));
-					glCompressedTextureSubImage2D(apiHandle, i, 0, 0, width, height, glFormat, requiredSize, data);
-					uint32_t offset = getFormatBytesPerBlock(format) * (width >> i) * (height >> i) / getFormatPixelsPerBlock(format);
-					data += offset;
+					glCompressedTextureSubImage2D(apiHandle, i, 0, 0, max(1U, width >> i), max(1U, height >> i), glFormat, requiredSize, data);
+					data += requiredSize;
 					if (autoGenerateMipMaps)
 					{
 						break;
@@ -174,9 +174,10 @@ namespace Falcor
 				uint8_t *data = (uint8_t*)pData;
 				for (uint32_t i = 0; i < mipLevels; ++i)
 				{
-					gl_call(glTextureSubImage2D(apiHandle, i, 0, 0, width, height, baseFormat, baseType, data));
-					uint32_t offset = getFormatBytesPerBlock(format) * (width >> i) * (height >> i) / getFormatPixelsPerBlock(format);
-					data += offset;
+					uint32_t mipWidth = max(1U, width >> i);
+					uint32_t mipHeight = max(1U, height >> i);
+					gl_call(glTextureSubImage2D(apiHandle, i, 0, 0, mipWidth, mipHeight, baseFormat, baseType, data));
+					data += getFormatBytesPerBlock(format) * mipWidth * mipHeight;
 					if (autoGenerateMipMaps)
 					{
 						break;
@@ -72,6 +72,7 @@ namespace Falcor
         {
             *(uint64_t*)pVar = 0;
         }
+        markDirty(offset, sizeof(uint64_t));
     }
 }
 #endif //#ifdef FALCOR_GL
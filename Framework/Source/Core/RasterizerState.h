@@ -138,9 +138,18 @@ namespace Falcor
         /** Get the API handle
         */
         RasterizerStateHandle getApiHandle() const;
+
+        /** Get a hash of the state description. Equivalent states have the same hash.
+        */
+        size_t getHash() const { return mHash; }
+
+        /** Check if another state object describes the same API state. Used by the render-context to filter redundant binds.
+        */
+        bool isEquivalent(const RasterizerState& other) const;
     private:
         RasterizerStateHandle mApiHandle;
-        RasterizerState(const Desc& Desc) : mDesc(Desc) {}
+        RasterizerState(const Desc& Desc);
         Desc mDesc;
+        size_t mHash;
     };
 }
\ No newline at end of file
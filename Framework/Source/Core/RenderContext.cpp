@@ -31,6 +31,7 @@
 #include "DepthStencilState.h"
 #include "BlendState.h"
 #include "FBO.h"
+#include "Utils/RenderStats.h"
 
 namespace Falcor
 {
@@ -101,18 +102,18 @@ namespace Falcor
         }
         mState = mStateStack.top();
 
-        // And set all state objects
+        // And set all state objects. State the API already has bound is skipped.
         applyFbo();
-        applyVao();
-        applyTopology();
-        applyRasterizerState();
-        applyDepthStencilState();
-        applyBlendState();
-        applyProgram();
+        bindVao();
+        bindTopology();
+        bindRasterizerState();
+        bindDepthStencilState();
+        bindBlendState();
+        bindProgram();
 
         for(uint32_t i = 0; i < mState.pUniformBuffers.size(); i++)
         {
-            applyUniformBuffer(i);
+            bindUniformBuffer(i);
         }
 
         for(uint32_t i = 0; i < mState.viewports.size(); i++)
@@ -177,38 +178,169 @@ namespace Falcor
         mScStack[index].pop();
     }
 
+    bool RenderContext::isRedundantBind(StateBind bind, bool isBound)
+    {
+        if(isBound)
+        {
+            mBindStats.skipped[(uint32_t)bind]++;
+            return true;
+        }
+        mBindStats.issued[(uint32_t)bind]++;
+        return false;
+    }
+
+    void RenderContext::invalidateApiState()
+    {
+        // Keep the slot vectors, just drop the references and mark everything unknown
+        mApiState.program = ApiSlot<ProgramVersion::SharedConstPtr>();
+        mApiState.vao = ApiSlot<Vao::SharedConstPtr>();
+        mApiState.topology = ApiSlot<Topology>();
+        mApiState.rastState = ApiSlot<RasterizerState::SharedConstPtr>();
+        mApiState.dsState = ApiSlot<DepthStencilState::SharedConstPtr>();
+        mApiState.blendState = ApiSlot<BlendState::SharedConstPtr>();
+        for(auto& slot : mApiState.uniformBuffers)
+        {
+            slot = ApiSlot<UniformBuffer::SharedConstPtr>();
+        }
+        for(auto& slot : mApiState.shaderStorageBuffers)
+        {
+            slot = ApiSlot<ShaderStorageBuffer::SharedConstPtr>();
+        }
+    }
+
+    void RenderContext::bindDepthStencilState()
+    {
+        auto& bound = mApiState.dsState;
+        bool isBound = bound.valid && (mApiState.stencilRef == mState.stencilRef) && bound.value->isEquivalent(*mState.pDsState);
+        if(isRedundantBind(StateBind::DepthStencilState, isBound) == false)
+        {
+            bound.value = mState.pDsState;
+            bound.valid = true;
+            mApiState.stencilRef = mState.stencilRef;
+            applyDepthStencilState();
+        }
+    }
+
+    void RenderContext::bindRasterizerState()
+    {
+        auto& bound = mApiState.rastState;
+        bool isBound = bound.valid && bound.value->isEquivalent(*mState.pRastState);
+        if(isRedundantBind(StateBind::RasterizerState, isBound) == false)
+        {
+            bound.value = mState.pRastState;
+            bound.valid = true;
+            applyRasterizerState();
+        }
+    }
+
+    void RenderContext::bindBlendState()
+    {
+        auto& bound = mApiState.blendState;
+        bool isBound = bound.valid && (mApiState.sampleMask == mState.sampleMask) && bound.value->isEquivalent(*mState.pBlendState);
+        if(isRedundantBind(StateBind::BlendState, isBound) == false)
+        {
+            bound.value = mState.pBlendState;
+            bound.valid = true;
+            mApiState.sampleMask = mState.sampleMask;
+            applyBlendState();
+        }
+    }
+
+    void RenderContext::bindProgram()
+    {
+        auto& bound = mApiState.program;
+        if(isRedundantBind(StateBind::Program, bound.valid && (bound.value == mState.pProgram)) == false)
+        {
+            bound.value = mState.pProgram;
+            bound.valid = true;
+            applyProgram();
+        }
+    }
+
+    void RenderContext::bindVao()
+    {
+        auto& bound = mApiState.vao;
+        if(isRedundantBind(StateBind::Vao, bound.valid && (bound.value == mState.pVao)) == false)
+        {
+            bound.value = mState.pVao;
+            bound.valid = true;
+            applyVao();
+        }
+    }
+
+    void RenderContext::bindTopology()
+    {
+        auto& bound = mApiState.topology;
+        if(isRedundantBind(StateBind::Topology, bound.valid && (bound.value == mState.topology)) == false)
+        {
+            bound.value = mState.topology;
+            bound.valid = true;
+            applyTopology();
+        }
+    }
+
+    void RenderContext::bindUniformBuffer(uint32_t index)
+    {
+        if(index >= mApiState.uniformBuffers.size())
+        {
+            mApiState.uniformBuffers.resize(mState.pUniformBuffers.size());
+        }
+
+        auto& bound = mApiState.uniformBuffers[index];
+        if(isRedundantBind(StateBind::UniformBuffer, bound.valid && (bound.value == mState.pUniformBuffers[index])) == false)
+        {
+            bound.value = mState.pUniformBuffers[index];
+            bound.valid = true;
+            applyUniformBuffer(index);
+        }
+    }
+
+    void RenderContext::bindShaderStorageBuffer(uint32_t index)
+    {
+        if(index >= mApiState.shaderStorageBuffers.size())
+        {
+            mApiState.shaderStorageBuffers.resize(mState.pShaderStorageBuffers.size());
+        }
+
+        auto& bound = mApiState.shaderStorageBuffers[index];
+        if(isRedundantBind(StateBind::ShaderStorageBuffer, bound.valid && (bound.value == mState.pShaderStorageBuffers[index])) == false)
+        {
+            bound.value = mState.pShaderStorageBuffers[index];
+            bound.valid = true;
+            applyShaderStorageBuffer(index);
+        }
+    }
+
     void RenderContext::setDepthStencilState(const DepthStencilState::SharedConstPtr& pDepthStencil, uint32_t stencilRef)
     {
-        // Not checking if the state actually changed. Some of the externals libraries we use make raw API calls, bypassing the render-context, so checking if the state actually changed might lead to unexpected behavior.
         mState.pDsState = (pDepthStencil == nullptr) ? mpDefaultDepthStencilState : pDepthStencil;
         mState.stencilRef = stencilRef;
-
-        applyDepthStencilState();
+        bindDepthStencilState();
     }
 
     void RenderContext::setRasterizerState(const RasterizerState::SharedConstPtr& pRastState)
     {
         mState.pRastState = (pRastState == nullptr) ? mpDefaultRastState : pRastState;
-        applyRasterizerState();
+        bindRasterizerState();
     }
 
     void RenderContext::setBlendState(const BlendState::SharedConstPtr& pBlendState, uint32_t sampleMask)
     {
         mState.pBlendState = (pBlendState == nullptr) ? mpDefaultBlendState : pBlendState;
         mState.sampleMask = sampleMask;
-        applyBlendState();
+        bindBlendState();
     }
 
     void RenderContext::setProgram(const ProgramVersion::SharedConstPtr& pProgram)
     {
         mState.pProgram = pProgram;
-        applyProgram();
+        bindProgram();
     }
 
     void RenderContext::setVao(const Vao::SharedConstPtr& pVao)
     {
         mState.pVao = pVao;
-        applyVao();
+        bindVao();
     }
 
     Fbo::SharedConstPtr RenderContext::getFbo() const
@@ -231,7 +363,7 @@ namespace Falcor
         if ( index != 0xFFFFFFFFu )  // check that index isn't -1 (i.e., an invalid return from GL calls)
         {
             mState.pUniformBuffers[index] = pBuffer;
-            applyUniformBuffer( index );
+            bindUniformBuffer( index );
         }
     }
 
@@ -239,16 +371,15 @@ namespace Falcor
     {
         if ( index != 0xFFFFFFFFu )
         {
-            // Not checking if the state actually changed. Some of the externals libraries we use make raw API calls, bypassing the render-context, so checking if the state actually changed might lead to unexpected behavior.
             mState.pShaderStorageBuffers[index] = pBuffer;
-            applyShaderStorageBuffer( index );
+            bindShaderStorageBuffer( index );
         }
     }
 
     void RenderContext::setTopology(Topology topology)
     {
         mState.topology = topology;
-        applyTopology();
+        bindTopology();
     }
 
     void RenderContext::setViewport(uint32_t index, const Viewport& vp)
@@ -276,13 +407,35 @@ namespace Falcor
         applyScissor(index);
     }
 
-    void RenderContext::prepareForDraw() const
+    static uint32_t getTriangleCount(RenderContext::Topology topology, uint32_t vertexCount)
+    {
+        switch(topology)
+        {
+        case RenderContext::Topology::TriangleList:
+            return vertexCount / 3;
+        case RenderContext::Topology::TriangleStrip:
+            return (vertexCount >= 3) ? vertexCount - 2 : 0;
+        default:
+            return 0;
+        }
+    }
+
+    void RenderContext::prepareForDraw(uint32_t vertexCount, uint32_t instanceCount) const
     {
-        for(auto& pUBO : mState.pUniformBuffers)
+        RenderStats::recordDraw(instanceCount, getTriangleCount(mState.topology, vertexCount));
+
+        if(mBatchUniformUploads)
         {
-            if(pUBO)
+            UniformBuffer::uploadToGPU(mState.pUniformBuffers, mpUniformStagingRing);
+        }
+        else
+        {
+            for(auto& pUBO : mState.pUniformBuffers)
             {
-                pUBO->uploadToGPU();
+                if(pUBO)
+                {
+                    pUBO->uploadToGPU();
+                }
             }
         }
 
@@ -296,4 +449,12 @@ namespace Falcor
         }
         prepareForDrawApi();
     }
+
+    void RenderContext::endFrame()
+    {
+        if(mpUniformStagingRing)
+        {
+            mpUniformStagingRing->endFrame();
+        }
+    }
 }
@@ -81,6 +81,40 @@ namespace Falcor
             int32_t height = 0;
         };
 
+        /** State bind types tracked by the bind statistics
+        */
+        enum class StateBind
+        {
+            Program,
+            Vao,
+            Topology,
+            RasterizerState,
+            DepthStencilState,
+            BlendState,
+            UniformBuffer,
+            ShaderStorageBuffer,
+
+            Count
+        };
+
+        /** Bind statistics. Counts the binds which reached the API and the binds which were skipped because the API already had the requested state bound.
+        */
+        struct BindStats
+        {
+            uint32_t issued[(uint32_t)StateBind::Count];
+            uint32_t skipped[(uint32_t)StateBind::Count];
+
+            BindStats() { reset(); }
+            void reset()
+            {
+                for(uint32_t i = 0; i < (uint32_t)StateBind::Count; i++)
+                {
+                    issued[i] = 0;
+                    skipped[i] = 0;
+                }
+            }
+        };
+
         /** create a new object
         */
         static SharedPtr create();
@@ -109,6 +143,14 @@ namespace Falcor
         */
         void drawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndexLocation, int baseVertexLocation, uint32_t startInstanceLocation);
 
+        /** Indexed multi-draw call. Draws several ranges of the index buffer with a single API call where the API supports it. Recorded as a single draw call in RenderStats.
+            \param[in] pIndexCounts Number of indices to draw, per range
+            \param[in] pStartIndexLocations The location of each range's first index in the index buffer (offset in indices)
+            \param[in] drawCount Number of ranges
+            \param[in] baseVertexLocation A value which is added to each index before reading a vertex from the vertex buffer
+        */
+        void multiDrawIndexed(const uint32_t* pIndexCounts, const uint32_t* pStartIndexLocations, uint32_t drawCount, int baseVertexLocation);
+
         /** Get current FBO.
         */
         Fbo::SharedConstPtr getFbo() const;
@@ -245,6 +287,32 @@ namespace Falcor
         /** Pops the last Scissor from the stack and sets it
         */
         void popScissor(uint32_t index);
+
+        /** Get the bind statistics accumulated since the last call to resetBindStats()
+        */
+        const BindStats& getBindStats() const { return mBindStats; }
+
+        /** Reset the bind statistics. Usually called once per frame.
+        */
+        void resetBindStats() { mBindStats.reset(); }
+
+        /** Forget what the API has bound, so that the next bind of each state object reaches the API. \n
+            The render-context skips binds of state the API already has. Code which makes raw API calls, bypassing the render-context, must call this function before going back to the render-context.
+        */
+        void invalidateApiState();
+
+        /** Enable or disable batched uniform buffer uploads. \n
+            When enabled, the modified ranges of all bound uniform buffers are packed before each draw into a persistently mapped staging ring, instead of mapping each buffer separately. See UniformBuffer#uploadToGPU().
+        */
+        void setBatchedUniformUploads(bool enable) { mBatchUniformUploads = enable; }
+
+        /** Check if batched uniform buffer uploads are enabled
+        */
+        bool isBatchingUniformUploads() const { return mBatchUniformUploads; }
+
+        /** Mark the end of a frame. The staging memory used by the uniform uploads of the frame is reused after the GPU finished it. Sample calls it at the end of every frame.
+        */
+        void endFrame();
     private:
         RenderContext(uint32_t viewportCount);
 
@@ -266,17 +334,55 @@ namespace Falcor
         };
 
         State mState;
+        bool mBatchUniformUploads = false;
+        mutable GpuRingBuffer::UniquePtr mpUniformStagingRing;
         std::stack<State> mStateStack;
         std::stack<Fbo::SharedPtr> mFboStack;
         std::vector<std::stack<Viewport>> mVpStack;
         std::vector<std::stack<Scissor>> mScStack;
 
+        // Shadow of the state currently bound to the API. A slot is only trusted while its valid flag is set.
+        template<typename T>
+        struct ApiSlot
+        {
+            T value;
+            bool valid = false;
+        };
+
+        struct ApiState
+        {
+            ApiSlot<ProgramVersion::SharedConstPtr> program;
+            ApiSlot<Vao::SharedConstPtr> vao;
+            ApiSlot<Topology> topology;
+            ApiSlot<RasterizerState::SharedConstPtr> rastState;
+            ApiSlot<DepthStencilState::SharedConstPtr> dsState;
+            uint32_t stencilRef = 0;
+            ApiSlot<BlendState::SharedConstPtr> blendState;
+            uint32_t sampleMask = 0;
+            std::vector<ApiSlot<UniformBuffer::SharedConstPtr>> uniformBuffers;
+            std::vector<ApiSlot<ShaderStorageBuffer::SharedConstPtr>> shaderStorageBuffers;
+        };
+
+        ApiState mApiState;
+        BindStats mBindStats;
+
         // Default state objects
         RasterizerState::SharedConstPtr mpDefaultRastState;
         BlendState::SharedConstPtr mpDefaultBlendState;
         DepthStencilState::SharedConstPtr mpDefaultDepthStencilState;
         Fbo::SharedPtr mpEmptyFBO;
 
+        // Skip the bind if the API already has the state bound, otherwise apply it and update the shadow state
+        void bindRasterizerState();
+        void bindDepthStencilState();
+        void bindBlendState();
+        void bindProgram();
+        void bindVao();
+        void bindUniformBuffer(uint32_t index);
+        void bindShaderStorageBuffer(uint32_t index);
+        void bindTopology();
+        bool isRedundantBind(StateBind bind, bool isBound);
+
         // Internal functions used by the API layers
         void applyViewport(uint32_t index) const;
         void applyScissor(uint32_t index) const;
@@ -289,7 +395,7 @@ namespace Falcor
         void applyUniformBuffer(uint32_t Index) const;
         void applyShaderStorageBuffer(uint32_t Index) const;
         void applyTopology() const;
-        void prepareForDraw() const;
+        void prepareForDraw(uint32_t vertexCount, uint32_t instanceCount) const;
         void prepareForDrawApi() const;
     };
 }
\ No newline at end of file
@@ -74,6 +74,9 @@ namespace Falcor
         friend class UniformBuffer;
         ID3D11ShaderReflectionPtr getReflectionInterface() const;
         ID3DBlobPtr getCodeBlob() const;
+#elif defined FALCOR_NULL
+        friend class ProgramVersion;
+        const std::string& getSource() const;
 #endif
     private:
         // API handle depends on the shader Type, so it stored be stored as part of the private data
@@ -31,6 +31,14 @@
 #include "buffer.h"
 #include "glm/glm.hpp"
 #include "texture.h"
+#include "Utils/RenderStats.h"
+
+// The null backend doesn't reflect variables and resources, so there is nothing to validate the calls against
+#ifdef FALCOR_NULL
+#define _VALIDATE_UNIFORM_ACCESS 0
+#else
+#define _VALIDATE_UNIFORM_ACCESS _LOG_ENABLED
+#endif
 
 namespace Falcor
 {
@@ -80,8 +88,20 @@ namespace Falcor
         if(mSize)
         {
             mData.assign(mSize, 0);
-            mpBuffer = Buffer::create(mSize, Buffer::BindFlags::Uniform, Buffer::AccessFlags::MapWrite, mData.data());
+            mpBuffer = Buffer::create(mSize, Buffer::BindFlags::Uniform, Buffer::AccessFlags::MapWrite | Buffer::AccessFlags::Dynamic, mData.data());
         }
+
+        // Build the name lookup table. The reflection data doesn't change after this point.
+        std::vector<std::string> names;
+        names.reserve(mVariables.size());
+        mVariableTable.clear();
+        mVariableTable.reserve(mVariables.size());
+        for(const auto& var : mVariables)
+        {
+            names.push_back(var.first);
+            mVariableTable.push_back(&var.second);
+        }
+        mVariableHash.build(names);
         
         return true;
     }
@@ -93,7 +113,7 @@ namespace Falcor
 
     void UniformBuffer::uploadToGPU(size_t offset, size_t size) const
     {
-        if(mDirty == false)
+        if(isDirty() == false)
         {
             return;
         }
@@ -114,87 +134,307 @@ namespace Falcor
             return;
         }
 
-        Buffer::MapType mapType = Buffer::MapType::Write;
-        if((offset == 0) && (size = mSize))
+        // Only upload the part of the requested range which was modified
+        size_t begin = std::max(offset, mDirtyBegin);
+        size_t end = std::min(offset + size, mDirtyEnd);
+        if(begin >= end)
+        {
+            return;
+        }
+
+#ifdef FALCOR_DX11
+        // Dynamic constant buffers can only be written by discarding the entire buffer
+        begin = 0;
+        end = mSize;
+#endif
+
+        if((begin == 0) && (end == mSize))
         {
-            mapType = Buffer::MapType::WriteDiscard; // Updating the entire buffer
+            // Updating the entire buffer
+            uint8_t* pData = (uint8_t*)mpBuffer->map(Buffer::MapType::WriteDiscard);
+            assert(pData);
+            memcpy(pData, mData.data(), mSize);
+            mpBuffer->unmap();
         }
+        else
+        {
+            // Mapping part of the buffer without discarding would wait for the GPU to finish reading it. updateData() is pipelined by the driver.
+            mpBuffer->updateData(mData.data() + begin, begin, end - begin);
+        }
+        clearDirtyRange(begin, end);
+        RenderStats::recordUniformUpload(end - begin);
+    }
+
+    static const size_t kStagingFramesInFlight = 3;
+    static const size_t kMinStagingFrameSize = 64 * 1024;
+    static const size_t kStagingAlignment = 16;
+
+    void UniformBuffer::uploadToGPU(const std::vector<SharedConstPtr>& buffers, GpuRingBuffer::UniquePtr& pStagingRing)
+    {
+#ifdef FALCOR_DX11
+        for(const auto& pBuffer : buffers)
+        {
+            if(pBuffer)
+            {
+                pBuffer->uploadToGPU();
+            }
+        }
+#else
+        size_t stagingSize = 0;
+        for(const auto& pBuffer : buffers)
+        {
+            if(pBuffer && pBuffer->mpBuffer && pBuffer->isDirty())
+            {
+                stagingSize += pBuffer->mDirtyEnd - pBuffer->mDirtyBegin;
+            }
+        }
+
+        if(stagingSize == 0)
+        {
+            return;
+        }
+
+        // Grow the ring if the uploads of the current frame don't fit into a third of it. The old buffer is released once the GPU is done with the copies which use it.
+        size_t frameSize = stagingSize + kStagingAlignment + (pStagingRing ? pStagingRing->getFrameSize() : 0);
+        if((pStagingRing == nullptr) || (frameSize * kStagingFramesInFlight > pStagingRing->getBuffer()->getSize()))
+        {
+            size_t newFrameSize = std::max(kMinStagingFrameSize, pStagingRing ? frameSize * 2 : frameSize);
+            Buffer::SharedPtr pBuffer = Buffer::create(newFrameSize * kStagingFramesInFlight, Buffer::BindFlags::None, Buffer::AccessFlags::MapWrite | Buffer::AccessFlags::MapPersistent, nullptr);
+            pStagingRing = GpuRingBuffer::create(pBuffer);
+        }
+
+        struct Copy
+        {
+            const UniformBuffer* pBuffer;
+            size_t stagingOffset;
+            size_t begin;
+            size_t size;
+        };
+        std::vector<Copy> copies;
+        copies.reserve(buffers.size());
+
+        size_t stagingBase;
+        uint8_t* pStaging = (uint8_t*)pStagingRing->map(stagingSize, kStagingAlignment, stagingBase);
+        if(pStaging == nullptr)
+        {
+            return;
+        }
+        size_t stagingOffset = 0;
+        for(const auto& pBuffer : buffers)
+        {
+            // A buffer can be bound to more than one slot. The first occurrence clears the dirty range.
+            if(pBuffer && pBuffer->mpBuffer && pBuffer->isDirty())
+            {
+                Copy c = {pBuffer.get(), stagingBase + stagingOffset, pBuffer->mDirtyBegin, pBuffer->mDirtyEnd - pBuffer->mDirtyBegin};
+                memcpy(pStaging + stagingOffset, pBuffer->mData.data() + c.begin, c.size);
+                stagingOffset += c.size;
+                pBuffer->clearDirtyRange(pBuffer->mDirtyBegin, pBuffer->mDirtyEnd);
+                copies.push_back(c);
+            }
+        }
+        pStagingRing->unmap();
+
+        const Buffer* pStagingBuffer = pStagingRing->getBuffer().get();
+        for(const auto& c : copies)
+        {
+            pStagingBuffer->copy(c.pBuffer->mpBuffer.get(), c.stagingOffset, c.begin, c.size);
+            RenderStats::recordUniformUpload(c.size);
+        }
+#endif
+    }
 
-        uint8_t* pData = (uint8_t*)mpBuffer->map(mapType);
-        assert(pData);
-        memcpy(pData + offset, mData.data() + offset, size);
-        mpBuffer->unmap();
-        mDirty = false;
+    void UniformBuffer::clearDirtyRange(size_t begin, size_t end) const
+    {
+        if((begin <= mDirtyBegin) && (end >= mDirtyEnd))
+        {
+            mDirtyBegin = 0;
+            mDirtyEnd = 0;
+        }
+        else if((begin <= mDirtyBegin) && (end > mDirtyBegin))
+        {
+            mDirtyBegin = end;
+        }
+        else if((end >= mDirtyEnd) && (begin < mDirtyEnd))
+        {
+            mDirtyEnd = begin;
+        }
+        // Otherwise the uploaded range is strictly inside the dirty range. Keep the entire range, it will be uploaded again.
     }
 
     template<bool ExpectArrayIndex>
     __forceinline const VariableDesc* UniformBuffer::getVariableData(const std::string& name, size_t& offset) const
     {
-        const std::string msg = "Error when getting uniform data\"" + name + "\" from uniform buffer \"" + mName + "\".\n";
+#ifdef FALCOR_NULL
+        // Without reflection data all the variables alias the start of the buffer
+        static const VariableDesc kNullVariable = []() { VariableDesc desc; desc.arraySize = (uint32_t)-1; return desc; }();
+        offset = 0;
+        return &kNullVariable;
+#else
+        // The error message is only built when the lookup fails
+        auto logError = [this, &name](const std::string& error)
+        {
+            Logger::log(Logger::Level::Error, "Error when getting uniform data\"" + name + "\" from uniform buffer \"" + mName + "\".\n" + error);
+        };
         uint32_t arrayIndex = 0;
 
         // Look for the uniform
-        auto& var = mVariables.find(name);
+        const VariableDesc* pData = findVariable(name);
 
 #ifdef FALCOR_DX11
-        if(var == mVariables.end())
+        if(pData == nullptr)
         {
             // Textures might come from our struct. Try again.
-            std::string texName = name + ".t";
-            var = mVariables.find(texName);
+            pData = findVariable(name + ".t");
         }
 #endif
-        if(var == mVariables.end())
+        if(pData == nullptr)
         {
             // The name might contain an array index. Remove the last array index and search again
             std::string nameV2 = removeLastArrayIndex(name);
-            var = mVariables.find(nameV2);
+            if(nameV2.length() != name.length())
+            {
+                pData = findVariable(nameV2);
+            }
 
-            if(var == mVariables.end())
+            if(pData == nullptr)
             {
-                Logger::log(Logger::Level::Error, msg + "Uniform not found.");
+                logError("Uniform not found.");
                 return nullptr;
             }
 
-            const auto& data = var->second;
-            if(data.arraySize == 0)
+            if(pData->arraySize == 0)
             {
                 // Not an array, so can't have an array index
-                Logger::log(Logger::Level::Error, msg + "Uniform is not an array, so name can't include an array index.");
+                logError("Uniform is not an array, so name can't include an array index.");
                 return nullptr;
             }
 
             // We know we have an array index. Make sure it's in range
-            std::string indexStr = name.substr(nameV2.length() + 1);
             char* pEndPtr;
-            arrayIndex = strtol(indexStr.c_str(), &pEndPtr, 0);
+            arrayIndex = strtol(name.c_str() + nameV2.length() + 1, &pEndPtr, 0);
             if(*pEndPtr != ']')
             {
-                Logger::log(Logger::Level::Error, msg + "Array index must be a literal number (no whitespace are allowed)");
+                logError("Array index must be a literal number (no whitespace are allowed)");
                 return nullptr;
             }
 
-            if(arrayIndex >= data.arraySize)
+            if(arrayIndex >= pData->arraySize)
             {
-                Logger::log(Logger::Level::Error, msg + "Array index (" + std::to_string(arrayIndex) + ") out-of-range. Array size == " + std::to_string(data.arraySize) + ".");
+                logError("Array index (" + std::to_string(arrayIndex) + ") out-of-range. Array size == " + std::to_string(pData->arraySize) + ".");
                 return nullptr;
             }
         }
-        else if(ExpectArrayIndex && var->second.arraySize > 0)
+        else if(ExpectArrayIndex && pData->arraySize > 0)
         {
             // Variable name should contain an explicit array index (for N-dim arrays, N indices), but the index was missing
-            Logger::log(Logger::Level::Error, msg + "Expecting to find explicit array index in uniform name (for N-dimensional array, N indices must be specified).");
+            logError("Expecting to find explicit array index in uniform name (for N-dimensional array, N indices must be specified).");
             return nullptr;
         }
 
-        const auto* pData = &var->second;
         offset = pData->offset + pData->arrayStride * arrayIndex;
         return pData;
+#endif
     }
 
+    const VariableDesc* UniformBuffer::findVariable(const std::string& name) const
+    {
+        uint32_t index = mVariableHash.lookup(name);
+        return (index == StringPerfectHash::kInvalidIndex) ? nullptr : mVariableTable[index];
+    }
+
+    bool UniformBuffer::resolveHandle(const std::string& name, VariableDesc::Type type, size_t typeSize, size_t& offset, uint32_t& elementCount, uint32_t& stride) const
+    {
+        const VariableDesc* pData = getVariableData<false>(name, offset);
+        if(pData == nullptr)
+        {
+            return false;
+        }
+
+#ifndef FALCOR_NULL
+        // Handles are validated once, so unlike the per-call checks this one is always enabled
+        if(pData->type != type)
+        {
+            Logger::log(Logger::Level::Error, "Error when creating a handle to uniform \"" + name + "\" in buffer \"" + mName + "\".\nType mismatch. The handle type is " + to_string(type) + ", variable was declared with type " + to_string(pData->type) + ".");
+            return false;
+        }
+#endif
+
+        if(pData->arraySize == 0)
+        {
+            elementCount = 1;
+            stride = (uint32_t)typeSize;
+        }
+        else if(pData->arrayStride == 0)
+        {
+            // No layout information (the null backend). Assume a tightly packed array which spans the rest of the buffer.
+            elementCount = (uint32_t)((mSize - offset) / typeSize);
+            stride = (uint32_t)typeSize;
+        }
+        else
+        {
+            // The name might point into the middle of the array
+            elementCount = pData->arraySize - (uint32_t)((offset - pData->offset) / pData->arrayStride);
+            stride = (uint32_t)pData->arrayStride;
+        }
+
+        if(offset + (elementCount - 1) * stride + typeSize > mSize)
+        {
+            Logger::log(Logger::Level::Error, "Error when creating a handle to uniform \"" + name + "\" in buffer \"" + mName + "\". The variable is out of the buffer's bounds.");
+            return false;
+        }
+        return true;
+    }
+
+#define get_handle(_var_type, _c_type) \
+    template<> UniformBuffer::Handle<_c_type> UniformBuffer::getHandle(const std::string& name) const  \
+    {                                                                                                   \
+        size_t offset;                                                                                  \
+        uint32_t elementCount, stride;                                                                  \
+        if(resolveHandle(name, VariableDesc::Type::_var_type, sizeof(_c_type), offset, elementCount, stride)) \
+        {                                                                                               \
+            return Handle<_c_type>(offset, elementCount, stride);                                       \
+        }                                                                                               \
+        return Handle<_c_type>();                                                                       \
+    }
+
+    get_handle(Bool, bool);
+    get_handle(Bool2, glm::bvec2);
+    get_handle(Bool3, glm::bvec3);
+    get_handle(Bool4, glm::bvec4);
+
+    get_handle(Uint, uint32_t);
+    get_handle(Uint2, glm::uvec2);
+    get_handle(Uint3, glm::uvec3);
+    get_handle(Uint4, glm::uvec4);
+
+    get_handle(Int, int32_t);
+    get_handle(Int2, glm::ivec2);
+    get_handle(Int3, glm::ivec3);
+    get_handle(Int4, glm::ivec4);
+
+    get_handle(Float, float);
+    get_handle(Float2, glm::vec2);
+    get_handle(Float3, glm::vec3);
+    get_handle(Float4, glm::vec4);
+
+    get_handle(Float2x2, glm::mat2);
+    get_handle(Float2x3, glm::mat2x3);
+    get_handle(Float2x4, glm::mat2x4);
+
+    get_handle(Float3x3, glm::mat3);
+    get_handle(Float3x2, glm::mat3x2);
+    get_handle(Float3x4, glm::mat3x4);
+
+    get_handle(Float4x4, glm::mat4);
+    get_handle(Float4x2, glm::mat4x2);
+    get_handle(Float4x3, glm::mat4x3);
+
+    get_handle(GpuPtr, uint64_t);
+#undef get_handle
+
     bool checkVariableType(VariableDesc::Type callType, VariableDesc::Type shaderType, const std::string& name, const std::string& bufferName)
     {
-#if _LOG_ENABLED
+#if _VALIDATE_UNIFORM_ACCESS
         // Check that the types match
         if(callType != shaderType)
         {
@@ -211,7 +451,7 @@ namespace Falcor
 
     bool checkVariableByOffset(VariableDesc::Type callType, size_t offset, size_t count, const VariableDescMap& uniforms, const std::string& bufferName)
     {
-#if _LOG_ENABLED
+#if _VALIDATE_UNIFORM_ACCESS
         // Find the uniform
         for(const auto& a : uniforms)
         {
@@ -270,7 +510,7 @@ namespace Falcor
         {                                                       \
             const uint8_t* pVar = mData.data() + offset;        \
             *(_c_type*)pVar = value;                            \
-            mDirty = true;                                      \
+            markDirty(offset, sizeof(_c_type));                 \
         }                                                       \
     }
 
@@ -316,7 +556,7 @@ namespace Falcor
         size_t offset;                                    \
         const auto* pUniform = getVariableData<true>(name, offset);    \
         assert(pUniform);                                       \
-        if((_LOG_ENABLED == 0) || (pUniform && checkVariableType(VariableDesc::Type::_var_type, pUniform->type, name, mName))) \
+        if((_VALIDATE_UNIFORM_ACCESS == 0) || (pUniform && checkVariableType(VariableDesc::Type::_var_type, pUniform->type, name, mName))) \
         {                                                       \
             setVariable(offset, value);                         \
         }                                                       \
@@ -368,7 +608,7 @@ namespace Falcor
             {                                                                                                       \
                 pData[i] = pValue[i];                                                                               \
             }                                                                                                       \
-            mDirty = true;                                                                                          \
+            markDirty(offset, count * sizeof(_c_type));                                                             \
         }                                                                                                           \
     }
 
@@ -474,12 +714,12 @@ namespace Falcor
             return;
         }
         memcpy(mData.data() + offset, pSrc, size);
-        mDirty = true;
+        markDirty(offset, size);
     }
 
     bool checkResourceDimension(const Texture* pTexture, const ShaderResourceDesc& shaderDesc, bool bindAsImage, const std::string& name, const std::string& bufferName)
     {
-#if _LOG_ENABLED
+#if _VALIDATE_UNIFORM_ACCESS
 
         bool dimsMatch = false;
         bool formatMatch = false;
@@ -587,7 +827,7 @@ namespace Falcor
     void UniformBuffer::setTexture(size_t offset, const Texture* pTexture, const Sampler* pSampler, bool bindAsImage)
     {
         bool bOK = true;
-#if _LOG_ENABLED
+#if _VALIDATE_UNIFORM_ACCESS
         // Debug checks
         if(pTexture)
         {
@@ -637,7 +877,6 @@ namespace Falcor
 
         if(bOK)
         {
-            mDirty = true;
             setTextureInternal(offset, pTexture, pSampler);
         }
     }
@@ -649,7 +888,7 @@ namespace Falcor
         if(pUniform)
         {
             bool bOK = true;
-#if _LOG_ENABLED == 1
+#if _VALIDATE_UNIFORM_ACCESS == 1
             if(pTexture != nullptr)
             {
                 const auto& it = getResourceDescIt(name, mResources);
@@ -679,7 +918,7 @@ namespace Falcor
             for(uint32_t i = 0; i < count; i++)
             {
                 bool bOK = true;
-#if _LOG_ENABLED == 1
+#if _VALIDATE_UNIFORM_ACCESS == 1
                 if(pTexture[i] != nullptr)
                 {
                     const auto& it = getResourceDescIt(name, mResources);
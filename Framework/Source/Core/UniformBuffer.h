@@ -30,6 +30,8 @@
 #include "ShaderReflection.h"
 #include "Texture.h"
 #include "Buffer.h"
+#include "GpuRingBuffer.h"
+#include "Utils/PerfectHash.h"
 
 namespace Falcor
 {
@@ -72,6 +74,35 @@ namespace Falcor
         using SharedPtr = SharedPtrT<UboVar<UniformBuffer>>;
         using SharedConstPtr = std::shared_ptr<const UniformBuffer>;
 
+        /** A typed handle to a variable, resolved once from the buffer's reflection data.\n
+            The name lookup and type validation happen when the handle is created. Setting a variable through a handle is a direct store into the CPU copy of the buffer.
+            A handle can be used with any buffer which has the same declaration as the buffer which created it.
+        */
+        template<typename T>
+        class Handle
+        {
+        public:
+            Handle() = default;
+
+            /** Check if the handle points to a variable
+            */
+            bool isValid() const { return mOffset != kInvalidUniformOffset; }
+
+            /** Get the byte offset of the variable inside the buffer
+            */
+            size_t getOffset() const { return mOffset; }
+
+            /** Get the number of elements which can be accessed through the handle. This is 1 for non-array variables.
+            */
+            uint32_t getElementCount() const { return mElementCount; }
+        private:
+            friend class UniformBuffer;
+            Handle(size_t offset, uint32_t elementCount, uint32_t stride) : mOffset(offset), mElementCount(elementCount), mStride(stride) {}
+            size_t mOffset = kInvalidUniformOffset;
+            uint32_t mElementCount = 0;
+            uint32_t mStride = 0;
+        };
+
         /** create a new uniform buffer.\n
             Even though the buffer is created with a specific program, it can be used with other programs as long as the buffer declarations are the same across programs.
             \param[in] pProgram A program object with the uniform buffer declared
@@ -117,6 +148,76 @@ namespace Falcor
         template<typename T>
         void setVariableArray(const std::string& name, const T* pValue, size_t count);
 
+        /** Get a handle to a variable.
+            The function will validate that T matches the declaration in the shader. If there's a mismatch, or the variable doesn't exist, an error will be logged and an invalid handle will be returned.
+            \param[in] name The uniform name. See notes about naming in the UniformBuffer class description. If the name points to an array element, the handle accesses the array starting at this element.
+        */
+        template<typename T>
+        Handle<T> getHandle(const std::string& name) const;
+
+        /** Set a uniform through a handle.
+            \param[in] handle The handle. Invalid handles are ignored, so variables which the compiler optimized out can be set unconditionally.
+            \param[in] value Value to set
+        */
+        template<typename T>
+        void setVariable(const Handle<T>& handle, const T& value)
+        {
+            if(handle.isValid() == false)
+            {
+                return;
+            }
+            *(T*)(mData.data() + handle.mOffset) = value;
+            markDirty(handle.mOffset, sizeof(T));
+        }
+
+        /** Set an array element through a handle.
+            \param[in] handle The handle. Invalid handles are ignored.
+            \param[in] index The element index, relative to the element the handle points to
+            \param[in] value Value to set
+        */
+        template<typename T>
+        void setVariable(const Handle<T>& handle, uint32_t index, const T& value)
+        {
+            if(handle.isValid() == false)
+            {
+                return;
+            }
+            assert(index < handle.mElementCount);
+            *(T*)(mData.data() + handle.mOffset + index * handle.mStride) = value;
+            markDirty(handle.mOffset + index * handle.mStride, sizeof(T));
+        }
+
+        /** Set consecutive array elements through a handle, starting at the element the handle points to.
+            \param[in] handle The handle. Invalid handles are ignored.
+            \param[in] pValue Pointer to an array of values to set
+            \param[in] count pValue array size
+        */
+        template<typename T>
+        void setVariableArray(const Handle<T>& handle, const T* pValue, size_t count)
+        {
+            if(handle.isValid() == false)
+            {
+                return;
+            }
+            assert(count <= handle.mElementCount);
+            uint8_t* pDst = mData.data() + handle.mOffset;
+            if(handle.mStride == sizeof(T))
+            {
+                memcpy(pDst, pValue, count * sizeof(T));
+            }
+            else
+            {
+                for(size_t i = 0; i < count; i++)
+                {
+                    *(T*)(pDst + i * handle.mStride) = pValue[i];
+                }
+            }
+            if(count)
+            {
+                markDirty(handle.mOffset, (count - 1) * handle.mStride + sizeof(T));
+            }
+        }
+
         /** Set a texture or image.
         The function will validate that the resource Type matches the declaration in the shader. If there's a mismatch, an error will be logged and the call will be ignored.
         \param[in] name The uniform name in the program. See notes about naming in the UniformBuffer class description.
@@ -146,12 +247,25 @@ namespace Falcor
         void setTexture(size_t Offset, const Texture* pTexture, const Sampler* pSampler, bool bindAsImage = false);
 
         /** Apply the changes to the actual GPU buffer.
+            The buffer tracks the byte range modified since the last upload, and only that range is copied. If the entire buffer was modified, the GPU copy is discarded and rewritten.
             Note that it is possible to use this function to update only part of the GPU copy of the buffer. This might lead to inconsistencies between the GPU and CPU buffer, so make sure you know what you are doing.
             \param[in] offset Offset into the buffer to write to
             \param[in] size   Number of bytes to upload. If this value is -1, will update the [Offset, EndOfBuffer] range.
         */
         void uploadToGPU(size_t offset = 0, size_t size = -1) const;
 
+        /** Upload the modified ranges of multiple buffers through a staging ring.
+            The staging buffer is persistently mapped, so it is mapped once when the ring is created and not for every upload. The dirty ranges are packed into a range sub-allocated from the ring, which is then copied into each of the buffers on the GPU.
+            The ranges written during a frame are reused after the GPU finished the frame, so GpuRingBuffer#endFrame() must be called once per frame. In DX11 dynamic constant buffers can't be copy destinations, so each buffer is uploaded separately.
+            \param[in] buffers The buffers to upload. Null entries are ignored.
+            \param[in,out] pStagingRing The staging ring to use. Will be (re)created if it's null or if it can't hold a few frames worth of uploads.
+        */
+        static void uploadToGPU(const std::vector<SharedConstPtr>& buffers, GpuRingBuffer::UniquePtr& pStagingRing);
+
+        /** Check if the CPU copy of the buffer was modified since the last upload
+        */
+        bool isDirty() const { return mDirtyBegin < mDirtyEnd; }
+
         /** Get the internal buffer object
         */
         Buffer::SharedPtr getBuffer() const { return mpBuffer; }
@@ -179,11 +293,34 @@ namespace Falcor
         const std::string mName;
         std::vector<uint8_t> mData;
         size_t mSize = 0;
-        mutable bool mDirty = true;
+
+        // Byte range modified since the last upload. The range is empty when mDirtyBegin >= mDirtyEnd.
+        mutable size_t mDirtyBegin = 0;
+        mutable size_t mDirtyEnd = 0;
+        void markDirty(size_t offset, size_t size)
+        {
+            if(isDirty())
+            {
+                mDirtyBegin = std::min(mDirtyBegin, offset);
+                mDirtyEnd = std::max(mDirtyEnd, offset + size);
+            }
+            else
+            {
+                mDirtyBegin = offset;
+                mDirtyEnd = offset + size;
+            }
+        }
+        void clearDirtyRange(size_t begin, size_t end) const;
 
         ShaderReflection::VariableDescMap mVariables;
         ShaderReflection::ShaderResourceDescMap mResources;
 
+        // Perfect hash over the variable names. Indices point into mVariableTable.
+        StringPerfectHash mVariableHash;
+        std::vector<const ShaderReflection::VariableDesc*> mVariableTable;
+        const ShaderReflection::VariableDesc* findVariable(const std::string& name) const;
+        bool resolveHandle(const std::string& name, ShaderReflection::VariableDesc::Type type, size_t typeSize, size_t& offset, uint32_t& elementCount, uint32_t& stride) const;
+
         template<bool ExpectArrayIndex>
         const ShaderReflection::VariableDesc* getVariableData(const std::string& name, size_t& offset) const;
 
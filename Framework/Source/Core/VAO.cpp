@@ -30,7 +30,7 @@
 
 namespace Falcor
 {
-    bool checkVaoParams(const Vao::VertexBufferDescVector& vbDesc, Buffer* pIB)
+    bool checkVaoParams(const Vao::VertexBufferDescVector& vbDesc, Buffer* pIB, ResourceFormat ibFormat)
     {
         // Must have at least 1 VB
         if(vbDesc.size() == 0)
@@ -39,22 +39,28 @@ namespace Falcor
             return false;
         }
 
+        if(ibFormat != ResourceFormat::R16Uint && ibFormat != ResourceFormat::R32Uint)
+        {
+            Logger::log(Logger::Level::Error, "Error when creating VAO. The index buffer format must be R16Uint or R32Uint");
+            return false;
+        }
+
         return true;
     }
 
-    Vao::Vao(const VertexBufferDescVector& vbDesc, const Buffer::SharedPtr& pIB) : mpIB(pIB)
+    Vao::Vao(const VertexBufferDescVector& vbDesc, const Buffer::SharedPtr& pIB, ResourceFormat ibFormat) : mpIB(pIB), mIbFormat(ibFormat)
     {
         mpVBs = vbDesc;
     }
 
-    Vao::SharedPtr Vao::create(const VertexBufferDescVector& vbDesc, const Buffer::SharedPtr& pIB)
+    Vao::SharedPtr Vao::create(const VertexBufferDescVector& vbDesc, const Buffer::SharedPtr& pIB, ResourceFormat ibFormat)
     {
-        if(checkVaoParams(vbDesc, pIB.get()) == false)
+        if(checkVaoParams(vbDesc, pIB.get(), ibFormat) == false)
         {
             return nullptr;
         }
 
-        SharedPtr pVao = SharedPtr(new Vao(vbDesc, pIB));
+        SharedPtr pVao = SharedPtr(new Vao(vbDesc, pIB, ibFormat));
         if(pVao->initialize() == false)
         {
             pVao = nullptr;
@@ -62,8 +62,9 @@ namespace Falcor
         /** create a new object
             \param vbDesc Array of pointers to vertex buffer descriptor. Must have at least 1 element
             \param pIB Pointer to the index-buffer. Can be nullptr, in which case no index-buffer will be bound.
+            \param ibFormat The format of the indices. Must be ResourceFormat::R16Uint or ResourceFormat::R32Uint.
         */
-        static SharedPtr create(const VertexBufferDescVector& vbDesc, const Buffer::SharedPtr& pIB);
+        static SharedPtr create(const VertexBufferDescVector& vbDesc, const Buffer::SharedPtr& pIB, ResourceFormat ibFormat = ResourceFormat::R32Uint);
         ~Vao();
 
         /** Get the API handle
@@ -95,17 +96,22 @@ namespace Falcor
         */
         Buffer::SharedConstPtr getIndexBuffer() const { return mpIB; }
 
+        /** Get the format of the indices
+        */
+        ResourceFormat getIndexBufferFormat() const { return mIbFormat; }
+
     protected:
         friend class RenderContext;
 #ifdef FALCOR_DX11
         ID3D11InputLayoutPtr getInputLayout(ID3DBlob* pVsBlob) const;
 #endif
     private:
-        Vao(const VertexBufferDescVector& vbDesc, const Buffer::SharedPtr& pIB);
+        Vao(const VertexBufferDescVector& vbDesc, const Buffer::SharedPtr& pIB, ResourceFormat ibFormat);
         bool initialize();
         VaoHandle mApiHandle;
         VertexBufferDescVector mpVBs;
         Buffer::SharedConstPtr mpIB = nullptr;
+        ResourceFormat mIbFormat = ResourceFormat::R32Uint;
         void* mpPrivateData = nullptr;
     };
 }
\ No newline at end of file
@@ -34,7 +34,7 @@
 void main()
 {
     mat4 worldMat = getWorldMat();
-    gl_Position = worldMat * vPos;
+    gl_Position = worldMat * getPositionL();
 #ifdef _APPLY_PROJECTION
     gl_Position = gCam.viewProjMat * gl_Position;
 #endif
@@ -46,8 +46,18 @@ layout(binding = 51)uniform InternalPerStaticMeshCB
 {
     mat4 gWorldMat[64];
     uint32_t gMeshId;
+    uint32_t gInstanceBase;     // Index of the draw's first instance in gInstanceWorldMat
+    mat4 gPositionDequantMat;   // Transforms the stored vertex positions to object space. Identity unless the positions are quantized.
+    uint32_t gOctahedralDirections; // Normals, tangents and bitangents are octahedral-encoded. See getDirectionL().
 };
 
+#ifdef _INSTANCE_DATA_STREAMING
+layout(std430, binding = 7) buffer InternalInstanceDataSB
+{
+    mat4 gInstanceWorldMat[];
+};
+#endif
+
 layout(binding = 52)uniform InternalPerSkinnedMeshCB
 {
     mat4 gBones[64];
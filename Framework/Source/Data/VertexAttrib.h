@@ -78,10 +78,35 @@ out vec2 texC;
 out vec3 posW;
 out vec3 colorV;
 
+// Matches decodeOctahedral() in VertexQuantization.cpp
+vec3 decodeOctahedral(vec2 oct)
+{
+    vec3 dir = vec3(oct, 1.0 - abs(oct.x) - abs(oct.y));
+    if(dir.z < 0)
+    {
+        dir.xy = (1.0 - abs(oct.yx)) * vec2(oct.x >= 0 ? 1.0 : -1.0, oct.y >= 0 ? 1.0 : -1.0);
+    }
+    return normalize(dir);
+}
+
+// The object-space position. Quantized positions are stored relative to the mesh's bounding-box.
+vec4 getPositionL()
+{
+    return gPositionDequantMat * vPos;
+}
+
+// Decode a normal, tangent or bitangent. Quantized ones are octahedral-encoded in the first 2 components.
+vec3 getDirectionL(vec3 dir)
+{
+    return (gOctahedralDirections != 0) ? decodeOctahedral(dir.xy) : dir;
+}
+
 mat4 getWorldMat()
 {
 #ifdef _VERTEX_BLENDING
     mat4 worldMat = blendVertices(vBoneWeights, vBoneIds);
+#elif defined(_INSTANCE_DATA_STREAMING)
+    mat4 worldMat = gInstanceWorldMat[gInstanceBase + gl_InstanceID];
 #else
     mat4 worldMat = gWorldMat[gl_InstanceID];
 #endif
@@ -91,13 +116,14 @@ mat4 getWorldMat()
 void defaultVS()
 {
     mat4 worldMat = getWorldMat();
-    posW = (worldMat * vPos).xyz;
-    gl_Position = gCam.viewProjMat * worldMat * vPos;
+    vec4 posL = getPositionL();
+    posW = (worldMat * posL).xyz;
+    gl_Position = gCam.viewProjMat * worldMat * posL;
     texC = vTexC;
     colorV = vColor;
-    normalW = (mat3x3(worldMat) * vNormal).xyz;
-    tangentW = (mat3x3(worldMat) * vTangent).xyz;
-    bitangentW = (mat3x3(worldMat) * vBitangent).xyz;
+    normalW = (mat3x3(worldMat) * getDirectionL(vNormal)).xyz;
+    tangentW = (mat3x3(worldMat) * getDirectionL(vTangent)).xyz;
+    bitangentW = (mat3x3(worldMat) * getDirectionL(vBitangent)).xyz;
 
 #ifdef _SINGLE_PASS_STEREO
   gl_SecondaryPositionNV.x = (gCam.rightEyeViewProjMat * vec4(posW, 1)).x;
@@ -452,13 +452,42 @@ namespace Falcor
         }
     }
 
+    bool CascadedShadowMaps::updateLightCullCamera()
+    {
+        // The shadow pass transforms vertices with globalMat. The cascades are sub-regions of the global shadow space, so culling against it is conservative.
+        glm::mat4 cullMat = mCsmData.globalMat;
+        if(mControls.depthClamp)
+        {
+            // With depth clamping, casters outside the depth range are still rasterized. Only side planes of an orthographic projection can be used.
+            if(mpLight->getType() != LightDirectional)
+            {
+                return false;
+            }
+
+            // Stretch the depth range to cover the entire scene
+            BoundingBox sceneBox = mpScene->getBoundingBox().transform(mCsmData.globalMat);
+            float minZ = min(-1.0f, sceneBox.center.z - sceneBox.extent.z);
+            float maxZ = max(1.0f, sceneBox.center.z + sceneBox.extent.z);
+            glm::mat4 depthRemap;
+            depthRemap[2][2] = 2 / (maxZ - minZ);
+            depthRemap[3][2] = -(maxZ + minZ) / (maxZ - minZ);
+            cullMat = depthRemap * cullMat;
+        }
+
+        mpLightCamera->setViewMatrix(glm::mat4());
+        mpLightCamera->setProjectionMatrix(cullMat);
+        return true;
+    }
+
     void CascadedShadowMaps::renderScene(RenderContext* pCtx)
     {
         mShadowPass.pLightUbo->setBlob(&mCsmData, 0, sizeof(mCsmData));
         pCtx->setUniformBuffer(0, mShadowPass.pLightUbo);
         pCtx->setUniformBuffer(1, mShadowPass.pAlphaUbo);
         mShadowPass.pAlphaUbo->setVariable("evsmExp", mCsmData.evsmExponents);
+        mpSceneRenderer->setObjectCullState(updateLightCullCamera());
         mpSceneRenderer->renderScene(pCtx, mShadowPass.pProg.get(), mpLightCamera.get());
+        mpSceneRenderer->setObjectCullState(false);
     }
 
     void CascadedShadowMaps::executeDepthPass(RenderContext* pCtx, const Camera* pCamera)
@@ -96,6 +96,7 @@ namespace Falcor
         void createShadowPassResources(uint32_t mapWidth, uint32_t mapHeight);
         void partitionCascades(const Camera* pCamera, const glm::vec2& distanceRange);
         void renderScene(RenderContext* pCtx);
+        bool updateLightCullCamera();
 
         // Shadow-pass
         struct
@@ -62,6 +62,7 @@
 // Graphics
 #include "Graphics/FullScreenPass.h"
 #include "Graphics/TextureHelper.h"
+#include "Graphics/TextureCache.h"
 #include "Graphics/Light.h"
 #include "Graphics/Program.h"
 #include "Graphics/Program.h"
@@ -76,6 +77,7 @@
 // Model
 #include "Graphics/Model/Mesh.h"
 #include "Graphics/Model/Model.h"
+#include "Graphics/Model/ModelImportCache.h"
 #include "Graphics/Model/ModelRenderer.h"
 
 // Scene
@@ -103,6 +105,8 @@
 #include "Utils/Profiler.h"
 #include "Utils/StringUtils.h"
 #include "Utils/BinaryFileStream.h"
+#include "Utils/ThreadPool.h"
+#include "Utils/AsyncLoader.h"
 #include "Utils/Video/VideoEncoder.h"
 #include "Utils/Video/VideoEncoderUI.h"
 #include "Utils/Video/VideoDecoder.h"
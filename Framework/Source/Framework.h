@@ -29,6 +29,7 @@
 #include "FalcorConfig.h"
 #include <stdint.h>
 #include <memory>
+#include <functional>
 #include "glm/glm.hpp"
 
 #ifndef arraysize
@@ -112,6 +113,16 @@ namespace Falcor
     {
         return (a > b) ? a : b;
     }
+
+    /** Mix the hash of a value into an existing hash
+        \param[in,out] seed The hash to combine into
+        \param[in] value The value to hash
+    */
+    template<typename T>
+    inline void hashCombine(size_t& seed, const T& value)
+    {
+        seed ^= std::hash<T>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
     /*! @} */
 }
 
@@ -122,6 +133,8 @@ namespace Falcor
 #include "Core/OpenGL/FalcorGL.h"
 #elif defined FALCOR_DX11
 #include "Core/DX11/FalcorDX11.h"
+#elif defined FALCOR_NULL
+#include "Core/Null/FalcorNull.h"
 #else
 #error Undefined falcor backend. Make sure that a backend is selected in "FalcorConfig.h"
 #endif
@@ -31,6 +31,7 @@
 #include "utils/AABB.h"
 #include "Utils/math/FalcorMath.h"
 #include "Core/UniformBuffer.h"
+#include <emmintrin.h>
 
 namespace Falcor
 {
@@ -190,6 +191,65 @@ namespace Falcor
         return !isInside;
     }
 
+    void Camera::cullBoxes(const float* cx, const float* cy, const float* cz, const float* ex, const float* ey, const float* ez, size_t count, uint8_t* visibleMask) const
+    {
+        calculateCameraParameters();
+
+        // Same test as isObjectCulled(), evaluated in the same order so that the results match exactly
+        __m128 planeX[6], planeY[6], planeZ[6], signX[6], signY[6], signZ[6], negW[6];
+        for(int plane = 0; plane < 6; plane++)
+        {
+            planeX[plane] = _mm_set1_ps(mFrustumPlanes[plane].xyz.x);
+            planeY[plane] = _mm_set1_ps(mFrustumPlanes[plane].xyz.y);
+            planeZ[plane] = _mm_set1_ps(mFrustumPlanes[plane].xyz.z);
+            signX[plane] = _mm_set1_ps(mFrustumPlanes[plane].sign.x);
+            signY[plane] = _mm_set1_ps(mFrustumPlanes[plane].sign.y);
+            signZ[plane] = _mm_set1_ps(mFrustumPlanes[plane].sign.z);
+            negW[plane] = _mm_set1_ps(mFrustumPlanes[plane].negW);
+        }
+
+        size_t i = 0;
+        for(; i + 4 <= count; i += 4)
+        {
+            const __m128 centerX = _mm_loadu_ps(cx + i);
+            const __m128 centerY = _mm_loadu_ps(cy + i);
+            const __m128 centerZ = _mm_loadu_ps(cz + i);
+            const __m128 extentX = _mm_loadu_ps(ex + i);
+            const __m128 extentY = _mm_loadu_ps(ey + i);
+            const __m128 extentZ = _mm_loadu_ps(ez + i);
+
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for(int plane = 0; plane < 6; plane++)
+            {
+                __m128 x = _mm_mul_ps(_mm_add_ps(centerX, _mm_mul_ps(extentX, signX[plane])), planeX[plane]);
+                __m128 y = _mm_mul_ps(_mm_add_ps(centerY, _mm_mul_ps(extentY, signY[plane])), planeY[plane]);
+                __m128 z = _mm_mul_ps(_mm_add_ps(centerZ, _mm_mul_ps(extentZ, signZ[plane])), planeZ[plane]);
+                __m128 dr = _mm_add_ps(_mm_add_ps(x, y), z);
+                inside = _mm_and_ps(inside, _mm_cmpgt_ps(dr, negW[plane]));
+            }
+
+            int mask = _mm_movemask_ps(inside);
+            visibleMask[i + 0] = (mask >> 0) & 1;
+            visibleMask[i + 1] = (mask >> 1) & 1;
+            visibleMask[i + 2] = (mask >> 2) & 1;
+            visibleMask[i + 3] = (mask >> 3) & 1;
+        }
+
+        // Scalar reference path for the remaining boxes
+        for(; i < count; i++)
+        {
+            BoundingBox box;
+            box.center = glm::vec3(cx[i], cy[i], cz[i]);
+            box.extent = glm::vec3(ex[i], ey[i], ez[i]);
+            visibleMask[i] = isObjectCulled(box) ? 0 : 1;
+        }
+    }
+
+    void Camera::cullBoxes(const BoundingBoxArray& boxes, uint8_t* visibleMask) const
+    {
+        cullBoxes(boxes.centerX.data(), boxes.centerY.data(), boxes.centerZ.data(), boxes.extentX.data(), boxes.extentY.data(), boxes.extentZ.data(), boxes.size(), visibleMask);
+    }
+
     void Camera::setRightEyePrevViewProjMatrix(const glm::mat4& prevViewProj)
     {
         mData.rightEyePrevViewProjMat = prevViewProj;
@@ -37,6 +37,7 @@
 namespace Falcor
 {
     struct BoundingBox;
+    struct BoundingBoxArray;
     class UniformBuffer;
 
    /** Camera class
@@ -154,6 +155,19 @@ namespace Falcor
         */
         bool isObjectCulled(const BoundingBox& box) const;
 
+        /** Frustum-cull a batch of boxes stored as a structure-of-arrays. Processes 4 boxes at a time using SSE.\n
+            Gives the same result as calling isObjectCulled() for each box.
+            \param[in] cx, cy, cz Arrays of box centers
+            \param[in] ex, ey, ez Arrays of box half-extents
+            \param[in] count The number of boxes
+            \param[out] visibleMask An array of count elements. Each element is set to 1 if the box is visible and to 0 if it's culled.
+        */
+        void cullBoxes(const float* cx, const float* cy, const float* cz, const float* ex, const float* ey, const float* ez, size_t count, uint8_t* visibleMask) const;
+
+        /** Frustum-cull a batch of boxes. See cullBoxes() above.
+        */
+        void cullBoxes(const BoundingBoxArray& boxes, uint8_t* visibleMask) const;
+
         void setIntoUniformBuffer(UniformBuffer* pBuffer, const std::string& varName) const;
         void setIntoUniformBuffer(UniformBuffer* pBuffer, const std::size_t& offset) const;
 
@@ -42,7 +42,7 @@ namespace Falcor
     {
 #ifdef FALCOR_GL
         return checkExtensionSupport("GL_NV_viewport_array2");
-#elif defined FALCOR_DX11
+#elif defined FALCOR_DX11 || defined FALCOR_NULL
         return false;
 #else
 #error Unknown API
@@ -60,7 +60,7 @@ namespace Falcor
 
 #ifdef FALCOR_DX11
 #define INVERT_Y(a) ((a == 1) ? 0 : 1)
-#elif defined FALCOR_GL
+#elif defined FALCOR_GL || defined FALCOR_NULL
 #define INVERT_Y(a) (a)
 #endif
     static const Vertex kVertices[] =
@@ -39,7 +39,7 @@ using glm::ivec3;
 
 namespace Falcor
 {
-#if _LOG_ENABLED
+#if _LOG_ENABLED && !defined(FALCOR_NULL)
 #define check_offset(_a) assert(pBuffer->getVariableOffset(varName + "." + #_a) == (offsetof(LightData, _a) + offset))
 #else
 #define check_offset(_a)
@@ -350,7 +350,18 @@ namespace Falcor
 
 			auto& vao = mMeshData.pMesh->getVao();
 		
-            setIndexBuffer(vao->getIndexBuffer());
+            // The light reads the index buffer as 32-bit triangles, starting at the beginning of the buffer. Meshes with 16-bit indices or packed meshes get a converted copy.
+            Buffer::SharedConstPtr pIndexBuffer = vao->getIndexBuffer();
+            if(vao->getIndexBufferFormat() != ResourceFormat::R32Uint || pMesh->getFirstIndex() != 0 || pMesh->getBaseVertex() != 0 || pIndexBuffer->getSize() != pMesh->getIndexCount() * sizeof(uint32_t))
+            {
+                std::vector<uint32_t> indices = pMesh->getIndices();
+                for(uint32_t& index : indices)
+                {
+                    index += pMesh->getBaseVertex();
+                }
+                pIndexBuffer = Buffer::create(indices.size() * sizeof(uint32_t), Buffer::BindFlags::Index, Buffer::AccessFlags::MapRead, indices.data());
+            }
+            setIndexBuffer(pIndexBuffer);
 
 			int32_t posIdx = vao->getElementIndexByLocation(VERTEX_POSITION_LOC).vbIndex;
 			assert(posIdx != Vao::ElementDesc::kInvalidIndex);
@@ -387,19 +398,37 @@ namespace Falcor
 	{
 		if(mVertexBuf && mIndexBuf)
         {
-			// Read data from the buffers
-			std::vector<ivec3> indices(mMeshData.pMesh->getPrimitiveCount());
-			mIndexBuf->readData(indices.data(), 0, mIndexBuf->getSize());
-			std::vector<vec3> vertices(mVertexBuf->getSize() / sizeof(vec3));
-			mVertexBuf->readData(vertices.data(), 0, mVertexBuf->getSize());
+            // Use the mesh's CPU copy if it has one, otherwise read the data from the buffers.
+            // The CPU indices are relative to the base vertex and the CPU positions start at it, so both layouts are addressed the same way.
+            const ivec3* pIndices;
+            const vec3* pVertices;
+            uint32_t vertexCount;
+			std::vector<ivec3> indices;
+			std::vector<vec3> vertices;
+            if(mMeshData.pMesh->hasCpuGeometry())
+            {
+                pIndices = (const ivec3*)mMeshData.pMesh->getCpuIndices();
+                pVertices = mMeshData.pMesh->getCpuPositions();
+                vertexCount = mMeshData.pMesh->getVertexCount();
+            }
+            else
+            {
+                indices.resize(mMeshData.pMesh->getPrimitiveCount());
+                mIndexBuf->readData(indices.data(), 0, mIndexBuf->getSize());
+                vertices.resize(mVertexBuf->getSize() / sizeof(vec3));
+                mVertexBuf->readData(vertices.data(), 0, mVertexBuf->getSize());
+                pIndices = indices.data();
+                pVertices = vertices.data();
+                vertexCount = (uint32_t)vertices.size();
+            }
 
 			// Calculate surface area of the mesh
 			mSurfaceArea = 0.f;
 			mMeshCDF.push_back(0.f);
 			for (uint32_t i = 0; i < mMeshData.pMesh->getPrimitiveCount(); ++i)
 			{
-				ivec3 pId = indices[i];
-				const vec3 p0(vertices[pId.x]), p1(vertices[pId.y]),  p2(vertices[pId.z]);
+				ivec3 pId = pIndices[i];
+				const vec3 p0(pVertices[pId.x]), p1(pVertices[pId.y]),  p2(pVertices[pId.z]);
 
 				mSurfaceArea += 0.5f * glm::length(glm::cross(p1 - p0, p2 - p0));
 
@@ -424,22 +453,22 @@ namespace Falcor
             setMeshCDFBuffer(pCDFBuffer);
 
 			// Set the world position and world direction of this light
-			if (!vertices.empty() && !indices.empty())
+			if (vertexCount > 0 && mMeshData.pMesh->getPrimitiveCount() > 0)
 			{
-				glm::vec3 boxMin = vertices[0];
-				glm::vec3 boxMax = vertices[0];
-				for (uint32_t id = 1; id < vertices.size(); ++id)
+				glm::vec3 boxMin = pVertices[0];
+				glm::vec3 boxMax = pVertices[0];
+				for (uint32_t id = 1; id < vertexCount; ++id)
 				{
-					boxMin = glm::min(boxMin, vertices[id]);
-					boxMax = glm::max(boxMax, vertices[id]);
+					boxMin = glm::min(boxMin, pVertices[id]);
+					boxMax = glm::max(boxMax, pVertices[id]);
 				}
 
 				mData.worldPos = BoundingBox::fromMinMax(boxMin, boxMax).center;
 
 				// This holds only for planar light sources
-				const glm::vec3& p0 = vertices[indices[0].x];
-				const glm::vec3& p1 = vertices[indices[0].y];
-				const glm::vec3& p2 = vertices[indices[0].z];
+				const glm::vec3& p0 = pVertices[pIndices[0].x];
+				const glm::vec3& p1 = pVertices[pIndices[0].y];
+				const glm::vec3& p2 = pVertices[pIndices[0].z];
 
                 // Take the normal of the first triangle as a light normal
 				mData.worldDir = normalize(cross(p1 - p0, p2 - p0));
@@ -36,7 +36,7 @@
 
 namespace Falcor
 {
-	uint32_t Material::sMaterialCounter = 0;
+	std::atomic<uint32_t> Material::sMaterialCounter(0);
     std::vector<Material::DescId> Material::sDescIdentifier;
 
     // Please add your texture here every time you add another texture slot into material
@@ -64,8 +64,7 @@ namespace Falcor
         static_assert((sizeof(MaterialLayerValues) - sizeof(glm::vec4)) == sizeof(MaterialValue) * 3, "Please register your texture offset in kTextureSlots every time you add another texture slot into material");
         static_assert((sizeof(MaterialValues) - sizeof(glm::vec4)) == sizeof(MaterialValue) * 4 + sizeof(MaterialLayerValues) * 3, "Please register your texture offset in kTextureSlots every time you add another texture slot into material");
 
-		mData.values.id = sMaterialCounter;
-		sMaterialCounter++;
+		mData.values.id = sMaterialCounter++;
 	}
 
     Material::SharedPtr Material::create(const std::string& name)
@@ -257,7 +256,7 @@ namespace Falcor
         }
 	}
 
-#if _LOG_ENABLED
+#if _LOG_ENABLED && !defined(FALCOR_NULL)
 #define check_offset(_a) assert(pBuffer->getVariableOffset(varName + "." + #_a) == (offsetof(MaterialData, _a) + offset))
 #else
 #define check_offset(_a)
@@ -265,10 +264,6 @@ namespace Falcor
 
     void Material::setIntoUniformBuffer(UniformBuffer* pBuffer, const std::string& varName) const
     {
-        finalize();
-        static const size_t dataSize = sizeof(MaterialData);
-        static_assert(dataSize % sizeof(glm::vec4) == 0, "Material::MaterialData size should be a multiple of 16");
-
         size_t offset = pBuffer->getVariableOffset(varName + ".desc.layers[0].type");
 
         if(offset == UniformBuffer::kInvalidUniformOffset)
@@ -280,6 +275,15 @@ namespace Falcor
         check_offset(values.layers[0].albedo.texture.ptr);
         check_offset(values.ambientMap.texture.ptr);
         check_offset(values.id);
+
+        setIntoUniformBuffer(pBuffer, offset);
+    }
+
+    void Material::setIntoUniformBuffer(UniformBuffer* pBuffer, const std::size_t& offset) const
+    {
+        finalize();
+        static const size_t dataSize = sizeof(MaterialData);
+        static_assert(dataSize % sizeof(glm::vec4) == 0, "Material::MaterialData size should be a multiple of 16");
         assert(offset + dataSize <= pBuffer->getBuffer()->getSize());
 
         bindTextures();
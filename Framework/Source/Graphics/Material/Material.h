@@ -27,6 +27,7 @@
 ***************************************************************************/
 #pragma once
 #include "glm/vec3.hpp"
+#include <atomic>
 #include <map>
 #include <vector>
 #include "glm/common.hpp"
@@ -199,6 +200,12 @@ namespace Falcor
             \param[in] VarName The name of the material variable in the program.
         */
         void setIntoUniformBuffer(UniformBuffer* pBuffer, const std::string& varName) const;
+
+        /** Set the material parameters into a uniform buffer, using a pre-fetched offset. Avoids the name lookup when setting the material every frame.
+            \param[in] pBuffer The uniform buffer to set the parameters into.
+            \param[in] offset The offset of the material variable's first field ("<VarName>.desc.layers[0].type") inside the buffer.
+        */
+        void setIntoUniformBuffer(UniformBuffer* pBuffer, const std::size_t& offset) const;
         
         /** Returns the raw material data
         */
@@ -243,7 +250,7 @@ namespace Falcor
 
         void normalize();
 
-		static uint32_t sMaterialCounter;
+		static std::atomic<uint32_t> sMaterialCounter;
         struct DescId
         {
             MaterialDesc desc;
@@ -28,103 +28,533 @@
 #include "Framework.h"
 #include "Animation.h"
 #include "AnimationController.h"
-#include "glm/gtc/matrix_transform.hpp"
-#include "glm/gtx/transform.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <emmintrin.h>
 
 namespace Falcor
 {
     Animation::UniquePtr Animation::create(const std::string& name, const std::vector<AnimationSet>& animationSets, float duration, float ticksPerSecond)
     {
-        return UniquePtr(new Animation(name, animationSets, duration, ticksPerSecond));
+        return UniquePtr(new Animation(name, animationSets, duration, ticksPerSecond, nullptr));
     }
 
-    Animation::Animation(const std::string& name, const std::vector<AnimationSet>& animationSets, float duration, float ticksPerSecond) : mName(name), mAnimationSets(animationSets), mDuration(duration), mTicksPerSecond(ticksPerSecond)
+    Animation::UniquePtr Animation::createCompressed(const std::string& name, const std::vector<AnimationSet>& animationSets, float duration, float ticksPerSecond, const CompressionDesc& desc)
     {
+        return UniquePtr(new Animation(name, animationSets, duration, ticksPerSecond, &desc));
+    }
+
+    static const float kSqrtHalf = 0.70710678f;
 
+    static float keyError(const glm::vec3& a, const glm::vec3& b)
+    {
+        return glm::length(a - b);
     }
 
-    Animation::~Animation() = default;
+    static float keyError(const glm::quat& a, const glm::quat& b)
+    {
+        // The angle of the rotation between the two
+        float d = std::min(fabsf(glm::dot(a, b)), 1.0f);
+        return 2.0f * acosf(d);
+    }
 
+    static glm::vec3 interpolate(const glm::vec3& start, const glm::vec3& end, float ratio)
+    {
+        return glm::mix(start, end, ratio);
+    }
+
+    static glm::quat interpolate(const glm::quat& start, const glm::quat& end, float ratio)
+    {
+        return glm::slerp(start, end, ratio);
+    }
+
+    // Returns the indices of the keys to keep. A key is removed if interpolating the keys around it reproduces it within the tolerance.
+    // The first and the last keys are always kept, since the last key interpolates into the first one when the animation loops.
     template<typename T>
-    uint32_t findCurrentFrame(T channel, float ticks)
+    static std::vector<uint32_t> reduceKeys(const std::vector<Animation::AnimationKey<T>>& keys, float tolerance)
     {
-        uint32_t curKeyID = channel.lastKeyUsed;
-        while(curKeyID < channel.keys.size() - 1)
+        std::vector<uint32_t> kept;
+        const uint32_t keyCount = (uint32_t)keys.size();
+        if(keyCount == 0)
+        {
+            return kept;
+        }
+
+        kept.push_back(0);
+
+        // A constant track only needs a single key
+        bool isConstant = true;
+        for(uint32_t k = 1; (k < keyCount) && isConstant; k++)
+        {
+            isConstant = keyError(keys[k].value, keys[0].value) <= tolerance;
+        }
+        if(isConstant)
         {
-            if(channel.keys[curKeyID + 1].time > ticks)
+            return kept;
+        }
+
+        uint32_t anchor = 0;
+        for(uint32_t end = 2; end < keyCount; end++)
+        {
+            // Check that all the keys between the anchor and the end can be reconstructed by interpolating the two
+            const Animation::AnimationKey<T>& a = keys[anchor];
+            const Animation::AnimationKey<T>& b = keys[end];
+            float span = b.time - a.time;
+            bool canRemove = true;
+            for(uint32_t k = anchor + 1; (k < end) && canRemove; k++)
+            {
+                float ratio = (span > 0) ? (keys[k].time - a.time) / span : 0.0f;
+                canRemove = keyError(interpolate(a.value, b.value, ratio), keys[k].value) <= tolerance;
+            }
+
+            if(canRemove == false)
             {
-                break;
+                anchor = end - 1;
+                kept.push_back(anchor);
             }
-            curKeyID++;
         }
-        return curKeyID;
+        kept.push_back(keyCount - 1);
+        return kept;
     }
 
-    glm::vec3 interpolate(const glm::vec3& start, const glm::vec3& end, float ratio)
+    template<typename TrackType, typename T>
+    static void initRawTrack(const std::vector<Animation::AnimationKey<T>>& keys, TrackType& track)
     {
-        return start + ((end - start) * ratio);
+        track.times.resize(keys.size());
+        track.values.resize(keys.size());
+        for(size_t i = 0; i < keys.size(); i++)
+        {
+            track.times[i] = keys[i].time;
+            track.values[i] = keys[i].value;
+        }
     }
 
-    glm::quat interpolate(const glm::quat& start, const glm::quat& end, float ratio)
+    template<typename TrackType>
+    static void initQuantizedTrack(const std::vector<Animation::AnimationKey<glm::vec3>>& keys, float tolerance, TrackType& track)
     {
-        return glm::slerp(start, end, ratio);
+        std::vector<uint32_t> kept = reduceKeys(keys, tolerance);
+        track.times.resize(kept.size());
+        track.values.resize(kept.size() * 3);
+
+        glm::vec3 minValue(FLT_MAX);
+        glm::vec3 maxValue(-FLT_MAX);
+        for(uint32_t k : kept)
+        {
+            minValue = glm::min(minValue, keys[k].value);
+            maxValue = glm::max(maxValue, keys[k].value);
+        }
+        const glm::vec3 range = maxValue - minValue;
+        track.minValue = minValue;
+        track.scale = range / 65535.0f;
+
+        for(size_t i = 0; i < kept.size(); i++)
+        {
+            const Animation::AnimationKey<glm::vec3>& key = keys[kept[i]];
+            track.times[i] = key.time;
+            for(int c = 0; c < 3; c++)
+            {
+                float normalized = (range[c] > 0) ? (key.value[c] - minValue[c]) / range[c] : 0.0f;
+                track.values[i * 3 + c] = (uint16_t)(glm::clamp(normalized, 0.0f, 1.0f) * 65535.0f + 0.5f);
+            }
+        }
     }
 
-    template<typename KeyType>
-    KeyType Animation::calcCurrentKey(AnimationChannel<KeyType>& channel, float ticks, float lastUpdateTime)
+    template<typename TrackType>
+    static void initQuantizedTrack(const std::vector<Animation::AnimationKey<glm::quat>>& keys, float tolerance, TrackType& track)
     {
-        KeyType curValue;
-        if(channel.keys.size() > 0)
+        std::vector<uint32_t> kept = reduceKeys(keys, tolerance);
+        track.times.resize(kept.size());
+        track.values.resize(kept.size() * 3);
+
+        for(size_t i = 0; i < kept.size(); i++)
         {
-            if(ticks < lastUpdateTime)
+            const Animation::AnimationKey<glm::quat>& key = keys[kept[i]];
+            track.times[i] = key.time;
+
+            // Smallest-three. The largest component is dropped and reconstructed from the unit length. It is made positive, since q and -q represent the same rotation.
+            // The other 3 components are in [-sqrt(0.5), sqrt(0.5)] and are stored in 15 bits each. The index of the largest component is stored in the top bits of the first 2 components.
+            glm::quat q = glm::normalize(key.value);
+            const float c[4] = {q.x, q.y, q.z, q.w};
+            uint32_t largest = 0;
+            for(uint32_t j = 1; j < 4; j++)
             {
-                channel.lastKeyUsed = 0;
+                if(fabsf(c[j]) > fabsf(c[largest]))
+                {
+                    largest = j;
+                }
             }
+            const float sign = (c[largest] < 0) ? -1.0f : 1.0f;
 
-            // search for the next keyframe
-            uint32_t curKeyIndex = findCurrentFrame(channel, ticks);
-            uint32_t nextKeyIndex = (curKeyIndex + 1) % channel.keys.size();
-            const AnimationKey<KeyType>& curKey = channel.keys[curKeyIndex];
-            const AnimationKey<KeyType>& nextKey = channel.keys[nextKeyIndex];
+            uint16_t* pDst = &track.values[i * 3];
+            uint32_t dst = 0;
+            for(uint32_t j = 0; j < 4; j++)
+            {
+                if(j != largest)
+                {
+                    float normalized = (c[j] * sign / kSqrtHalf) * 0.5f + 0.5f;
+                    pDst[dst++] = (uint16_t)(glm::clamp(normalized, 0.0f, 1.0f) * 32767.0f + 0.5f);
+                }
+            }
+            pDst[0] |= (uint16_t)((largest & 1) << 15);
+            pDst[1] |= (uint16_t)((largest >> 1) << 15);
+        }
+    }
+
+    glm::vec3 Animation::QuantizedVec3Track::decode(uint32_t key) const
+    {
+        const uint16_t* pSrc = &values[key * 3];
+        return minValue + glm::vec3(pSrc[0], pSrc[1], pSrc[2]) * scale;
+    }
 
-            assert(ticks >= curKey.time);
-            // Interpolate between them
-            float diff = nextKey.time - curKey.time;
-            if(diff < 0)
+    glm::quat Animation::QuantizedQuatTrack::decode(uint32_t key) const
+    {
+        const uint16_t* pSrc = &values[key * 3];
+        const uint32_t largest = (pSrc[0] >> 15) | ((pSrc[1] >> 15) << 1);
+
+        float c[4];
+        float sumSquares = 0;
+        uint32_t src = 0;
+        for(uint32_t j = 0; j < 4; j++)
+        {
+            if(j != largest)
             {
-                diff += mDuration;
+                c[j] = (float(pSrc[src++] & 0x7fff) * (2.0f / 32767.0f) - 1.0f) * kSqrtHalf;
+                sumSquares += c[j] * c[j];
             }
-            else if(diff == 0)
+        }
+        c[largest] = sqrtf(std::max(1.0f - sumSquares, 0.0f));
+        return glm::quat(c[3], c[0], c[1], c[2]);
+    }
+
+    Animation::Animation(const std::string& name, const std::vector<AnimationSet>& animationSets, float duration, float ticksPerSecond, const CompressionDesc* pCompression) : mName(name), mDuration(duration), mTicksPerSecond(ticksPerSecond)
+    {
+        size_t channelCount = animationSets.size();
+        mBoneIDs.resize(channelCount);
+        mIsCompressed = (pCompression != nullptr);
+
+        if(mIsCompressed)
+        {
+            mQuantizedTranslations.resize(channelCount);
+            mQuantizedScalings.resize(channelCount);
+            mQuantizedRotations.resize(channelCount);
+        }
+        else
+        {
+            mTranslations.resize(channelCount);
+            mScalings.resize(channelCount);
+            mRotations.resize(channelCount);
+        }
+
+        for(size_t i = 0; i < channelCount; i++)
+        {
+            const AnimationSet& set = animationSets[i];
+            mBoneIDs[i] = set.boneID;
+            if(mIsCompressed)
             {
-                curValue = curKey.value;
+                initQuantizedTrack(set.translation.keys, pCompression->translationTolerance, mQuantizedTranslations[i]);
+                initQuantizedTrack(set.scaling.keys, pCompression->scaleTolerance, mQuantizedScalings[i]);
+                initQuantizedTrack(set.rotation.keys, pCompression->rotationTolerance, mQuantizedRotations[i]);
+                initKeyIndex(mQuantizedTranslations[i]);
+                initKeyIndex(mQuantizedScalings[i]);
+                initKeyIndex(mQuantizedRotations[i]);
             }
             else
             {
-                float ratio = (ticks - curKey.time) / diff;
-                curValue = interpolate(curKey.value, nextKey.value, ratio);
+                initRawTrack(set.translation.keys, mTranslations[i]);
+                initRawTrack(set.scaling.keys, mScalings[i]);
+                initRawTrack(set.rotation.keys, mRotations[i]);
+                initKeyIndex(mTranslations[i]);
+                initKeyIndex(mScalings[i]);
+                initKeyIndex(mRotations[i]);
             }
-            channel.lastKeyUsed = curKeyIndex;
         }
-        return curValue;
     }
 
-    void Animation::animate(double totalTime, AnimationController* pAnimationController)
+    void Animation::initKeyIndex(KeyIndex& index) const
     {
-        // Calculate the relative time
-        float ticks = (float)fmod(totalTime * mTicksPerSecond, mDuration);
+        const uint32_t keyCount = (uint32_t)index.times.size();
+        if((keyCount == 0) || (mDuration <= 0))
+        {
+            return;
+        }
+
+        // One bucket per key, so that a bucket holds a single key on average
+        const uint32_t bucketCount = keyCount;
+        index.bucketsPerTick = float(bucketCount) / mDuration;
+        index.bucketKeys.resize(bucketCount);
+        uint32_t key = 0;
+        for(uint32_t bucket = 0; bucket < bucketCount; bucket++)
+        {
+            const float bucketStart = float(bucket) / index.bucketsPerTick;
+            while((key + 1 < keyCount) && (index.times[key + 1] <= bucketStart))
+            {
+                key++;
+            }
+            index.bucketKeys[bucket] = key;
+        }
+    }
+
+    template<typename TrackType>
+    static size_t getTrackMemorySize(const TrackType& track)
+    {
+        return track.times.size() * sizeof(float) + track.values.size() * sizeof(track.values[0]) + track.bucketKeys.size() * sizeof(uint32_t);
+    }
+
+    size_t Animation::getKeysMemorySize() const
+    {
+        size_t size = 0;
+        for(size_t i = 0; i < mBoneIDs.size(); i++)
+        {
+            if(mIsCompressed)
+            {
+                size += getTrackMemorySize(mQuantizedTranslations[i]) + getTrackMemorySize(mQuantizedScalings[i]) + getTrackMemorySize(mQuantizedRotations[i]);
+            }
+            else
+            {
+                size += getTrackMemorySize(mTranslations[i]) + getTrackMemorySize(mScalings[i]) + getTrackMemorySize(mRotations[i]);
+            }
+        }
+        return size;
+    }
+
+    Animation::~Animation() = default;
+
+    Animation::PlaybackState::UniquePtr Animation::createPlaybackState() const
+    {
+        PlaybackState::UniquePtr pState = PlaybackState::UniquePtr(new PlaybackState);
+        pState->cursors.assign(mBoneIDs.size() * 3, 0);
+        pState->pose.resize(mBoneIDs.size());
+        return pState;
+    }
+
+    void Animation::PlaybackState::PoseSoA::resize(size_t count)
+    {
+        // Padding lanes hold an identity transform
+        count = (count + 3) & ~size_t(3);
+        for(auto pArray : {&tx, &ty, &tz, &q0x, &q0y, &q0z, &q1x, &q1y, &q1z, &w1})
+        {
+            pArray->assign(count, 0.0f);
+        }
+        for(auto pArray : {&sx, &sy, &sz, &q0w, &q1w, &w0})
+        {
+            pArray->assign(count, 1.0f);
+        }
+    }
+
+    void Animation::findKeys(const KeyIndex& track, float ticks, uint32_t& cursor, uint32_t& nextKey, float& ratio) const
+    {
+        const uint32_t keyCount = (uint32_t)track.times.size();
+        const float* pTimes = track.times.data();
+        uint32_t curKeyID;
+
+        // Forward playback usually stays on the same key or moves to the next one
+        if((cursor < keyCount) && (pTimes[cursor] <= ticks) && ((cursor + 1 == keyCount) || (ticks < pTimes[cursor + 1])))
+        {
+            curKeyID = cursor;
+        }
+        else if((cursor + 1 < keyCount) && (pTimes[cursor + 1] <= ticks) && ((cursor + 2 == keyCount) || (ticks < pTimes[cursor + 2])))
+        {
+            curKeyID = cursor + 1;
+        }
+        else if(track.bucketKeys.size())
+        {
+            // Random access. The key is between the first keys of this bucket and the next one.
+            const uint32_t bucketCount = (uint32_t)track.bucketKeys.size();
+            uint32_t bucket = std::min((uint32_t)std::max(ticks * track.bucketsPerTick, 0.0f), bucketCount - 1);
+            // The range is padded by a key on each side, in case the bucket calculation rounded differently than initTrack()
+            uint32_t first = track.bucketKeys[bucket];
+            first = (first > 0) ? first - 1 : 0;
+            uint32_t last = (bucket + 1 < bucketCount) ? std::min(track.bucketKeys[bucket + 1] + 1, keyCount - 1) : keyCount - 1;
+            const float* pUpper = std::upper_bound(pTimes + first, pTimes + last + 1, ticks);
+            curKeyID = (pUpper == pTimes + first) ? first : uint32_t(pUpper - pTimes) - 1;
+        }
+        else
+        {
+            curKeyID = 0;
+        }
+        cursor = curKeyID;
+        nextKey = (curKeyID + 1) % keyCount;
+
+        // Interpolate between them. When the next key wraps around, the interval continues into the next loop of the animation.
+        float diff = pTimes[nextKey] - pTimes[curKeyID];
+        if(diff < 0)
+        {
+            diff += mDuration;
+        }
+        ratio = (diff > 0) ? glm::clamp((ticks - pTimes[curKeyID]) / diff, 0.0f, 1.0f) : 0.0f;
+    }
+
+    template<typename Vec3Track, typename QuatTrack>
+    void Animation::evaluateKeys(float ticks, const std::vector<Vec3Track>& translations, const std::vector<Vec3Track>& scalings, const std::vector<QuatTrack>& rotations, PlaybackState* pState) const
+    {
+        PlaybackState::PoseSoA& pose = pState->pose;
+        uint32_t nextKey;
+        float ratio;
+
+        // Compressed keys are decoded here, only the 2 keys around the current time are decoded for each track
+        for(size_t i = 0; i < mBoneIDs.size(); i++)
+        {
+            // Translation and scaling are linear, no reason to defer them
+            const Vec3Track& translation = translations[i];
+            if(translation.times.size())
+            {
+                uint32_t& curKey = pState->cursors[i * 3 + 0];
+                findKeys(translation, ticks, curKey, nextKey, ratio);
+                glm::vec3 t = glm::mix(translation.decode(curKey), translation.decode(nextKey), ratio);
+                pose.tx[i] = t.x;
+                pose.ty[i] = t.y;
+                pose.tz[i] = t.z;
+            }
+
+            const Vec3Track& scaling = scalings[i];
+            if(scaling.times.size())
+            {
+                uint32_t& curKey = pState->cursors[i * 3 + 1];
+                findKeys(scaling, ticks, curKey, nextKey, ratio);
+                glm::vec3 s = glm::mix(scaling.decode(curKey), scaling.decode(nextKey), ratio);
+                pose.sx[i] = s.x;
+                pose.sy[i] = s.y;
+                pose.sz[i] = s.z;
+            }
+
+            // Rotations only gather the keys and the ratio. The slerp is evaluated for all channels together.
+            const QuatTrack& rotation = rotations[i];
+            if(rotation.times.size())
+            {
+                uint32_t& curKey = pState->cursors[i * 3 + 2];
+                findKeys(rotation, ticks, curKey, nextKey, ratio);
+                const glm::quat q0 = rotation.decode(curKey);
+                const glm::quat q1 = rotation.decode(nextKey);
+                pose.q0x[i] = q0.x;
+                pose.q0y[i] = q0.y;
+                pose.q0z[i] = q0.z;
+                pose.q0w[i] = q0.w;
+                pose.q1x[i] = q1.x;
+                pose.q1y[i] = q1.y;
+                pose.q1z[i] = q1.z;
+                pose.q1w[i] = q1.w;
+                pose.w1[i] = ratio;
+            }
+        }
+    }
 
-        for(auto& Key : mAnimationSets)
+    void Animation::calcSlerpWeights(PlaybackState::PoseSoA& pose) const
+    {
+        // Converts the ratios in w1 into slerp weights, so that q = q0 * w0 + q1 * w1. Same math as glm::slerp().
+        // No branches on the data other than the selects, so that the compiler can vectorize the loop.
+        const size_t count = pose.w1.size();
+        for(size_t i = 0; i < count; i++)
         {
-            glm::mat4 translation;
-            translation[3] = glm::vec4(calcCurrentKey(Key.translation, ticks, Key.lastUpdateTime), 1);
-            glm::mat4 scaling = glm::scale(calcCurrentKey(Key.scaling, ticks, Key.lastUpdateTime));
-            glm::quat q = calcCurrentKey(Key.rotation, ticks, Key.lastUpdateTime);
-            glm::mat4 rotation = glm::mat4_cast(q);
+            float a = pose.w1[i];
+            float cosTheta = pose.q0x[i] * pose.q1x[i] + pose.q0y[i] * pose.q1y[i] + pose.q0z[i] * pose.q1z[i] + pose.q0w[i] * pose.q1w[i];
+
+            // Take the short way around the sphere
+            float sign = (cosTheta < 0) ? -1.0f : 1.0f;
+            cosTheta *= sign;
+
+            // Use a linear interpolation when cosTheta is close to 1, sin(angle) will be close to zero
+            bool useLerp = cosTheta > (1.0f - glm::epsilon<float>());
+            float angle = acosf(useLerp ? 0.0f : cosTheta);
+            float invSin = 1.0f / sinf(angle);
+            pose.w0[i] = useLerp ? (1.0f - a) : sinf((1.0f - a) * angle) * invSin;
+            pose.w1[i] = sign * (useLerp ? a : sinf(a * angle) * invSin);
+        }
+    }
+
+    void Animation::composeLocalTransforms(const PlaybackState::PoseSoA& pose, glm::mat4* pLocalTransforms) const
+    {
+        // Evaluates T * R * S for 4 channels at a time. The result is written directly as the matrix columns, which saves the matrix multiplications.
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 two = _mm_set1_ps(2.0f);
+        const size_t channelCount = mBoneIDs.size();
+
+        for(size_t i = 0; i < channelCount; i += 4)
+        {
+            // Blend the quaternions
+            const __m128 w0 = _mm_loadu_ps(&pose.w0[i]);
+            const __m128 w1 = _mm_loadu_ps(&pose.w1[i]);
+            const __m128 x = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&pose.q0x[i]), w0), _mm_mul_ps(_mm_loadu_ps(&pose.q1x[i]), w1));
+            const __m128 y = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&pose.q0y[i]), w0), _mm_mul_ps(_mm_loadu_ps(&pose.q1y[i]), w1));
+            const __m128 z = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&pose.q0z[i]), w0), _mm_mul_ps(_mm_loadu_ps(&pose.q1z[i]), w1));
+            const __m128 w = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&pose.q0w[i]), w0), _mm_mul_ps(_mm_loadu_ps(&pose.q1w[i]), w1));
+
+            // Rotation matrix, same as glm::mat3_cast()
+            const __m128 xx = _mm_mul_ps(x, x);
+            const __m128 yy = _mm_mul_ps(y, y);
+            const __m128 zz = _mm_mul_ps(z, z);
+            const __m128 xz = _mm_mul_ps(x, z);
+            const __m128 xy = _mm_mul_ps(x, y);
+            const __m128 yz = _mm_mul_ps(y, z);
+            const __m128 wx = _mm_mul_ps(w, x);
+            const __m128 wy = _mm_mul_ps(w, y);
+            const __m128 wz = _mm_mul_ps(w, z);
 
-            Key.lastUpdateTime = ticks;
+            const __m128 sx = _mm_loadu_ps(&pose.sx[i]);
+            const __m128 sy = _mm_loadu_ps(&pose.sy[i]);
+            const __m128 sz = _mm_loadu_ps(&pose.sz[i]);
 
-            glm::mat4 T = translation * rotation * scaling;
-            pAnimationController->setBoneLocalTransform(Key.boneID, T);
+            // Each column of the rotation is scaled by the matching scale component
+            __m128 c0r0 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+            __m128 c0r1 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx);
+            __m128 c0r2 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx);
+            __m128 c0r3 = zero;
+
+            __m128 c1r0 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy);
+            __m128 c1r1 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+            __m128 c1r2 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy);
+            __m128 c1r3 = zero;
+
+            __m128 c2r0 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz);
+            __m128 c2r1 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz);
+            __m128 c2r2 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+            __m128 c2r3 = zero;
+
+            __m128 c3r0 = _mm_loadu_ps(&pose.tx[i]);
+            __m128 c3r1 = _mm_loadu_ps(&pose.ty[i]);
+            __m128 c3r2 = _mm_loadu_ps(&pose.tz[i]);
+            __m128 c3r3 = one;
+
+            // Transpose from SoA into one column per channel
+            _MM_TRANSPOSE4_PS(c0r0, c0r1, c0r2, c0r3);
+            _MM_TRANSPOSE4_PS(c1r0, c1r1, c1r2, c1r3);
+            _MM_TRANSPOSE4_PS(c2r0, c2r1, c2r2, c2r3);
+            _MM_TRANSPOSE4_PS(c3r0, c3r1, c3r2, c3r3);
+
+            const __m128 columns[4][4] = 
+            {
+                {c0r0, c1r0, c2r0, c3r0},
+                {c0r1, c1r1, c2r1, c3r1},
+                {c0r2, c1r2, c2r2, c3r2},
+                {c0r3, c1r3, c2r3, c3r3},
+            };
+
+            const size_t laneCount = std::min(channelCount - i, (size_t)4);
+            for(size_t lane = 0; lane < laneCount; lane++)
+            {
+                float* pDst = &pLocalTransforms[mBoneIDs[i + lane]][0][0];
+                _mm_storeu_ps(pDst + 0, columns[lane][0]);
+                _mm_storeu_ps(pDst + 4, columns[lane][1]);
+                _mm_storeu_ps(pDst + 8, columns[lane][2]);
+                _mm_storeu_ps(pDst + 12, columns[lane][3]);
+            }
+        }
+    }
+
+    void Animation::animate(double totalTime, PlaybackState* pState, AnimationController* pAnimationController) const
+    {
+        // Calculate the relative time
+        float ticks = (float)fmod(totalTime * mTicksPerSecond, mDuration);
+
+        if(mIsCompressed)
+        {
+            evaluateKeys(ticks, mQuantizedTranslations, mQuantizedScalings, mQuantizedRotations, pState);
+        }
+        else
+        {
+            evaluateKeys(ticks, mTranslations, mScalings, mRotations, pState);
         }
+        calcSlerpWeights(pState->pose);
+        composeLocalTransforms(pState->pose, pAnimationController->mLocalTransforms.data());
     }
-}
+}
\ No newline at end of file
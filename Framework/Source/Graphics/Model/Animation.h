@@ -51,7 +51,6 @@ namespace Falcor
         struct AnimationChannel
         {
             std::vector<AnimationKey<T>> keys;
-            uint32_t lastKeyUsed = 0;
         };
 
         struct AnimationSet
@@ -60,24 +59,124 @@ namespace Falcor
             AnimationChannel<glm::vec3> translation;
             AnimationChannel<glm::vec3> scaling;
             AnimationChannel<glm::quat> rotation;
-            float lastUpdateTime = 0;
+        };
+
+        /** Per-instance playback state. Holds the key cursors and the scratch pose, so that a single animation can drive multiple instances at different times without being modified.
+            A state can only be used with the animation that created it.
+        */
+        class PlaybackState
+        {
+        public:
+            using UniquePtr = std::unique_ptr<PlaybackState>;
+        private:
+            friend class Animation;
+
+            // Per-channel pose, evaluated 4 channels at a time. Arrays are padded to a multiple of 4.
+            struct PoseSoA
+            {
+                std::vector<float> tx, ty, tz;
+                std::vector<float> sx, sy, sz;
+                std::vector<float> q0x, q0y, q0z, q0w;
+                std::vector<float> q1x, q1y, q1z, q1w;
+                std::vector<float> w0, w1;
+                void resize(size_t count);
+            };
+
+            std::vector<uint32_t> cursors;  ///< The last key used by each track. 3 tracks per channel - translation, scaling, rotation
+            PoseSoA pose;
+        };
+
+        /** Settings for compressed animations.\n
+            Keys which can be reconstructed by interpolating their neighbors within the tolerance are removed. The remaining rotations are stored with the smallest-three encoding in 48 bits, translations and scales are quantized to 16 bits per component relative to the track's range.
+        */
+        struct CompressionDesc
+        {
+            float rotationTolerance = 0.0005f;      ///< Max rotation error of a removed key, in radians
+            float translationTolerance = 0.0001f;   ///< Max distance between a removed translation key and the interpolated value
+            float scaleTolerance = 0.0001f;         ///< Max distance between a removed scale key and the interpolated value
         };
 
         static UniquePtr create(const std::string& name, const std::vector<AnimationSet>& animationSets, float duration, float ticksPerSecond);
+
+        /** Create a compressed animation. The keys are decompressed on the fly by animate().
+        */
+        static UniquePtr createCompressed(const std::string& name, const std::vector<AnimationSet>& animationSets, float duration, float ticksPerSecond, const CompressionDesc& desc);
         ~Animation();
-        void animate(double totalTime, AnimationController* pAnimationController);
+
+        /** Check if the animation is stored in compressed form
+        */
+        bool isCompressed() const { return mIsCompressed; }
+
+        /** Get the number of bytes used by the keys
+        */
+        size_t getKeysMemorySize() const;
+
+        /** Create a playback state for this animation
+        */
+        PlaybackState::UniquePtr createPlaybackState() const;
+
+        /** Evaluate the animation and write the local transforms of the animated bones into the animation controller.
+            The time can move in any direction. Forward playback finds the keys in constant time, random seeks take O(log n) in the worst case.
+            \param[in] totalTime The global time
+            \param[in] pState The playback state of the instance being animated
+            \param[in] pAnimationController The controller to write the bone transforms into
+        */
+        void animate(double totalTime, PlaybackState* pState, AnimationController* pAnimationController) const;
         const std::string& getName() const { return mName; }
 
     private:
-        Animation(const std::string& name, const std::vector<AnimationSet>& animationSets, float duration, float ticksPerSecond);
+        Animation(const std::string& name, const std::vector<AnimationSet>& animationSets, float duration, float ticksPerSecond, const CompressionDesc* pCompression);
         
         const std::string mName;
         float mDuration;
         float mTicksPerSecond;
 
-        std::vector<AnimationSet> mAnimationSets;
+        // Channel data is stored as SoA. Each track holds the key times and values in separate arrays.
+        // The time range of the animation is split into uniform buckets, each storing the last key that starts before the bucket, which allows jumping to any time without a linear search.
+        struct KeyIndex
+        {
+            std::vector<float> times;
+            std::vector<uint32_t> bucketKeys;
+            float bucketsPerTick = 0;
+        };
+
+        template<typename T>
+        struct Track : public KeyIndex
+        {
+            std::vector<T> values;
+            T decode(uint32_t key) const { return values[key]; }
+        };
+
+        // 3 components of 16 bits per key, relative to the track's range
+        struct QuantizedVec3Track : public KeyIndex
+        {
+            std::vector<uint16_t> values;
+            glm::vec3 minValue;
+            glm::vec3 scale;
+            glm::vec3 decode(uint32_t key) const;
+        };
+
+        // Smallest-three encoding. 3 components of 16 bits per key.
+        struct QuantizedQuatTrack : public KeyIndex
+        {
+            std::vector<uint16_t> values;
+            glm::quat decode(uint32_t key) const;
+        };
+
+        std::vector<uint32_t> mBoneIDs;
+        bool mIsCompressed = false;
+        std::vector<Track<glm::vec3>> mTranslations;
+        std::vector<Track<glm::vec3>> mScalings;
+        std::vector<Track<glm::quat>> mRotations;
+        std::vector<QuantizedVec3Track> mQuantizedTranslations;
+        std::vector<QuantizedVec3Track> mQuantizedScalings;
+        std::vector<QuantizedQuatTrack> mQuantizedRotations;
 
-        template<typename _KeyType>
-        _KeyType calcCurrentKey(AnimationChannel<_KeyType>& channel, float ticks, float lastUpdateTime);
+        void initKeyIndex(KeyIndex& index) const;
+        void findKeys(const KeyIndex& index, float ticks, uint32_t& cursor, uint32_t& nextKey, float& ratio) const;
+        template<typename Vec3Track, typename QuatTrack>
+        void evaluateKeys(float ticks, const std::vector<Vec3Track>& translations, const std::vector<Vec3Track>& scalings, const std::vector<QuatTrack>& rotations, PlaybackState* pState) const;
+        void calcSlerpWeights(PlaybackState::PoseSoA& pose) const;
+        void composeLocalTransforms(const PlaybackState::PoseSoA& pose, glm::mat4* pLocalTransforms) const;
     };
 }
\ No newline at end of file
@@ -31,6 +31,7 @@
 #include <fstream>
 #include "Animation.h"
 #include <algorithm>
+#include <emmintrin.h>
 
 namespace Falcor
 {
@@ -68,8 +69,28 @@ namespace Falcor
 
     AnimationController::AnimationController(const std::vector<Bone>& Bones)
     {
-        mBones = Bones;
-        mBoneTransforms.resize(mBones.size());
+        size_t boneCount = Bones.size();
+        mParentIDs.resize(boneCount);
+        mBoneNames.resize(boneCount);
+        mOffsets.resize(boneCount);
+        mLocalTransforms.resize(boneCount);
+        mOriginalLocalTransforms.resize(boneCount);
+        mGlobalTransforms.resize(boneCount);
+        mBoneTransforms.resize(boneCount);
+
+        for(size_t i = 0; i < boneCount; i++)
+        {
+            const Bone& bone = Bones[i];
+            assert(bone.boneID == i);
+            // animate() computes the global transforms in a single pass, which requires the parents to come first
+            assert(bone.parentID == INVALID_BONE_ID || bone.parentID < i);
+            mParentIDs[i] = bone.parentID;
+            mBoneNames[i] = bone.name;
+            mOffsets[i] = bone.offset;
+            mLocalTransforms[i] = bone.localTransform;
+            mOriginalLocalTransforms[i] = bone.originalLocalTransform;
+            mGlobalTransforms[i] = bone.globalTransform;
+        }
     }
 
     void AnimationController::addAnimation(Animation::UniquePtr pAnimation)
@@ -81,25 +102,102 @@ namespace Falcor
 
     void AnimationController::setBoneLocalTransform(uint32_t boneID, const glm::mat4& transform)
     {
-        assert(boneID < mBones.size());
-        mBones[boneID].localTransform = transform;
+        assert(boneID < mLocalTransforms.size());
+        mLocalTransforms[boneID] = transform;
+    }
+
+    uint32_t AnimationController::getBoneIdFromName(const std::string& name) const
+    {
+        for(uint32_t i = 0; i < mBoneNames.size(); i++)
+        {
+            if(mBoneNames[i] == name)
+            {
+                return i;
+            }
+        }
+        return INVALID_BONE_ID;
+    }
+
+    // Multiplies two affine matrices. The last row of both matrices is assumed to be (0, 0, 0, 1), which saves a quarter of the work of a full multiplication.
+    static void multiplyAffine(const glm::mat4& a, const glm::mat4& b, glm::mat4& result)
+    {
+        const __m128 a0 = _mm_loadu_ps(&a[0][0]);
+        const __m128 a1 = _mm_loadu_ps(&a[1][0]);
+        const __m128 a2 = _mm_loadu_ps(&a[2][0]);
+        const __m128 a3 = _mm_loadu_ps(&a[3][0]);
+
+        __m128 b0 = _mm_loadu_ps(&b[0][0]);
+        __m128 b1 = _mm_loadu_ps(&b[1][0]);
+        __m128 b2 = _mm_loadu_ps(&b[2][0]);
+        __m128 b3 = _mm_loadu_ps(&b[3][0]);
+
+#define affine_column(_b) _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0, _mm_shuffle_ps(_b, _b, _MM_SHUFFLE(0, 0, 0, 0))), _mm_mul_ps(a1, _mm_shuffle_ps(_b, _b, _MM_SHUFFLE(1, 1, 1, 1)))), _mm_mul_ps(a2, _mm_shuffle_ps(_b, _b, _MM_SHUFFLE(2, 2, 2, 2))))
+        b0 = affine_column(b0);
+        b1 = affine_column(b1);
+        b2 = affine_column(b2);
+        b3 = _mm_add_ps(affine_column(b3), a3);
+#undef affine_column
+
+        _mm_storeu_ps(&result[0][0], b0);
+        _mm_storeu_ps(&result[1][0], b1);
+        _mm_storeu_ps(&result[2][0], b2);
+        _mm_storeu_ps(&result[3][0], b3);
     }
 
     void AnimationController::animate(double currentTime)
+    {
+        evaluate(currentTime);
+        mKeyPoseEnd.clear();
+    }
+
+    void AnimationController::evaluate(double currentTime)
     {
         if(mActiveAnimation != BIND_POSE_ANIMATION_ID)
         {
-            mAnimations[mActiveAnimation]->animate(currentTime, this);
+            mAnimations[mActiveAnimation]->animate(currentTime, mpPlaybackState.get(), this);
         }
 
-        for(uint32_t i = 0; i < mBones.size(); i++)
+        const uint32_t boneCount = getBoneCount();
+        for(uint32_t i = 0; i < boneCount; i++)
         {
-            mBones[i].globalTransform = mBones[i].localTransform;
-            if(mBones[i].parentID != INVALID_BONE_ID)
+            const uint32_t parentID = mParentIDs[i];
+            if(parentID != INVALID_BONE_ID)
             {
-                mBones[i].globalTransform = mBones[mBones[i].parentID].globalTransform * mBones[i].globalTransform;
+                multiplyAffine(mGlobalTransforms[parentID], mLocalTransforms[i], mGlobalTransforms[i]);
+            }
+            else
+            {
+                mGlobalTransforms[i] = mLocalTransforms[i];
+            }
+            multiplyAffine(mGlobalTransforms[i], mOffsets[i], mBoneTransforms[i]);
+        }
+    }
+
+    void AnimationController::animateKeyPose(double keyTime)
+    {
+        mKeyPoseStart = mBoneTransforms;
+        evaluate(keyTime);
+        mKeyPoseEnd.swap(mBoneTransforms);
+        mBoneTransforms = mKeyPoseStart;
+    }
+
+    void AnimationController::interpolateKeyPose(float factor)
+    {
+        if(mKeyPoseEnd.size() != mBoneTransforms.size())
+        {
+            // No key pose was evaluated
+            return;
+        }
+
+        const uint32_t boneCount = getBoneCount();
+        for(uint32_t i = 0; i < boneCount; i++)
+        {
+            const glm::mat4& start = mKeyPoseStart[i];
+            const glm::mat4& end = mKeyPoseEnd[i];
+            for(uint32_t c = 0; c < 4; c++)
+            {
+                mBoneTransforms[i][c] = start[c] + (end[c] - start[c]) * factor;
             }
-            mBoneTransforms[i] = mBones[i].globalTransform * mBones[i].offset;
         }
     }
 
@@ -107,12 +205,15 @@ namespace Falcor
     {
         assert(id == BIND_POSE_ANIMATION_ID || id < mAnimations.size());
         mActiveAnimation = id;
+        mKeyPoseEnd.clear();
         if(id == BIND_POSE_ANIMATION_ID)
         {
-            for(auto& bone : mBones)
-            {
-                bone.localTransform = bone.originalLocalTransform;
-            }
+            mLocalTransforms = mOriginalLocalTransforms;
+            mpPlaybackState = nullptr;
+        }
+        else
+        {
+            mpPlaybackState = mAnimations[id]->createPlaybackState();
         }
     }
 
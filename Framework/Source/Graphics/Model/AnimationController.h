@@ -56,32 +56,59 @@ namespace Falcor
         using UniquePtr = std::unique_ptr<AnimationController>;
         using UniqueConstPtr = std::unique_ptr<const AnimationController>;
 
+        /** Create a new object.
+            \param[in] bones The skeleton. Bones must be sorted so that a parent appears before its children.
+        */
         static UniquePtr create(const std::vector<Bone>& bones);
         ~AnimationController();
 
         void addAnimation(Animation::UniquePtr pAnimation);
+
+        /** Evaluate the active animation and update the bone matrices.
+            Bone transforms are assumed to be affine.
+        */
         void animate(double currentTime);
 
+        /** Evaluate the active animation at a future time and store the result as the target key pose. The bone matrices are left unchanged, call interpolateKeyPose() to move them towards the target.
+            Used to update the skeleton at a lower rate than the frame rate.
+            \param[in] keyTime The time at which the target pose should be reached
+        */
+        void animateKeyPose(double keyTime);
+
+        /** Set the bone matrices to a linear blend between the pose the bones had when animateKeyPose() was called and the target key pose.
+            \param[in] factor The blend factor. 0 returns the start pose, 1 returns the target key pose.
+        */
+        void interpolateKeyPose(float factor);
+
         uint32_t getAnimationCount() const { return uint32_t(mAnimations.size()); }
         const std::string& getAnimationName(uint32_t ID) const;
         void setActiveAnimation(uint32_t id);
         uint32_t getActiveAnimation() const {return mActiveAnimation;}
 
         const glm::mat4* getBoneMatrices() const { return mBoneTransforms.data(); }
-        uint32_t getBoneCount() const { return uint32_t(mBones.size()); }
+        uint32_t getBoneCount() const { return uint32_t(mParentIDs.size()); }
 
         uint32_t getBoneIdFromName(const std::string& name) const;
         void setBoneLocalTransform(uint32_t boneID, const glm::mat4& transform);
 
     private:
+        friend class Animation;
         AnimationController(const std::vector<Bone>& bones);
+        void evaluate(double currentTime);
 
-        std::vector<Bone> mBones;
+        // Bone data is stored as SoA, in topological order
+        std::vector<uint32_t> mParentIDs;
+        std::vector<std::string> mBoneNames;
+        std::vector<glm::mat4> mOffsets;
+        std::vector<glm::mat4> mLocalTransforms;
+        std::vector<glm::mat4> mOriginalLocalTransforms;
+        std::vector<glm::mat4> mGlobalTransforms;
         std::vector<glm::mat4> mBoneTransforms;
+        std::vector<glm::mat4> mKeyPoseStart;   ///< The bone matrices when the last key pose was evaluated
+        std::vector<glm::mat4> mKeyPoseEnd;     ///< The last evaluated key pose
         std::vector<Animation::UniquePtr> mAnimations;
 
         uint32_t mActiveAnimation = BIND_POSE_ANIMATION_ID;
-
-        void calculateBoneTransforms();
+        Animation::PlaybackState::UniquePtr mpPlaybackState;    ///< Playback state of the active animation
     };
 }
\ No newline at end of file
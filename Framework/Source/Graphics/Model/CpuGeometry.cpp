@@ -0,0 +1,205 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "CpuGeometry.h"
+#include "Core/VertexLayout.h"
+#include "Data/VertexAttrib.h"
+#include "glm/common.hpp"
+#include <emmintrin.h>
+
+namespace Falcor
+{
+    struct StreamElement
+    {
+        const uint8_t* pData = nullptr;     // First vertex, including the element offset
+        uint32_t stride = 0;
+        ResourceFormat format = ResourceFormat::Unknown;
+    };
+
+    static StreamElement findElement(const Vao::VertexBufferDescVector& vbDescs, const std::vector<const uint8_t*>& vertexData, uint32_t shaderLocation)
+    {
+        StreamElement element;
+        for(size_t i = 0; i < vbDescs.size(); i++)
+        {
+            const VertexLayout* pLayout = vbDescs[i].pLayout.get();
+            for(uint32_t e = 0; e < pLayout->getElementCount(); e++)
+            {
+                if(pLayout->getElementShaderLocation(e) == shaderLocation)
+                {
+                    element.pData = vertexData[i] + pLayout->getElementOffset(e);
+                    element.stride = vbDescs[i].stride ? vbDescs[i].stride : pLayout->getTotalStride();
+                    element.format = pLayout->getElementFormat(e);
+                    return element;
+                }
+            }
+        }
+        return element;
+    }
+
+    static bool decodePositions(const StreamElement& element, uint32_t vertexCount, const VertexQuantization& quantization, std::vector<glm::vec3>& positions)
+    {
+        positions.resize(vertexCount);
+        if(element.format == ResourceFormat::RGB32Float || element.format == ResourceFormat::RGBA32Float)
+        {
+            for(uint32_t i = 0; i < vertexCount; i++)
+            {
+                positions[i] = *(const glm::vec3*)(element.pData + size_t(i) * element.stride);
+            }
+        }
+        else if(element.format == kQuantizedPositionFormat)
+        {
+            for(uint32_t i = 0; i < vertexCount; i++)
+            {
+                const uint16_t* pSrc = (const uint16_t*)(element.pData + size_t(i) * element.stride);
+                positions[i] = glm::vec3(pSrc[0], pSrc[1], pSrc[2]) * quantization.positionScale + quantization.positionOffset;
+            }
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+
+    static bool decodeDirections(const StreamElement& element, uint32_t vertexCount, std::vector<glm::vec3>& directions)
+    {
+        directions.resize(vertexCount);
+        if(element.format == ResourceFormat::RGB32Float || element.format == ResourceFormat::RGBA32Float)
+        {
+            for(uint32_t i = 0; i < vertexCount; i++)
+            {
+                directions[i] = *(const glm::vec3*)(element.pData + size_t(i) * element.stride);
+            }
+        }
+        else if(element.format == kQuantizedDirectionFormat)
+        {
+            for(uint32_t i = 0; i < vertexCount; i++)
+            {
+                const int16_t* pSrc = (const int16_t*)(element.pData + size_t(i) * element.stride);
+                glm::vec2 oct = glm::max(glm::vec2(pSrc[0], pSrc[1]) / 32767.0f, glm::vec2(-1.0f));
+                directions[i] = decodeOctahedral(oct);
+            }
+        }
+        else
+        {
+            directions.clear();
+            return false;
+        }
+        return true;
+    }
+
+    CpuVertexData::SharedPtr createCpuVertexData(const Vao::VertexBufferDescVector& vbDescs, const std::vector<const uint8_t*>& vertexData, uint32_t vertexCount, const VertexQuantization& quantization)
+    {
+        assert(vbDescs.size() == vertexData.size());
+        CpuVertexData::SharedPtr pData = std::make_shared<CpuVertexData>();
+
+        StreamElement position = findElement(vbDescs, vertexData, VERTEX_POSITION_LOC);
+        if(position.pData == nullptr || decodePositions(position, vertexCount, quantization, pData->positions) == false)
+        {
+            Logger::log(Logger::Level::Warning, "Can't keep a CPU copy of a mesh without float or quantized positions");
+            return nullptr;
+        }
+
+        StreamElement normal = findElement(vbDescs, vertexData, VERTEX_NORMAL_LOC);
+        if(normal.pData && decodeDirections(normal, vertexCount, pData->normals) == false)
+        {
+            Logger::log(Logger::Level::Warning, "Unsupported normal format, the CPU copy of the mesh won't have normals");
+        }
+        return pData;
+    }
+
+    void transformVectors(glm::vec3* pVectors, uint32_t count, const glm::mat4& matrix, bool isPoint, glm::vec3& boundsMin, glm::vec3& boundsMax)
+    {
+        boundsMin = glm::vec3(std::numeric_limits<float>::max());
+        boundsMax = glm::vec3(-std::numeric_limits<float>::max());
+        if(count == 0)
+        {
+            return;
+        }
+
+        // Broadcast the matrix, so that 4 vectors are transformed as a structure-of-arrays
+        __m128 m[4][3];
+        for(uint32_t col = 0; col < 4; col++)
+        {
+            for(uint32_t row = 0; row < 3; row++)
+            {
+                m[col][row] = _mm_set1_ps((col < 3 || isPoint) ? matrix[col][row] : 0.0f);
+            }
+        }
+        __m128 minX = _mm_set1_ps(boundsMin.x), minY = minX, minZ = minX;
+        __m128 maxX = _mm_set1_ps(boundsMax.x), maxY = maxX, maxZ = maxX;
+
+        float* pData = (float*)pVectors;
+        for(uint32_t first = 0; first < count; first += 4)
+        {
+            // The last batch repeats its last vector in the unused lanes. This doesn't change the bounds.
+            float v[3][4];
+            for(uint32_t lane = 0; lane < 4; lane++)
+            {
+                const float* pSrc = pData + size_t(std::min(first + lane, count - 1)) * 3;
+                v[0][lane] = pSrc[0];
+                v[1][lane] = pSrc[1];
+                v[2][lane] = pSrc[2];
+            }
+            __m128 x = _mm_loadu_ps(v[0]);
+            __m128 y = _mm_loadu_ps(v[1]);
+            __m128 z = _mm_loadu_ps(v[2]);
+
+            __m128 r[3];
+            for(uint32_t row = 0; row < 3; row++)
+            {
+                r[row] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0][row], x), _mm_mul_ps(m[1][row], y)), _mm_add_ps(_mm_mul_ps(m[2][row], z), m[3][row]));
+                _mm_storeu_ps(v[row], r[row]);
+            }
+            minX = _mm_min_ps(minX, r[0]);
+            minY = _mm_min_ps(minY, r[1]);
+            minZ = _mm_min_ps(minZ, r[2]);
+            maxX = _mm_max_ps(maxX, r[0]);
+            maxY = _mm_max_ps(maxY, r[1]);
+            maxZ = _mm_max_ps(maxZ, r[2]);
+
+            for(uint32_t lane = 0; lane < 4 && first + lane < count; lane++)
+            {
+                float* pDst = pData + size_t(first + lane) * 3;
+                pDst[0] = v[0][lane];
+                pDst[1] = v[1][lane];
+                pDst[2] = v[2][lane];
+            }
+        }
+
+        float lanes[4];
+        __m128 bounds[2][3] = { { minX, minY, minZ }, { maxX, maxY, maxZ } };
+        for(uint32_t c = 0; c < 3; c++)
+        {
+            _mm_storeu_ps(lanes, bounds[0][c]);
+            boundsMin[c] = std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3]));
+            _mm_storeu_ps(lanes, bounds[1][c]);
+            boundsMax[c] = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+        }
+    }
+}
@@ -0,0 +1,68 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <memory>
+#include <vector>
+#include "glm/vec3.hpp"
+#include "glm/mat4x4.hpp"
+#include "Core/VAO.h"
+#include "Graphics/Model/VertexQuantization.h"
+
+namespace Falcor
+{
+    /** System memory copy of a mesh's vertices, kept when a model is loaded with Model::KeepCpuGeometry.\n
+        Positions and normals are always stored as object-space floats, even when the vertex buffers are quantized. Meshes which share their vertices share the copy.
+    */
+    struct CpuVertexData
+    {
+        using SharedPtr = std::shared_ptr<CpuVertexData>;
+
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec3> normals;     ///< Empty if the mesh doesn't have normals
+    };
+
+    /** Decode the positions and normals of a set of vertex streams.\n
+        Supports 32-bit float streams, and streams quantized with quantizePositions() and quantizeDirections().
+        \param[in] vbDescs The layouts of the streams. The first element of each stream is used.
+        \param[in] vertexData The first vertex of each stream, one pointer per vertex buffer descriptor
+        \param[in] vertexCount Number of vertices
+        \param[in] quantization How the quantized streams are decoded
+        \return The decoded vertices, or nullptr if there is no position stream or if it uses an unsupported format
+    */
+    CpuVertexData::SharedPtr createCpuVertexData(const Vao::VertexBufferDescVector& vbDescs, const std::vector<const uint8_t*>& vertexData, uint32_t vertexCount, const VertexQuantization& quantization);
+
+    /** Transform an array of vectors in place, 4 vectors at a time with SSE
+        \param[in, out] pVectors The vectors
+        \param[in] count Number of vectors
+        \param[in] matrix The transform. Only the upper 3x4 part is used.
+        \param[in] isPoint Whether to apply the translation
+        \param[out] boundsMin Receives the minimum of the transformed vectors
+        \param[out] boundsMax Receives the maximum of the transformed vectors
+    */
+    void transformVectors(glm::vec3* pVectors, uint32_t count, const glm::mat4& matrix, bool isPoint, glm::vec3& boundsMin, glm::vec3& boundsMax);
+}
@@ -0,0 +1,167 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "GeometryPacker.h"
+
+namespace Falcor
+{
+    void packIndices(const uint32_t* pIndices, uint32_t indexCount, ResourceFormat format, std::vector<uint8_t>& dst)
+    {
+        size_t offset = dst.size();
+        if(format == ResourceFormat::R16Uint)
+        {
+            dst.resize(offset + indexCount * sizeof(uint16_t));
+            uint16_t* pDst = (uint16_t*)(dst.data() + offset);
+            for(uint32_t i = 0; i < indexCount; i++)
+            {
+                assert(pIndices[i] <= 0xFFFF);
+                pDst[i] = (uint16_t)pIndices[i];
+            }
+        }
+        else
+        {
+            assert(format == ResourceFormat::R32Uint);
+            dst.resize(offset + indexCount * sizeof(uint32_t));
+            memcpy(dst.data() + offset, pIndices, indexCount * sizeof(uint32_t));
+        }
+    }
+
+    Buffer::SharedPtr createIndexBuffer(const uint32_t* pIndices, uint32_t indexCount, ResourceFormat format, Buffer::AccessFlags accessFlags)
+    {
+        if(format == ResourceFormat::R32Uint)
+        {
+            return Buffer::create(indexCount * sizeof(uint32_t), Buffer::BindFlags::Index, accessFlags, pIndices);
+        }
+
+        std::vector<uint8_t> data;
+        packIndices(pIndices, indexCount, format, data);
+        return Buffer::create(data.size(), Buffer::BindFlags::Index, accessFlags, data.data());
+    }
+
+    static std::string getLayoutKey(const Vao::VertexBufferDescVector& vbDescs, ResourceFormat indexFormat)
+    {
+        std::string key = std::to_string((uint32_t)indexFormat);
+        for(const auto& vbDesc : vbDescs)
+        {
+            const VertexLayout* pLayout = vbDesc.pLayout.get();
+            key += "|" + std::to_string(pLayout->getTotalStride());
+            for(uint32_t i = 0; i < pLayout->getElementCount(); i++)
+            {
+                key += "," + pLayout->getElementName(i) + ":" + std::to_string(pLayout->getElementOffset(i)) + ":" + std::to_string((uint32_t)pLayout->getElementFormat(i)) +
+                    ":" + std::to_string(pLayout->getElementArraySize(i)) + ":" + std::to_string(pLayout->getElementShaderLocation(i));
+            }
+        }
+        return key;
+    }
+
+    uint32_t GeometryPacker::addVertices(const Vao::VertexBufferDescVector& vbDescs, const std::vector<const uint8_t*>& vertexData, uint32_t vertexCount)
+    {
+        assert(vbDescs.size() == vertexData.size());
+        ResourceFormat indexFormat = getIndexFormat(vertexCount);
+        std::string key = getLayoutKey(vbDescs, indexFormat);
+
+        auto groupIt = mGroupIDs.find(key);
+        if(groupIt == mGroupIDs.end())
+        {
+            Group group;
+            group.indexFormat = indexFormat;
+            group.vertexData.resize(vbDescs.size());
+            for(const auto& vbDesc : vbDescs)
+            {
+                Vao::VertexBufferDesc desc;
+                desc.pLayout = vbDesc.pLayout;
+                desc.stride = vbDesc.pLayout->getTotalStride();
+                group.vbDescs.push_back(desc);
+            }
+            groupIt = mGroupIDs.insert(std::make_pair(key, (uint32_t)mGroups.size())).first;
+            mGroups.push_back(std::move(group));
+        }
+
+        Group& group = mGroups[groupIt->second];
+        for(size_t i = 0; i < vbDescs.size(); i++)
+        {
+            size_t size = size_t(group.vbDescs[i].stride) * vertexCount;
+            group.vertexData[i].insert(group.vertexData[i].end(), vertexData[i], vertexData[i] + size);
+        }
+
+        VertexSet set;
+        set.groupID = groupIt->second;
+        set.baseVertex = (int32_t)group.vertexCount;
+        group.vertexCount += vertexCount;
+        mVertexSets.push_back(set);
+        return (uint32_t)mVertexSets.size() - 1;
+    }
+
+    uint32_t GeometryPacker::addIndices(uint32_t verticesID, const uint32_t* pIndices, uint32_t indexCount)
+    {
+        const VertexSet& set = mVertexSets[verticesID];
+        Group& group = mGroups[set.groupID];
+
+        Range range;
+        range.groupID = set.groupID;
+        range.range.firstIndex = group.indexCount;
+        range.range.indexCount = indexCount;
+        range.range.baseVertex = set.baseVertex;
+        packIndices(pIndices, indexCount, group.indexFormat, group.indexData);
+        group.indexCount += indexCount;
+
+        mRanges.push_back(range);
+        return (uint32_t)mRanges.size() - 1;
+    }
+
+    std::vector<Buffer::SharedPtr> GeometryPacker::createBuffers()
+    {
+        std::vector<Buffer::SharedPtr> buffers;
+        for(Group& group : mGroups)
+        {
+            for(size_t i = 0; i < group.vbDescs.size(); i++)
+            {
+                group.vbDescs[i].pBuffer = Buffer::create(group.vertexData[i].size(), Buffer::BindFlags::Vertex, Buffer::AccessFlags::None, group.vertexData[i].data());
+                buffers.push_back(group.vbDescs[i].pBuffer);
+            }
+
+            Buffer::SharedPtr pIB = nullptr;
+            if(group.indexCount > 0)
+            {
+                pIB = Buffer::create(group.indexData.size(), Buffer::BindFlags::Index, Buffer::AccessFlags::None, group.indexData.data());
+                buffers.push_back(pIB);
+            }
+            group.pVao = Vao::create(group.vbDescs, pIB, group.indexFormat);
+
+            // The data was uploaded, release the system memory copy
+            group.vertexData = std::vector<std::vector<uint8_t>>();
+            group.indexData = std::vector<uint8_t>();
+        }
+
+        for(Range& range : mRanges)
+        {
+            range.range.pVao = mGroups[range.groupID].pVao;
+        }
+        return buffers;
+    }
+}
@@ -0,0 +1,125 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <map>
+#include <string>
+#include <vector>
+#include "Core/VAO.h"
+
+namespace Falcor
+{
+    /** Get the smallest index format which can address a mesh's vertices
+        \param[in] vertexCount Number of vertices the indices refer to
+        \return ResourceFormat::R16Uint or ResourceFormat::R32Uint
+    */
+    inline ResourceFormat getIndexFormat(uint32_t vertexCount)
+    {
+        return (vertexCount <= 0xFFFF) ? ResourceFormat::R16Uint : ResourceFormat::R32Uint;
+    }
+
+    /** Append indices to a byte array, narrowing them to the given format
+    */
+    void packIndices(const uint32_t* pIndices, uint32_t indexCount, ResourceFormat format, std::vector<uint8_t>& dst);
+
+    /** Create an index buffer, narrowing the indices to the given format
+    */
+    Buffer::SharedPtr createIndexBuffer(const uint32_t* pIndices, uint32_t indexCount, ResourceFormat format, Buffer::AccessFlags accessFlags = Buffer::AccessFlags::None);
+
+    /** Packs the vertices and indices of many meshes into a shared set of buffers per vertex layout.\n
+        Meshes with the same vertex layout and index format end up in the same vertex and index buffers, and share a VAO. Each mesh draws a range of the shared buffers, using its first index and base vertex.
+        Indices stay relative to their mesh's first vertex, so meshes with less than 64K vertices keep 16-bit indices no matter how large the shared buffer is.\n
+        Usage: add the vertices and indices of all the meshes, call createBuffers(), then create the meshes using getMeshRange().
+    */
+    class GeometryPacker
+    {
+    public:
+        /** The location of a mesh inside the shared buffers
+        */
+        struct MeshRange
+        {
+            Vao::SharedPtr pVao;        ///< The shared VAO. Valid after createBuffers() was called.
+            uint32_t firstIndex = 0;
+            uint32_t indexCount = 0;
+            int32_t baseVertex = 0;
+        };
+
+        /** Add the vertices of a mesh
+            \param[in] vbDescs The vertex buffer descriptors of the mesh. Only the layouts are used.
+            \param[in] vertexData The vertices, one pointer per vertex buffer descriptor
+            \param[in] vertexCount Number of vertices
+            \return An ID to pass to addIndices()
+        */
+        uint32_t addVertices(const Vao::VertexBufferDescVector& vbDescs, const std::vector<const uint8_t*>& vertexData, uint32_t vertexCount);
+
+        /** Add the indices of a mesh. A set of vertices can be used by multiple meshes.
+            \param[in] verticesID The ID returned by addVertices()
+            \param[in] pIndices The indices, relative to the first vertex of the set
+            \param[in] indexCount Number of indices
+            \return An ID to pass to getMeshRange()
+        */
+        uint32_t addIndices(uint32_t verticesID, const uint32_t* pIndices, uint32_t indexCount);
+
+        /** Create the shared buffers and VAOs and release the system memory copies of the data. Must be called after all the meshes were added.
+            \return The buffers which were created
+        */
+        std::vector<Buffer::SharedPtr> createBuffers();
+
+        /** Get the location of a mesh inside the shared buffers
+        */
+        const MeshRange& getMeshRange(uint32_t rangeID) const { return mRanges[rangeID].range; }
+
+    private:
+        struct Group
+        {
+            Vao::VertexBufferDescVector vbDescs;
+            std::vector<std::vector<uint8_t>> vertexData;
+            std::vector<uint8_t> indexData;
+            ResourceFormat indexFormat;
+            uint32_t vertexCount = 0;
+            uint32_t indexCount = 0;
+            Vao::SharedPtr pVao;
+        };
+
+        struct VertexSet
+        {
+            uint32_t groupID;
+            int32_t baseVertex;
+        };
+
+        struct Range
+        {
+            uint32_t groupID;
+            MeshRange range;
+        };
+
+        std::vector<Group> mGroups;
+        std::map<std::string, uint32_t> mGroupIDs;  // Keyed by the vertex layout and the index format
+        std::vector<VertexSet> mVertexSets;
+        std::vector<Range> mRanges;
+    };
+}
@@ -29,6 +29,8 @@
 #include "AssimpModelImporter.h"
 #include "../Model.h"
 #include "Importer.hpp"
+#include "IOSystem.hpp"
+#include "IOStream.hpp"
 #include "postprocess.h"
 #include "scene.h"
 #include "../Animation.h"
@@ -41,23 +43,17 @@
 #include "glm/matrix.hpp"
 #include "Utils/OS.h"
 #include "Graphics/TextureHelper.h"
+#include "Graphics/TextureCache.h"
 #include "Core/VertexLayout.h"
 #include "Data/VertexAttrib.h"
 #include "Utils/StringUtils.h"
+#include "Utils/ThreadPool.h"
+#include "Utils/AsyncLoader.h"
+#include "../TangentSpaceGenerator.h"
+#include <set>
 
 namespace Falcor
 {
-    template<typename posType>
-    void generateSubmeshTangentData(
-        const std::vector<uint32_t>& indices,
-        const posType* vertexPosData,
-        const glm::vec3* vertexNormalData,
-        const glm::vec2* texCrdData,
-        uint32_t texCrdCount,
-        glm::vec3* tangentData,
-        glm::vec3* bitangentData);
-
-
     std::vector<uint32_t> createIndexBufferData(const aiMesh* pAiMesh)
     {
         uint32_t indexCount = pAiMesh->mNumFaces * pAiMesh->mFaces[0].mNumIndices;
@@ -77,21 +73,30 @@ namespace Falcor
         return indices;
     }
 
-    void genTangentSpace(const aiMesh* pAiMesh)
+    void genTangentSpace(const aiMesh* pAiMesh, const std::vector<uint32_t>& indices, ThreadPool* pPool)
     {
-        if(pAiMesh->mFaces[0].mNumIndices == 3)
+        if(pAiMesh->mFaces[0].mNumIndices == 3 && pAiMesh->HasNormals())
         {
             aiMesh* pMesh = const_cast<aiMesh*>(pAiMesh);
             pMesh->mTangents = new aiVector3D[pMesh->mNumVertices];
             pMesh->mBitangents = new aiVector3D[pMesh->mNumVertices];
 
-            const glm::vec3* pPos = (glm::vec3*)pMesh->mVertices;
-            glm::vec3* pTan = (glm::vec3*)pMesh->mTangents;
-            glm::vec3* pBi = (glm::vec3*)pMesh->mBitangents;
-            glm::vec3* pNormals = (glm::vec3*)pMesh->mNormals;
-            std::vector<uint32_t> indices = createIndexBufferData(pAiMesh);
-
-            generateSubmeshTangentData<glm::vec3>(indices, pPos, pNormals, nullptr, 0, pTan, pBi);
+            TangentSpaceDesc desc;
+            desc.pIndices = indices.data();
+            desc.indexCount = (uint32_t)indices.size();
+            desc.vertexCount = pMesh->mNumVertices;
+            desc.pPositions = (const uint8_t*)pMesh->mVertices;
+            desc.positionStride = sizeof(aiVector3D);
+            desc.pNormals = (const uint8_t*)pMesh->mNormals;
+            desc.normalStride = sizeof(aiVector3D);
+            if(pMesh->HasTextureCoords(0))
+            {
+                desc.pTexCoords = (const uint8_t*)pMesh->mTextureCoords[0];
+                desc.texCoordStride = sizeof(aiVector3D);
+            }
+            desc.pTangents = (glm::vec3*)pMesh->mTangents;
+            desc.pBitangents = (glm::vec3*)pMesh->mBitangents;
+            generateSmoothTangentSpace(desc, pPool);
         }
     }
 
@@ -217,7 +222,9 @@ namespace Falcor
                 {
                     // create a new texture
                     std::string fullpath = folder + '\\' + s;
-                    pTex = createTextureFromFile(fullpath, true, isSrgbRequired(aiType, useSrgb));
+                    bool isSrgb = isSrgbRequired(aiType, useSrgb);
+                    AsyncLoader::addItems(1);
+                    AsyncLoader::upload([&]() {pTex = shareTextures() ? createSharedTextureFromFile(fullpath, true, isSrgb) : createTextureFromFile(fullpath, true, isSrgb); });
                     if(pTex)
                     {
                         mpModel->addTexture(pTex);
@@ -336,8 +343,111 @@ namespace Falcor
         mpModel = Model::SharedPtr(new Model);
     }
 
+    void AssimpModelImporter::loadAllTextures(const aiScene* pScene, const std::string& folder, bool useSrgb)
+    {
+        struct TextureRequest
+        {
+            std::string name;
+            std::string fullpath;
+            bool isSrgb;
+            std::shared_ptr<TextureFileData> pData;
+            TextureCache::FileKey cacheKey;
+            bool hasCacheKey;
+            Texture::SharedPtr pTexture;        // Found in the texture cache
+        };
+
+        // Collect the textures referenced by the materials, in the same order loadTextures() would have encountered them
+        std::vector<TextureRequest> requests;
+        std::set<std::string> names;
+        for(uint32_t m = 0; m < pScene->mNumMaterials; m++)
+        {
+            const aiMaterial* pAiMaterial = pScene->mMaterials[m];
+            for(int i = 0; i < AI_TEXTURE_TYPE_MAX; ++i)
+            {
+                aiTextureType aiType = (aiTextureType)i;
+                uint32_t textureCount = pAiMaterial->GetTextureCount(aiType);
+                if(textureCount > 1)
+                {
+                    // loadTextures() will report the error and skip the rest of the material
+                    break;
+                }
+                else if(textureCount == 1)
+                {
+                    aiString path;
+                    pAiMaterial->GetTexture(aiType, 0, &path);
+                    std::string s(path.data);
+                    if(s.empty() == false && names.insert(s).second)
+                    {
+                        requests.push_back({s, folder + '\\' + s, isSrgbRequired(aiType, useSrgb), nullptr});
+                    }
+                }
+            }
+        }
+
+        // Decode the files in parallel, unless the textures were already created by another model
+        const bool useCache = shareTextures();
+        auto decodeTask = [&requests, useCache](uint32_t taskID)
+        {
+            TextureRequest& request = requests[taskID];
+            if(useCache)
+            {
+                request.hasCacheKey = TextureCache::createFileKey(request.fullpath, true, request.isSrgb, request.cacheKey);
+                request.pTexture = request.hasCacheKey ? TextureCache::findFile(request.cacheKey) : nullptr;
+            }
+
+            if(request.pTexture == nullptr)
+            {
+                request.pData = loadTextureDataFromFile(request.fullpath, true, request.isSrgb);
+
+                // An identical file may have been loaded from another directory
+                if(request.hasCacheKey && request.pData)
+                {
+                    request.pTexture = TextureCache::findFileContent(request.cacheKey, getTextureCacheDesc(request.pData));
+                    if(request.pTexture)
+                    {
+                        request.pData = nullptr;
+                    }
+                }
+            }
+        };
+        Model::getImportThreadPool()->run((uint32_t)requests.size(), decodeTask);
+
+        // Create the textures on the render thread. Textures which failed to decode are left out of the cache, and loadTextures() will try loading them again
+        AsyncLoader::addItems((uint32_t)requests.size());
+        for(auto& request : requests)
+        {
+            AsyncLoader::upload([this, &request]()
+            {
+                Texture::SharedPtr pTex = request.pTexture;
+                if(pTex == nullptr)
+                {
+                    pTex = createTextureFromData(request.pData);
+                    if(request.hasCacheKey)
+                    {
+                        TextureCache::addFile(request.cacheKey, pTex);
+                    }
+                }
+
+                if(pTex)
+                {
+                    mpModel->addTexture(pTex);
+                    mTextureCache[request.name] = pTex;
+                }
+            });
+            request.pData = nullptr;
+        }
+    }
+
+    bool AssimpModelImporter::shareTextures() const
+    {
+        // Compression replaces the textures' data in place, which would change them for the other models too
+        return (mFlags & Model::CompressTextures) == 0;
+    }
+
     bool AssimpModelImporter::createAllMaterials(const aiScene* pScene, const std::string& modelFolder, bool isObjFile, bool useSrgb)
     {
+        loadAllTextures(pScene, modelFolder, useSrgb);
+
         for(uint32_t i = 0; i < pScene->mNumMaterials; i++)
         {
             const aiMaterial* pAiMaterial = pScene->mMaterials[i];
@@ -379,7 +489,8 @@ namespace Falcor
                 if(aiToFalcorMesh.find(aiId) == aiToFalcorMesh.end())
                 {
                     // New mesh
-                    auto pNewMesh = createMesh(pScene->mMeshes[aiId]);
+                    Mesh::SharedPtr pNewMesh;
+                    AsyncLoader::upload([&]() {pNewMesh = createMesh(pScene->mMeshes[aiId], mMeshData[aiId]); });
                     aiToFalcorMesh[aiId] = pNewMesh;  // Set into the map before adding to the model. std::move() sets pNewMesh to nullptr
                     mpModel->addMesh(std::move(pNewMesh));
                 }
@@ -404,14 +515,114 @@ namespace Falcor
         return b;
     }
 
+    void markUsedMeshes(const aiNode* pNode, std::vector<bool>& isUsed)
+    {
+        for(uint32_t i = 0; i < pNode->mNumMeshes; i++)
+        {
+            isUsed[pNode->mMeshes[i]] = true;
+        }
+        for(uint32_t i = 0; i < pNode->mNumChildren; i++)
+        {
+            markUsedMeshes(pNode->mChildren[i], isUsed);
+        }
+    }
+
+    void AssimpModelImporter::decodeMeshes(const aiScene* pScene)
+    {
+        std::vector<bool> isUsed(pScene->mNumMeshes, false);
+        markUsedMeshes(pScene->mRootNode, isUsed);
+
+        std::vector<uint32_t> meshIDs;
+        for(uint32_t i = 0; i < pScene->mNumMeshes; i++)
+        {
+            if(isUsed[i])
+            {
+                meshIDs.push_back(i);
+            }
+        }
+
+        mMeshData.clear();
+        mMeshData.resize(pScene->mNumMeshes);
+
+        // Large meshes generate their tangents across the pool before the per-mesh tasks run, since the generator can't use the pool from inside a task
+        if(mFlags & Model::GenerateTangentSpace)
+        {
+            for(uint32_t aiId : meshIDs)
+            {
+                const aiMesh* pAiMesh = pScene->mMeshes[aiId];
+                if(pAiMesh->HasTangentsAndBitangents() == false && pAiMesh->mNumFaces > kTangentSpaceTaskSize)
+                {
+                    mMeshData[aiId].indices = createIndexBufferData(pAiMesh);
+                    genTangentSpace(pAiMesh, mMeshData[aiId].indices, Model::getImportThreadPool());
+                }
+            }
+        }
+
+        // Each task only touches its own aiMesh and MeshData, so the meshes can be decoded in any order
+        auto decodeTask = [this, pScene, &meshIDs](uint32_t taskID)
+        {
+            uint32_t aiId = meshIDs[taskID];
+            mMeshData[aiId].isValid = decodeMesh(pScene->mMeshes[aiId], mMeshData[aiId]);
+        };
+        Model::getImportThreadPool()->run((uint32_t)meshIDs.size(), decodeTask);
+        AsyncLoader::addItems((uint32_t)meshIDs.size());
+
+        if(mFlags & Model::OptimizeMeshes)
+        {
+            for(uint32_t aiId : meshIDs)
+            {
+                mpModel->mMeshOptimizationStats += mMeshData[aiId].optimizationStats;
+            }
+        }
+
+        for(uint32_t aiId : meshIDs)
+        {
+            mpModel->mVertexQuantizationStats += mMeshData[aiId].quantizationStats;
+        }
+    }
+
     bool AssimpModelImporter::createDrawList(const aiScene* pScene)
     {
         createAnimationController(pScene);
+        decodeMeshes(pScene);
+        if(mFlags & Model::PackGeometry)
+        {
+            packMeshes(pScene);
+        }
         std::map<uint32_t, Mesh::SharedPtr> aiToFalcorMesh;
         aiNode* pRoot = pScene->mRootNode;
-        return parseAiSceneNode(pRoot, pScene, aiToFalcorMesh);
+        bool result = parseAiSceneNode(pRoot, pScene, aiToFalcorMesh);
+        mMeshData.clear();
+        return result;
     }
 
+    /** Forwards Assimp's file accesses to another IO system, and records the files which were opened, like .obj material libraries
+    */
+    class RecordingIOSystem : public Assimp::IOSystem
+    {
+    public:
+        RecordingIOSystem(Assimp::IOSystem* pIOSystem, std::vector<std::string>& openedFiles) : mpIOSystem(pIOSystem), mOpenedFiles(openedFiles) {}
+
+        bool Exists(const char* pFile) const override { return mpIOSystem->Exists(pFile); }
+        char getOsSeparator() const override { return mpIOSystem->getOsSeparator(); }
+        bool ComparePaths(const char* one, const char* second) const override { return mpIOSystem->ComparePaths(one, second); }
+        void Close(Assimp::IOStream* pFile) override { mpIOSystem->Close(pFile); }
+
+        Assimp::IOStream* Open(const char* pFile, const char* pMode) override
+        {
+            Assimp::IOStream* pStream = mpIOSystem->Open(pFile, pMode);
+            if(pStream)
+            {
+                mOpenedFiles.push_back(canonicalizeFilename(pFile));
+            }
+            return pStream;
+        }
+
+    private:
+        Assimp::IOSystem* mpIOSystem;
+        std::vector<std::string>& mOpenedFiles;
+    };
+
     bool AssimpModelImporter::initModel(const std::string& filename)
     {
         std::string fullpath;
@@ -420,6 +631,7 @@ namespace Falcor
             Logger::log(Logger::Level::Error, std::string("Can't find model file ") + filename, true);
             return nullptr;
         }
+        uint64_t fileSize = AsyncLoader::addFile(fullpath);
 
         uint32_t AssimpFlags = aiProcessPreset_TargetRealtime_MaxQuality |
             aiProcess_OptimizeGraph |
@@ -431,6 +643,11 @@ namespace Falcor
         {
             AssimpFlags &= ~aiProcess_FindDegenerates;
         }
+        // We run our own optimization, which also handles overdraw
+        if(mFlags & Model::OptimizeMeshes)
+        {
+            AssimpFlags &= ~aiProcess_ImproveCacheLocality;
+        }
         // Avoid merging original meshes
         if((mFlags & Model::DontMergeMeshes) != 0)
         {
@@ -442,7 +659,21 @@ namespace Falcor
         }
 
         Assimp::Importer importer;
-        const aiScene* pScene = importer.ReadFile(fullpath, AssimpFlags);
+        const aiScene* pScene;
+        if(mpOpenedFiles)
+        {
+            // The importer deletes the IO system it replaces, so the file accesses are forwarded to the default IO system of a second importer.
+            // Ours is released before the importer is destroyed, otherwise it would be deleted too.
+            Assimp::Importer fileSystemOwner;
+            RecordingIOSystem recordingIO(fileSystemOwner.GetIOHandler(), *mpOpenedFiles);
+            importer.SetIOHandler(&recordingIO);
+            pScene = importer.ReadFile(fullpath, AssimpFlags);
+            importer.SetIOHandler(nullptr);
+        }
+        else
+        {
+            pScene = importer.ReadFile(fullpath, AssimpFlags);
+        }
 
         if((pScene == nullptr) || (verifyScene(pScene) == false))
         {
@@ -451,6 +682,7 @@ namespace Falcor
             Logger::log(Logger::Level::Error, str, true);
             return false;
         }
+        AsyncLoader::reportBytesLoaded(fileSize);
 
         // Extract the folder name
         auto last = fullpath.find_last_of("/\\");
@@ -474,9 +706,10 @@ namespace Falcor
         return true;
     }
 
-    Model::SharedPtr AssimpModelImporter::createFromFile(const std::string& filename, uint32_t flags)
+    Model::SharedPtr AssimpModelImporter::createFromFile(const std::string& filename, uint32_t flags, std::vector<std::string>* pOpenedFiles)
     {
         AssimpModelImporter loader(flags);
+        loader.mpOpenedFiles = pOpenedFiles;
 
         // Init the model
         if(loader.initModel(filename) == false)
@@ -637,33 +870,194 @@ namespace Falcor
             }
         }
 
+        if(mFlags & Model::CompressAnimations)
+        {
+            return Animation::createCompressed(std::string(pAiAnim->mName.C_Str()), animationSets, duration, ticksPerSecond, Animation::CompressionDesc());
+        }
         return Animation::create(std::string(pAiAnim->mName.C_Str()), animationSets, duration, ticksPerSecond);
     }
 
-    Mesh::SharedPtr AssimpModelImporter::createMesh(const aiMesh* pAiMesh)
+    bool AssimpModelImporter::decodeMesh(const aiMesh* pAiMesh, MeshData& data)
     {
         uint32_t vertexCount = pAiMesh->mNumVertices;
-        uint32_t indexCount = pAiMesh->mNumFaces * pAiMesh->mFaces[0].mNumIndices;
-        auto pIB = createIndexBuffer(pAiMesh);
-        BoundingBox boundingBox;
+        if(data.indices.empty())
+        {
+            data.indices = createIndexBufferData(pAiMesh);
+        }
 
         bool manualTangentGen = pAiMesh->HasTangentsAndBitangents() == false && (mFlags & Model::GenerateTangentSpace);
         if(manualTangentGen)
         {
-            genTangentSpace(pAiMesh);
+            genTangentSpace(pAiMesh, data.indices, nullptr);
+        }
+
+        bool result = createVertexLayouts(pAiMesh, data.vbDescs);
+        if(result)
+        {
+            data.vertexData.resize(data.vbDescs.size());
+            for(size_t i = 0; i < data.vbDescs.size(); i++)
+            {
+                initVertexData(pAiMesh, vertexCount, data.boundingBox, data.vbDescs[i].pLayout.get(), data.vertexData[i]);
+            }
+
+            if((mFlags & Model::OptimizeMeshes) && pAiMesh->mFaces[0].mNumIndices == 3)
+            {
+                optimizeMesh(data, vertexCount);
+            }
+
+            // Skinned meshes move away from their bind-pose bounds, so they are always drawn in full
+            if((mFlags & Model::GenerateMeshClusters) && pAiMesh->mFaces[0].mNumIndices == 3 && pAiMesh->HasBones() == false)
+            {
+                uint32_t positionStride;
+                const uint8_t* pPositions = findPositions(data, positionStride);
+                data.clusters = generateMeshClusters(data.indices.data(), (uint32_t)data.indices.size(), vertexCount, pPositions, positionStride);
+            }
+
+            if(mFlags & Model::KeepCpuGeometry)
+            {
+                std::vector<const uint8_t*> vertexData;
+                for(const auto& stream : data.vertexData)
+                {
+                    vertexData.push_back(stream.data());
+                }
+                data.pCpuVertices = createCpuVertexData(data.vbDescs, vertexData, vertexCount, data.quantization);
+            }
+
+            // After the optimization and the CPU copy, which need the float positions
+            if(mFlags & (Model::QuantizeVertices | Model::QuantizePositions))
+            {
+                quantizeMesh(data, vertexCount);
+            }
+        }
+
+        if(manualTangentGen)
+        {
+            aiMesh* pM = const_cast<aiMesh*>(pAiMesh);
+            safe_delete_array(pM->mTangents);
+            safe_delete_array(pM->mBitangents);
+        }
+
+        return result;
+    }
+
+    const uint8_t* AssimpModelImporter::findPositions(const MeshData& data, uint32_t& stride)
+    {
+        for(size_t i = 0; i < data.vbDescs.size(); i++)
+        {
+            const VertexLayout* pLayout = data.vbDescs[i].pLayout.get();
+            if(pLayout->getElementShaderLocation(0) == VERTEX_POSITION_LOC)
+            {
+                stride = pLayout->getTotalStride();
+                return data.vertexData[i].data();
+            }
+        }
+        stride = 0;
+        return nullptr;
+    }
+
+    void AssimpModelImporter::optimizeMesh(MeshData& data, uint32_t vertexCount)
+    {
+        uint32_t* pIndices = data.indices.data();
+        uint32_t indexCount = (uint32_t)data.indices.size();
+        data.optimizationStats.before = calcVertexCacheStats(pIndices, indexCount, vertexCount);
+
+        uint32_t positionStride;
+        const uint8_t* pPositions = findPositions(data, positionStride);
+        optimizeTriangleOrder(pIndices, indexCount, vertexCount, pPositions, positionStride);
+
+        std::vector<uint32_t> remap = calcVertexFetchRemap(pIndices, indexCount, vertexCount);
+        remapIndices(pIndices, indexCount, remap);
+        for(size_t i = 0; i < data.vbDescs.size(); i++)
+        {
+            remapVertices(data.vertexData[i].data(), data.vbDescs[i].pLayout->getTotalStride(), remap);
+        }
+        data.optimizationStats.after = calcVertexCacheStats(pIndices, indexCount, vertexCount);
+    }
+
+    void AssimpModelImporter::quantizeMesh(MeshData& data, uint32_t vertexCount)
+    {
+        bool quantizePositions = (mFlags & Model::QuantizePositions) != 0;
+        bool quantizeAttributes = (mFlags & Model::QuantizeVertices) != 0;
+        for(size_t i = 0; i < data.vbDescs.size(); i++)
+        {
+            quantizeVertexStream(data.vbDescs[i], data.vertexData[i], vertexCount, quantizePositions, quantizeAttributes, data.quantization, data.quantizationStats);
+        }
+    }
+
+    void AssimpModelImporter::packMeshes(const aiScene* pScene)
+    {
+        GeometryPacker packer;
+        std::vector<uint32_t> rangeIDs(mMeshData.size());
+        for(size_t aiId = 0; aiId < mMeshData.size(); aiId++)
+        {
+            MeshData& data = mMeshData[aiId];
+            if(data.isValid == false)
+            {
+                continue;
+            }
+
+            std::vector<const uint8_t*> vertexData;
+            for(const auto& stream : data.vertexData)
+            {
+                vertexData.push_back(stream.data());
+            }
+            uint32_t verticesID = packer.addVertices(data.vbDescs, vertexData, pScene->mMeshes[aiId]->mNumVertices);
+            rangeIDs[aiId] = packer.addIndices(verticesID, data.indices.data(), (uint32_t)data.indices.size());
+
+            // The packer keeps a copy, release ours. The indices of meshes which keep a CPU copy are released by createMesh().
+            if(data.pCpuVertices == nullptr)
+            {
+                data.indices = std::vector<uint32_t>();
+            }
+            data.vertexData = std::vector<std::vector<uint8_t>>();
+        }
+
+        AsyncLoader::addItems(1);
+        AsyncLoader::upload([&]()
+        {
+            for(const auto& pBuffer : packer.createBuffers())
+            {
+                mpModel->addBuffer(pBuffer);
+            }
+        });
+
+        for(size_t aiId = 0; aiId < mMeshData.size(); aiId++)
+        {
+            if(mMeshData[aiId].isValid)
+            {
+                mMeshData[aiId].packedRange = packer.getMeshRange(rangeIDs[aiId]);
+            }
         }
+    }
 
-        Vao::VertexBufferDescVector vbDescVec;
-        if(false == createVertexLayouts(pAiMesh, vbDescVec))
+    Mesh::SharedPtr AssimpModelImporter::createMesh(const aiMesh* pAiMesh, MeshData& data)
+    {
+        if(data.isValid == false)
         {
             return nullptr;
         }
 
-        // Create corresponding vertex buffers
-        for(auto& vbDesc : vbDescVec)
+        uint32_t vertexCount = pAiMesh->mNumVertices;
+        const GeometryPacker::MeshRange& packedRange = data.packedRange;
+        Vao::SharedPtr pVao = packedRange.pVao;
+        uint32_t indexCount = packedRange.indexCount;
+        if(pVao == nullptr)
         {
-            vbDesc.pBuffer = createVertexBuffer(pAiMesh, vertexCount, boundingBox, vbDesc.pLayout.get());
-            vbDesc.stride = vbDesc.pLayout->getTotalStride();
+            indexCount = (uint32_t)data.indices.size();
+            ResourceFormat indexFormat = getIndexFormat(vertexCount);
+            auto pIB = createIndexBuffer(data.indices.data(), indexCount, indexFormat);
+            mpModel->addBuffer(pIB);
+
+            // Create corresponding vertex buffers
+            Vao::VertexBufferDescVector& vbDescVec = data.vbDescs;
+            for(size_t i = 0; i < vbDescVec.size(); i++)
+            {
+                auto& vbDesc = vbDescVec[i];
+                vbDesc.stride = vbDesc.pLayout->getTotalStride();
+                vbDesc.pBuffer = Buffer::create(vbDesc.stride * vertexCount, Buffer::BindFlags::Vertex, Buffer::AccessFlags::None, data.vertexData[i].data());
+                mpModel->addBuffer(vbDesc.pBuffer);
+            }
+            pVao = Vao::create(vbDescVec, pIB, indexFormat);
         }
 
         RenderContext::Topology topology;
@@ -686,27 +1080,20 @@ namespace Falcor
         auto pMaterial = mAiMaterialToFalcor[pAiMesh->mMaterialIndex];
         assert(pMaterial);
 
-        Mesh::SharedPtr pMesh = Mesh::create(vbDescVec, vertexCount, pIB, indexCount, topology, pMaterial, boundingBox, pAiMesh->HasBones());
-
-        if(manualTangentGen)
+        Mesh::SharedPtr pMesh = Mesh::create(pVao, vertexCount, indexCount, packedRange.firstIndex, packedRange.baseVertex, topology, pMaterial, data.boundingBox, pAiMesh->HasBones());
+        pMesh->setVertexQuantization(data.quantization);
+        pMesh->setClusters(std::move(data.clusters));
+        if(data.pCpuVertices)
         {
-           aiMesh* pM = const_cast<aiMesh*>(pAiMesh);
-            safe_delete_array(pM->mTangents);
-            safe_delete_array(pM->mBitangents);
+            pMesh->setCpuGeometry(data.pCpuVertices, std::move(data.indices));
         }
 
+        // The data was uploaded, release the system memory copy
+        data.indices = std::vector<uint32_t>();
+        data.vertexData = std::vector<std::vector<uint8_t>>();
         return pMesh;
     }
 
-    Buffer::SharedPtr AssimpModelImporter::createIndexBuffer(const aiMesh* pAiMesh)
-    {
-        std::vector<uint32_t> indices = createIndexBufferData(pAiMesh);
-        auto pBuffer = Buffer::create(uint32_t(sizeof(uint32_t)*indices.size()), Buffer::BindFlags::Index, Buffer::AccessFlags::None, indices.data());
-        mpModel->addBuffer(pBuffer);
-        return pBuffer;
-    }
-
-
 	bool isElementUsed(const aiMesh* pAiMesh, uint32_t location)
 	{
         switch(location)
@@ -771,17 +1158,16 @@ namespace Falcor
         return true;
     }
 
-    Buffer::SharedPtr AssimpModelImporter::createVertexBuffer(const aiMesh* pAiMesh, uint32_t vertexCount, BoundingBox& boundingBox, const VertexLayout* pLayout)
+    void AssimpModelImporter::initVertexData(const aiMesh* pAiMesh, uint32_t vertexCount, BoundingBox& boundingBox, const VertexLayout* pLayout, std::vector<uint8_t>& initData)
     {
         const uint32_t vertexStride = pLayout->getTotalStride();
-        auto initData = std::unique_ptr<uint8_t[]>(new uint8_t[vertexStride * vertexCount]);
-        memset(initData.get(), 0, vertexStride * vertexCount);
+        initData.assign(vertexStride * vertexCount, 0);
 
         glm::vec3 boxMin, boxMax;
 
         for(uint32_t vertexID = 0; vertexID < vertexCount; vertexID++)
         {
-            uint8_t* pVertex = initData.get() + (vertexStride * vertexID);
+            uint8_t* pVertex = initData.data() + (vertexStride * vertexID);
 
             for(uint32_t elementID = 0; elementID < pLayout->getElementCount(); elementID++)
             {
@@ -837,12 +1223,8 @@ namespace Falcor
 
         if(pAiMesh->HasBones())
         {
-            loadBones(pAiMesh, initData.get(), vertexCount, vertexStride);
+            loadBones(pAiMesh, initData.data(), vertexCount, vertexStride);
         }
-
-        auto pBuffer = Buffer::create(vertexStride * vertexCount, Buffer::BindFlags::Vertex, Buffer::AccessFlags::None, initData.get());
-        mpModel->addBuffer(pBuffer);
-        return pBuffer;
     }
 
     void AssimpModelImporter::loadBones(const aiMesh* pAiMesh, uint8_t* pVertexData, uint32_t vertexCount, uint32_t vertexStride)
@@ -31,6 +31,7 @@
 #include "../AnimationController.h"
 #include "../Mesh.h"
 #include "../Model.h"
+#include "../GeometryPacker.h"
 
 struct aiScene;
 struct aiNode;
@@ -51,9 +52,10 @@ namespace Falcor
         /** create a new model using ASSIMP
             \param[in] filename Model's filename. Loader will look for it in the data directories.
             \param[in] flags Flags controlling model creation
+            \param[out] pOpenedFiles Optional. Receives the canonical path of every file Assimp opened, the model file and the files it references, like .mtl material libraries. Textures are loaded by Falcor and aren't included.
             returns nullptr if loading failed, otherwise a new Model object
         */
-        static Model::SharedPtr createFromFile(const std::string& filename, uint32_t flags);
+        static Model::SharedPtr createFromFile(const std::string& filename, uint32_t flags, std::vector<std::string>* pOpenedFiles = nullptr);
 
     private:
         AssimpModelImporter(uint32_t flags);
@@ -72,11 +74,35 @@ namespace Falcor
 
         Animation::UniquePtr createAnimation(const aiAnimation* pAiAnim);
 
-        Mesh::SharedPtr createMesh(const aiMesh* pAiMesh);
+        /** System memory data of a mesh, produced by the decode phase and consumed by createMesh()
+        */
+        struct MeshData
+        {
+            std::vector<uint32_t> indices;
+            Vao::VertexBufferDescVector vbDescs;
+            std::vector<std::vector<uint8_t>> vertexData;   // One entry per element in vbDescs
+            BoundingBox boundingBox;
+            MeshOptimizationStats optimizationStats;
+            VertexQuantization quantization;
+            VertexQuantizationStats quantizationStats;
+            GeometryPacker::MeshRange packedRange;          // Set by packMeshes()
+            CpuVertexData::SharedPtr pCpuVertices;          // Only with Model::KeepCpuGeometry
+            std::vector<MeshCluster> clusters;              // Only with Model::GenerateMeshClusters
+            bool isValid = false;
+        };
+
+        void decodeMeshes(const aiScene* pScene);
+        bool decodeMesh(const aiMesh* pAiMesh, MeshData& data);
+        static const uint8_t* findPositions(const MeshData& data, uint32_t& stride);
+        void optimizeMesh(MeshData& data, uint32_t vertexCount);
+        void quantizeMesh(MeshData& data, uint32_t vertexCount);
+        void packMeshes(const aiScene* pScene);
+        Mesh::SharedPtr createMesh(const aiMesh* pAiMesh, MeshData& data);
         bool createVertexLayouts(const aiMesh* pAiMesh, Vao::VertexBufferDescVector& layouts);
-        Buffer::SharedPtr createIndexBuffer(const aiMesh* pAiMesh);
-        Buffer::SharedPtr createVertexBuffer(const aiMesh* pAiMesh, uint32_t vertexCount, BoundingBox& boundingBox, const VertexLayout* pLayout);
+        void initVertexData(const aiMesh* pAiMesh, uint32_t vertexCount, BoundingBox& boundingBox, const VertexLayout* pLayout, std::vector<uint8_t>& initData);
         void loadBones(const aiMesh* pAiMesh, uint8_t* pVertexData, uint32_t vertexCount, uint32_t vertexStride);
+        void loadAllTextures(const aiScene* pScene, const std::string& folder, bool useSrgb);
+        bool shareTextures() const;     // Whether textures go through the process-wide TextureCache
         void loadTextures(const aiMaterial* pAiMaterial, const std::string& folder, BasicMaterial* pMaterial, bool isObjFile, bool useSrgb);
         Material::SharedPtr createMaterial(const aiMaterial* pAiMaterial, const std::string& folder, bool isObjFile, bool useSrgb);
 
@@ -87,9 +113,11 @@ namespace Falcor
 
         std::vector<Bone> mBones;
         uint32_t mFlags;
+        std::vector<std::string>* mpOpenedFiles = nullptr;
 
         uint32_t mBoneIDOffset = 0;
         uint32_t mBoneWeightOffset = 0;
         std::map<const std::string, Texture::SharedPtr> mTextureCache;
+        std::vector<MeshData> mMeshData;    // Indexed by the aiMesh ID
     };
 }
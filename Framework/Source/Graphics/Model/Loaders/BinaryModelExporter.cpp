@@ -31,10 +31,12 @@
 #include "../Mesh.h"
 #include "Core/VAO.h"
 #include "BinaryModelSpec.h"
+#include "NativeModelSpec.h"
 #include "Core/Buffer.h"
 #include "core/Texture.h"
 #include "BinaryImage.hpp"
 #include "Data/VertexAttrib.h"
+#include "Utils/AsyncLoader.h"
 
 namespace Falcor
 {
@@ -157,9 +159,9 @@ namespace Falcor
         stream.write(str.c_str(), str.size());;
     }
 
-    void BinaryModelExporter::exportToFile(const std::string& filename, const Model* pModel)
+    void BinaryModelExporter::exportToFile(const std::string& filename, const Model* pModel, FileFormat format)
     {
-        BinaryModelExporter(filename, pModel);
+        BinaryModelExporter(filename, pModel, format);
     }
 
     void BinaryModelExporter::error(const std::string& msg)
@@ -173,7 +175,7 @@ namespace Falcor
         Logger::log(Logger::Level::Error, "Warning when exporting model \"" + mFilename + "\".\n" + Msg);
     }
 
-    BinaryModelExporter::BinaryModelExporter(const std::string& filename, const Model* pModel) : mFilename(filename)
+    BinaryModelExporter::BinaryModelExporter(const std::string& filename, const Model* pModel, FileFormat format) : mFilename(filename)
     {
         mStream.open(filename.c_str(), BinaryFileStream::Mode::Write);
         mpModel = pModel;
@@ -190,6 +192,12 @@ namespace Falcor
             return;
         }
 
+        if(format == FileFormat::Native)
+        {
+            exportNative();
+            return;
+        }
+
         if(prepareSubmeshes() == false) return;
         if(writeHeader()      == false) return;
         if(writeTextures()    == false) return;
@@ -201,6 +209,7 @@ namespace Falcor
     {
         // The binary format has a concept of submeshes, that share the same vertex buffer, but have different materials and index buffers.
         // Model works in a similar way (meshes can share VB), but only stores the meshes vector. We need to process that vector to identify submeshes.
+        // Packed meshes share the VAO but use different ranges of the vertex buffers, so the base vertex is part of the key.
         for(uint32_t i = 0; i < mpModel->getMeshCount(); i++)
         {
             auto pMesh = mpModel->getMesh(i);
@@ -211,7 +220,7 @@ namespace Falcor
             }
 
             auto pVao = pMesh->getVao();
-            auto& submesh = mMeshes[pVao.get()];
+            auto& submesh = mMeshes[std::make_pair(pVao.get(), pMesh->getBaseVertex())];
             submesh.push_back(pMesh);
         }
 
@@ -283,16 +292,28 @@ namespace Falcor
             }
             mStream << (int32_t)type << (int32_t)format << (int32_t)channels;
 
+            // Float positions and normals come from the mesh's CPU copy, if it has one
+            vbInfo[i].stride = pLayout->getTotalStride();
+            const glm::vec3* pCpuData = nullptr;
+            if(pLayout->getElementFormat(0) == ResourceFormat::RGB32Float && vbInfo[i].stride == sizeof(glm::vec3))
+            {
+                uint32_t location = pLayout->getElementShaderLocation(0);
+                pCpuData = (location == VERTEX_POSITION_LOC) ? pMesh->getCpuPositions() : ((location == VERTEX_NORMAL_LOC) ? pMesh->getCpuNormals() : nullptr);
+            }
+            if(pCpuData)
+            {
+                vbInfo[i].pData = (size_t)pCpuData;
+                continue;
+            }
+
             // Most of the buffers we use were created without any access flags, so can't be mapped.
-            // We create a temporary staging buffer to overcome this.
+            // We create a temporary staging buffer to overcome this. The vertex buffer can be shared with other meshes, so only the mesh's range is copied.
 			const Buffer* pVB = pVao->getVertexBuffer(i).get();
-			vbInfo[i].pBuffer = Buffer::create(pVB->getSize(), Buffer::BindFlags::None, Buffer::AccessFlags::MapRead, nullptr);
-            pVB->copy(vbInfo[i].pBuffer.get());
+            size_t rangeSize = size_t(vbInfo[i].stride) * pMesh->getVertexCount();
+			vbInfo[i].pBuffer = Buffer::create(rangeSize, Buffer::BindFlags::None, Buffer::AccessFlags::MapRead, nullptr);
+            pVB->copy(vbInfo[i].pBuffer.get(), size_t(vbInfo[i].stride) * pMesh->getBaseVertex(), 0, rangeSize);
 
             vbInfo[i].pData = (size_t)vbInfo[i].pBuffer->map(Buffer::MapType::Read);
-
-
-            vbInfo[i].stride = pLayout->getTotalStride();
         }
 
         // Write the vertex buffer
@@ -307,7 +328,10 @@ namespace Falcor
 
         for (auto& a : vbInfo)
 		{
-			a.pBuffer->unmap();
+            if(a.pBuffer)
+            {
+                a.pBuffer->unmap();
+            }
 		}
 
         return true;
@@ -350,16 +374,9 @@ namespace Falcor
 
         mStream << (int32_t)primCount;
 
-        // Output the index buffer
-        // Most of the buffers we use were created without any access flags, so can't be mapped.
-        // We create a temporary staging buffer to overcome this.
-        auto pStaging = Buffer::create(pMesh->getVao()->getIndexBuffer()->getSize(), Buffer::BindFlags::None, Buffer::AccessFlags::MapRead, nullptr);
-        pMesh->getVao()->getIndexBuffer()->copy(pStaging.get());
-
-        const void* pIndices = pStaging->map(Buffer::MapType::Read);
-        mStream.write(pIndices, indexCount * sizeof(uint32_t));
-
-        pStaging->unmap();
+        // Output the index buffer. The binary format only supports 32-bit indices.
+        std::vector<uint32_t> indices = pMesh->getIndices();
+        mStream.write(indices.data(), indexCount * sizeof(uint32_t));
 
         return true;
     }
@@ -447,4 +464,328 @@ namespace Falcor
         mStream.write(data.data(), dataSize);
         return true;
     }
-}
\ No newline at end of file
+
+    static uint64_t alignNativeOffset(uint64_t offset)
+    {
+        return (offset + kNativeModelAlignment - 1) & ~uint64_t(kNativeModelAlignment - 1);
+    }
+
+    void BinaryModelExporter::writeNativePadding(uint64_t offset)
+    {
+        static const uint8_t kZeros[kNativeModelAlignment] = {0};
+        assert(offset >= mNativeOffset && offset - mNativeOffset <= kNativeModelAlignment);
+        mStream.write(kZeros, size_t(offset - mNativeOffset));
+        mNativeOffset = offset;
+    }
+
+    bool BinaryModelExporter::writeNativeBufferData(const Buffer* pBuffer)
+    {
+        // Most of the buffers we use were created without any access flags, so can't be mapped.
+        // We create a temporary staging buffer to overcome this. Each readback is a separate upload, and the file is written by the calling thread.
+        std::vector<uint8_t> data(pBuffer->getSize());
+        AsyncLoader::upload([&]()
+        {
+            auto pStaging = Buffer::create(pBuffer->getSize(), Buffer::BindFlags::None, Buffer::AccessFlags::MapRead, nullptr);
+            pBuffer->copy(pStaging.get());
+            memcpy(data.data(), pStaging->map(Buffer::MapType::Read), data.size());
+            pStaging->unmap();
+        });
+        mStream.write(data.data(), data.size());
+        mNativeOffset += pBuffer->getSize();
+        return true;
+    }
+
+    bool BinaryModelExporter::writeNativeTextureData(const Texture* pTexture)
+    {
+        std::vector<uint8_t> data;
+        for(uint32_t mip = 0; mip < pTexture->getMipLevels(); mip++)
+        {
+            uint32_t dataSize = pTexture->getMipLevelDataSize(mip);
+            data.resize(dataSize);
+            AsyncLoader::upload([&]() { pTexture->readSubresourceData(data.data(), dataSize, mip, 0); });
+            mStream.write(data.data(), dataSize);
+            mNativeOffset += dataSize;
+        }
+        return true;
+    }
+
+    bool BinaryModelExporter::exportNative()
+    {
+        static_assert(BasicMaterial::MapType::Count <= arraysize(NativeMaterialDesc::textureIDs), "NativeMaterialDesc can't hold all the material maps");
+
+        std::vector<char> strings;
+        std::vector<NativeBufferDesc> buffers;
+        std::vector<NativeTextureDesc> textures;
+        std::vector<NativeMaterialDesc> materials;
+        std::vector<NativeVertexStreamDesc> streams;
+        std::vector<NativeVertexElementDesc> elements;
+        std::vector<NativeMeshDesc> meshes;
+        std::vector<glm::mat4> instances;
+        std::vector<NativeClusterDesc> clusters;
+
+        std::vector<const Buffer*> bufferObjects;
+        std::vector<const Texture*> textureObjects;
+        std::map<const Buffer*, uint32_t> bufferIDs;
+        std::map<const Texture*, uint32_t> textureIDs;
+        std::map<const Material*, uint32_t> materialIDs;
+
+        auto addString = [&strings](const std::string& str)
+        {
+            uint32_t offset = (uint32_t)strings.size();
+            strings.insert(strings.end(), str.begin(), str.end());
+            strings.push_back('\0');
+            return offset;
+        };
+
+        auto addBuffer = [&](const Buffer* pBuffer, Buffer::BindFlags bindFlags, Buffer::AccessFlags accessFlags)
+        {
+            auto it = bufferIDs.find(pBuffer);
+            if(it != bufferIDs.end())
+            {
+                return it->second;
+            }
+            NativeBufferDesc desc = {};
+            desc.size = pBuffer->getSize();
+            desc.bindFlags = (uint32_t)bindFlags;
+            desc.accessFlags = (uint32_t)accessFlags;
+            uint32_t id = (uint32_t)buffers.size();
+            buffers.push_back(desc);
+            bufferObjects.push_back(pBuffer);
+            bufferIDs[pBuffer] = id;
+            return id;
+        };
+
+        auto addTexture = [&](const Texture* pTexture)
+        {
+            if(pTexture == nullptr)
+            {
+                return kNativeModelInvalidID;
+            }
+            auto it = textureIDs.find(pTexture);
+            if(it != textureIDs.end())
+            {
+                return it->second;
+            }
+            NativeTextureDesc desc = {};
+            desc.width = pTexture->getWidth();
+            desc.height = pTexture->getHeight();
+            desc.mipLevels = pTexture->getMipLevels();
+            desc.format = (uint32_t)pTexture->getFormat();
+            desc.nameOffset = addString(pTexture->getSourceFilename());
+            for(uint32_t mip = 0; mip < desc.mipLevels; mip++)
+            {
+                desc.dataSize += pTexture->getMipLevelDataSize(mip);
+            }
+            uint32_t id = (uint32_t)textures.size();
+            textures.push_back(desc);
+            textureObjects.push_back(pTexture);
+            textureIDs[pTexture] = id;
+            return id;
+        };
+
+        for(uint32_t meshID = 0; meshID < mpModel->getMeshCount(); meshID++)
+        {
+            const Mesh* pMesh = mpModel->getMesh(meshID).get();
+            const Vao* pVao = pMesh->getVao().get();
+            NativeMeshDesc meshDesc = {};
+
+            // Vertex streams
+            meshDesc.firstStream = (uint32_t)streams.size();
+            meshDesc.streamCount = pVao->getVertexBuffersCount();
+            for(uint32_t i = 0; i < pVao->getVertexBuffersCount(); i++)
+            {
+                const VertexLayout* pLayout = pVao->getVertexBufferLayout(i).get();
+                NativeVertexStreamDesc stream;
+                stream.bufferID = addBuffer(pVao->getVertexBuffer(i).get(), Buffer::BindFlags::Vertex, Buffer::AccessFlags::None);
+                stream.stride = pVao->getVertexBufferStride(i);
+                stream.firstElement = (uint32_t)elements.size();
+                stream.elementCount = pLayout->getElementCount();
+                streams.push_back(stream);
+
+                for(uint32_t e = 0; e < pLayout->getElementCount(); e++)
+                {
+                    NativeVertexElementDesc element = {};
+                    element.nameOffset = addString(pLayout->getElementName(e));
+                    element.offset = pLayout->getElementOffset(e);
+                    element.format = (uint32_t)pLayout->getElementFormat(e);
+                    element.arraySize = pLayout->getElementArraySize(e);
+                    element.shaderLocation = pLayout->getElementShaderLocation(e);
+                    elements.push_back(element);
+                }
+            }
+
+            // Index buffer
+            const Buffer* pIB = pVao->getIndexBuffer().get();
+            meshDesc.indexBufferID = pIB ? addBuffer(pIB, Buffer::BindFlags::Index, Buffer::AccessFlags::MapRead) : kNativeModelInvalidID;
+            meshDesc.indexFormat = (uint32_t)pVao->getIndexBufferFormat();
+            meshDesc.indexCount = pMesh->getIndexCount();
+            meshDesc.firstIndex = pMesh->getFirstIndex();
+            meshDesc.baseVertex = pMesh->getBaseVertex();
+            meshDesc.vertexCount = pMesh->getVertexCount();
+            meshDesc.topology = (uint32_t)pMesh->getTopology();
+
+            // Material
+            const Material* pMaterial = pMesh->getMaterial().get();
+            auto materialIt = materialIDs.find(pMaterial);
+            if(materialIt == materialIDs.end())
+            {
+                BasicMaterial basicMaterial;
+                basicMaterial.initializeFromMaterial(pMaterial);
+
+                NativeMaterialDesc materialDesc = {};
+                materialDesc.diffuseColor = basicMaterial.diffuseColor;
+                materialDesc.opacity = basicMaterial.opacity;
+                materialDesc.specularColor = basicMaterial.specularColor;
+                materialDesc.shininess = basicMaterial.shininess;
+                materialDesc.transparentColor = basicMaterial.transparentColor;
+                materialDesc.IoR = basicMaterial.IoR;
+                materialDesc.emissiveColor = basicMaterial.emissiveColor;
+                materialDesc.bumpScale = basicMaterial.bumpScale;
+                materialDesc.bumpOffset = basicMaterial.bumpOffset;
+                for(uint32_t i = 0; i < arraysize(materialDesc.textureIDs); i++)
+                {
+                    materialDesc.textureIDs[i] = (i < BasicMaterial::MapType::Count) ? addTexture(basicMaterial.pTextures[i].get()) : kNativeModelInvalidID;
+                }
+
+                materialIt = materialIDs.insert(std::make_pair(pMaterial, (uint32_t)materials.size())).first;
+                materials.push_back(materialDesc);
+            }
+            meshDesc.materialID = materialIt->second;
+
+            // Instances
+            meshDesc.firstInstance = (uint32_t)instances.size();
+            meshDesc.instanceCount = pMesh->getInstanceCount();
+            for(uint32_t i = 0; i < pMesh->getInstanceCount(); i++)
+            {
+                instances.push_back(pMesh->getInstanceMatrix(i));
+            }
+
+            meshDesc.boundingBoxCenter = pMesh->getObjectSpaceBoundingBox().center;
+            meshDesc.boundingBoxExtent = pMesh->getObjectSpaceBoundingBox().extent;
+            meshDesc.positionScale = pMesh->getVertexQuantization().positionScale;
+            meshDesc.positionOffset = pMesh->getVertexQuantization().positionOffset;
+            meshDesc.octahedralDirections = pMesh->getVertexQuantization().octahedralDirections ? 1 : 0;
+
+            // Clusters
+            meshDesc.firstCluster = (uint32_t)clusters.size();
+            meshDesc.clusterCount = (uint32_t)pMesh->getClusters().size();
+            for(const MeshCluster& cluster : pMesh->getClusters())
+            {
+                NativeClusterDesc clusterDesc = {};
+                clusterDesc.firstIndex = cluster.firstIndex;
+                clusterDesc.indexCount = cluster.indexCount;
+                clusterDesc.center = cluster.center;
+                clusterDesc.radius = cluster.radius;
+                clusterDesc.coneAxis = cluster.coneAxis;
+                clusterDesc.coneCutoff = cluster.coneCutoff;
+                clusters.push_back(clusterDesc);
+            }
+            meshes.push_back(meshDesc);
+        }
+
+        for(const Texture* pTexture : textureObjects)
+        {
+            if(pTexture->getArraySize() > 1 || pTexture->getType() != Texture::Type::Texture2D)
+            {
+                error("Native format only supports 2D textures.");
+                return false;
+            }
+        }
+
+        // Lay out the file - the header and the table of contents, the descriptor sections, and the data section
+        struct Section
+        {
+            NativeSectionType type;
+            const void* pData;
+            size_t elementSize;
+            size_t elementCount;
+        };
+
+        const Section sections[] =
+        {
+            {NativeSectionType::Strings, strings.data(), 1, strings.size()},
+            {NativeSectionType::Buffers, buffers.data(), sizeof(NativeBufferDesc), buffers.size()},
+            {NativeSectionType::Textures, textures.data(), sizeof(NativeTextureDesc), textures.size()},
+            {NativeSectionType::Materials, materials.data(), sizeof(NativeMaterialDesc), materials.size()},
+            {NativeSectionType::VertexStreams, streams.data(), sizeof(NativeVertexStreamDesc), streams.size()},
+            {NativeSectionType::VertexElements, elements.data(), sizeof(NativeVertexElementDesc), elements.size()},
+            {NativeSectionType::Meshes, meshes.data(), sizeof(NativeMeshDesc), meshes.size()},
+            {NativeSectionType::Instances, instances.data(), sizeof(glm::mat4), instances.size()},
+            {NativeSectionType::Clusters, clusters.data(), sizeof(NativeClusterDesc), clusters.size()},
+        };
+        const uint32_t sectionCount = arraysize(sections) + 1;
+
+        std::vector<NativeSectionDesc> toc(sectionCount);
+        uint64_t offset = sizeof(NativeModelHeader) + sectionCount * sizeof(NativeSectionDesc);
+        for(uint32_t i = 0; i < arraysize(sections); i++)
+        {
+            offset = alignNativeOffset(offset);
+            toc[i].type = (uint32_t)sections[i].type;
+            toc[i].elementCount = (sections[i].type == NativeSectionType::Strings) ? 0 : (uint32_t)sections[i].elementCount;
+            toc[i].offset = offset;
+            toc[i].size = sections[i].elementSize * sections[i].elementCount;
+            offset += toc[i].size;
+        }
+
+        NativeSectionDesc& dataSection = toc[sectionCount - 1];
+        dataSection.type = (uint32_t)NativeSectionType::Data;
+        dataSection.elementCount = 0;
+        dataSection.offset = alignNativeOffset(offset);
+        offset = dataSection.offset;
+        for(auto& buffer : buffers)
+        {
+            buffer.dataOffset = alignNativeOffset(offset);
+            offset = buffer.dataOffset + buffer.size;
+        }
+        for(auto& texture : textures)
+        {
+            texture.dataOffset = alignNativeOffset(offset);
+            offset = texture.dataOffset + texture.dataSize;
+        }
+        dataSection.size = offset - dataSection.offset;
+
+        NativeModelHeader header = {};
+        memcpy(header.formatID, kNativeModelFormatID, sizeof(header.formatID));
+        header.version = kNativeModelVersion;
+        header.sectionCount = sectionCount;
+        header.fileSize = offset;
+
+        // Write everything in file order. Every buffer and every texture mip is read back by its own upload.
+        uint32_t readbackCount = (uint32_t)bufferObjects.size();
+        for(const Texture* pTexture : textureObjects)
+        {
+            readbackCount += pTexture->getMipLevels();
+        }
+        AsyncLoader::addItems(readbackCount);
+        mNativeOffset = 0;
+        mStream.write(&header, sizeof(header));
+        mStream.write(toc.data(), toc.size() * sizeof(NativeSectionDesc));
+        mNativeOffset += sizeof(header) + toc.size() * sizeof(NativeSectionDesc);
+        for(uint32_t i = 0; i < arraysize(sections); i++)
+        {
+            writeNativePadding(toc[i].offset);
+            mStream.write(sections[i].pData, (size_t)toc[i].size);
+            mNativeOffset += toc[i].size;
+        }
+
+        writeNativePadding(dataSection.offset);
+        for(size_t i = 0; i < buffers.size(); i++)
+        {
+            writeNativePadding(buffers[i].dataOffset);
+            writeNativeBufferData(bufferObjects[i]);
+        }
+        for(size_t i = 0; i < textures.size(); i++)
+        {
+            writeNativePadding(textures[i].dataOffset);
+            writeNativeTextureData(textureObjects[i]);
+        }
+        assert(mNativeOffset == header.fileSize);
+
+        if(mStream.isFail())
+        {
+            error("Failed to write the file.");
+            return false;
+        }
+        return true;
+    }
+}
@@ -38,19 +38,27 @@ namespace Falcor
     class Mesh;
     class Vao;
     class Texture;
+    class Buffer;
 
     class BinaryModelExporter
     {
     public:
-        /** Export a model into a binary file
+        enum class FileFormat
+        {
+            Native,     ///< Falcor's native format, which the importer memory-maps. See NativeModelSpec.h.
+            Legacy,     ///< The BinScene format
+        };
+
+        /** Export a model into a binary file.\n
+            The native format reads the GPU buffers and textures back with one AsyncLoader::upload() each, so it can be exported from a loader thread without stalling the render thread for the whole export. The legacy format must be exported from the render thread.
             \param[in] filename Model's filename. Loader will look for it in the data directories.
             \param[in] pModel The model to export
-            returns nullptr if loading failed, otherwise a new Model object
+            \param[in] format The file format to write
         */
-        static void exportToFile(const std::string& filename, const Model* pModel);
+        static void exportToFile(const std::string& filename, const Model* pModel, FileFormat format = FileFormat::Native);
 
     private:
-        BinaryModelExporter(const std::string& filename, const Model* pModel);
+        BinaryModelExporter(const std::string& filename, const Model* pModel, FileFormat format);
         const Model* mpModel = nullptr;
         BinaryFileStream mStream;
         const std::string& mFilename;
@@ -64,11 +72,17 @@ namespace Falcor
         
         bool exportBinaryImage(const Texture* pTexture);
 
+        bool exportNative();
+        bool writeNativeBufferData(const Buffer* pBuffer);
+        bool writeNativeTextureData(const Texture* pTexture);
+        void writeNativePadding(uint64_t offset);
+        uint64_t mNativeOffset = 0;     ///< The current write offset in the native file
+
         void error(const std::string& Msg);
         void warning(const std::string& Msg);
 
         bool prepareSubmeshes();
-        std::map<const Vao*, std::vector<Mesh::SharedPtr>> mMeshes;
+        std::map<std::pair<const Vao*, int32_t>, std::vector<Mesh::SharedPtr>> mMeshes;   // Keyed by the VAO and the base vertex
         std::map<const Texture*, int32_t> mTextureHash;
         uint32_t mInstanceCount = 0;   // Not the same as Model::Instance count. Model keeps the total instance count, while the binary format has a concept of meshes and submeshes, and the instance count there is the mesh instance count.
     };
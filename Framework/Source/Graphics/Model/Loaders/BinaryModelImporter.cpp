@@ -28,6 +28,7 @@
 #include "Framework.h"
 #include "BinaryModelImporter.h"
 #include "BinaryModelSpec.h"
+#include "NativeModelSpec.h"
 #include "../Model.h"
 #include "../Mesh.h"
 #include "Utils/OS.h"
@@ -38,8 +39,13 @@
 #include "BinaryImage.hpp"
 #include "Core/Formats.h"
 #include "Core/Texture.h"
+#include "Graphics/TextureCache.h"
 #include "Graphics/Material/Material.h"
 #include "glm/geometric.hpp"
+#include "Utils/ThreadPool.h"
+#include "Utils/AsyncLoader.h"
+#include "../GeometryPacker.h"
+#include "../TangentSpaceGenerator.h"
 
 namespace Falcor
 {
@@ -50,122 +56,45 @@ namespace Falcor
         ResourceFormat format = ResourceFormat::Unknown;
         std::vector<uint8_t> data;
         std::string name;
+        bool expandRgbToRgbx = false;   // The data was read as 3-channel RGB and needs to be padded in-place. See expandTextureData()
+        uint64_t contentHash = 0;       // Hash of the dimensions and the expanded data, for the TextureCache
     };
 
-    bool isSpecialFloat(float f)
-    {
-        uint32_t d = *(uint32_t*)&f;
-        // Check the exponent
-        d = (d >> 23) & 0xff;
-        return d == 0xff;
-    }
+    static const uint32_t kInvalidBufferIndex = (uint32_t)-1;
 
-    template<typename posType>
-    void generateSubmeshTangentData(
-        const std::vector<uint32_t>& indices,
-        const posType* vertexPosData,
-        const glm::vec3* vertexNormalData,
-        const glm::vec2* texCrdData,
-        uint32_t texCrdCount,
-        glm::vec3* tangentData,
-        glm::vec3* bitangentData)
+    /** System memory data of a sub-mesh in the legacy format
+    */
+    struct LegacySubmeshData
     {
-        // calculate the tangent and bitangent for every face
-        size_t primCount = indices.size() / 3;
-        for(size_t primID = 0; primID < primCount; primID++)
-        {
-            struct Data
-            {
-                posType position;
-                glm::vec3 normal;
-                glm::vec2 uv;
-            };
-            Data V[3];
-
-            // Get the data
-            for(uint32_t i = 0; i < 3; i++)
-            {
-                uint32_t index = indices[primID * 3 + i];
-                V[i].position = vertexPosData[index];
-                V[i].normal = vertexNormalData[index];
-
-                if(texCrdData)
-                {
-                    V[i].uv = texCrdData[index * texCrdCount];
-                }
-                else
-                {
-                    V[i].uv = glm::vec2(0.f, 0.f);
-                }
-            }
-
-            // Position delta
-            posType posDelta[2];
-            posDelta[0] = V[1].position - V[0].position;
-            posDelta[1] = V[2].position - V[0].position;
-
-            // Texture offset
-            glm::vec2 s = V[1].uv - V[0].uv;
-            glm::vec2 t = V[2].uv - V[0].uv;
-            s.y = -s.y;
-            t.y = -t.y;
-
-            float dirCorrection = (t.x * s.y - t.y * s.x) < 0.0f ? -1.0f : 1.0f;
-            // when t1, t2, t3 in same position in UV space, just use default UV direction.
-            if((s == glm::vec2(0, 0)) && (t == glm::vec2(0, 0)))
-            {
-                s.x = 0.0;
-                s.y = 1.0;
-                t.x = 1.0;
-                t.y = 0.0;
-            }
-
-            // tangent points in the direction where to positive X axis of the texture coord's would point in model space
-            // bitangent's points along the positive Y axis of the texture coord's, respectively
-            glm::vec3 tangent;
-            glm::vec3 bitangent;
-            tangent.x = (posDelta[1].x * s.y - posDelta[0].x * t.y) * dirCorrection;
-            tangent.y = (posDelta[1].y * s.y - posDelta[0].y * t.y) * dirCorrection;
-            tangent.z = (posDelta[1].z * s.y - posDelta[0].z * t.y) * dirCorrection;
-
-            bitangent.x = (posDelta[1].x * s.x - posDelta[0].x * t.x) * dirCorrection;
-            bitangent.y = (posDelta[1].y * s.x - posDelta[0].y * t.x) * dirCorrection;
-            bitangent.z = (posDelta[1].z * s.x - posDelta[0].z * t.x) * dirCorrection;
-
-            // store for every vertex of that face
-            for(uint32_t i = 0; i < 3; i++)
-            {
-                // project tangent and bitangent into the plane formed by the vertex' normal
-                glm::vec3 localTangent = tangent - V[i].normal * (glm::dot(tangent, V[i].normal));
-                localTangent = glm::normalize(localTangent);
-                glm::vec3 localBitangent = bitangent - V[i].normal * (glm::dot(bitangent, V[i].normal));
-                localBitangent = glm::normalize(localBitangent);
-
-                // reconstruct tangent/bitangent according to normal and bitangent/tangent when it's infinite or NaN.
-                bool isInvalidTangent = isSpecialFloat(localTangent.x) || isSpecialFloat(localTangent.y) || isSpecialFloat(localTangent.z);
-                bool isInvalidBitangent = isSpecialFloat(localBitangent.x) || isSpecialFloat(localBitangent.y) || isSpecialFloat(localBitangent.z);
-
-                if(isInvalidTangent != isInvalidBitangent)
-                {
-                    if(isInvalidTangent)
-                    {
-                        localTangent = glm::cross(V[i].normal, localBitangent);
-                        localTangent = glm::normalize(localTangent);
-                    }
-                    else
-                    {
-                        localBitangent = glm::cross(localTangent, V[i].normal);
-                        localBitangent = glm::normalize(localBitangent);
-                    }
-                }
+        BasicMaterial material;                                             // Doesn't reference textures yet
+        std::vector<std::pair<BasicMaterial::MapType, int32_t>> textures;   // Material slot and texture ID
+        std::vector<uint32_t> indices;
+        std::vector<uint8_t> tangentData;       // Snapshot of the mesh's tangent buffer after generating this sub-mesh's tangents
+        std::vector<uint8_t> bitangentData;
+        BoundingBox boundingBox;
+        std::vector<MeshCluster> clusters;
+    };
 
-                // and write it into the mesh
-                uint32_t index = indices[primID * 3 + i];
-                tangentData[index] = localTangent;
-                bitangentData[index] = localBitangent;
-            }
-        }
-    }
+    /** System memory data of a mesh in the legacy format
+    */
+    struct LegacyMeshData
+    {
+        Vao::VertexBufferDescVector vbDescs;
+        std::vector<std::vector<uint8_t>> buffers;
+        int32_t numAttribs = 0;
+        int32_t numVertices = 0;
+        bool genTangents = false;
+        uint32_t positionBufferIndex = kInvalidBufferIndex;
+        uint32_t normalBufferIndex = kInvalidBufferIndex;
+        uint32_t tangentBufferIndex = kInvalidBufferIndex;
+        uint32_t bitangentBufferIndex = kInvalidBufferIndex;
+        uint32_t texCoordBufferIndex = kInvalidBufferIndex;
+        std::vector<LegacySubmeshData> submeshes;
+        MeshOptimizationStats optimizationStats;
+        VertexQuantization quantization;
+        VertexQuantizationStats quantizationStats;
+        CpuVertexData::SharedPtr pCpuVertices;      // Only with Model::KeepCpuGeometry. Shared by the sub-meshes.
+    };
 
     static BasicMaterial::MapType getFalcorMapType(TextureType map)
     {
@@ -449,10 +378,17 @@ namespace Falcor
 
         data.data.resize(storageSize);
         stream.read(data.data.data(), dataSize);
+        data.expandRgbToRgbx = (bpp == 3);
 
+        return true;
+    }
+
+    void expandTextureData(TextureData& data)
+    {
         // Convert 3-channel 8-bits RGB formats to 4-channel RGBX by adding padding
-        if(bpp == 3)
+        if(data.expandRgbToRgbx)
         {
+            const int32_t texelCount = data.width * data.height;
             for(int32_t i=texelCount-1;i>=0;--i)
             {
                 data.data[i * 4 + 0] = data.data[i * 3 + 0];
@@ -460,9 +396,152 @@ namespace Falcor
                 data.data[i * 4 + 2] = data.data[i * 3 + 2];
                 data.data[i * 4 + 3] = 0xff;
             }
+            data.expandRgbToRgbx = false;
+        }
+    }
+
+    /** Optimize the sub-meshes of a legacy mesh. The sub-meshes share the vertex buffers, so the vertices are ordered by their first use over all the sub-meshes.
+    */
+    void optimizeLegacyMesh(LegacyMeshData& mesh)
+    {
+        const uint32_t vertexCount = (uint32_t)mesh.numVertices;
+        const uint8_t* pPositions = mesh.buffers[mesh.positionBufferIndex].data();
+        const uint32_t positionStride = mesh.vbDescs[mesh.positionBufferIndex].stride;
+
+        std::vector<uint32_t> allIndices;
+        for(auto& submesh : mesh.submeshes)
+        {
+            uint32_t* pIndices = submesh.indices.data();
+            uint32_t indexCount = (uint32_t)submesh.indices.size();
+            mesh.optimizationStats.before += calcVertexCacheStats(pIndices, indexCount, vertexCount);
+            optimizeTriangleOrder(pIndices, indexCount, vertexCount, pPositions, positionStride);
+            allIndices.insert(allIndices.end(), submesh.indices.begin(), submesh.indices.end());
         }
 
-        return true;
+        std::vector<uint32_t> remap = calcVertexFetchRemap(allIndices.data(), (uint32_t)allIndices.size(), vertexCount);
+        for(size_t i = 0; i < mesh.buffers.size(); i++)
+        {
+            remapVertices(mesh.buffers[i].data(), mesh.vbDescs[i].stride, remap);
+        }
+        for(auto& submesh : mesh.submeshes)
+        {
+            remapIndices(submesh.indices.data(), (uint32_t)submesh.indices.size(), remap);
+            mesh.optimizationStats.after += calcVertexCacheStats(submesh.indices.data(), (uint32_t)submesh.indices.size(), vertexCount);
+        }
+    }
+
+    /** Quantize the vertex streams of a legacy mesh. Generated tangents are stored per sub-mesh, so they are quantized separately.
+    */
+    void quantizeLegacyMesh(LegacyMeshData& mesh, bool quantizePositions, bool quantizeAttributes)
+    {
+        const uint32_t vertexCount = (uint32_t)mesh.numVertices;
+        for(int32_t i = 0; i < mesh.numAttribs; i++)
+        {
+            quantizeVertexStream(mesh.vbDescs[i], mesh.buffers[i], vertexCount, quantizePositions, quantizeAttributes, mesh.quantization, mesh.quantizationStats);
+        }
+
+        if(mesh.genTangents && quantizeAttributes)
+        {
+            for(auto& submesh : mesh.submeshes)
+            {
+                std::vector<uint8_t> quantized;
+                quantizeDirections(submesh.tangentData.data(), sizeof(glm::vec3), vertexCount, quantized, mesh.quantizationStats);
+                submesh.tangentData = std::move(quantized);
+                quantizeDirections(submesh.bitangentData.data(), sizeof(glm::vec3), vertexCount, quantized, mesh.quantizationStats);
+                submesh.bitangentData = std::move(quantized);
+            }
+
+            for(uint32_t i : {mesh.tangentBufferIndex, mesh.bitangentBufferIndex})
+            {
+                Vao::VertexBufferDesc& vbDesc = mesh.vbDescs[i];
+                VertexLayout::SharedPtr pLayout = VertexLayout::create();
+                pLayout->addElement(vbDesc.pLayout->getElementName(0), 0, kQuantizedDirectionFormat, 1, vbDesc.pLayout->getElementShaderLocation(0));
+                vbDesc.pLayout = pLayout;
+                vbDesc.stride = pLayout->getTotalStride();
+            }
+            mesh.quantization.octahedralDirections = true;
+        }
+    }
+
+    void decodeLegacyMesh(LegacyMeshData& mesh, bool optimize, bool generateClusters, bool quantizePositions, bool quantizeAttributes, bool keepCpuGeometry, ThreadPool* pTangentPool)
+    {
+        // Optimize first, so that the tangents are generated for the final vertex order
+        if(optimize)
+        {
+            optimizeLegacyMesh(mesh);
+        }
+
+        // Sub-meshes share the tangent buffers, so they are processed in file order. This way each snapshot matches what a serial load produces.
+        const Vao::VertexBufferDescVector& vbDescs = mesh.vbDescs;
+        std::vector<std::vector<uint8_t>>& buffers = mesh.buffers;
+        for(auto& submesh : mesh.submeshes)
+        {
+            const std::vector<uint32_t>& indices = submesh.indices;
+            const uint32_t numIndices = (uint32_t)indices.size();
+
+            // Generate tangent space data if needed
+            if(mesh.genTangents)
+            {
+                TangentSpaceDesc desc;
+                desc.pIndices = indices.data();
+                desc.indexCount = numIndices;
+                desc.vertexCount = (uint32_t)mesh.numVertices;
+                desc.pPositions = buffers[mesh.positionBufferIndex].data();
+                desc.positionStride = vbDescs[mesh.positionBufferIndex].stride;
+                desc.pNormals = buffers[mesh.normalBufferIndex].data();
+                desc.normalStride = vbDescs[mesh.normalBufferIndex].stride;
+                if(mesh.texCoordBufferIndex != kInvalidBufferIndex)
+                {
+                    desc.pTexCoords = buffers[mesh.texCoordBufferIndex].data();
+                    desc.texCoordStride = vbDescs[mesh.texCoordBufferIndex].stride;
+                }
+                desc.pTangents = (glm::vec3*)buffers[mesh.tangentBufferIndex].data();
+                desc.pBitangents = (glm::vec3*)buffers[mesh.bitangentBufferIndex].data();
+                generateSmoothTangentSpace(desc, pTangentPool);
+
+                submesh.tangentData = buffers[mesh.tangentBufferIndex];
+                submesh.bitangentData = buffers[mesh.bitangentBufferIndex];
+            }
+
+            // Calculate the bounding-box
+            glm::vec3 max, min;
+            for(uint32_t i = 0; i < numIndices; i++)
+            {
+                uint32_t vertexID = indices[i];
+                uint8_t* pVertex = (vbDescs[mesh.positionBufferIndex].stride * vertexID) + buffers[mesh.positionBufferIndex].data();
+
+                float* pPosition = (float*)pVertex;
+
+                glm::vec3 xyz(pPosition[0], pPosition[1], pPosition[2]);
+                min = glm::min(min, xyz);
+                max = glm::max(max, xyz);
+            }
+
+            submesh.boundingBox = BoundingBox::fromMinMax(min, max);
+
+            // The tangents are accumulated per vertex, so reordering the triangles afterwards doesn't change them
+            if(generateClusters)
+            {
+                submesh.clusters = generateMeshClusters(submesh.indices.data(), numIndices, (uint32_t)mesh.numVertices, buffers[mesh.positionBufferIndex].data(), vbDescs[mesh.positionBufferIndex].stride);
+            }
+        }
+
+        if(keepCpuGeometry)
+        {
+            Vao::VertexBufferDescVector attribDescs(vbDescs.begin(), vbDescs.begin() + mesh.numAttribs);
+            std::vector<const uint8_t*> vertexData;
+            for(int32_t i = 0; i < mesh.numAttribs; i++)
+            {
+                vertexData.push_back(buffers[i].data());
+            }
+            mesh.pCpuVertices = createCpuVertexData(attribDescs, vertexData, (uint32_t)mesh.numVertices, mesh.quantization);
+        }
+
+        // Last, since the tangents, bounding-boxes, clusters and CPU copy are calculated from the float data
+        if(quantizePositions || quantizeAttributes)
+        {
+            quantizeLegacyMesh(mesh, quantizePositions, quantizeAttributes);
+        }
     }
 
     bool importTextures(std::vector<TextureData>& textures, uint32_t textureCount, BinaryFileStream& stream, const std::string& modelName)
@@ -578,11 +657,34 @@ namespace Falcor
     
     Model::SharedPtr BinaryModelImporter::createModel(uint32_t flags)
     {
+        uint64_t fileSize = AsyncLoader::addFile(mModelName);
+
         // Format ID and version.
         char formatID[9];
         mStream.read(formatID, 8);
         formatID[8] = '\0';
 
+        // The native format is memory-mapped instead of streamed
+        if(std::string(formatID) == kNativeModelFormatID)
+        {
+            mStream.close();
+            size_t mappedSize = 0;
+            const uint8_t* pFile = (const uint8_t*)mapFileForRead(mModelName, mappedSize);
+            if(pFile == nullptr)
+            {
+                Logger::log(Logger::Level::Error, "Error when loading model " + mModelName + ".\nCan't map the file.");
+                return nullptr;
+            }
+            AsyncLoader::reportBytesLoaded(fileSize);
+            if(flags & (Model::OptimizeMeshes | Model::PackGeometry))
+            {
+                Logger::log(Logger::Level::Info, "Model " + mModelName + " is in the native format and is loaded as-is. Its meshes should be optimized and packed when converting it.");
+            }
+            Model::SharedPtr pModel = createNativeModel(pFile, mappedSize, flags);
+            unmapFile(pFile);
+            return pModel;
+        }
+
         uint32_t version;
         mStream >> version;
 
@@ -656,22 +758,11 @@ namespace Falcor
         // When creating instances of meshes, it means we need to translate the original mesh index to all it's submeshes Falcor IDs. This is what the next 2 variables are for.
         std::vector<std::vector<uint32_t>> meshToSubmeshesID(numMeshes);
 
-        struct TexSignature
-        {
-            const uint8_t* pData;
-            ResourceFormat format;
-            bool operator<(const TexSignature& other) const 
-            { 
-                if(pData < other.pData) return true;
-                if(pData == other.pData) return format < other.format;
-                return false;
-            }
-            bool operator==(const TexSignature& other) const { return pData == other.pData || format == other.format; }
-        };
-        std::map<TexSignature, Texture::SharedPtr> textures;
-        bool loadTexAsSrgb = (flags & Model::AssumeLinearSpaceTextures) ? false : true;
+        // Loading is done in 3 phases. The file is read sequentially into system memory, then textures and meshes are decoded on the import thread pool,
+        // and finally the API resources are created on the calling thread in file order
+        std::vector<LegacyMeshData> meshes(numMeshes);
 
-        // Load the meshes
+        // Read the meshes
         for(int meshIdx = 0; meshIdx < numMeshes; meshIdx++)
         {
             // Mesh header
@@ -697,17 +788,20 @@ namespace Falcor
                 return nullptr;
             }
 
-			Vao::VertexBufferDescVector vbDescs;
-			std::vector<std::vector<uint8_t> > buffers;
+            LegacyMeshData& meshData = meshes[meshIdx];
+            meshData.numAttribs = numAttribs;
+            meshData.numVertices = numVertices;
+
+			Vao::VertexBufferDescVector& vbDescs = meshData.vbDescs;
+			std::vector<std::vector<uint8_t> >& buffers = meshData.buffers;
             vbDescs.resize(numAttribs);
 			buffers.resize(numAttribs);
 
-            const uint32_t kInvalidBufferIndex = (uint32_t)-1;
-            uint32_t positionBufferIndex = kInvalidBufferIndex;
-            uint32_t normalBufferIndex = kInvalidBufferIndex;
-            uint32_t tangentBufferIndex = kInvalidBufferIndex;
-            uint32_t bitangentBufferIndex = kInvalidBufferIndex;
-            uint32_t texCoordBufferIndex = kInvalidBufferIndex;
+            uint32_t& positionBufferIndex = meshData.positionBufferIndex;
+            uint32_t& normalBufferIndex = meshData.normalBufferIndex;
+            uint32_t& tangentBufferIndex = meshData.tangentBufferIndex;
+            uint32_t& bitangentBufferIndex = meshData.bitangentBufferIndex;
+            uint32_t& texCoordBufferIndex = meshData.texCoordBufferIndex;
 
             for(int i = 0; i < numAttribs; i++)
             {
@@ -759,7 +853,7 @@ namespace Falcor
 
 			
             // Check if we need to generate tangents  
-            bool genTangentForMesh = false;
+            bool& genTangentForMesh = meshData.genTangents;
             if(shouldGenerateTangents && (tangentBufferIndex == kInvalidBufferIndex) && (bitangentBufferIndex == kInvalidBufferIndex))
             {
                 if(normalBufferIndex == kInvalidBufferIndex)
@@ -790,7 +884,7 @@ namespace Falcor
                     Vao::VertexBufferDesc& vbBitangentDesc = vbDescs[bitangentBufferIndex];
 					auto& pBitangentLayout = vbBitangentDesc.pLayout;
 					pBitangentLayout = VertexLayout::create();
-                    vbDescs[tangentBufferIndex].stride = sizeof(glm::vec3);
+                    vbDescs[bitangentBufferIndex].stride = sizeof(glm::vec3);
 					pBitangentLayout->addElement(VERTEX_BITANGENT_NAME, 0, ResourceFormat::RGB32Float, 1, VERTEX_BITANGENT_LOC);
 					buffers[bitangentBufferIndex].resize(sizeof(glm::vec3) * numVertices);
                 }
@@ -809,25 +903,20 @@ namespace Falcor
 				}
             }
 
-			for (int32_t i = 0; i < numAttribs; ++i)
-			{
-                vbDescs[i].pBuffer = Buffer::create(buffers[i].size(), Buffer::BindFlags::Vertex, Buffer::AccessFlags::None, buffers[i].data());
-                pModel->addBuffer(vbDescs[i].pBuffer);
-			}
-
             if(version <= 5)
             {
                 importTextures(texData, numTextures, mStream, mModelName);
-                textures.clear();
             }
 
             // Array of Submesh.
             // Falcor doesn't have a concept of submeshes, just create a new mesh for each submesh
+            meshData.submeshes.resize(numSubmeshes);
             for(int submesh = 0; submesh < numSubmeshes; submesh++)
             {
-                // create the material
-                BasicMaterial basicMaterial;
+                LegacySubmeshData& submeshData = meshData.submeshes[submesh];
 
+                // Read the material
+                BasicMaterial& basicMaterial = submeshData.material;
                 glm::vec3 ambient;
                 glm::vec4 diffuse;
                 glm::vec3 specular;
@@ -867,36 +956,10 @@ namespace Falcor
 							continue;
 						}
 
-                        // Load the texture
-                        TexSignature texSig;
-                        texSig.format = getFormatFromMapType(loadTexAsSrgb, texData[texID].format, falcorType);
-                        texSig.pData = texData[texID].data.data();
-                        // Check if we already created a matching texture
-                        auto existingTex = textures.find(texSig);
-                        if(existingTex != textures.end())
-                        {
-                            basicMaterial.pTextures[falcorType] = existingTex->second;
-                        }
-                        else
-                        {
-                            auto pTexture = Texture::create2D(texData[texID].width, texData[texID].height, texSig.format, 1, Texture::kEntireMipChain, texSig.pData);
-                            pTexture->setSourceFilename(texData[texID].name);
-                            textures[texSig] = pTexture;
-                            pModel->addTexture(pTexture);
-                            basicMaterial.pTextures[falcorType] = pTexture;
-                        }
+                        submeshData.textures.push_back({falcorType, texID});
                     }
                 }
 
-                auto pMaterial = basicMaterial.convertToMaterial();
-                auto pAddedMaterial = pModel->getOrAddMaterial(pMaterial);
-
-                // Check it the material already existed in the model
-                if(pAddedMaterial != pMaterial)
-                {
-                    pMaterial = pAddedMaterial;
-                }
-
                 int32_t numTriangles;
                 mStream >> numTriangles;
                 if(numTriangles < 0)
@@ -906,68 +969,255 @@ namespace Falcor
                     return nullptr;
                 }
 
-                // create the index buffer
+                // Read the indices
                 uint32_t numIndices = numTriangles * 3;
-                std::vector<uint32_t> indices(numIndices);
+                std::vector<uint32_t>& indices = submeshData.indices;
+                indices.resize(numIndices);
                 uint32_t ibSize = 3 * numTriangles * sizeof(uint32_t);
                 mStream.read(&indices[0], ibSize);
+            }
+        }
 
-                auto pIB = Buffer::create(ibSize, Buffer::BindFlags::Index, Buffer::AccessFlags::MapRead, indices.data());
-                pModel->addBuffer(pIB);
+        AsyncLoader::reportBytesLoaded(fileSize);
 
-                
-                // Generate tangent space data if needed
-                if(genTangentForMesh)
+        // Decode the textures and meshes in parallel
+        ThreadPool* pPool = Model::getImportThreadPool();
+        // Textures shared with models loaded before are found in the TextureCache by their content. Compression replaces the textures' data in place, so those models keep their own.
+        bool shareTextures = (flags & Model::CompressTextures) == 0;
+        pPool->run((uint32_t)texData.size(), [&texData, shareTextures](uint32_t taskID)
+        {
+            TextureData& data = texData[taskID];
+            expandTextureData(data);
+            if(shareTextures)
+            {
+                const uint32_t dims[] = { data.width, data.height };
+                data.contentHash = TextureCache::hashData(data.data.data(), data.data.size(), TextureCache::hashData(dims, sizeof(dims)));
+            }
+        });
+        bool optimizeMeshes = (flags & Model::OptimizeMeshes) != 0;
+        bool generateClusters = (flags & Model::GenerateMeshClusters) != 0;
+        bool quantizePositions = (flags & Model::QuantizePositions) != 0;
+        bool quantizeAttributes = (flags & Model::QuantizeVertices) != 0;
+        bool keepCpuGeometry = (flags & Model::KeepCpuGeometry) != 0;
+
+        // Meshes with large sub-meshes generate their tangents across the pool. The rest are decoded one mesh per task.
+        std::vector<uint32_t> smallMeshes;
+        for(uint32_t meshIdx = 0; meshIdx < (uint32_t)meshes.size(); meshIdx++)
+        {
+            bool isLarge = false;
+            if(meshes[meshIdx].genTangents)
+            {
+                for(const auto& submesh : meshes[meshIdx].submeshes)
                 {
-                    if(texCoordBufferIndex != kInvalidBufferIndex)
-                    {
-                        Logger::log(Logger::Level::Error, "Model " + mModelName + " asked to generate tangents w/o texture coordinates");
-                    }
-                    uint32_t texCrdCount = 0;
-                    glm::vec2* texCrd = nullptr;
-                    if(texCoordBufferIndex != kInvalidBufferIndex)
-                    {
-                        texCrdCount = vbDescs[texCoordBufferIndex].stride / sizeof(glm::vec2);
-                        texCrd = (glm::vec2*)buffers[texCoordBufferIndex].data();
-                    }
+                    isLarge = isLarge || (submesh.indices.size() / 3 > kTangentSpaceTaskSize);
+                }
+            }
+
+            if(isLarge)
+            {
+                decodeLegacyMesh(meshes[meshIdx], optimizeMeshes, generateClusters, quantizePositions, quantizeAttributes, keepCpuGeometry, pPool);
+            }
+            else
+            {
+                smallMeshes.push_back(meshIdx);
+            }
+        }
+        pPool->run((uint32_t)smallMeshes.size(), [&](uint32_t taskID) { decodeLegacyMesh(meshes[smallMeshes[taskID]], optimizeMeshes, generateClusters, quantizePositions, quantizeAttributes, keepCpuGeometry, nullptr); });
+        for(const auto& meshData : meshes)
+        {
+            pModel->mMeshOptimizationStats += meshData.optimizationStats;
+            pModel->mVertexQuantizationStats += meshData.quantizationStats;
+        }
+
+        // Create the API resources
+        struct TexSignature
+        {
+            const uint8_t* pData;
+            ResourceFormat format;
+            bool operator<(const TexSignature& other) const 
+            { 
+                if(pData < other.pData) return true;
+                if(pData == other.pData) return format < other.format;
+                return false;
+            }
+            bool operator==(const TexSignature& other) const { return pData == other.pData || format == other.format; }
+        };
+        std::map<TexSignature, Texture::SharedPtr> textures;
+        bool loadTexAsSrgb = (flags & Model::AssumeLinearSpaceTextures) ? false : true;
+
+        // With PackGeometry, the meshes go into shared buffers. Generated tangents are stored per sub-mesh, so meshes which generate them keep their own vertex buffers.
+        GeometryPacker packer;
+        std::vector<bool> isPacked(numMeshes, false);
+        std::vector<std::vector<uint32_t>> packedRangeIDs(numMeshes);
+        if(flags & Model::PackGeometry)
+        {
+            for(int meshIdx = 0; meshIdx < numMeshes; meshIdx++)
+            {
+                LegacyMeshData& meshData = meshes[meshIdx];
+                if(meshData.genTangents)
+                {
+                    continue;
+                }
 
-                    if (vbDescs[positionBufferIndex].pLayout->getElementFormat(0) == ResourceFormat::RGB32Float)
+                Vao::VertexBufferDescVector attribDescs(meshData.vbDescs.begin(), meshData.vbDescs.begin() + meshData.numAttribs);
+                std::vector<const uint8_t*> vertexData;
+                for(int32_t i = 0; i < meshData.numAttribs; i++)
+                {
+                    vertexData.push_back(meshData.buffers[i].data());
+                }
+                uint32_t verticesID = packer.addVertices(attribDescs, vertexData, meshData.numVertices);
+                for(auto& submeshData : meshData.submeshes)
+                {
+                    packedRangeIDs[meshIdx].push_back(packer.addIndices(verticesID, submeshData.indices.data(), (uint32_t)submeshData.indices.size()));
+                    if(meshData.pCpuVertices == nullptr)
                     {
-                        generateSubmeshTangentData<glm::vec3>(indices, (glm::vec3*)buffers[positionBufferIndex].data(), (glm::vec3*)buffers[normalBufferIndex].data(), texCrd, texCrdCount, (glm::vec3*)buffers[tangentBufferIndex].data(), (glm::vec3*)buffers[bitangentBufferIndex].data());
+                        submeshData.indices = std::vector<uint32_t>();
                     }
-                    else if (vbDescs[positionBufferIndex].pLayout->getElementFormat(0) == ResourceFormat::RGBA32Float)
+                }
+
+                // The packer keeps a copy, release ours
+                meshData.buffers = std::vector<std::vector<uint8_t>>();
+                isPacked[meshIdx] = true;
+            }
+
+            AsyncLoader::addItems(1);
+            AsyncLoader::upload([&]()
+            {
+                for(const auto& pBuffer : packer.createBuffers())
+                {
+                    pModel->addBuffer(pBuffer);
+                }
+            });
+        }
+
+        // Every unpacked mesh's vertex buffers and every sub-mesh are a separate upload
+        uint32_t uploadCount = 0;
+        for(int meshIdx = 0; meshIdx < numMeshes; meshIdx++)
+        {
+            uploadCount += (isPacked[meshIdx] ? 0 : 1) + (uint32_t)meshes[meshIdx].submeshes.size();
+        }
+        AsyncLoader::addItems(uploadCount);
+
+        for(int meshIdx = 0; meshIdx < numMeshes; meshIdx++)
+        {
+            LegacyMeshData& meshData = meshes[meshIdx];
+            Vao::VertexBufferDescVector& vbDescs = meshData.vbDescs;
+            std::vector<std::vector<uint8_t> >& buffers = meshData.buffers;
+
+            if(isPacked[meshIdx] == false)
+            {
+                AsyncLoader::upload([&]()
+                {
+                    for (int32_t i = 0; i < meshData.numAttribs; ++i)
                     {
-                        generateSubmeshTangentData<glm::vec4>(indices, (glm::vec4*)buffers[positionBufferIndex].data(), (glm::vec3*)buffers[normalBufferIndex].data(), texCrd, texCrdCount, (glm::vec3*)buffers[tangentBufferIndex].data(), (glm::vec3*)buffers[bitangentBufferIndex].data());
+                        vbDescs[i].pBuffer = Buffer::create(buffers[i].size(), Buffer::BindFlags::Vertex, Buffer::AccessFlags::None, buffers[i].data());
+                        pModel->addBuffer(vbDescs[i].pBuffer);
                     }
+                });
+            }
 
-                    vbDescs[tangentBufferIndex].pBuffer = Buffer::create(buffers[tangentBufferIndex].size(), Buffer::BindFlags::Vertex, Buffer::AccessFlags::None, buffers[tangentBufferIndex].data());
-                    pModel->addBuffer(vbDescs[tangentBufferIndex].pBuffer);
+            if(version <= 5)
+            {
+                textures.clear();
+            }
 
-                    vbDescs[bitangentBufferIndex].pBuffer = Buffer::create(buffers[bitangentBufferIndex].size(), Buffer::BindFlags::Vertex, Buffer::AccessFlags::None, buffers[bitangentBufferIndex].data());
-                    pModel->addBuffer(vbDescs[bitangentBufferIndex].pBuffer);
-                }
-				
+            for(size_t submesh = 0; submesh < meshData.submeshes.size(); submesh++)
+            {
+                LegacySubmeshData& submeshData = meshData.submeshes[submesh];
 
-                // Calculate the bounding-box
-                glm::vec3 max, min;
-                for(uint32_t i = 0; i < numIndices; i++)
+                // The textures, material, index buffer and mesh of a sub-mesh are created together
+                AsyncLoader::upload([&]()
                 {
-                    uint32_t vertexID = indices[i];
-                    uint8_t* pVertex = (vbDescs[positionBufferIndex].stride * vertexID) + buffers[positionBufferIndex].data();
+                    // create the material
+                    BasicMaterial& basicMaterial = submeshData.material;
+                    for(const auto& tex : submeshData.textures)
+                    {
+                        BasicMaterial::MapType falcorType = tex.first;
+                        int32_t texID = tex.second;
 
-                    float* pPosition = (float*)pVertex;
+                        // Load the texture
+                        TexSignature texSig;
+                        texSig.format = getFormatFromMapType(loadTexAsSrgb, texData[texID].format, falcorType);
+                        texSig.pData = texData[texID].data.data();
+                        // Check if we already created a matching texture
+                        auto existingTex = textures.find(texSig);
+                        if(existingTex != textures.end())
+                        {
+                            basicMaterial.pTextures[falcorType] = existingTex->second;
+                        }
+                        else
+                        {
+                            const uint64_t contentHash = TextureCache::hashData(&texSig.format, sizeof(texSig.format), texData[texID].contentHash);
+                            TextureCache::Desc desc;
+                            desc.width = texData[texID].width;
+                            desc.height = texData[texID].height;
+                            desc.mipLevels = Texture::kEntireMipChain;
+                            desc.format = texSig.format;
+                            Texture::SharedPtr pTexture = shareTextures ? TextureCache::findData(contentHash, desc) : nullptr;
+                            if(pTexture == nullptr)
+                            {
+                                pTexture = Texture::create2D(texData[texID].width, texData[texID].height, texSig.format, 1, Texture::kEntireMipChain, texSig.pData);
+                                pTexture->setSourceFilename(texData[texID].name);
+                                if(shareTextures)
+                                {
+                                    TextureCache::addData(contentHash, pTexture);
+                                }
+                            }
+                            textures[texSig] = pTexture;
+                            pModel->addTexture(pTexture);
+                            basicMaterial.pTextures[falcorType] = pTexture;
+                        }
+                    }
 
-                    glm::vec3 xyz(pPosition[0], pPosition[1], pPosition[2]);
-                    min = glm::min(min, xyz);
-                    max = glm::max(max, xyz);
-                }
+                    auto pMaterial = basicMaterial.convertToMaterial();
+                    auto pAddedMaterial = pModel->getOrAddMaterial(pMaterial);
+
+                    // Check it the material already existed in the model
+                    if(pAddedMaterial != pMaterial)
+                    {
+                        pMaterial = pAddedMaterial;
+                    }
+
+                    Mesh::SharedPtr pMesh;
+                    if(isPacked[meshIdx])
+                    {
+                        const GeometryPacker::MeshRange& range = packer.getMeshRange(packedRangeIDs[meshIdx][submesh]);
+                        pMesh = Mesh::create(range.pVao, meshData.numVertices, range.indexCount, range.firstIndex, range.baseVertex, RenderContext::Topology::TriangleList, pMaterial, submeshData.boundingBox, false);
+                    }
+                    else
+                    {
+                        // create the index buffer
+                        uint32_t numIndices = (uint32_t)submeshData.indices.size();
+                        ResourceFormat indexFormat = getIndexFormat(meshData.numVertices);
+                        auto pIB = createIndexBuffer(submeshData.indices.data(), numIndices, indexFormat, Buffer::AccessFlags::MapRead);
+                        pModel->addBuffer(pIB);
 
-                BoundingBox box = BoundingBox::fromMinMax(min, max);
+                        if(meshData.genTangents)
+                        {
+                            vbDescs[meshData.tangentBufferIndex].pBuffer = Buffer::create(submeshData.tangentData.size(), Buffer::BindFlags::Vertex, Buffer::AccessFlags::None, submeshData.tangentData.data());
+                            pModel->addBuffer(vbDescs[meshData.tangentBufferIndex].pBuffer);
 
-                // create the mesh                
-                auto pMesh = Mesh::create(vbDescs, numVertices, pIB, numIndices, RenderContext::Topology::TriangleList, pMaterial, box, false);
-                pModel->addMesh(std::move(pMesh));
-                meshToSubmeshesID[meshIdx].push_back(pModel->getMeshCount() - 1);
+                            vbDescs[meshData.bitangentBufferIndex].pBuffer = Buffer::create(submeshData.bitangentData.size(), Buffer::BindFlags::Vertex, Buffer::AccessFlags::None, submeshData.bitangentData.data());
+                            pModel->addBuffer(vbDescs[meshData.bitangentBufferIndex].pBuffer);
+                        }
+
+                        // create the mesh
+                        pMesh = Mesh::create(vbDescs, meshData.numVertices, pIB, numIndices, RenderContext::Topology::TriangleList, pMaterial, submeshData.boundingBox, false, indexFormat);
+                    }
+                    pMesh->setVertexQuantization(meshData.quantization);
+                    pMesh->setClusters(std::move(submeshData.clusters));
+                    if(meshData.pCpuVertices)
+                    {
+                        pMesh->setCpuGeometry(meshData.pCpuVertices, std::move(submeshData.indices));
+                    }
+                    pModel->addMesh(std::move(pMesh));
+                    meshToSubmeshesID[meshIdx].push_back(pModel->getMeshCount() - 1);
+                });
+
+                // Release the system memory copies
+                submeshData.indices = std::vector<uint32_t>();
+                submeshData.tangentData = std::vector<uint8_t>();
+                submeshData.bitangentData = std::vector<uint8_t>();
             }
         }
 
@@ -1006,4 +1256,362 @@ namespace Falcor
 
         return pModel;
     }
+
+    static bool isValidNativeRange(uint64_t offset, uint64_t size, size_t fileSize)
+    {
+        return (offset % kNativeModelAlignment) == 0 && offset <= fileSize && size <= fileSize - offset;
+    }
+
+    template<typename T>
+    static bool getNativeSection(const uint8_t* pFile, const NativeSectionDesc* pSection, const T*& pData, uint32_t& count)
+    {
+        pData = nullptr;
+        count = 0;
+        if(pSection == nullptr)
+        {
+            // Missing sections are empty
+            return true;
+        }
+
+        if(pSection->size != uint64_t(pSection->elementCount) * sizeof(T))
+        {
+            return false;
+        }
+        pData = (const T*)(pFile + pSection->offset);
+        count = pSection->elementCount;
+        return true;
+    }
+
+    // The size of a texture's mip chain, using the layout Texture::create2D() expects
+    static uint64_t calcNativeTextureDataSize(const NativeTextureDesc& desc)
+    {
+        ResourceFormat format = ResourceFormat(desc.format);
+        uint32_t blockWidth = getFormatWidthCompressionRatio(format);
+        uint32_t blockHeight = getFormatHeightCompressionRatio(format);
+        uint64_t size = 0;
+        for(uint32_t mip = 0; mip < desc.mipLevels; mip++)
+        {
+            uint32_t width = max(1U, desc.width >> mip);
+            uint32_t height = max(1U, desc.height >> mip);
+            size += uint64_t(getFormatBytesPerBlock(format)) * ((width + blockWidth - 1) / blockWidth) * ((height + blockHeight - 1) / blockHeight);
+        }
+        return size;
+    }
+
+    Model::SharedPtr BinaryModelImporter::createNativeModel(const uint8_t* pFile, size_t fileSize, uint32_t flags)
+    {
+        auto corrupted = [this]()
+        {
+            Logger::log(Logger::Level::Error, "Error when loading model " + mModelName + ".\nFile is corrupted.");
+            return nullptr;
+        };
+
+        // Header and table of contents
+        const NativeModelHeader* pHeader = (const NativeModelHeader*)pFile;
+        if(fileSize < sizeof(NativeModelHeader) || pHeader->fileSize != fileSize)
+        {
+            return corrupted();
+        }
+
+        if(pHeader->version != kNativeModelVersion)
+        {
+            Logger::log(Logger::Level::Error, "Error when loading model " + mModelName + ".\nUnsupported native model version " + std::to_string(pHeader->version));
+            return nullptr;
+        }
+
+        if(uint64_t(pHeader->sectionCount) * sizeof(NativeSectionDesc) > fileSize - sizeof(NativeModelHeader))
+        {
+            return corrupted();
+        }
+
+        const NativeSectionDesc* pToc = (const NativeSectionDesc*)(pFile + sizeof(NativeModelHeader));
+        const NativeSectionDesc* pSections[(uint32_t)NativeSectionType::Count] = {};
+        for(uint32_t i = 0; i < pHeader->sectionCount; i++)
+        {
+            if(isValidNativeRange(pToc[i].offset, pToc[i].size, fileSize) == false)
+            {
+                return corrupted();
+            }
+
+            // Unknown sections are ignored
+            if(pToc[i].type < (uint32_t)NativeSectionType::Count)
+            {
+                pSections[pToc[i].type] = &pToc[i];
+            }
+        }
+
+        const NativeBufferDesc* pBuffers;
+        const NativeTextureDesc* pTextures;
+        const NativeMaterialDesc* pMaterials;
+        const NativeVertexStreamDesc* pStreams;
+        const NativeVertexElementDesc* pElements;
+        const NativeMeshDesc* pMeshes;
+        const glm::mat4* pInstances;
+        const NativeClusterDesc* pClusters;
+        uint32_t bufferCount, textureCount, materialCount, streamCount, elementCount, meshCount, instanceCount, clusterCount;
+
+        bool valid = getNativeSection(pFile, pSections[(uint32_t)NativeSectionType::Buffers], pBuffers, bufferCount);
+        valid = valid && getNativeSection(pFile, pSections[(uint32_t)NativeSectionType::Textures], pTextures, textureCount);
+        valid = valid && getNativeSection(pFile, pSections[(uint32_t)NativeSectionType::Materials], pMaterials, materialCount);
+        valid = valid && getNativeSection(pFile, pSections[(uint32_t)NativeSectionType::VertexStreams], pStreams, streamCount);
+        valid = valid && getNativeSection(pFile, pSections[(uint32_t)NativeSectionType::VertexElements], pElements, elementCount);
+        valid = valid && getNativeSection(pFile, pSections[(uint32_t)NativeSectionType::Meshes], pMeshes, meshCount);
+        valid = valid && getNativeSection(pFile, pSections[(uint32_t)NativeSectionType::Instances], pInstances, instanceCount);
+        valid = valid && getNativeSection(pFile, pSections[(uint32_t)NativeSectionType::Clusters], pClusters, clusterCount);
+        if(valid == false)
+        {
+            return corrupted();
+        }
+
+        // All the names must be null-terminated inside the strings section
+        const NativeSectionDesc* pStringsSection = pSections[(uint32_t)NativeSectionType::Strings];
+        const char* pStrings = pStringsSection ? (const char*)(pFile + pStringsSection->offset) : nullptr;
+        const uint64_t stringsSize = pStringsSection ? pStringsSection->size : 0;
+        if(stringsSize && pStrings[stringsSize - 1] != '\0')
+        {
+            return corrupted();
+        }
+
+        auto pModel = Model::SharedPtr(new Model());
+        AsyncLoader::addItems(bufferCount + textureCount + meshCount);
+
+        // The buffers and the textures are created straight from the mapped file
+        std::vector<Buffer::SharedPtr> buffers(bufferCount);
+        for(uint32_t i = 0; i < bufferCount; i++)
+        {
+            const NativeBufferDesc& desc = pBuffers[i];
+            if(isValidNativeRange(desc.dataOffset, desc.size, fileSize) == false)
+            {
+                return corrupted();
+            }
+            AsyncLoader::upload([&]() {buffers[i] = Buffer::create((size_t)desc.size, Buffer::BindFlags(desc.bindFlags), Buffer::AccessFlags(desc.accessFlags), pFile + desc.dataOffset); });
+            pModel->addBuffer(buffers[i]);
+        }
+
+        for(uint32_t i = 0; i < textureCount; i++)
+        {
+            const NativeTextureDesc& desc = pTextures[i];
+            if(desc.format == (uint32_t)ResourceFormat::Unknown || desc.format > (uint32_t)ResourceFormat::BC5Snorm || desc.width == 0 || desc.height == 0 || desc.mipLevels == 0 || desc.mipLevels > 32 ||
+                desc.nameOffset >= stringsSize || isValidNativeRange(desc.dataOffset, desc.dataSize, fileSize) == false || desc.dataSize < calcNativeTextureDataSize(desc))
+            {
+                return corrupted();
+            }
+        }
+
+        // Textures shared with models loaded before are found in the TextureCache by their content. Compression replaces the textures' data in place, so those models keep their own.
+        const bool shareTextures = (flags & Model::CompressTextures) == 0;
+        std::vector<uint64_t> textureHashes(textureCount);
+        if(shareTextures)
+        {
+            Model::getImportThreadPool()->run(textureCount, [&](uint32_t taskID)
+            {
+                const NativeTextureDesc& desc = pTextures[taskID];
+                const uint32_t params[] = { desc.width, desc.height, desc.mipLevels, desc.format };
+                textureHashes[taskID] = TextureCache::hashData(pFile + desc.dataOffset, (size_t)calcNativeTextureDataSize(desc), TextureCache::hashData(params, sizeof(params)));
+            });
+        }
+
+        std::vector<Texture::SharedPtr> textures(textureCount);
+        for(uint32_t i = 0; i < textureCount; i++)
+        {
+            const NativeTextureDesc& desc = pTextures[i];
+            AsyncLoader::upload([&]()
+            {
+                TextureCache::Desc cacheDesc;
+                cacheDesc.width = desc.width;
+                cacheDesc.height = desc.height;
+                cacheDesc.mipLevels = desc.mipLevels;
+                cacheDesc.format = ResourceFormat(desc.format);
+                textures[i] = shareTextures ? TextureCache::findData(textureHashes[i], cacheDesc) : nullptr;
+                if(textures[i] == nullptr)
+                {
+                    textures[i] = Texture::create2D(desc.width, desc.height, ResourceFormat(desc.format), 1, desc.mipLevels, pFile + desc.dataOffset);
+                    textures[i]->setSourceFilename(pStrings + desc.nameOffset);
+                    if(shareTextures)
+                    {
+                        TextureCache::addData(textureHashes[i], textures[i]);
+                    }
+                }
+            });
+            pModel->addTexture(textures[i]);
+        }
+
+        std::vector<Material::SharedPtr> materials(materialCount);
+        for(uint32_t i = 0; i < materialCount; i++)
+        {
+            const NativeMaterialDesc& desc = pMaterials[i];
+            BasicMaterial basicMaterial;
+            basicMaterial.diffuseColor = desc.diffuseColor;
+            basicMaterial.opacity = desc.opacity;
+            basicMaterial.specularColor = desc.specularColor;
+            basicMaterial.shininess = desc.shininess;
+            basicMaterial.transparentColor = desc.transparentColor;
+            basicMaterial.IoR = desc.IoR;
+            basicMaterial.emissiveColor = desc.emissiveColor;
+            basicMaterial.bumpScale = desc.bumpScale;
+            basicMaterial.bumpOffset = desc.bumpOffset;
+            for(uint32_t map = 0; map < BasicMaterial::MapType::Count; map++)
+            {
+                uint32_t textureID = desc.textureIDs[map];
+                if(textureID != kNativeModelInvalidID)
+                {
+                    if(textureID >= textureCount)
+                    {
+                        return corrupted();
+                    }
+                    basicMaterial.pTextures[map] = textures[textureID];
+                }
+            }
+            materials[i] = pModel->getOrAddMaterial(basicMaterial.convertToMaterial());
+        }
+
+        // Meshes which draw ranges of the same buffers share a VAO. The key is the buffers and the vertex layout.
+        std::map<std::string, Vao::SharedPtr> vaos;
+        std::map<std::string, CpuVertexData::SharedPtr> cpuVertices;
+        for(uint32_t meshID = 0; meshID < meshCount; meshID++)
+        {
+            const NativeMeshDesc& desc = pMeshes[meshID];
+            if(uint64_t(desc.firstStream) + desc.streamCount > streamCount || uint64_t(desc.firstInstance) + desc.instanceCount > instanceCount || desc.materialID >= materialCount ||
+                desc.topology > (uint32_t)RenderContext::Topology::TriangleStrip || (desc.indexBufferID != kNativeModelInvalidID && desc.indexBufferID >= bufferCount) ||
+                (desc.indexFormat != (uint32_t)ResourceFormat::R16Uint && desc.indexFormat != (uint32_t)ResourceFormat::R32Uint))
+            {
+                return corrupted();
+            }
+            if(desc.indexBufferID != kNativeModelInvalidID && (uint64_t(desc.firstIndex) + desc.indexCount) * getFormatBytesPerBlock(ResourceFormat(desc.indexFormat)) > pBuffers[desc.indexBufferID].size)
+            {
+                return corrupted();
+            }
+            if(uint64_t(desc.firstCluster) + desc.clusterCount > clusterCount || (desc.clusterCount && desc.indexBufferID == kNativeModelInvalidID))
+            {
+                return corrupted();
+            }
+
+            std::vector<MeshCluster> clusters(desc.clusterCount);
+            for(uint32_t i = 0; i < desc.clusterCount; i++)
+            {
+                const NativeClusterDesc& cluster = pClusters[desc.firstCluster + i];
+                if(uint64_t(cluster.firstIndex) + cluster.indexCount > desc.indexCount)
+                {
+                    return corrupted();
+                }
+                clusters[i].firstIndex = cluster.firstIndex;
+                clusters[i].indexCount = cluster.indexCount;
+                clusters[i].center = cluster.center;
+                clusters[i].radius = cluster.radius;
+                clusters[i].coneAxis = cluster.coneAxis;
+                clusters[i].coneCutoff = cluster.coneCutoff;
+            }
+
+            std::string vaoKey = std::to_string(desc.indexBufferID) + ":" + std::to_string(desc.indexFormat);
+            Vao::VertexBufferDescVector vbDescs(desc.streamCount);
+            for(uint32_t i = 0; i < desc.streamCount; i++)
+            {
+                const NativeVertexStreamDesc& stream = pStreams[desc.firstStream + i];
+                if(stream.bufferID >= bufferCount || uint64_t(stream.firstElement) + stream.elementCount > elementCount)
+                {
+                    return corrupted();
+                }
+
+                vbDescs[i].pBuffer = buffers[stream.bufferID];
+                vbDescs[i].stride = stream.stride;
+                vaoKey += "|" + std::to_string(stream.bufferID) + ":" + std::to_string(stream.stride);
+                for(uint32_t e = 0; e < stream.elementCount; e++)
+                {
+                    const NativeVertexElementDesc& element = pElements[stream.firstElement + e];
+                    if(element.nameOffset >= stringsSize || element.format == (uint32_t)ResourceFormat::Unknown || element.format > (uint32_t)ResourceFormat::BC5Snorm || element.arraySize == 0)
+                    {
+                        return corrupted();
+                    }
+
+                    // The element must be inside the vertex, otherwise it's read from the next vertex or past the end of the buffer
+                    if(uint64_t(element.offset) + uint64_t(getFormatBytesPerBlock(ResourceFormat(element.format))) * element.arraySize > stream.stride)
+                    {
+                        return corrupted();
+                    }
+                    vbDescs[i].pLayout->addElement(pStrings + element.nameOffset, element.offset, ResourceFormat(element.format), element.arraySize, element.shaderLocation);
+                    vaoKey += "," + std::to_string(element.nameOffset) + ":" + std::to_string(element.offset) + ":" + std::to_string(element.format) + ":" + std::to_string(element.arraySize) + ":" + std::to_string(element.shaderLocation);
+                }
+            }
+
+            Buffer::SharedPtr pIB = (desc.indexBufferID != kNativeModelInvalidID) ? buffers[desc.indexBufferID] : nullptr;
+            BoundingBox box;
+            box.center = desc.boundingBoxCenter;
+            box.extent = desc.boundingBoxExtent;
+            VertexQuantization quantization;
+            quantization.positionScale = desc.positionScale;
+            quantization.positionOffset = desc.positionOffset;
+            quantization.octahedralDirections = (desc.octahedralDirections != 0);
+
+            // The CPU copy is decoded from the mapped file. Meshes which draw the same vertex range share it.
+            CpuVertexData::SharedPtr pCpuVertices;
+            std::vector<uint32_t> cpuIndices;
+            if((flags & Model::KeepCpuGeometry) && pIB)
+            {
+                std::vector<const uint8_t*> vertexData(desc.streamCount);
+                for(uint32_t i = 0; i < desc.streamCount; i++)
+                {
+                    const NativeVertexStreamDesc& stream = pStreams[desc.firstStream + i];
+                    const NativeBufferDesc& buffer = pBuffers[stream.bufferID];
+                    if(desc.baseVertex < 0 || (uint64_t(desc.baseVertex) + desc.vertexCount) * stream.stride > buffer.size)
+                    {
+                        return corrupted();
+                    }
+                    vertexData[i] = pFile + buffer.dataOffset + uint64_t(desc.baseVertex) * stream.stride;
+                }
+
+                CpuVertexData::SharedPtr& pShared = cpuVertices[vaoKey + "@" + std::to_string(desc.baseVertex) + ":" + std::to_string(desc.vertexCount)];
+                if(pShared == nullptr)
+                {
+                    pShared = createCpuVertexData(vbDescs, vertexData, desc.vertexCount, quantization);
+                }
+                pCpuVertices = pShared;
+
+                const uint8_t* pIndexData = pFile + pBuffers[desc.indexBufferID].dataOffset;
+                cpuIndices.resize(desc.indexCount);
+                if(desc.indexFormat == (uint32_t)ResourceFormat::R16Uint)
+                {
+                    const uint16_t* pSrc = (const uint16_t*)pIndexData + desc.firstIndex;
+                    std::copy(pSrc, pSrc + desc.indexCount, cpuIndices.begin());
+                }
+                else
+                {
+                    const uint32_t* pSrc = (const uint32_t*)pIndexData + desc.firstIndex;
+                    std::copy(pSrc, pSrc + desc.indexCount, cpuIndices.begin());
+                }
+
+                // The CPU geometry is indexed relative to the mesh's vertex range. Indices outside of it would read past the decoded vertices.
+                for(uint32_t index : cpuIndices)
+                {
+                    if(index >= desc.vertexCount)
+                    {
+                        return corrupted();
+                    }
+                }
+            }
+
+            Vao::SharedPtr& pVao = vaos[vaoKey];
+            Mesh::SharedPtr pMesh;
+            AsyncLoader::upload([&]()
+            {
+                if(pVao == nullptr)
+                {
+                    pVao = Vao::create(vbDescs, pIB, ResourceFormat(desc.indexFormat));
+                }
+                pMesh = Mesh::create(pVao, desc.vertexCount, desc.indexCount, desc.firstIndex, desc.baseVertex, RenderContext::Topology(desc.topology), materials[desc.materialID], box, false);
+            });
+            pMesh->setVertexQuantization(quantization);
+            pMesh->setClusters(std::move(clusters));
+            if(pCpuVertices)
+            {
+                pMesh->setCpuGeometry(pCpuVertices, std::move(cpuIndices));
+            }
+            for(uint32_t i = 0; i < desc.instanceCount; i++)
+            {
+                pMesh->addInstance(pInstances[desc.firstInstance + i]);
+            }
+            pModel->addMesh(std::move(pMesh));
+        }
+
+        return pModel;
+    }
 }
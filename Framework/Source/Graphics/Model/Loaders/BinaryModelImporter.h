@@ -48,6 +48,7 @@ namespace Falcor
     private:
         BinaryModelImporter(const std::string& fullpath);
         Model::SharedPtr createModel(uint32_t flags);
+        Model::SharedPtr createNativeModel(const uint8_t* pFile, size_t fileSize, uint32_t flags);
 
         std::string mModelName;
         BinaryFileStream mStream;
@@ -0,0 +1,216 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <stdint.h>
+#include "glm/vec3.hpp"
+
+//------------------------------------------------------------------------
+/*
+
+Falcor native model file format v4
+----------------------------------
+
+- The file is designed to be memory-mapped. The data is stored in the layout the GPU expects, so vertex buffers, index buffers and textures can be created directly from pointers into the file.
+- All values are little-endian. Offsets are in bytes, relative to the start of the file.
+- Every section and every blob in the data section starts at a 16-byte aligned offset.
+- Names are offsets into the strings section, which holds null-terminated strings.
+- Each line describes: <ofs_bytes> <size_bytes> <Type> <name> (<comments>)
+
+File
+0       8       char[8] formatID            ("FalcorMd")
+8       4       uint    formatVersion       (4)
+12      4       uint    sectionCount
+16      8       uint64  fileSize
+24      n*24    array   SectionDesc         (sectionCount, the table of contents)
+?       ?       bytes   sections            (in any order)
+
+SectionDesc
+0       4       uint    type                (NativeSectionType)
+4       4       uint    elementCount        (the number of array elements, or 0 for the strings and data sections)
+8       8       uint64  offset
+16      8       uint64  size
+
+Sections
+Strings         char[]                      Null-terminated names
+Buffers         NativeBufferDesc[]          Vertex and index buffers. Meshes can share buffers, each mesh draws a range of its index buffer.
+Textures        NativeTextureDesc[]         2D textures, with their entire pre-baked mip chain
+Materials       NativeMaterialDesc[]        Texture IDs are indices into the textures section
+VertexStreams   NativeVertexStreamDesc[]    One per vertex buffer of a mesh
+VertexElements  NativeVertexElementDesc[]   The layout of the vertex streams
+Meshes          NativeMeshDesc[]
+Instances       glm::mat4[]                 Mesh instance transforms
+Data            bytes                       Buffer and texture data, referenced by the descriptors
+Clusters        NativeClusterDesc[]         Optional. The clusters of the meshes which were split, see MeshClusters.h.
+
+Version history
+1       Initial version
+2       NativeMeshDesc holds the vertex quantization parameters
+3       NativeMeshDesc holds the index format, the first index and the base vertex
+4       Clusters section. NativeMeshDesc holds the mesh's cluster range.
+
+*/
+//------------------------------------------------------------------------
+
+namespace Falcor
+{
+    static const char kNativeModelFormatID[] = "FalcorMd";
+    static const uint32_t kNativeModelVersion = 4;
+    static const uint32_t kNativeModelAlignment = 16;
+    static const uint32_t kNativeModelInvalidID = uint32_t(-1);
+
+    enum class NativeSectionType : uint32_t
+    {
+        Strings,
+        Buffers,
+        Textures,
+        Materials,
+        VertexStreams,
+        VertexElements,
+        Meshes,
+        Instances,
+        Data,
+        Clusters,
+
+        Count
+    };
+
+    struct NativeModelHeader
+    {
+        char formatID[8];
+        uint32_t version;
+        uint32_t sectionCount;
+        uint64_t fileSize;
+    };
+
+    struct NativeSectionDesc
+    {
+        uint32_t type;
+        uint32_t elementCount;
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    struct NativeBufferDesc
+    {
+        uint64_t dataOffset;
+        uint64_t size;
+        uint32_t bindFlags;         ///< Buffer::BindFlags
+        uint32_t accessFlags;       ///< Buffer::AccessFlags
+        uint32_t reserved[2];
+    };
+
+    struct NativeTextureDesc
+    {
+        uint64_t dataOffset;        ///< The mip levels are stored one after the other, starting with the most detailed one
+        uint64_t dataSize;
+        uint32_t width;
+        uint32_t height;
+        uint32_t mipLevels;
+        uint32_t format;            ///< ResourceFormat
+        uint32_t nameOffset;        ///< The texture's source filename
+        uint32_t reserved[3];
+    };
+
+    struct NativeMaterialDesc
+    {
+        glm::vec3 diffuseColor;
+        float opacity;
+        glm::vec3 specularColor;
+        float shininess;
+        glm::vec3 transparentColor;
+        float IoR;
+        glm::vec3 emissiveColor;
+        float bumpScale;
+        float bumpOffset;
+        uint32_t textureIDs[8];     ///< One per BasicMaterial::MapType. kNativeModelInvalidID if the map is not used.
+        uint32_t reserved[3];
+    };
+
+    struct NativeVertexStreamDesc
+    {
+        uint32_t bufferID;
+        uint32_t stride;
+        uint32_t firstElement;
+        uint32_t elementCount;
+    };
+
+    struct NativeVertexElementDesc
+    {
+        uint32_t nameOffset;
+        uint32_t offset;
+        uint32_t format;            ///< ResourceFormat
+        uint32_t arraySize;
+        uint32_t shaderLocation;
+        uint32_t reserved[3];
+    };
+
+    struct NativeMeshDesc
+    {
+        uint32_t firstStream;
+        uint32_t streamCount;
+        uint32_t vertexCount;
+        uint32_t indexBufferID;     ///< kNativeModelInvalidID for non-indexed meshes
+        uint32_t indexCount;
+        uint32_t topology;          ///< RenderContext::Topology
+        uint32_t materialID;
+        uint32_t firstInstance;
+        uint32_t instanceCount;
+        glm::vec3 boundingBoxCenter;
+        glm::vec3 boundingBoxExtent;
+        glm::vec3 positionScale;        ///< See VertexQuantization
+        glm::vec3 positionOffset;
+        uint32_t octahedralDirections;  ///< 1 if normals, tangents and bitangents are octahedral-encoded
+        uint32_t indexFormat;       ///< ResourceFormat. R16Uint or R32Uint.
+        uint32_t firstIndex;
+        int32_t baseVertex;
+        uint32_t firstCluster;
+        uint32_t clusterCount;      ///< 0 if the mesh isn't split into clusters
+        uint32_t reserved[1];
+    };
+
+    struct NativeClusterDesc
+    {
+        uint32_t firstIndex;        ///< Relative to the mesh's first index
+        uint32_t indexCount;
+        glm::vec3 center;
+        float radius;
+        glm::vec3 coneAxis;
+        float coneCutoff;
+        uint32_t reserved[2];
+    };
+
+    static_assert(sizeof(NativeModelHeader) == 24, "NativeModelHeader layout changed");
+    static_assert(sizeof(NativeSectionDesc) == 24, "NativeSectionDesc layout changed");
+    static_assert(sizeof(NativeBufferDesc) == 32, "NativeBufferDesc layout changed");
+    static_assert(sizeof(NativeTextureDesc) == 48, "NativeTextureDesc layout changed");
+    static_assert(sizeof(NativeMaterialDesc) == 112, "NativeMaterialDesc layout changed");
+    static_assert(sizeof(NativeVertexStreamDesc) == 16, "NativeVertexStreamDesc layout changed");
+    static_assert(sizeof(NativeVertexElementDesc) == 32, "NativeVertexElementDesc layout changed");
+    static_assert(sizeof(NativeMeshDesc) == 112, "NativeMeshDesc layout changed");
+    static_assert(sizeof(NativeClusterDesc) == 48, "NativeClusterDesc layout changed");
+}
@@ -39,7 +39,7 @@
 
 namespace Falcor
 { 
-	uint32_t Mesh::sMeshCounter = 0;
+	std::atomic<uint32_t> Mesh::sMeshCounter(0);
     Mesh::~Mesh() = default;
 
     Mesh::SharedPtr Mesh::create(const Vao::VertexBufferDescVector& vertexBuffers,
@@ -49,15 +49,31 @@ namespace Falcor
         RenderContext::Topology topology,
         const Material::SharedPtr& pMaterial,
         const BoundingBox& boundingBox,
+        bool hasBones,
+        ResourceFormat indexFormat)
+    {
+        Vao::SharedPtr pVao = Vao::create(vertexBuffers, pIndexBuffer, indexFormat);
+        return SharedPtr(new Mesh(pVao, vertexCount, indexCount, 0, 0, topology, pMaterial, boundingBox, hasBones));
+    }
+
+    Mesh::SharedPtr Mesh::create(const Vao::SharedPtr& pVao,
+        uint32_t vertexCount,
+        uint32_t indexCount,
+        uint32_t firstIndex,
+        int32_t baseVertex,
+        RenderContext::Topology topology,
+        const Material::SharedPtr& pMaterial,
+        const BoundingBox& boundingBox,
         bool hasBones)
     {
-        return SharedPtr(new Mesh(vertexBuffers, vertexCount, pIndexBuffer, indexCount, topology, pMaterial, boundingBox, hasBones));
+        return SharedPtr(new Mesh(pVao, vertexCount, indexCount, firstIndex, baseVertex, topology, pMaterial, boundingBox, hasBones));
     }
 
-    Mesh::Mesh(const Vao::VertexBufferDescVector& vertexBuffers,
+    Mesh::Mesh(const Vao::SharedPtr& pVao,
         uint32_t vertexCount,
-        const Buffer::SharedPtr& pIndexBuffer,
         uint32_t indexCount,
+        uint32_t firstIndex,
+        int32_t baseVertex,
         RenderContext::Topology topology,
         const Material::SharedPtr& pMaterial,
         const BoundingBox& boundingBox,
@@ -81,101 +97,265 @@ namespace Falcor
         }
 
         mIndexCount = indexCount;
+        mFirstIndex = firstIndex;
+        mBaseVertex = baseVertex;
         mPrimitiveCount = mIndexCount / VertsPerPrim;
         mTopology = topology;
         mpMaterial = pMaterial;
         mBoundingBox = boundingBox;
         mHasBones = hasBones;
+        mpVao = pVao;
+    }
 
-        mpVao = Vao::create(vertexBuffers, pIndexBuffer);
+    void Mesh::setCpuGeometry(const CpuVertexData::SharedPtr& pVertices, std::vector<uint32_t> indices)
+    {
+        assert(pVertices == nullptr || (pVertices->positions.size() == mVertexCount && indices.size() == mIndexCount));
+        mpCpuVertices = pVertices;
+        mCpuIndices = std::move(indices);
     }
 
-    void Mesh::applyTransform(const glm::mat4& Transform) 
+    std::vector<uint32_t> Mesh::getIndices() const
     {
-        // Transform geometry, keeping track of min/max
-        glm::vec3 posMin(std::numeric_limits<float>::max(),std::numeric_limits<float>::max(),std::numeric_limits<float>::max());
-        glm::vec3 posMax(std::numeric_limits<float>::min(),std::numeric_limits<float>::min(),std::numeric_limits<float>::min());
-        for(uint32_t i=0u; i<mpVao->getVertexBuffersCount(); ++i)
+        if(mpCpuVertices)
         {
-            const auto& pLayout = mpVao->getVertexBufferLayout(i);
-            const uint32_t stride = mpVao->getVertexBufferStride(i);
-            Buffer* pBuffer = const_cast<Buffer*>(mpVao->getVertexBuffer(i).get());
-            size_t numVerts = pBuffer->getSize() / stride;
+            return mCpuIndices;
+        }
 
-            float* tempData = new float[(pBuffer->getSize()+sizeof(float)-1)/sizeof(float)];
-            pBuffer->readData(tempData, 0,pBuffer->getSize());
+        std::vector<uint32_t> indices(mIndexCount);
+        const Buffer* pIB = mpVao->getIndexBuffer().get();
+        if(pIB == nullptr || mIndexCount == 0)
+        {
+            return indices;
+        }
+
+        // Most of the buffers we use were created without any access flags, so can't be mapped.
+        // We copy the mesh's range to a temporary staging buffer.
+        const uint32_t indexSize = getFormatBytesPerBlock(mpVao->getIndexBufferFormat());
+        const size_t size = size_t(mIndexCount) * indexSize;
+        auto pStaging = Buffer::create(size, Buffer::BindFlags::None, Buffer::AccessFlags::MapRead, nullptr);
+        pIB->copy(pStaging.get(), size_t(mFirstIndex) * indexSize, 0, size);
+
+        const void* pData = pStaging->map(Buffer::MapType::Read);
+        if(indexSize == sizeof(uint16_t))
+        {
+            const uint16_t* pSrc = (const uint16_t*)pData;
+            std::copy(pSrc, pSrc + mIndexCount, indices.begin());
+        }
+        else
+        {
+            memcpy(indices.data(), pData, size);
+        }
+        pStaging->unmap();
+        return indices;
+    }
 
-            for(uint32_t j = 0u; j<pLayout->getElementCount(); ++j)
+    std::vector<glm::vec3> Mesh::getNormals() const
+    {
+        if(mpCpuVertices)
+        {
+            return mpCpuVertices->normals;
+        }
+
+        // Read the mesh's range of each vertex buffer back, and decode it the same way the importers create the CPU copy
+        Vao::VertexBufferDescVector vbDescs(mpVao->getVertexBuffersCount());
+        std::vector<std::vector<uint8_t>> readback(vbDescs.size());
+        std::vector<const uint8_t*> vertexData(vbDescs.size());
+        for(uint32_t i = 0; i < mpVao->getVertexBuffersCount(); i++)
+        {
+            vbDescs[i].stride = mpVao->getVertexBufferStride(i);
+            vbDescs[i].pLayout = std::const_pointer_cast<VertexLayout>(mpVao->getVertexBufferLayout(i));
+
+            const Buffer* pVB = mpVao->getVertexBuffer(i).get();
+            const size_t offset = size_t(mBaseVertex) * vbDescs[i].stride;
+            const size_t size = size_t(mVertexCount) * vbDescs[i].stride;
+            if(offset + size > pVB->getSize())
+            {
+                Logger::log(Logger::Level::Error, "Mesh::getNormals() - the mesh's vertex range is out of the bounds of its vertex buffers");
+                return std::vector<glm::vec3>();
+            }
+            readback[i].resize(size);
+            pVB->readData(readback[i].data(), offset, size);
+            vertexData[i] = readback[i].data();
+        }
+
+        CpuVertexData::SharedPtr pVertices = createCpuVertexData(vbDescs, vertexData, mVertexCount, mVertexQuantization);
+        return pVertices ? pVertices->normals : std::vector<glm::vec3>();
+    }
+
+    // Transform the positions and normals of a vertex buffer by reading it back from the GPU. With transformData set to false, the buffer was already transformed and only the position bounds are computed.
+    static void transformVertexBuffer(Buffer* pBuffer, const VertexLayout* pLayout, uint32_t stride, const glm::mat4& transform, bool transformData, glm::vec3& posMin, glm::vec3& posMax)
+    {
+        size_t numVerts = pBuffer->getSize() / stride;
+
+        float* tempData = new float[(pBuffer->getSize()+sizeof(float)-1)/sizeof(float)];
+        pBuffer->readData(tempData, 0,pBuffer->getSize());
+
+        for(uint32_t j = 0u; j<pLayout->getElementCount(); ++j)
+        {
+            glm::mat4 matrix;
+            bool doMinMax;
+            if(pLayout->getElementShaderLocation(j) == VERTEX_POSITION_LOC)
+            {
+                matrix = transformData ? transform : glm::mat4();
+                doMinMax = true;
+            }
+            else if(pLayout->getElementShaderLocation(j) == VERTEX_NORMAL_LOC && transformData)
             {
-                glm::mat4 matrix;
-                bool doMinMax;
-                if(pLayout->getElementShaderLocation(j) == VERTEX_POSITION_LOC)
+                matrix = glm::transpose(glm::inverse(transform));
+                doMinMax = false;
+            }
+            else continue;
+
+            const uint32_t channels = getFormatChannelCount(pLayout->getElementFormat(j));
+
+            for(size_t k = 0 ; k < numVerts ; ++k)
+            {   // TODO: optimize
+                float* pElement = tempData + k*stride / sizeof(float) + pLayout->getElementOffset(j) / sizeof(float);
+                glm::vec4 vert;
+                switch (channels) 
                 {
-                    matrix = Transform;
-                    doMinMax = true;
+                    case 1: 
+                        vert=glm::vec4(pElement[0],  0.0f,  0.0f,  1.0f); 
+                        break;
+                    case 2: 
+                        vert=glm::vec4(pElement[0],pElement[1],  0.0f,  1.0f); 
+                        break;
+                    case 3: 
+                        vert=glm::vec4(pElement[0],pElement[1],pElement[2],  1.0f); 
+                        break;
+                    case 4: 
+                        vert=glm::vec4(pElement[0],pElement[1],pElement[2],pElement[3]); 
+                        break;
+                    default: 
+                        should_not_get_here();
                 }
-                else if(pLayout->getElementShaderLocation(j) == VERTEX_NORMAL_LOC)
+
+                vert = matrix * vert;
+                switch (channels) 
                 {
-                    matrix = glm::transpose(glm::inverse(Transform));
-                    doMinMax = false;
+                    case 4: 
+                        pElement[3]=vert.w; // fallthrough
+                    case 3: 
+                        pElement[2]=vert.z; // fallthrough
+                    case 2: 
+                        pElement[1]=vert.y; // fallthrough
+                    case 1: 
+                        pElement[0]=vert.x; 
+                        break;
+                    default: 
+                        should_not_get_here();
                 }
-                else continue;
 
-                const uint32_t channels = getFormatChannelCount(pLayout->getElementFormat(j));
+                if (doMinMax) 
+                {
+                    //glm::vec3 xyz(Vert.x,Vert.y,Vert.z);
+                    posMin = glm::vec3(std::min(posMin.x,vert.x),std::min(posMin.y,vert.y),std::min(posMin.z,vert.z)); //glm::min(PosMin,xyz);
+                    posMax = glm::vec3(std::max(posMax.x,vert.x),std::max(posMax.y,vert.y),std::max(posMax.z,vert.z)); //glm::max(PosMax,xyz);
+                }
+            }
+        }
 
-                for(size_t k = 0 ; k < numVerts ; ++k)
-                {   // TODO: optimize
-                    float* pElement = tempData + k*stride / sizeof(float) + pLayout->getElementOffset(j) / sizeof(float);
-                    glm::vec4 vert;
-                    switch (channels) 
-                    {
-                        case 1: 
-                            vert=glm::vec4(pElement[0],  0.0f,  0.0f,  1.0f); 
-                            break;
-                        case 2: 
-                            vert=glm::vec4(pElement[0],pElement[1],  0.0f,  1.0f); 
-                            break;
-                        case 3: 
-                            vert=glm::vec4(pElement[0],pElement[1],pElement[2],  1.0f); 
-                            break;
-                        case 4: 
-                            vert=glm::vec4(pElement[0],pElement[1],pElement[2],pElement[3]); 
-                            break;
-                        default: 
-                            should_not_get_here();
-                    }
+        if(transformData)
+        {
+            pBuffer->updateData(tempData, 0, pBuffer->getSize(), true);
+        }
+        delete [] tempData;
+    }
+
+    void Mesh::applyTransform(const glm::mat4& transform, std::set<const void*>* pTransformedData)
+    {
+        // Returns true the first time it's called for a piece of data. Without a set, everything is transformed.
+        auto markTransformed = [pTransformedData](const void* pData)
+        {
+            return (pTransformedData == nullptr) || pTransformedData->insert(pData).second;
+        };
 
-                    vert = matrix * vert;
-                    switch (channels) 
-                    {
-                        case 4: 
-                            pElement[3]=vert.w; // fallthrough
-                        case 3: 
-                            pElement[2]=vert.z; // fallthrough
-                        case 2: 
-                            pElement[1]=vert.y; // fallthrough
-                        case 1: 
-                            pElement[0]=vert.x; 
-                            break;
-                        default: 
-                            should_not_get_here();
-                    }
 
-                    if (doMinMax) 
+        if(mVertexQuantization.isQuantized())
+        {
+            Logger::log(Logger::Level::Error, "Mesh::applyTransform() doesn't support quantized vertices. Load the model without Model::QuantizeVertices and Model::QuantizePositions.");
+            return;
+        }
+        if(mpVao->getVertexBuffer(0)->getSize() != size_t(mpVao->getVertexBufferStride(0)) * mVertexCount)
+        {
+            Logger::log(Logger::Level::Error, "Mesh::applyTransform() doesn't support meshes which share their vertex buffers. Load the model without Model::PackGeometry.");
+            return;
+        }
+
+        // Transform geometry, keeping track of min/max
+        glm::vec3 posMin(std::numeric_limits<float>::max());
+        glm::vec3 posMax(-std::numeric_limits<float>::max());
+        if(mpCpuVertices)
+        {
+            // Transform the CPU copy, then upload the buffers which only hold positions or normals. Other buffers are transformed on the GPU copy.
+            std::vector<glm::vec3>& positions = mpCpuVertices->positions;
+            std::vector<glm::vec3>& normals = mpCpuVertices->normals;
+            if(markTransformed(mpCpuVertices.get()))
+            {
+                transformVectors(positions.data(), mVertexCount, transform, true, posMin, posMax);
+                if(normals.size())
+                {
+                    glm::vec3 normalMin, normalMax;
+                    transformVectors(normals.data(), mVertexCount, glm::transpose(glm::inverse(transform)), false, normalMin, normalMax);
+                }
+            }
+            else
+            {
+                for(const auto& pos : positions)
+                {
+                    posMin = glm::min(posMin, pos);
+                    posMax = glm::max(posMax, pos);
+                }
+            }
+
+            for(uint32_t i = 0u; i < mpVao->getVertexBuffersCount(); ++i)
+            {
+                const auto& pLayout = mpVao->getVertexBufferLayout(i);
+                const uint32_t stride = mpVao->getVertexBufferStride(i);
+                Buffer* pBuffer = const_cast<Buffer*>(mpVao->getVertexBuffer(i).get());
+                if(markTransformed(pBuffer) == false)
+                {
+                    continue;
+                }
+
+                const std::vector<glm::vec3>* pSrc = nullptr;
+                for(uint32_t j = 0u; j < pLayout->getElementCount(); ++j)
+                {
+                    uint32_t location = pLayout->getElementShaderLocation(j);
+                    if(location == VERTEX_POSITION_LOC || location == VERTEX_NORMAL_LOC)
                     {
-                        //glm::vec3 xyz(Vert.x,Vert.y,Vert.z);
-                        posMin = glm::vec3(std::min(posMin.x,vert.x),std::min(posMin.y,vert.y),std::min(posMin.z,vert.z)); //glm::min(PosMin,xyz);
-                        posMax = glm::vec3(std::max(posMax.x,vert.x),std::max(posMax.y,vert.y),std::max(posMax.z,vert.z)); //glm::max(PosMax,xyz);
+                        pSrc = (location == VERTEX_POSITION_LOC) ? &positions : &normals;
                     }
                 }
-            }
+                if(pSrc == nullptr)
+                {
+                    continue;
+                }
 
-            pBuffer->updateData(tempData, 0, pBuffer->getSize(), true);
-            delete [] tempData;
+                if(pLayout->getElementCount() == 1 && pLayout->getElementFormat(0) == ResourceFormat::RGB32Float && stride == sizeof(glm::vec3) && pSrc->size() == mVertexCount)
+                {
+                    pBuffer->updateData(pSrc->data(), 0, pBuffer->getSize(), true);
+                }
+                else
+                {
+                    glm::vec3 unusedMin, unusedMax;
+                    transformVertexBuffer(pBuffer, pLayout.get(), stride, transform, true, unusedMin, unusedMax);
+                }
+            }
+        }
+        else
+        {
+            for(uint32_t i = 0u; i < mpVao->getVertexBuffersCount(); ++i)
+            {
+                const auto& pLayout = mpVao->getVertexBufferLayout(i);
+                Buffer* pBuffer = const_cast<Buffer*>(mpVao->getVertexBuffer(i).get());
+                transformVertexBuffer(pBuffer, pLayout.get(), mpVao->getVertexBufferStride(i), transform, markTransformed(pBuffer), posMin, posMax);
+            }
         }
 
         // Update bounding box
         mBoundingBox = BoundingBox::fromMinMax(posMin,posMax);
+        transformMeshClusters(mClusters.data(), (uint32_t)mClusters.size(), transform, mClusters.data());
 
         // Update instances
         mInstanceBoundingBox.clear();
@@ -184,6 +364,16 @@ namespace Falcor
             BoundingBox box = mBoundingBox.transform(matrix);
             mInstanceBoundingBox.push_back(box);
         }
+        updateInstanceBoundingBoxArray();
+    }
+
+    void Mesh::updateInstanceBoundingBoxArray()
+    {
+        mInstanceBoundingBoxArray.resize(mInstanceBoundingBox.size());
+        for(size_t i = 0; i < mInstanceBoundingBox.size(); i++)
+        {
+            mInstanceBoundingBoxArray.set(i, mInstanceBoundingBox[i]);
+        }
     }
 
     void Mesh::addInstance(const glm::mat4& transform)
@@ -193,6 +383,7 @@ namespace Falcor
         mInstanceMatrices.push_back(transform);
         BoundingBox Bbox = mBoundingBox.transform(transform);
         mInstanceBoundingBox.push_back(Bbox);
+        mInstanceBoundingBoxArray.push_back(Bbox);
     }
 
     void Mesh::deleteCulledInstances(const Camera* pCamera)
@@ -219,6 +410,7 @@ namespace Falcor
         auto boxPred = [&zeroBbox](BoundingBox& b) {return b == zeroBbox; };
         auto& boxEnd = std::remove_if(mInstanceBoundingBox.begin(), mInstanceBoundingBox.end(), boxPred);
         mInstanceBoundingBox.erase(boxEnd, mInstanceBoundingBox.end());
+        updateInstanceBoundingBoxArray();
 
         assert(mInstanceBoundingBox.size() == mInstanceMatrices.size());
     }
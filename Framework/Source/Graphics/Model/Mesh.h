@@ -26,7 +26,9 @@
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ***************************************************************************/
 #pragma once
+#include <atomic>
 #include <map>
+#include <set>
 #include <vector>
 #include "glm/vec3.hpp"
 #include "glm/mat4x4.hpp"
@@ -35,6 +37,9 @@
 #include "utils/AABB.h"
 #include "Graphics/Material/Material.h"
 #include "Graphics/Paths/MovableObject.h"
+#include "Graphics/Model/VertexQuantization.h"
+#include "Graphics/Model/CpuGeometry.h"
+#include "Graphics/Model/MeshClusters.h"
 
 namespace Falcor
 {
@@ -65,6 +70,7 @@ namespace Falcor
             \param[in] pMaterial The material of the mesh
             \param[in] BoundingBox The mesh's axis-aligned bounding-box
             \param[in] bHasBones Indicates the the mesh uses bones for animation
+            \param[in] indexFormat The format of the indices. R16Uint or R32Uint.
         */
         static SharedPtr create(const Vao::VertexBufferDescVector& vertexBuffers,
             uint32_t vertexCount,
@@ -73,16 +79,39 @@ namespace Falcor
             RenderContext::Topology topology,
             const Material::SharedPtr& pMaterial,
             const BoundingBox& boundingBox,
+            bool hasBones,
+            ResourceFormat indexFormat = ResourceFormat::R32Uint);
+
+        /** create a new mesh which draws a range of a VAO. Meshes sharing a VAO don't switch vertex and index buffers between draws.
+            \param[in] pVao The VAO holding the mesh's vertices and indices
+            \param[in] vertexCount Number of vertices used by the mesh
+            \param[in] indexCount Number of indices to draw
+            \param[in] firstIndex Location of the first index in the index buffer
+            \param[in] baseVertex Value added to the indices before reading the vertex buffers
+            \param[in] Topology The primitive topology of the mesh
+            \param[in] pMaterial The material of the mesh
+            \param[in] BoundingBox The mesh's axis-aligned bounding-box
+            \param[in] bHasBones Indicates the the mesh uses bones for animation
+        */
+        static SharedPtr create(const Vao::SharedPtr& pVao,
+            uint32_t vertexCount,
+            uint32_t indexCount,
+            uint32_t firstIndex,
+            int32_t baseVertex,
+            RenderContext::Topology topology,
+            const Material::SharedPtr& pMaterial,
+            const BoundingBox& boundingBox,
             bool hasBones);
 
         /** Destructor
         */
         ~Mesh();
 
-        /** Permanently transform the mesh by the given transform
+        /** Permanently transform the mesh by the given transform. Meshes with a CPU copy of their geometry transform the copy and upload it, instead of reading the vertex buffers back.
             \param[in] Transform The transform to apply
+            \param[in, out] pTransformedData Optional. The CPU copies and vertex buffers which were already transformed, when several meshes share their vertices. They are skipped, and the data transformed by this call is added to the set. See Model::applyTransform().
         */
-        void Mesh::applyTransform(const glm::mat4& transform);
+        void applyTransform(const glm::mat4& transform, std::set<const void*>* pTransformedData = nullptr);
 
         /** Get the mesh's axis-aligned bounding-box in object space
         */
@@ -96,6 +125,42 @@ namespace Falcor
         /** Get the number of indices in the index buffer. Use this value when drawing the mesh.
         */
         uint32_t getIndexCount() const { return mIndexCount; }
+        /** Get the location of the mesh's first index in the index buffer. Use this value when drawing the mesh.
+        */
+        uint32_t getFirstIndex() const { return mFirstIndex; }
+        /** Get the value added to the mesh's indices before reading the vertex buffers. Use this value when drawing the mesh.
+        */
+        int32_t getBaseVertex() const { return mBaseVertex; }
+
+        /** Get the mesh's indices, widened to 32-bit. The indices are relative to the base vertex.
+            Without a CPU copy of the geometry, the indices are read back from the GPU. This is slow. It's meant for exporters and for code which can only consume 32-bit indices.
+        */
+        std::vector<uint32_t> getIndices() const;
+
+        /** Get the mesh's object-space normals, starting at the base vertex. Empty if the mesh doesn't have normals.
+            Without a CPU copy of the geometry, the vertex buffers are read back from the GPU and decoded. This is slow, like getIndices().
+        */
+        std::vector<glm::vec3> getNormals() const;
+
+        /** Check if the mesh keeps a system memory copy of its positions, normals and indices. See Model::KeepCpuGeometry.
+        */
+        bool hasCpuGeometry() const { return mpCpuVertices != nullptr; }
+
+        /** Get the system memory copy of the mesh's object-space positions. The array starts at the base vertex and has getVertexCount() elements. nullptr if the mesh doesn't keep a CPU copy.
+        */
+        const glm::vec3* getCpuPositions() const { return mpCpuVertices ? mpCpuVertices->positions.data() : nullptr; }
+
+        /** Get the system memory copy of the mesh's normals. Same layout as getCpuPositions(). nullptr if the mesh doesn't keep a CPU copy or doesn't have normals.
+        */
+        const glm::vec3* getCpuNormals() const { return (mpCpuVertices && mpCpuVertices->normals.size()) ? mpCpuVertices->normals.data() : nullptr; }
+
+        /** Get the system memory copy of the mesh's indices. Has getIndexCount() elements, relative to the base vertex. nullptr if the mesh doesn't keep a CPU copy.
+        */
+        const uint32_t* getCpuIndices() const { return mpCpuVertices ? mCpuIndices.data() : nullptr; }
+
+        /** Get the clusters the mesh's triangles are split into, in object space. Empty if the mesh wasn't split, see Model::GenerateMeshClusters.
+        */
+        const std::vector<MeshCluster>& getClusters() const { return mClusters; }
 
         /** Get a pointer to the mesh's material
         */
@@ -109,6 +174,10 @@ namespace Falcor
         */
         bool hasBones() const { return mHasBones; }
 
+        /** Get the parameters the vertex shader uses to decode quantized vertex attributes
+        */
+        const VertexQuantization& getVertexQuantization() const { return mVertexQuantization; }
+
         /** Set the mesh's material. Can be used to override the material loaded with the model.
         */
         void setMaterial(const Material::SharedPtr& pMaterial) { mpMaterial = pMaterial; }
@@ -133,6 +202,10 @@ namespace Falcor
         */
         const BoundingBox& getInstanceBoundingBox(uint32_t instanceID) const { return mInstanceBoundingBox[instanceID]; }
 
+        /** Get all the instance bounding-boxes as a structure-of-arrays. Can be used for batch culling.
+        */
+        const BoundingBoxArray& getInstanceBoundingBoxes() const { return mInstanceBoundingBoxArray; }
+
         /** Get a pointer to the instance matrices array. Can be used to set a batch of instances at ones.
         */
         const glm::mat4* getInstanceMatrices() const {  return mInstanceMatrices.data(); }
@@ -155,33 +228,45 @@ namespace Falcor
         friend BinaryModelImporter;
         friend SimpleModelImporter;
         void addInstance(const glm::mat4& transform);
+        void setVertexQuantization(const VertexQuantization& quantization) { mVertexQuantization = quantization; }
+        void setCpuGeometry(const CpuVertexData::SharedPtr& pVertices, std::vector<uint32_t> indices);
+        void setClusters(std::vector<MeshCluster> clusters) { mClusters = std::move(clusters); }
         static const uint32_t kMaxBonesPerVertex = 4;              ///> Max supported bones per vertex
 
     private:
-        Mesh(const Vao::VertexBufferDescVector& vertexBuffers,
+        Mesh(const Vao::SharedPtr& pVao,
             uint32_t vertexCount,
-            const Buffer::SharedPtr& pIndexBuffer,
             uint32_t indexCount,
+            uint32_t firstIndex,
+            int32_t baseVertex,
             RenderContext::Topology topology,
             const Material::SharedPtr& pMaterial,
             const BoundingBox& boundingBox,
             bool hasBones);
 
-		static uint32_t sMeshCounter;
+		static std::atomic<uint32_t> sMeshCounter;
 
 		uint32_t mId;
         uint32_t mIndexCount = 0;
+        uint32_t mFirstIndex = 0;
+        int32_t mBaseVertex = 0;
         uint32_t mVertexCount = 0;
         uint32_t mPrimitiveCount = 0;
         bool mHasBones = false;
         Material::SharedPtr mpMaterial;
         RenderContext::Topology mTopology;
         BoundingBox mBoundingBox;
+        VertexQuantization mVertexQuantization;
+        CpuVertexData::SharedPtr mpCpuVertices;
+        std::vector<uint32_t> mCpuIndices;
+        std::vector<MeshCluster> mClusters;
 
         Vao::SharedPtr mpVao;
         std::vector<glm::mat4> mInstanceMatrices;
         std::vector<glm::mat4> mOriginalInstanceMatrices;
         bool mDirty = true;
         std::vector<BoundingBox> mInstanceBoundingBox;
+        BoundingBoxArray mInstanceBoundingBoxArray;
+        void updateInstanceBoundingBoxArray();
     };
 }
\ No newline at end of file
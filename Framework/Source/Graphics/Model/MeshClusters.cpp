@@ -0,0 +1,306 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "MeshClusters.h"
+#include "glm/geometric.hpp"
+#include "glm/matrix.hpp"
+#include "glm/vector_relational.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace Falcor
+{
+    // Triangles whose normal is further than ~45 degrees from the cluster's first triangle start a new cluster
+    static const float kMinNormalDot = 0.7f;
+
+    static glm::vec3 getPosition(const uint8_t* pPositions, uint32_t positionStride, uint32_t vertex)
+    {
+        return *(const glm::vec3*)(pPositions + size_t(vertex) * positionStride);
+    }
+
+    static void calcClusterBounds(const uint32_t* pIndices, const std::vector<uint32_t>& triangles, const std::vector<glm::vec3>& normals, const uint8_t* pPositions, uint32_t positionStride, MeshCluster& cluster)
+    {
+        // The sphere is centered on the bounding-box
+        glm::vec3 boxMin(std::numeric_limits<float>::max());
+        glm::vec3 boxMax(-std::numeric_limits<float>::max());
+        glm::vec3 normalSum(0);
+        for(uint32_t t : triangles)
+        {
+            for(uint32_t c = 0; c < 3; c++)
+            {
+                glm::vec3 position = getPosition(pPositions, positionStride, pIndices[t * 3 + c]);
+                boxMin = glm::min(boxMin, position);
+                boxMax = glm::max(boxMax, position);
+            }
+            normalSum += normals[t];
+        }
+
+        cluster.center = (boxMin + boxMax) * 0.5f;
+        float radiusSquared = 0;
+        for(uint32_t t : triangles)
+        {
+            for(uint32_t c = 0; c < 3; c++)
+            {
+                glm::vec3 offset = getPosition(pPositions, positionStride, pIndices[t * 3 + c]) - cluster.center;
+                radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+            }
+        }
+        cluster.radius = sqrtf(radiusSquared);
+
+        // The cone can only reject the cluster if all the normals are less than 90 degrees away from the axis
+        cluster.coneAxis = glm::vec3(0, 0, 1);
+        cluster.coneCutoff = 1;
+        float axisLength = glm::length(normalSum);
+        if(axisLength > 0)
+        {
+            cluster.coneAxis = normalSum / axisLength;
+            float minDot = 1;
+            for(uint32_t t : triangles)
+            {
+                if(normals[t] != glm::vec3(0))
+                {
+                    minDot = std::min(minDot, glm::dot(normals[t], cluster.coneAxis));
+                }
+            }
+            if(minDot > 0)
+            {
+                cluster.coneCutoff = sqrtf(1 - std::min(minDot * minDot, 1.0f));
+            }
+        }
+    }
+
+    std::vector<MeshCluster> generateMeshClusters(uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount, const uint8_t* pPositions, uint32_t positionStride, uint32_t maxTriangles)
+    {
+        std::vector<MeshCluster> clusters;
+        const uint32_t triangleCount = indexCount / 3;
+        if(maxTriangles == 0 || triangleCount <= maxTriangles)
+        {
+            return clusters;
+        }
+
+        // Unit normals. Degenerate triangles have a zero normal and can join any cluster.
+        std::vector<glm::vec3> normals(triangleCount);
+        for(uint32_t t = 0; t < triangleCount; t++)
+        {
+            glm::vec3 p0 = getPosition(pPositions, positionStride, pIndices[t * 3 + 0]);
+            glm::vec3 p1 = getPosition(pPositions, positionStride, pIndices[t * 3 + 1]);
+            glm::vec3 p2 = getPosition(pPositions, positionStride, pIndices[t * 3 + 2]);
+            glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+            float length = glm::length(normal);
+            normals[t] = (length > 0) ? normal / length : glm::vec3(0);
+        }
+
+        // Vertex to triangle adjacency, stored as one array with an offset per vertex
+        std::vector<uint32_t> adjacencyOffset(vertexCount + 1, 0);
+        for(uint32_t i = 0; i < triangleCount * 3; i++)
+        {
+            adjacencyOffset[pIndices[i] + 1]++;
+        }
+        for(uint32_t v = 0; v < vertexCount; v++)
+        {
+            adjacencyOffset[v + 1] += adjacencyOffset[v];
+        }
+        std::vector<uint32_t> adjacency(triangleCount * 3);
+        {
+            std::vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+            for(uint32_t i = 0; i < triangleCount * 3; i++)
+            {
+                adjacency[fill[pIndices[i]]++] = i / 3;
+            }
+        }
+
+        std::vector<bool> assigned(triangleCount, false);
+        std::vector<uint32_t> order;
+        order.reserve(triangleCount);
+        std::vector<uint32_t> triangles;
+        uint32_t cursor = 0;
+        while(true)
+        {
+            while(cursor < triangleCount && assigned[cursor])
+            {
+                cursor++;
+            }
+            if(cursor == triangleCount)
+            {
+                break;
+            }
+
+            // Grow the cluster breadth-first from the first unassigned triangle
+            glm::vec3 referenceNormal(0);
+            glm::vec3 boxMin(std::numeric_limits<float>::max());
+            glm::vec3 boxMax(-std::numeric_limits<float>::max());
+            triangles.clear();
+            size_t head = 0;
+
+            auto accepts = [&](uint32_t t)
+            {
+                return (assigned[t] == false) && (referenceNormal == glm::vec3(0) || normals[t] == glm::vec3(0) || glm::dot(normals[t], referenceNormal) >= kMinNormalDot);
+            };
+
+            auto add = [&](uint32_t t)
+            {
+                assigned[t] = true;
+                triangles.push_back(t);
+                if(referenceNormal == glm::vec3(0))
+                {
+                    referenceNormal = normals[t];
+                }
+                for(uint32_t c = 0; c < 3; c++)
+                {
+                    glm::vec3 position = getPosition(pPositions, positionStride, pIndices[t * 3 + c]);
+                    boxMin = glm::min(boxMin, position);
+                    boxMax = glm::max(boxMax, position);
+                }
+            };
+
+            add(cursor);
+            while(triangles.size() < maxTriangles)
+            {
+                if(head < triangles.size())
+                {
+                    uint32_t t = triangles[head++];
+                    for(uint32_t c = 0; c < 3; c++)
+                    {
+                        uint32_t v = pIndices[t * 3 + c];
+                        for(uint32_t a = adjacencyOffset[v]; a < adjacencyOffset[v + 1] && triangles.size() < maxTriangles; a++)
+                        {
+                            if(accepts(adjacency[a]))
+                            {
+                                add(adjacency[a]);
+                            }
+                        }
+                    }
+                    continue;
+                }
+
+                // The connected region is exhausted. Continue with the next triangle in the input order if it's close to the cluster, which keeps meshes made of many small pieces from producing tiny clusters.
+                while(cursor < triangleCount && assigned[cursor])
+                {
+                    cursor++;
+                }
+                if(cursor == triangleCount || accepts(cursor) == false)
+                {
+                    break;
+                }
+                glm::vec3 margin = (boxMax - boxMin) * 0.5f;
+                glm::vec3 position = getPosition(pPositions, positionStride, pIndices[cursor * 3]);
+                if(glm::any(glm::lessThan(position, boxMin - margin)) || glm::any(glm::greaterThan(position, boxMax + margin)))
+                {
+                    break;
+                }
+                add(cursor);
+            }
+
+            // Keep the input order inside the cluster, for the post-transform vertex cache
+            std::sort(triangles.begin(), triangles.end());
+
+            MeshCluster cluster;
+            cluster.firstIndex = (uint32_t)order.size() * 3;
+            cluster.indexCount = (uint32_t)triangles.size() * 3;
+            calcClusterBounds(pIndices, triangles, normals, pPositions, positionStride, cluster);
+            clusters.push_back(cluster);
+            order.insert(order.end(), triangles.begin(), triangles.end());
+        }
+
+        std::vector<uint32_t> source(pIndices, pIndices + triangleCount * 3);
+        for(uint32_t i = 0; i < triangleCount; i++)
+        {
+            for(uint32_t c = 0; c < 3; c++)
+            {
+                pIndices[i * 3 + c] = source[order[i] * 3 + c];
+            }
+        }
+        return clusters;
+    }
+
+    void transformMeshClusters(const MeshCluster* pSrc, uint32_t count, const glm::mat4& transform, MeshCluster* pDst)
+    {
+        // Angles are preserved if the columns are orthogonal and have the same length
+        const glm::mat3 linear(transform);
+        const float scaleX = glm::length(linear[0]);
+        const float scaleY = glm::length(linear[1]);
+        const float scaleZ = glm::length(linear[2]);
+        const float maxScale = std::max(scaleX, std::max(scaleY, scaleZ));
+        const float minScale = std::min(scaleX, std::min(scaleY, scaleZ));
+        const float tolerance = 1e-3f * maxScale * maxScale;
+        const bool isConformal = (maxScale > 0) && (maxScale - minScale <= 1e-3f * maxScale) &&
+            fabsf(glm::dot(linear[0], linear[1])) <= tolerance && fabsf(glm::dot(linear[0], linear[2])) <= tolerance && fabsf(glm::dot(linear[1], linear[2])) <= tolerance;
+
+        // Mirroring flips the winding, so the normals defined by the winding flip as well
+        const float axisSign = (glm::determinant(linear) < 0) ? -1.0f : 1.0f;
+
+        for(uint32_t i = 0; i < count; i++)
+        {
+            MeshCluster cluster = pSrc[i];
+            cluster.center = glm::vec3(transform * glm::vec4(cluster.center, 1));
+            cluster.radius *= maxScale;
+            if(isConformal)
+            {
+                cluster.coneAxis = glm::normalize(linear * cluster.coneAxis) * axisSign;
+            }
+            else
+            {
+                cluster.coneCutoff = 1;
+            }
+            pDst[i] = cluster;
+        }
+    }
+
+    bool isClusterBackfacing(const MeshCluster& cluster, const glm::vec3& viewPosition, bool clockwiseFront)
+    {
+        if(cluster.coneCutoff >= 1)
+        {
+            return false;
+        }
+
+        // Every point of the bounding sphere is seen at less than 90 degrees minus the cone angle from the axis
+        glm::vec3 toCenter = cluster.center - viewPosition;
+        float axisDot = glm::dot(toCenter, cluster.coneAxis);
+        if(clockwiseFront)
+        {
+            axisDot = -axisDot;
+        }
+        return axisDot >= cluster.coneCutoff * glm::length(toCenter) + cluster.radius;
+    }
+
+    bool isClusterBackfacingParallel(const MeshCluster& cluster, const glm::vec3& viewDirection, bool clockwiseFront)
+    {
+        if(cluster.coneCutoff >= 1)
+        {
+            return false;
+        }
+
+        // All the view rays are parallel, so the bounding sphere doesn't matter. This is the limit of the positional test as the viewer moves away along the rays.
+        float axisDot = glm::dot(viewDirection, cluster.coneAxis);
+        if(clockwiseFront)
+        {
+            axisDot = -axisDot;
+        }
+        return axisDot >= cluster.coneCutoff;
+    }
+}
@@ -0,0 +1,86 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <vector>
+#include "glm/vec3.hpp"
+#include "glm/mat4x4.hpp"
+
+namespace Falcor
+{
+    /** The default maximal number of triangles in a cluster
+    */
+    static const uint32_t kDefaultClusterTriangleCount = 128;
+
+    /** A range of a triangle mesh's indices with conservative bounds, which can be culled on its own.\n
+        The cone bounds the normals of the cluster's triangles, as defined by their counter-clockwise winding. It's used to reject clusters which are entirely back-facing, see isClusterBackfacing().
+    */
+    struct MeshCluster
+    {
+        uint32_t firstIndex;        ///< Location of the cluster's first index, relative to the mesh's first index
+        uint32_t indexCount;
+        glm::vec3 center;           ///< Bounding sphere
+        float radius;
+        glm::vec3 coneAxis;         ///< Normalized average of the triangle normals
+        float coneCutoff;           ///< Sine of the angle between the axis and the farthest normal. 1 if the cone can't be used for culling.
+    };
+
+    /** Split a triangle list into clusters.\n
+        Clusters are grown from a seed triangle across shared vertices, rejecting triangles which face away from the seed so that the normal cones stay narrow. The triangles are then
+        reordered so that each cluster is a contiguous range of indices. Inside a cluster, the triangles keep their original order, so run this after optimizeTriangleOrder().
+        \param[in, out] pIndices Triangle list indices
+        \param[in] indexCount Number of indices
+        \param[in] vertexCount Number of vertices in the vertex buffers
+        \param[in] pPositions Vertex positions, 3 floats per vertex
+        \param[in] positionStride Distance in bytes between consecutive positions
+        \param[in] maxTriangles Maximal number of triangles in a cluster
+        \return The clusters, in index order. Empty if the mesh is too small to be worth splitting, in which case the indices are not modified.
+    */
+    std::vector<MeshCluster> generateMeshClusters(uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount, const uint8_t* pPositions, uint32_t positionStride, uint32_t maxTriangles = kDefaultClusterTriangleCount);
+
+    /** Transform the bounds of a list of clusters. Cones are disabled if the transform doesn't preserve angles, and flipped if it mirrors the geometry.
+        \param[in] pSrc The clusters to transform
+        \param[in] count Number of clusters
+        \param[in] transform The transform to apply
+        \param[out] pDst The transformed clusters. Can be the same array as pSrc.
+    */
+    void transformMeshClusters(const MeshCluster* pSrc, uint32_t count, const glm::mat4& transform, MeshCluster* pDst);
+
+    /** Check if all the triangles of a cluster face away from a viewer. The test is conservative.
+        \param[in] cluster The cluster, in the viewer's space
+        \param[in] viewPosition The viewer's position
+        \param[in] clockwiseFront Set to true if clockwise triangles are the front-facing ones
+    */
+    bool isClusterBackfacing(const MeshCluster& cluster, const glm::vec3& viewPosition, bool clockwiseFront = false);
+
+    /** Check if all the triangles of a cluster face away from a viewer at infinity, as seen through an orthographic projection. The test is conservative.
+        \param[in] cluster The cluster, in the viewer's space
+        \param[in] viewDirection The normalized direction of the view rays, pointing away from the viewer
+        \param[in] clockwiseFront Set to true if clockwise triangles are the front-facing ones
+    */
+    bool isClusterBackfacingParallel(const MeshCluster& cluster, const glm::vec3& viewDirection, bool clockwiseFront = false);
+}
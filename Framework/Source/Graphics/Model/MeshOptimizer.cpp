@@ -0,0 +1,352 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "MeshOptimizer.h"
+#include "glm/geometric.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace Falcor
+{
+    static const uint32_t kInvalidVertex = (uint32_t)-1;
+
+    std::string to_string(const MeshOptimizationStats& stats)
+    {
+        char str[256];
+        snprintf(str, arraysize(str), "%u triangles. ACMR %.3f -> %.3f, ATVR %.3f -> %.3f (FIFO cache with %u entries)",
+            stats.after.triangleCount, stats.before.getAcmr(), stats.after.getAcmr(), stats.before.getAtvr(), stats.after.getAtvr(), kDefaultVertexCacheSize);
+        return str;
+    }
+
+    VertexCacheStats calcVertexCacheStats(const uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize)
+    {
+        VertexCacheStats stats;
+        stats.triangleCount = indexCount / 3;
+
+        // A vertex is in the cache if less than cacheSize vertices were transformed since it was. Starting the clock at cacheSize makes all the vertices miss initially.
+        std::vector<uint32_t> cacheTime(vertexCount, 0);
+        std::vector<bool> referenced(vertexCount, false);
+        uint32_t time = cacheSize;
+        for(uint32_t i = 0; i < indexCount; i++)
+        {
+            uint32_t v = pIndices[i];
+            assert(v < vertexCount);
+            if(time - cacheTime[v] >= cacheSize)
+            {
+                cacheTime[v] = time;
+                time++;
+                stats.transformCount++;
+            }
+            if(referenced[v] == false)
+            {
+                referenced[v] = true;
+                stats.vertexCount++;
+            }
+        }
+        return stats;
+    }
+
+    /** Order the triangles using Tipsify. Returns the first triangle of every cluster, which starts whenever the algorithm had to jump to a vertex that isn't in the cache.
+    */
+    static std::vector<uint32_t> tipsify(uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize)
+    {
+        uint32_t triangleCount = indexCount / 3;
+
+        // Vertex to triangle adjacency, stored as one array with an offset per vertex
+        std::vector<uint32_t> adjacencyOffset(vertexCount + 1, 0);
+        for(uint32_t i = 0; i < indexCount; i++)
+        {
+            adjacencyOffset[pIndices[i] + 1]++;
+        }
+        std::vector<uint32_t> liveTriangles(vertexCount);
+        for(uint32_t v = 0; v < vertexCount; v++)
+        {
+            liveTriangles[v] = adjacencyOffset[v + 1];
+            adjacencyOffset[v + 1] += adjacencyOffset[v];
+        }
+        std::vector<uint32_t> adjacency(indexCount);
+        {
+            std::vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+            for(uint32_t i = 0; i < indexCount; i++)
+            {
+                adjacency[fill[pIndices[i]]++] = i / 3;
+            }
+        }
+
+        std::vector<uint32_t> cacheTime(vertexCount, 0);
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<uint32_t> deadEnds;
+        std::vector<uint32_t> candidates;
+        std::vector<uint32_t> output;
+        output.reserve(indexCount);
+        std::vector<uint32_t> clusters(1, 0);
+
+        uint32_t time = cacheSize + 1;
+        uint32_t cursor = 0;
+        while(cursor < vertexCount && liveTriangles[cursor] == 0)
+        {
+            cursor++;
+        }
+        uint32_t fan = (cursor < vertexCount) ? cursor : kInvalidVertex;
+        while(fan != kInvalidVertex)
+        {
+            // Emit all the remaining triangles around the fanning vertex
+            candidates.clear();
+            for(uint32_t a = adjacencyOffset[fan]; a < adjacencyOffset[fan + 1]; a++)
+            {
+                uint32_t t = adjacency[a];
+                if(emitted[t])
+                {
+                    continue;
+                }
+                for(uint32_t c = 0; c < 3; c++)
+                {
+                    uint32_t v = pIndices[t * 3 + c];
+                    output.push_back(v);
+                    deadEnds.push_back(v);
+                    candidates.push_back(v);
+                    liveTriangles[v]--;
+                    if(time - cacheTime[v] > cacheSize)
+                    {
+                        cacheTime[v] = time;
+                        time++;
+                    }
+                }
+                emitted[t] = true;
+            }
+
+            // Prefer the oldest candidate which will still be in the cache after emitting its triangles
+            uint32_t next = kInvalidVertex;
+            int64_t bestPriority = -1;
+            for(uint32_t v : candidates)
+            {
+                if(liveTriangles[v] > 0)
+                {
+                    int64_t priority = 0;
+                    if(time - cacheTime[v] + 2 * liveTriangles[v] <= cacheSize)
+                    {
+                        priority = time - cacheTime[v];
+                    }
+                    if(priority > bestPriority)
+                    {
+                        bestPriority = priority;
+                        next = v;
+                    }
+                }
+            }
+
+            // Dead end. Continue from a recently used vertex, or from the next vertex in the input order.
+            if(next == kInvalidVertex)
+            {
+                while(deadEnds.empty() == false && next == kInvalidVertex)
+                {
+                    uint32_t v = deadEnds.back();
+                    deadEnds.pop_back();
+                    if(liveTriangles[v] > 0)
+                    {
+                        next = v;
+                    }
+                }
+                while(next == kInvalidVertex && cursor < vertexCount)
+                {
+                    if(liveTriangles[cursor] > 0)
+                    {
+                        next = cursor;
+                    }
+                    cursor++;
+                }
+                if(next != kInvalidVertex)
+                {
+                    clusters.push_back(uint32_t(output.size() / 3));
+                }
+            }
+            fan = next;
+        }
+
+        assert(output.size() == triangleCount * 3);
+        std::copy(output.begin(), output.end(), pIndices);
+        return clusters;
+    }
+
+    /** Split the Tipsify clusters at points where the cache efficiency of the cluster is good enough that restarting the cache doesn't cost much
+    */
+    static std::vector<uint32_t> splitClusters(const uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount, const std::vector<uint32_t>& hardClusters, uint32_t cacheSize, float threshold)
+    {
+        uint32_t triangleCount = indexCount / 3;
+        std::vector<uint32_t> cacheTime(vertexCount, 0);
+        uint32_t time = cacheSize;
+        std::vector<uint32_t> clusters;
+
+        for(size_t c = 0; c < hardClusters.size(); c++)
+        {
+            uint32_t end = (c + 1 < hardClusters.size()) ? hardClusters[c + 1] : triangleCount;
+            uint32_t start = hardClusters[c];
+            clusters.push_back(start);
+            time += cacheSize;  // Flush the cache
+            uint32_t transforms = 0;
+            for(uint32_t t = start; t < end; t++)
+            {
+                for(uint32_t i = t * 3; i < t * 3 + 3; i++)
+                {
+                    uint32_t v = pIndices[i];
+                    if(time - cacheTime[v] >= cacheSize)
+                    {
+                        cacheTime[v] = time;
+                        time++;
+                        transforms++;
+                    }
+                }
+
+                uint32_t clusterTriangles = t - clusters.back() + 1;
+                if(t + 1 < end && float(transforms) <= threshold * float(clusterTriangles))
+                {
+                    clusters.push_back(t + 1);
+                    time += cacheSize;
+                    transforms = 0;
+                }
+            }
+        }
+        return clusters;
+    }
+
+    static void sortClustersForOverdraw(uint32_t* pIndices, uint32_t indexCount, const uint8_t* pPositions, uint32_t positionStride, const std::vector<uint32_t>& clusters)
+    {
+        uint32_t triangleCount = indexCount / 3;
+        auto getPosition = [pPositions, positionStride](uint32_t v) {return *(const glm::vec3*)(pPositions + size_t(v) * positionStride); };
+
+        struct Cluster
+        {
+            uint32_t start;
+            uint32_t end;
+            glm::vec3 centroid;
+            glm::vec3 normal;
+            float sortKey;
+        };
+        std::vector<Cluster> sorted(clusters.size());
+
+        // Area weighted centroids and normals
+        glm::vec3 meshCentroid(0);
+        float meshArea = 0;
+        for(size_t c = 0; c < clusters.size(); c++)
+        {
+            Cluster& cluster = sorted[c];
+            cluster.start = clusters[c];
+            cluster.end = (c + 1 < clusters.size()) ? clusters[c + 1] : triangleCount;
+            cluster.centroid = glm::vec3(0);
+            cluster.normal = glm::vec3(0);
+            float clusterArea = 0;
+            for(uint32_t t = cluster.start; t < cluster.end; t++)
+            {
+                glm::vec3 p0 = getPosition(pIndices[t * 3]);
+                glm::vec3 p1 = getPosition(pIndices[t * 3 + 1]);
+                glm::vec3 p2 = getPosition(pIndices[t * 3 + 2]);
+                glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+                float area = glm::length(n);
+                cluster.centroid += (p0 + p1 + p2) * (area / 3.0f);
+                cluster.normal += n;
+                clusterArea += area;
+            }
+            meshCentroid += cluster.centroid;
+            meshArea += clusterArea;
+            cluster.centroid = (clusterArea > 0) ? cluster.centroid / clusterArea : getPosition(pIndices[cluster.start * 3]);
+        }
+        meshCentroid = (meshArea > 0) ? meshCentroid / meshArea : glm::vec3(0);
+
+        // Clusters facing away from the center are drawn first, since they are likely to occlude the others
+        for(auto& cluster : sorted)
+        {
+            float normalLength = glm::length(cluster.normal);
+            cluster.sortKey = (normalLength > 0) ? glm::dot(cluster.centroid - meshCentroid, cluster.normal / normalLength) : 0;
+        }
+        std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster& a, const Cluster& b) {return a.sortKey > b.sortKey; });
+
+        std::vector<uint32_t> output;
+        output.reserve(indexCount);
+        for(const auto& cluster : sorted)
+        {
+            output.insert(output.end(), pIndices + cluster.start * 3, pIndices + cluster.end * 3);
+        }
+        std::copy(output.begin(), output.end(), pIndices);
+    }
+
+    void optimizeTriangleOrder(uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount, const uint8_t* pPositions, uint32_t positionStride, uint32_t cacheSize, float overdrawThreshold)
+    {
+        assert(indexCount % 3 == 0);
+        if(indexCount < 6)
+        {
+            return;
+        }
+
+        std::vector<uint32_t> clusters = tipsify(pIndices, indexCount, vertexCount, cacheSize);
+        if(pPositions)
+        {
+            float acmr = calcVertexCacheStats(pIndices, indexCount, vertexCount, cacheSize).getAcmr();
+            clusters = splitClusters(pIndices, indexCount, vertexCount, clusters, cacheSize, overdrawThreshold * acmr);
+            sortClustersForOverdraw(pIndices, indexCount, pPositions, positionStride, clusters);
+        }
+    }
+
+    std::vector<uint32_t> calcVertexFetchRemap(const uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount)
+    {
+        std::vector<uint32_t> remap(vertexCount, kInvalidVertex);
+        uint32_t next = 0;
+        for(uint32_t i = 0; i < indexCount; i++)
+        {
+            uint32_t& r = remap[pIndices[i]];
+            if(r == kInvalidVertex)
+            {
+                r = next++;
+            }
+        }
+        for(auto& r : remap)
+        {
+            if(r == kInvalidVertex)
+            {
+                r = next++;
+            }
+        }
+        return remap;
+    }
+
+    void remapIndices(uint32_t* pIndices, uint32_t indexCount, const std::vector<uint32_t>& remap)
+    {
+        for(uint32_t i = 0; i < indexCount; i++)
+        {
+            pIndices[i] = remap[pIndices[i]];
+        }
+    }
+
+    void remapVertices(uint8_t* pVertices, uint32_t stride, const std::vector<uint32_t>& remap)
+    {
+        std::vector<uint8_t> source(pVertices, pVertices + remap.size() * stride);
+        for(size_t v = 0; v < remap.size(); v++)
+        {
+            std::memcpy(pVertices + size_t(remap[v]) * stride, source.data() + v * stride, stride);
+        }
+    }
+}
@@ -0,0 +1,121 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+    /** The default size of the simulated post-transform vertex cache
+    */
+    static const uint32_t kDefaultVertexCacheSize = 16;
+
+    /** Post-transform vertex cache statistics of a triangle list, simulated with a FIFO cache
+    */
+    struct VertexCacheStats
+    {
+        uint32_t transformCount = 0;    ///< Number of cache misses, which is the number of vertex shader invocations
+        uint32_t triangleCount = 0;     ///< Number of triangles
+        uint32_t vertexCount = 0;       ///< Number of unique vertices referenced by the triangles
+
+        /** Get the average cache miss ratio, the number of transformed vertices per triangle. Ranges from 3 down to roughly 0.5 for large regular meshes.
+        */
+        float getAcmr() const { return triangleCount ? float(transformCount) / float(triangleCount) : 0; }
+
+        /** Get the average transform to vertex ratio. 1 is optimal.
+        */
+        float getAtvr() const { return vertexCount ? float(transformCount) / float(vertexCount) : 0; }
+
+        VertexCacheStats& operator+=(const VertexCacheStats& other)
+        {
+            transformCount += other.transformCount;
+            triangleCount += other.triangleCount;
+            vertexCount += other.vertexCount;
+            return *this;
+        }
+    };
+
+    /** Vertex cache statistics of a model's triangle meshes, before and after they were optimized
+    */
+    struct MeshOptimizationStats
+    {
+        VertexCacheStats before;
+        VertexCacheStats after;
+
+        MeshOptimizationStats& operator+=(const MeshOptimizationStats& other)
+        {
+            before += other.before;
+            after += other.after;
+            return *this;
+        }
+    };
+
+    /** Format the statistics for logging
+    */
+    std::string to_string(const MeshOptimizationStats& stats);
+
+    /** Simulate a FIFO post-transform vertex cache
+        \param[in] pIndices Triangle list indices
+        \param[in] indexCount Number of indices
+        \param[in] vertexCount Number of vertices in the vertex buffers. All indices must be smaller than it.
+        \param[in] cacheSize Number of entries in the cache
+    */
+    VertexCacheStats calcVertexCacheStats(const uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize = kDefaultVertexCacheSize);
+
+    /** Reorder the triangles of a triangle list for the post-transform vertex cache and for overdraw.\n
+        The triangles are first ordered by Tipsify (Sander et al. 2007), which also splits them into clusters. The clusters are then sorted so that clusters
+        facing away from the mesh center, which are likely to occlude the rest of the mesh, are drawn first.
+        \param[in, out] pIndices Triangle list indices
+        \param[in] indexCount Number of indices
+        \param[in] vertexCount Number of vertices in the vertex buffers
+        \param[in] pPositions Vertex positions, 3 floats per vertex. Pass nullptr to skip the overdraw pass.
+        \param[in] positionStride Distance in bytes between consecutive positions
+        \param[in] cacheSize Size of the cache to optimize for
+        \param[in] overdrawThreshold Limits the ACMR cost of the overdraw pass. The clusters are only split at points where the cluster's ACMR is below the threshold times the mesh ACMR.
+    */
+    void optimizeTriangleOrder(uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount, const uint8_t* pPositions, uint32_t positionStride, uint32_t cacheSize = kDefaultVertexCacheSize, float overdrawThreshold = 1.05f);
+
+    /** Create a table which orders vertices by their first use in an index list, for vertex fetch locality. Unreferenced vertices are moved to the end, keeping their order.
+        \param[in] pIndices The indices. The table should be created after the triangles were reordered.
+        \param[in] indexCount Number of indices
+        \param[in] vertexCount Number of vertices
+        \return The new location of every vertex
+    */
+    std::vector<uint32_t> calcVertexFetchRemap(const uint32_t* pIndices, uint32_t indexCount, uint32_t vertexCount);
+
+    /** Replace indices using a remap table created by calcVertexFetchRemap()
+    */
+    void remapIndices(uint32_t* pIndices, uint32_t indexCount, const std::vector<uint32_t>& remap);
+
+    /** Reorder vertex data using a remap table created by calcVertexFetchRemap()
+        \param[in, out] pVertices The vertex data
+        \param[in] stride Size of a vertex in bytes
+        \param[in] remap The remap table. Its size is the number of vertices.
+    */
+    void remapVertices(uint8_t* pVertices, uint32_t stride, const std::vector<uint32_t>& remap);
+}
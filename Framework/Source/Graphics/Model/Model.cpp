@@ -30,6 +30,7 @@
 #include "Loaders/AssimpModelImporter.h"
 #include "Loaders/BinaryModelImporter.h"
 #include "Loaders/BinaryModelExporter.h"
+#include "ModelImportCache.h"
 #include "Utils/OS.h"
 #include "mesh.h"
 #include "glm/geometric.hpp"
@@ -39,12 +40,14 @@
 #include "Core/Texture.h"
 #include "Graphics/TextureHelper.h"
 #include "Utils/StringUtils.h"
+#include "Utils/ThreadPool.h"
 #include "Graphics/Camera/Camera.h"
 #include "core/VAO.h"
 
 namespace Falcor
 {
-	uint32_t Model::sModelCounter = 0;
+	std::atomic<uint32_t> Model::sModelCounter(0);
+    thread_local ThreadPool* Model::spImportThreadPool = nullptr;
     const char* Model::kSupportedFileFormatsStr = "Supported Formats\0*.obj;*.bin;*.dae;*.x;*.md5mesh;*.ply;*.fbx;*.3ds;*.blend;*.ase;*.ifc;*.xgl;*.zgl;*.dxf;*.lwo;*.lws;*.lxo;*.stl;*.x;*.ac;*.ms3d;*.cob;*.scn;*.3d;*.mdl;*.mdl2;*.pk3;*.smd;*.vta;*.raw;*.ter\0\0";
 
     // Method to sort meshes
@@ -66,9 +69,11 @@ namespace Falcor
     */
     void Model::applyTransform(const glm::mat4& transform) 
 	{
+        // Meshes can share their vertex buffers and CPU copies. Transform each of them once.
+        std::set<const void*> transformedData;
         for(auto& pMesh : mpMeshes)
         {
-            pMesh->applyTransform(transform);
+            pMesh->applyTransform(transform, &transformedData);
         }
 
         calculateModelProperties();
@@ -84,22 +89,53 @@ namespace Falcor
         }
         else
         {
-            pModel = AssimpModelImporter::createFromFile(filename, flags);
+            pModel = ModelImportCache::createFromFile(filename, flags, [&](std::vector<std::string>& dependencies) { return AssimpModelImporter::createFromFile(filename, flags, &dependencies); });
         }
 
         if(pModel)
         {
             if(flags & CompressTextures)
             {
-                pModel->compressAllTextures();
+                AsyncLoader::addItems(1);
+                AsyncLoader::upload([&pModel]() {pModel->compressAllTextures(); });
             }
 
             pModel->calculateModelProperties();
+
+            if((flags & OptimizeMeshes) && pModel->mMeshOptimizationStats.before.triangleCount > 0)
+            {
+                Logger::log(Logger::Level::Info, "Optimized the meshes of " + filename + ". " + to_string(pModel->mMeshOptimizationStats));
+            }
+
+            if((flags & (QuantizeVertices | QuantizePositions)) && pModel->mVertexQuantizationStats.bytesBefore > 0)
+            {
+                Logger::log(Logger::Level::Info, "Quantized the vertices of " + filename + ". " + to_string(pModel->mVertexQuantizationStats));
+            }
         }
 
         return pModel;
     }
 
+    Model::LoadHandle::SharedPtr Model::createFromFileAsync(const std::string& filename, uint32_t flags)
+    {
+        std::function<SharedPtr()> load = [filename, flags]() {return createFromFile(filename, flags); };
+        return AsyncLoader::start(load);
+    }
+
+    void Model::setImportThreadPool(ThreadPool* pPool)
+    {
+        spImportThreadPool = pPool;
+    }
+
+    ThreadPool* Model::getImportThreadPool()
+    {
+        if(spImportThreadPool)
+        {
+            return spImportThreadPool;
+        }
+        return AsyncLoader::isLoaderThread() ? AsyncLoader::getDecodePool() : ThreadPool::getGlobalPool();
+    }
+
     void Model::exportToBinaryFile(const std::string& filename)
     {
         if(hasSuffix(filename, ".bin", false) == false)
@@ -120,24 +156,32 @@ namespace Falcor
         //std::sort(mpMeshes.begin(), mpMeshes.end(), compareMeshes);
 
         vec3 modelMin = vec3(1e25f), modelMax = vec3(-1e25f);
-        std::map<const Buffer*, bool> vbFound;
+        vec3 boxMin = vec3(1e25f), boxMax = vec3(-1e25f);
+        std::map<std::pair<const Buffer*, int32_t>, bool> vbFound;  // Meshes can share the buffers, so the key is the buffer and the base vertex
+        std::vector<BoundingBox> meshInstanceBoxes;
+        mMeshInstanceOffsets.clear();
 
         for(const auto& pMesh : mpMeshes)
         {
+            mMeshInstanceOffsets.push_back((uint32_t)meshInstanceBoxes.size());
             for(uint32_t i = 0 ; i < pMesh->getInstanceCount() ; i++)
             {
                 const BoundingBox& meshBox = pMesh->getInstanceBoundingBox(i);
+                meshInstanceBoxes.push_back(meshBox);
 
                 vec3 meshMin = meshBox.center - meshBox.extent * 0.5f;
                 vec3 meshMax = meshBox.center + meshBox.extent * 0.5f;
 
                 modelMin = min(modelMin, meshMin);
                 modelMax = max(modelMax, meshMax);
+                boxMin = min(boxMin, meshBox.center - meshBox.extent);
+                boxMax = max(boxMax, meshBox.center + meshBox.extent);
 
-                if(vbFound.find(pMesh->getVao()->getVertexBuffer(0).get()) == vbFound.end())
+                auto vbKey = std::make_pair(pMesh->getVao()->getVertexBuffer(0).get(), pMesh->getBaseVertex());
+                if(vbFound.find(vbKey) == vbFound.end())
                 {
                     mVertexCount += pMesh->getVertexCount();
-                    vbFound[pMesh->getVao()->getVertexBuffer(0).get()] = true;
+                    vbFound[vbKey] = true;
                 }
 
                 mPrimitiveCount += pMesh->getPrimitiveCount();
@@ -146,6 +190,9 @@ namespace Falcor
         }
         mCenter = (modelMin + modelMax) * 0.5f;
         mRadius = glm::length(modelMin - modelMax) * 0.5f;
+        mBoundingBox = BoundingBox::fromMinMax(boxMin, boxMax);
+        mMeshInstancesBvh.build(meshInstanceBoxes);
+        mGeometryChangeCount++;
     }
 
     void Model::animate(double currentTime)
@@ -156,6 +203,40 @@ namespace Falcor
         }
     }
 
+    void Model::animateModels(const std::vector<Model*>& models, double currentTime)
+    {
+        // The animation state is owned by each model's animation controller, so different models can be animated concurrently
+        auto animateModel = [&models, currentTime](uint32_t modelID)
+        {
+            models[modelID]->animate(currentTime);
+        };
+
+        if(models.size() > 1)
+        {
+            ThreadPool::getGlobalPool()->run((uint32_t)models.size(), animateModel);
+        }
+        else if(models.size() == 1)
+        {
+            animateModel(0);
+        }
+    }
+
+    void Model::animateKeyPose(double keyTime)
+    {
+        if(mpAnimationController)
+        {
+            mpAnimationController->animateKeyPose(keyTime);
+        }
+    }
+
+    void Model::interpolateKeyPose(float factor)
+    {
+        if(mpAnimationController)
+        {
+            mpAnimationController->interpolateKeyPose(factor);
+        }
+    }
+
     bool Model::hasAnimations() const
     {
         return (getAnimationsCount() != 0);
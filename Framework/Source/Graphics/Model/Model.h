@@ -26,6 +26,7 @@
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ***************************************************************************/
 #pragma once
+#include <atomic>
 #include <vector>
 #include <map>
 #include "glm/mat4x4.hpp"
@@ -34,6 +35,9 @@
 #include "Graphics/Model/Mesh.h"
 #include "Core/Sampler.h"
 #include "Graphics/Model/AnimationController.h"
+#include "Graphics/Model/MeshOptimizer.h"
+#include "Utils/AsyncLoader.h"
+#include "Utils/BoundingVolumeHierarchy.h"
 
 namespace Falcor
 {
@@ -42,6 +46,7 @@ namespace Falcor
     class SimpleModelImporter;
     class Buffer;
     class Camera;
+    class ThreadPool;
 
     /** Class representing a complete model object, including meshes, animations and materials
     */
@@ -51,21 +56,45 @@ namespace Falcor
     public:
         using SharedPtr = std::shared_ptr<Model>;
         using SharedConstPtr = std::shared_ptr<const Model>;
+        using LoadHandle = AsyncLoader::Handle<SharedPtr>;
 
         enum
         {
             None,
             CompressTextures            = 1,    ///< When loading textures, compress them if they are uncompressed
-            GenerateTangentSpace        = 2,    ///< Calculate tangent/bitangent vectors if they are missing. This require the model to have normals and texture coordinates
+            GenerateTangentSpace        = 2,    ///< Calculate tangent/bitangent vectors if they are missing. This require the model to have normals and texture coordinates. The tangents are smoothed across UV seams, see generateSmoothTangentSpace()
             FindDegeneratePrimitives    = 4,    ///< Replace degenerate triangles/lines with lines/points. This can create a meshes with topology that wasn't present in the original model.
             AssumeLinearSpaceTextures   = 8,    ///< By default, textures representing colors (diffuse/specular) are interpreted as sRGB data. Use this flag to force linear space for color textures.
             DontMergeMeshes             = 16,   ///< Preserve the original list of meshes in the scene, don't merge meshes with the same material
+            CompressAnimations          = 32,   ///< Store animations in compressed form. See Animation::CompressionDesc.
+            OptimizeMeshes              = 64,   ///< Reorder triangles for the post-transform vertex cache and overdraw, and vertices for fetch locality. Native binary files are loaded as-is, optimize them when converting (see ObjToBin).
+            QuantizeVertices            = 128,  ///< Store normals, tangents and bitangents as 16-bit octahedral vectors, and texture coordinates as half floats if that's accurate enough. See VertexQuantization.
+            QuantizePositions           = 256,  ///< Store positions as 16-bit values relative to the mesh's bounding-box. Can be used with or without QuantizeVertices.
+            PackGeometry                = 512,  ///< Pack the meshes into a shared vertex and index buffer per vertex layout. The meshes draw ranges of the shared buffers. See GeometryPacker.
+            KeepCpuGeometry             = 1024, ///< Keep a system memory copy of the positions, normals and indices of every mesh. Mesh transforms, area lights, the exporter and the ray-tracer use it instead of reading the GPU buffers back. See Mesh::getCpuPositions().
+            GenerateMeshClusters        = 2048, ///< Split large static triangle meshes into clusters with bounding spheres and normal cones, which SceneRenderer culls individually. Native binary files keep the clusters they were exported with. See MeshClusters.h.
         };
 
         /** create a new model from file
         */
         static SharedPtr createFromFile(const std::string& filename, uint32_t flags);
 
+        /** Start loading a model from file on a background thread. API resources are created on the render thread by AsyncLoader::processUploads(), which Sample calls every frame.
+            \param[in] filename Model's filename
+            \param[in] flags Flags controlling model creation
+            \return A handle to poll. Its result is nullptr if loading failed.
+        */
+        static LoadHandle::SharedPtr createFromFileAsync(const std::string& filename, uint32_t flags);
+
+        /** Set the thread pool the importers use to decode textures and meshes on the calling thread. API resources are always created on the render thread.
+            \param[in] pPool The pool to use. Pass nullptr to use the default, which is the global thread pool, or AsyncLoader::getDecodePool() on loader threads.
+        */
+        static void setImportThreadPool(ThreadPool* pPool);
+
+        /** Get the thread pool used to decode textures and meshes when importing a model
+        */
+        static ThreadPool* getImportThreadPool();
+
         static const char* kSupportedFileFormatsStr;
 
         ~Model();
@@ -75,7 +104,7 @@ namespace Falcor
         */
         void applyTransform(const glm::mat4& transform);
 
-        /** Export the model to a binary file
+        /** Export the model to a binary file, using Falcor's native format. Native files are memory-mapped when loaded, and their buffers and textures are created directly from the file data.
         */
         void exportToBinaryFile(const std::string& filename);
 
@@ -85,6 +114,12 @@ namespace Falcor
         /** Get the model center
         */
         const glm::vec3& getCenter() const { return mCenter; }
+        /** Get the model bounding-box, in model space
+        */
+        const BoundingBox& getBoundingBox() const { return mBoundingBox; }
+        /** Get a counter which is incremented every time the model geometry changes, either by applyTransform() or deleteCulledMeshes()
+        */
+        uint32_t getGeometryChangeCount() const { return mGeometryChangeCount; }
         /** Get the number of vertices in the model
         */
         uint32_t getVertexCount() const { return mVertexCount; }
@@ -99,6 +134,15 @@ namespace Falcor
         */
         uint32_t getInstanceCount() const { return mInstanceCount; }
 
+        /** Get the hierarchy over the bounding-boxes of all the mesh instances, in model space. It's rebuilt every time the geometry changes.\n
+            The mesh instances of a mesh have contiguous primitive IDs, starting at getMeshInstanceOffset().
+        */
+        const BoundingVolumeHierarchy& getMeshInstancesBvh() const { return mMeshInstancesBvh; }
+
+        /** Get the primitive ID of a mesh's first instance in getMeshInstancesBvh()
+        */
+        uint32_t getMeshInstanceOffset(uint32_t meshID) const { return mMeshInstanceOffsets[meshID]; }
+
         /** Get the number of unique textures in the model
         */
         uint32_t getTextureCount() const { return (uint32_t)mpTextures.size(); }
@@ -107,6 +151,14 @@ namespace Falcor
         */
         uint32_t getMaterialCount() const { return (uint32_t)mpMaterials.size(); }
 
+        /** Get the vertex cache statistics of the triangle meshes before and after they were optimized. Only set if the model was loaded with the OptimizeMeshes flag.
+        */
+        const MeshOptimizationStats& getMeshOptimizationStats() const { return mMeshOptimizationStats; }
+
+        /** Get the size and error statistics of vertex quantization. Only set if the model was loaded with the QuantizeVertices or QuantizePositions flags.
+        */
+        const VertexQuantizationStats& getVertexQuantizationStats() const { return mVertexQuantizationStats; }
+
         /** Get the number of unique buffers in the model
         */
         uint32_t getBufferCount() const { return (uint32_t)mpBuffers.size(); }
@@ -133,6 +185,19 @@ namespace Falcor
             \param[in] CurrentTime The current global time
         */
         void animate(double currentTime);
+        /** Animate multiple models in parallel on the global thread pool. Each model is animated by a single task.
+            \param[in] models The models to animate. A model shouldn't appear more than once in the list.
+            \param[in] currentTime The current global time
+        */
+        static void animateModels(const std::vector<Model*>& models, double currentTime);
+        /** Evaluate the active animation at a future time without changing the bone matrices. Use interpolateKeyPose() to move the bones towards the new pose.
+            \param[in] keyTime The global time at which the key pose should be reached
+        */
+        void animateKeyPose(double keyTime);
+        /** Blend the bone matrices between the pose they had when animateKeyPose() was called and the key pose.
+            \param[in] factor The blend factor, in [0, 1]
+        */
+        void interpolateKeyPose(float factor);
         /** Get the animation name from animation ID
         */
         const std::string& getAnimationName(uint32_t animationID) const;
@@ -195,10 +260,16 @@ namespace Falcor
     private:
         float mRadius;
         glm::vec3 mCenter;
+        BoundingBox mBoundingBox;
+        uint32_t mGeometryChangeCount = 0;
 
         uint32_t mVertexCount;
         uint32_t mPrimitiveCount;
         uint32_t mInstanceCount;
+        BoundingVolumeHierarchy mMeshInstancesBvh;
+        std::vector<uint32_t> mMeshInstanceOffsets;
+        MeshOptimizationStats mMeshOptimizationStats;
+        VertexQuantizationStats mVertexQuantizationStats;
 
 		uint32_t mId;
 
@@ -211,7 +282,8 @@ namespace Falcor
 
         std::string mName;
 
-		static uint32_t sModelCounter;
+		static std::atomic<uint32_t> sModelCounter;
+        static thread_local ThreadPool* spImportThreadPool;
 
         void calculateModelProperties();
         void deleteUnusedMaterials(std::map<const Material*, bool> usedMaterials);
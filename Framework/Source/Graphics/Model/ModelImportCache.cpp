@@ -0,0 +1,412 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "ModelImportCache.h"
+#include "Loaders/BinaryModelImporter.h"
+#include "Loaders/BinaryModelExporter.h"
+#include "Loaders/NativeModelSpec.h"
+#include "Core/Texture.h"
+#include "Utils/OS.h"
+#include "Utils/CpuTimer.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+
+namespace Falcor
+{
+    const char* ModelImportCache::kDisableArg = "-noModelCache";
+
+    // Bump when the cooked data changes without a native format version change
+    static const uint32_t kCacheVersion = 2;
+    static const char* kEntryHeader = "FalcorModelCacheEntry";
+
+    // Flags which only affect what happens after the import, so they don't change the cooked file
+    static const uint32_t kPostImportFlags = Model::CompressTextures | Model::KeepCpuGeometry | Model::CompressAnimations;
+
+    struct CacheState
+    {
+        std::mutex mutex;       // Guards the members and the cache directory
+        bool enabled;
+        std::string directory;
+        uint64_t sizeLimit = ModelImportCache::kDefaultSizeLimit;
+        ModelImportCache::Stats stats;
+
+        CacheState()
+        {
+            enabled = (hasCommandLineArg(ModelImportCache::kDisableArg) == false);
+            directory = getExecutableDirectory() + "\\ModelCache";
+        }
+    };
+
+    static CacheState& getState()
+    {
+        static CacheState state;
+        return state;
+    }
+
+    /** An entry is a cooked file and a small text file which describes it. The description is rewritten on every hit, so its modification time is the entry's last use.
+    */
+    struct CacheEntry
+    {
+        uint64_t cookedSize = 0;
+        std::vector<std::pair<std::string, time_t>> dependencies;  // Full path and modification time of the files the model was imported from
+    };
+
+    static std::string getCookedPath(const std::string& directory, const std::string& key)
+    {
+        return directory + "\\" + key + ".bin";
+    }
+
+    static std::string getEntryPath(const std::string& directory, const std::string& key)
+    {
+        return directory + "\\" + key + ".entry";
+    }
+
+    // 64-bit FNV-1a
+    static uint64_t hashBytes(const uint8_t* pData, size_t size, uint64_t hash = 14695981039346656037ull)
+    {
+        for(size_t i = 0; i < size; i++)
+        {
+            hash ^= pData[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    static std::string calcKey(const std::string& fullpath, uint32_t flags)
+    {
+        size_t size = 0;
+        const uint8_t* pFile = (const uint8_t*)mapFileForRead(fullpath, size);
+        if(pFile == nullptr)
+        {
+            return std::string();
+        }
+        uint64_t hash = hashBytes(pFile, size);
+        unmapFile(pFile);
+
+        // The same file in another directory references other textures and material libraries
+        hash = hashBytes((const uint8_t*)fullpath.data(), fullpath.size(), hash);
+
+        const uint32_t params[] = { flags & ~kPostImportFlags, kNativeModelVersion, kCacheVersion };
+        hash = hashBytes((const uint8_t*)params, sizeof(params), hash);
+
+        std::ostringstream key;
+        key << std::hex << std::setw(16) << std::setfill('0') << hash;
+        return key.str();
+    }
+
+    static bool readEntry(const std::string& path, CacheEntry& entry)
+    {
+        std::ifstream stream(path);
+        std::string header;
+        uint32_t version = 0;
+        if(!(stream >> header >> version >> entry.cookedSize) || header != kEntryHeader || version != kCacheVersion)
+        {
+            return false;
+        }
+
+        std::string line;
+        std::getline(stream, line);
+        while(std::getline(stream, line))
+        {
+            size_t separator = line.find('\t');
+            if(separator == std::string::npos)
+            {
+                return false;
+            }
+            entry.dependencies.push_back({ line.substr(separator + 1), (time_t)std::stoll(line.substr(0, separator)) });
+        }
+        return true;
+    }
+
+    static bool writeEntry(const std::string& path, const CacheEntry& entry)
+    {
+        std::ofstream stream(path, std::ios::trunc);
+        stream << kEntryHeader << ' ' << kCacheVersion << ' ' << entry.cookedSize << '\n';
+        for(const auto& dependency : entry.dependencies)
+        {
+            stream << (long long)dependency.second << '\t' << dependency.first << '\n';
+        }
+        return stream.good();
+    }
+
+    static bool areDependenciesValid(const CacheEntry& entry)
+    {
+        for(const auto& dependency : entry.dependencies)
+        {
+            if(doesFileExist(dependency.first) == false || getFileModifiedTime(dependency.first) != dependency.second)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static void removeEntry(const std::string& directory, const std::string& key)
+    {
+        std::remove(getEntryPath(directory, key).c_str());
+        std::remove(getCookedPath(directory, key).c_str());
+    }
+
+    // Delete the least-recently used entries until the cache fits its size limit. Must be called with the state locked.
+    static void evictEntries(CacheState& state, const std::string& keepKey)
+    {
+        struct EntryInfo
+        {
+            std::string key;
+            time_t lastUse;
+            uint64_t size;
+        };
+
+        std::vector<std::string> files;
+        enumerateFiles(state.directory + "\\*.entry", files);
+        std::vector<EntryInfo> entries;
+        uint64_t totalSize = 0;
+        for(const std::string& file : files)
+        {
+            std::string key = file.substr(0, file.size() - std::string(".entry").size());
+            std::string path = getEntryPath(state.directory, key);
+            CacheEntry entry;
+            if(readEntry(path, entry) == false)
+            {
+                removeEntry(state.directory, key);
+                continue;
+            }
+            entries.push_back({ key, getFileModifiedTime(path), entry.cookedSize });
+            totalSize += entry.cookedSize;
+        }
+
+        std::sort(entries.begin(), entries.end(), [](const EntryInfo& a, const EntryInfo& b) { return a.lastUse < b.lastUse; });
+        for(const EntryInfo& entry : entries)
+        {
+            if(totalSize <= state.sizeLimit)
+            {
+                break;
+            }
+            if(entry.key != keepKey)
+            {
+                removeEntry(state.directory, entry.key);
+                totalSize -= entry.size;
+                state.stats.bytesEvicted += entry.size;
+            }
+        }
+    }
+
+    // The checks BinaryModelExporter does before writing a native file. Failing them would log errors on every load.
+    static bool isCacheable(const Model* pModel)
+    {
+        if(pModel->hasBones() || pModel->hasAnimations())
+        {
+            return false;
+        }
+        for(uint32_t i = 0; i < pModel->getTextureCount(); i++)
+        {
+            const Texture* pTexture = pModel->getTexture(i).get();
+            if(pTexture->getArraySize() > 1 || pTexture->getType() != Texture::Type::Texture2D)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static void storeModel(const Model::SharedPtr& pModel, const std::vector<std::string>& importDependencies, const std::string& directory, const std::string& key)
+    {
+        if(createDirectory(directory) == false)
+        {
+            Logger::log(Logger::Level::Warning, "Can't create the model cache directory " + directory);
+            return;
+        }
+
+        // Export under a temporary name, so that a partially written file is never used. The exporter reads each GPU resource back as a separate upload and writes the file on the calling thread.
+        const std::string cookedPath = getCookedPath(directory, key);
+        const std::string tempPath = cookedPath + ".tmp";
+        BinaryModelExporter::exportToFile(tempPath, pModel.get());
+        CacheEntry entry;
+        entry.cookedSize = getFileSize(tempPath);
+        if(entry.cookedSize == 0)
+        {
+            // The exporter already logged the error
+            return;
+        }
+
+        std::vector<std::string> dependencies = importDependencies;
+        for(uint32_t i = 0; i < pModel->getTextureCount(); i++)
+        {
+            std::string fullpath;
+            if(findFileInDataDirectories(pModel->getTexture(i)->getSourceFilename(), fullpath))
+            {
+                dependencies.push_back(fullpath);
+            }
+        }
+        std::sort(dependencies.begin(), dependencies.end());
+        dependencies.erase(std::unique(dependencies.begin(), dependencies.end()), dependencies.end());
+        for(const std::string& dependency : dependencies)
+        {
+            entry.dependencies.push_back({ dependency, getFileModifiedTime(dependency) });
+        }
+
+        CacheState& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        std::remove(cookedPath.c_str());
+        if(std::rename(tempPath.c_str(), cookedPath.c_str()) != 0 || writeEntry(getEntryPath(directory, key), entry) == false)
+        {
+            std::remove(tempPath.c_str());
+            removeEntry(directory, key);
+            return;
+        }
+        state.stats.bytesWritten += entry.cookedSize;
+        evictEntries(state, key);
+    }
+
+    Model::SharedPtr ModelImportCache::createFromFile(const std::string& filename, uint32_t flags, const ImportFunc& import)
+    {
+        std::vector<std::string> dependencies;
+        std::string fullpath;
+        if(isEnabled() == false || findFileInDataDirectories(filename, fullpath) == false)
+        {
+            return import(dependencies);
+        }
+
+        const std::string key = calcKey(fullpath, flags);
+        if(key.empty())
+        {
+            return import(dependencies);
+        }
+
+        CacheState& state = getState();
+        const std::string directory = getDirectory();
+        const std::string cookedPath = getCookedPath(directory, key);
+        auto startTime = CpuTimer::getCurrentTimePoint();
+
+        bool isHit;
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            CacheEntry entry;
+            isHit = readEntry(getEntryPath(directory, key), entry) && areDependenciesValid(entry) && getFileSize(cookedPath) == entry.cookedSize;
+            if(isHit)
+            {
+                writeEntry(getEntryPath(directory, key), entry);
+            }
+        }
+
+        if(isHit)
+        {
+            // The cooked file already went through the mesh optimization and packing
+            Model::SharedPtr pModel = BinaryModelImporter::createFromFile(cookedPath, flags & ~(Model::OptimizeMeshes | Model::PackGeometry));
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if(pModel)
+            {
+                state.stats.hits++;
+                float duration = CpuTimer::calcDuration(startTime, CpuTimer::getCurrentTimePoint());
+                Logger::log(Logger::Level::Info, "Loaded " + filename + " from the model cache in " + std::to_string(duration) + " ms.");
+                return pModel;
+            }
+            Logger::log(Logger::Level::Warning, "Discarding the model cache entry of " + filename + ", the cooked file couldn't be loaded.");
+            removeEntry(directory, key);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.stats.misses++;
+        }
+        Model::SharedPtr pModel = import(dependencies);
+        if(pModel && isCacheable(pModel.get()))
+        {
+            // The model file itself is covered by the key
+            dependencies.erase(std::remove(dependencies.begin(), dependencies.end(), fullpath), dependencies.end());
+            storeModel(pModel, dependencies, directory, key);
+        }
+        return pModel;
+    }
+
+    void ModelImportCache::setEnabled(bool enabled)
+    {
+        CacheState& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.enabled = enabled;
+    }
+
+    bool ModelImportCache::isEnabled()
+    {
+        CacheState& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        return state.enabled;
+    }
+
+    void ModelImportCache::setDirectory(const std::string& directory)
+    {
+        CacheState& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.directory = directory;
+    }
+
+    std::string ModelImportCache::getDirectory()
+    {
+        CacheState& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        return state.directory;
+    }
+
+    void ModelImportCache::setSizeLimit(uint64_t bytes)
+    {
+        CacheState& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.sizeLimit = bytes;
+        evictEntries(state, std::string());
+    }
+
+    uint64_t ModelImportCache::getSizeLimit()
+    {
+        CacheState& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        return state.sizeLimit;
+    }
+
+    void ModelImportCache::clear()
+    {
+        CacheState& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        std::vector<std::string> files;
+        enumerateFiles(state.directory + "\\*.entry", files);
+        for(const std::string& file : files)
+        {
+            removeEntry(state.directory, file.substr(0, file.size() - std::string(".entry").size()));
+        }
+    }
+
+    ModelImportCache::Stats ModelImportCache::getStats()
+    {
+        CacheState& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        return state.stats;
+    }
+}
@@ -0,0 +1,94 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <functional>
+#include <string>
+#include <vector>
+#include "Graphics/Model/Model.h"
+
+namespace Falcor
+{
+    /** Cache of cooked models for the formats which are imported through Assimp.\n
+        The cache is content-addressed. The key is a hash of the source file's content and canonical path, the load flags which change the imported data, and the native format version.
+        The path is part of the key because the files the model references, like textures and .mtl material libraries, are resolved relative to it.
+        On a miss the model is imported as usual, then written into the cache directory in the native binary format (see BinaryModelExporter). On a hit the cooked file is memory-mapped instead of running the import.\n
+        Each entry records the other files the import read, the textures and the files the importer opened, like .mtl material libraries. The entry is discarded if one of them was modified or deleted.
+        When the cache grows beyond its size limit, the least-recently used entries are deleted.
+        Models with bones or animations can't be stored in the native format, they are always imported.\n
+        The cache is enabled by default. Start the application with -noModelCache to disable it.
+    */
+    class ModelImportCache
+    {
+    public:
+        /** Imports the model. Adds the full path of the files it read, besides the model file and the textures, to dependencies.
+        */
+        using ImportFunc = std::function<Model::SharedPtr(std::vector<std::string>& dependencies)>;
+
+        /** Usage statistics since the application started
+        */
+        struct Stats
+        {
+            uint32_t hits = 0;
+            uint32_t misses = 0;
+            uint64_t bytesWritten = 0;      ///< Size of the cooked files written
+            uint64_t bytesEvicted = 0;      ///< Size of the cooked files deleted to stay below the size limit
+        };
+
+        /** Load a model through the cache
+            \param[in] filename The model's filename. Looked for in the data directories.
+            \param[in] flags The load flags. See Model::createFromFile().
+            \param[in] import Imports the model on a miss
+            \return The model, or nullptr if the import failed
+        */
+        static Model::SharedPtr createFromFile(const std::string& filename, uint32_t flags, const ImportFunc& import);
+
+        /** Enable or disable the cache. When disabled, createFromFile() always imports.
+        */
+        static void setEnabled(bool enabled);
+        static bool isEnabled();
+
+        /** Set the directory which holds the cooked files. The default is the ModelCache directory next to the executable.
+        */
+        static void setDirectory(const std::string& directory);
+        static std::string getDirectory();
+
+        /** Set the maximum total size of the cooked files, in bytes. The default is kDefaultSizeLimit.
+        */
+        static void setSizeLimit(uint64_t bytes);
+        static uint64_t getSizeLimit();
+
+        /** Delete all the entries
+        */
+        static void clear();
+
+        static Stats getStats();
+
+        static const uint64_t kDefaultSizeLimit = 8ull * 1024 * 1024 * 1024;
+        static const char* kDisableArg;     ///< The command-line argument which disables the cache
+    };
+}
@@ -0,0 +1,285 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "TangentSpaceGenerator.h"
+#include "Utils/ThreadPool.h"
+#include "glm/geometric.hpp"
+#include <emmintrin.h>
+#include <functional>
+#include <vector>
+
+namespace Falcor
+{
+    struct Vec3x4
+    {
+        __m128 x, y, z;
+    };
+
+    static inline Vec3x4 sub(const Vec3x4& a, const Vec3x4& b)
+    {
+        return{ _mm_sub_ps(a.x, b.x), _mm_sub_ps(a.y, b.y), _mm_sub_ps(a.z, b.z) };
+    }
+
+    static inline Vec3x4 mul(const Vec3x4& a, __m128 s)
+    {
+        return{ _mm_mul_ps(a.x, s), _mm_mul_ps(a.y, s), _mm_mul_ps(a.z, s) };
+    }
+
+    static inline __m128 dot(const Vec3x4& a, const Vec3x4& b)
+    {
+        return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a.x, b.x), _mm_mul_ps(a.y, b.y)), _mm_mul_ps(a.z, b.z));
+    }
+
+    // Zero-length vectors stay zero
+    static inline Vec3x4 normalize(const Vec3x4& v)
+    {
+        __m128 lengthSq = dot(v, v);
+        __m128 valid = _mm_cmpgt_ps(lengthSq, _mm_setzero_ps());
+        __m128 invLength = _mm_and_ps(valid, _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(lengthSq)));
+        return mul(v, invLength);
+    }
+
+    // Abramowitz and Stegun 4.4.45. The error is below 7e-5 radians, which is plenty for weights.
+    static inline __m128 acos4(__m128 x)
+    {
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+        x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+        __m128 absX = _mm_andnot_ps(signMask, x);
+        __m128 poly = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(-0.0187293f), absX), _mm_set1_ps(0.0742610f));
+        poly = _mm_add_ps(_mm_mul_ps(poly, absX), _mm_set1_ps(-0.2121144f));
+        poly = _mm_add_ps(_mm_mul_ps(poly, absX), _mm_set1_ps(1.5707288f));
+        __m128 result = _mm_mul_ps(_mm_sqrt_ps(_mm_sub_ps(_mm_set1_ps(1.0f), absX)), poly);
+        __m128 isNegative = _mm_cmplt_ps(x, _mm_setzero_ps());
+        __m128 reflected = _mm_sub_ps(_mm_set1_ps(3.14159265f), result);
+        return _mm_or_ps(_mm_and_ps(isNegative, reflected), _mm_andnot_ps(isNegative, result));
+    }
+
+    static void runRanges(ThreadPool* pPool, uint32_t itemCount, const std::function<void(uint32_t begin, uint32_t end)>& func)
+    {
+        uint32_t taskCount = (itemCount + kTangentSpaceTaskSize - 1) / kTangentSpaceTaskSize;
+        auto task = [&](uint32_t taskID)
+        {
+            uint32_t begin = taskID * kTangentSpaceTaskSize;
+            func(begin, std::min(begin + kTangentSpaceTaskSize, itemCount));
+        };
+
+        if(pPool && taskCount > 1)
+        {
+            pPool->run(taskCount, task);
+        }
+        else
+        {
+            for(uint32_t i = 0; i < taskCount; i++)
+            {
+                task(i);
+            }
+        }
+    }
+
+    struct FaceFrame
+    {
+        glm::vec3 tangent;      // Normalized, zero if the triangle is degenerate in texture space
+        glm::vec3 bitangent;
+    };
+
+    // Calculates the texture-space frame of every triangle and the angle of every triangle corner, 4 triangles at a time
+    static void calcFaceFrames(const TangentSpaceDesc& desc, uint32_t firstTriangle, uint32_t endTriangle, FaceFrame* pFrames, float* pCornerAngles)
+    {
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+        const __m128 one = _mm_set1_ps(1.0f);
+        const uint32_t* pIndices = desc.pIndices;
+
+        for(uint32_t first = firstTriangle; first < endTriangle; first += 4)
+        {
+            // Gather the corners. The last batch repeats its last triangle in the unused lanes.
+            float p[3][3][4];
+            float uv[3][2][4];
+            for(uint32_t lane = 0; lane < 4; lane++)
+            {
+                uint32_t triangle = std::min(first + lane, endTriangle - 1);
+                for(uint32_t corner = 0; corner < 3; corner++)
+                {
+                    uint32_t index = pIndices[triangle * 3 + corner];
+                    const float* pPos = (const float*)(desc.pPositions + size_t(index) * desc.positionStride);
+                    p[corner][0][lane] = pPos[0];
+                    p[corner][1][lane] = pPos[1];
+                    p[corner][2][lane] = pPos[2];
+                    const float* pUV = desc.pTexCoords ? (const float*)(desc.pTexCoords + size_t(index) * desc.texCoordStride) : nullptr;
+                    uv[corner][0][lane] = pUV ? pUV[0] : 0.0f;
+                    uv[corner][1][lane] = pUV ? pUV[1] : 0.0f;
+                }
+            }
+
+            Vec3x4 pos[3];
+            __m128 u[3], v[3];
+            for(uint32_t corner = 0; corner < 3; corner++)
+            {
+                pos[corner] = { _mm_loadu_ps(p[corner][0]), _mm_loadu_ps(p[corner][1]), _mm_loadu_ps(p[corner][2]) };
+                u[corner] = _mm_loadu_ps(uv[corner][0]);
+                v[corner] = _mm_loadu_ps(uv[corner][1]);
+            }
+
+            // Texture-space frame. Flip it for mirrored triangles, so that it follows the triangle's winding.
+            Vec3x4 d1 = sub(pos[1], pos[0]);
+            Vec3x4 d2 = sub(pos[2], pos[0]);
+            __m128 u1 = _mm_sub_ps(u[1], u[0]);
+            __m128 v1 = _mm_sub_ps(v[1], v[0]);
+            __m128 u2 = _mm_sub_ps(u[2], u[0]);
+            __m128 v2 = _mm_sub_ps(v[2], v[0]);
+            __m128 signedArea = _mm_sub_ps(_mm_mul_ps(u1, v2), _mm_mul_ps(v1, u2));
+            __m128 orientation = _mm_or_ps(_mm_and_ps(_mm_cmplt_ps(signedArea, zero), signMask), one);
+
+            Vec3x4 tangent = normalize(mul(sub(mul(d1, v2), mul(d2, v1)), orientation));
+            Vec3x4 bitangent = normalize(mul(sub(mul(d2, u1), mul(d1, u2)), orientation));
+
+            // Corner angles
+            Vec3x4 e01 = normalize(d1);
+            Vec3x4 e02 = normalize(d2);
+            Vec3x4 e12 = normalize(sub(pos[2], pos[1]));
+            __m128 angles[3];
+            angles[0] = acos4(dot(e01, e02));
+            angles[1] = acos4(_mm_xor_ps(dot(e12, e01), signMask));
+            angles[2] = acos4(dot(e02, e12));
+
+            // Scatter
+            float t[3][4], b[3][4], a[3][4];
+            _mm_storeu_ps(t[0], tangent.x);
+            _mm_storeu_ps(t[1], tangent.y);
+            _mm_storeu_ps(t[2], tangent.z);
+            _mm_storeu_ps(b[0], bitangent.x);
+            _mm_storeu_ps(b[1], bitangent.y);
+            _mm_storeu_ps(b[2], bitangent.z);
+            for(uint32_t corner = 0; corner < 3; corner++)
+            {
+                _mm_storeu_ps(a[corner], angles[corner]);
+            }
+
+            for(uint32_t lane = 0; lane < 4 && first + lane < endTriangle; lane++)
+            {
+                uint32_t triangle = first + lane;
+                pFrames[triangle].tangent = glm::vec3(t[0][lane], t[1][lane], t[2][lane]);
+                pFrames[triangle].bitangent = glm::vec3(b[0][lane], b[1][lane], b[2][lane]);
+                for(uint32_t corner = 0; corner < 3; corner++)
+                {
+                    pCornerAngles[triangle * 3 + corner] = a[corner][lane];
+                }
+            }
+        }
+    }
+
+    // Project into the plane defined by a normal and normalize. Returns zero if the result is degenerate.
+    static inline glm::vec3 projectToPlane(const glm::vec3& v, const glm::vec3& normal)
+    {
+        glm::vec3 projected = v - normal * glm::dot(normal, v);
+        float length = glm::length(projected);
+        return (length > 0) ? projected / length : glm::vec3(0);
+    }
+
+    static inline glm::vec3 getPerpendicular(const glm::vec3& n)
+    {
+        glm::vec3 perpendicular = (std::abs(n.x) > std::abs(n.y)) ? glm::vec3(n.z, 0, -n.x) : glm::vec3(0, n.z, -n.y);
+        float length = glm::length(perpendicular);
+        return (length > 0) ? perpendicular / length : glm::vec3(1, 0, 0);
+    }
+
+    void generateSmoothTangentSpace(const TangentSpaceDesc& desc, ThreadPool* pPool)
+    {
+        assert(desc.pIndices && desc.pPositions && desc.pNormals && desc.pTangents && desc.pBitangents);
+        assert(desc.indexCount % 3 == 0);
+        const uint32_t triangleCount = desc.indexCount / 3;
+        if(triangleCount == 0)
+        {
+            return;
+        }
+
+        // Per-triangle frames and per-corner weights
+        std::vector<FaceFrame> frames(triangleCount);
+        std::vector<float> cornerAngles(desc.indexCount);
+        runRanges(pPool, triangleCount, [&](uint32_t begin, uint32_t end) { calcFaceFrames(desc, begin, end, frames.data(), cornerAngles.data()); });
+
+        // List the corners of every vertex, so that the vertices can be processed in parallel without write conflicts
+        std::vector<uint32_t> cornerOffsets(desc.vertexCount + 1, 0);
+        for(uint32_t i = 0; i < desc.indexCount; i++)
+        {
+            assert(desc.pIndices[i] < desc.vertexCount);
+            cornerOffsets[desc.pIndices[i] + 1]++;
+        }
+        for(uint32_t v = 0; v < desc.vertexCount; v++)
+        {
+            cornerOffsets[v + 1] += cornerOffsets[v];
+        }
+        std::vector<uint32_t> corners(desc.indexCount);
+        {
+            std::vector<uint32_t> cursor(cornerOffsets.begin(), cornerOffsets.end() - 1);
+            for(uint32_t i = 0; i < desc.indexCount; i++)
+            {
+                corners[cursor[desc.pIndices[i]]++] = i;
+            }
+        }
+
+        // Accumulate and orthonormalize
+        runRanges(pPool, desc.vertexCount, [&](uint32_t begin, uint32_t end)
+        {
+            for(uint32_t v = begin; v < end; v++)
+            {
+                if(cornerOffsets[v] == cornerOffsets[v + 1])
+                {
+                    continue;
+                }
+
+                const glm::vec3 normal = *(const glm::vec3*)(desc.pNormals + size_t(v) * desc.normalStride);
+                glm::vec3 tangentSum(0);
+                glm::vec3 bitangentSum(0);
+                for(uint32_t i = cornerOffsets[v]; i < cornerOffsets[v + 1]; i++)
+                {
+                    uint32_t corner = corners[i];
+                    const FaceFrame& frame = frames[corner / 3];
+                    float weight = cornerAngles[corner];
+                    tangentSum += projectToPlane(frame.tangent, normal) * weight;
+                    bitangentSum += projectToPlane(frame.bitangent, normal) * weight;
+                }
+
+                glm::vec3 tangent = projectToPlane(tangentSum, normal);
+                if(tangent == glm::vec3(0))
+                {
+                    // No texture-space direction, any frame around the normal will do
+                    tangent = getPerpendicular(normal);
+                }
+                glm::vec3 bitangent = glm::cross(normal, tangent);
+                if(glm::dot(bitangent, bitangentSum) < 0)
+                {
+                    bitangent = -bitangent;
+                }
+
+                desc.pTangents[v] = tangent;
+                desc.pBitangents[v] = bitangent;
+            }
+        });
+    }
+}
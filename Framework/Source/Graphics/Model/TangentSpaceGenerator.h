@@ -0,0 +1,67 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <stdint.h>
+#include "glm/vec3.hpp"
+
+namespace Falcor
+{
+    class ThreadPool;
+
+    /** Number of triangles and of vertices processed by each task of generateSmoothTangentSpace(). Meshes smaller than that are processed on the calling thread.
+    */
+    static const uint32_t kTangentSpaceTaskSize = 16384;
+
+    /** The inputs and outputs of generateSmoothTangentSpace(). Strides are in bytes.
+    */
+    struct TangentSpaceDesc
+    {
+        const uint32_t* pIndices = nullptr;     ///< Triangle list
+        uint32_t indexCount = 0;
+        uint32_t vertexCount = 0;
+        const uint8_t* pPositions = nullptr;    ///< The first 3 floats of each element are used
+        uint32_t positionStride = sizeof(glm::vec3);
+        const uint8_t* pNormals = nullptr;      ///< Normalized 3 floats
+        uint32_t normalStride = sizeof(glm::vec3);
+        const uint8_t* pTexCoords = nullptr;    ///< The first 2 floats of each element are used. Optional. Without texture coordinates the tangents form an arbitrary frame around the normals.
+        uint32_t texCoordStride = 2 * sizeof(float);
+        glm::vec3* pTangents = nullptr;         ///< Output. Vertices which no triangle references are left untouched.
+        glm::vec3* pBitangents = nullptr;       ///< Output
+    };
+
+    /** Generate smooth per-vertex tangents and bitangents for a triangle list.\n
+        Every triangle corner contributes the triangle's texture-space tangent, projected into the plane of the vertex normal and weighted by the corner's angle.
+        The tangent is the normalized sum, and the bitangent is cross(normal, tangent), flipped to match the sum of the bitangent contributions.\n
+        The index and vertex buffers are not modified, so a vertex always gets a single frame. Vertices shared by triangles with different texture-space orientations, such as those on
+        a mirrored UV seam, get a blend of the frames. The result is not MikkTSpace-compatible, and normal maps baked with MikkTSpace tangents can show errors along such seams.\n
+        The triangles are processed 4 at a time with SSE. With a thread pool, the triangles and the vertices are processed in parallel ranges.
+        \param[in] desc The mesh
+        \param[in] pPool The thread pool to use. nullptr runs everything on the calling thread. Must not be called from a task of the same pool.
+    */
+    void generateSmoothTangentSpace(const TangentSpaceDesc& desc, ThreadPool* pPool = nullptr);
+}
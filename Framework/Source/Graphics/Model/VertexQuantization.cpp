@@ -0,0 +1,253 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "VertexQuantization.h"
+#include "Data/VertexAttrib.h"
+#include "glm/geometric.hpp"
+#include "glm/packing.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include <algorithm>
+
+namespace Falcor
+{
+    glm::mat4 VertexQuantization::getPositionDequantMatrix() const
+    {
+        glm::mat4 mat = glm::translate(glm::mat4(), positionOffset);
+        return glm::scale(mat, positionScale);
+    }
+
+    VertexQuantizationStats& VertexQuantizationStats::operator+=(const VertexQuantizationStats& other)
+    {
+        bytesBefore += other.bytesBefore;
+        bytesAfter += other.bytesAfter;
+        maxPositionError = std::max(maxPositionError, other.maxPositionError);
+        maxDirectionError = std::max(maxDirectionError, other.maxDirectionError);
+        maxTexCoordError = std::max(maxTexCoordError, other.maxTexCoordError);
+        floatTexCoordStreams += other.floatTexCoordStreams;
+        return *this;
+    }
+
+    std::string to_string(const VertexQuantizationStats& stats)
+    {
+        char str[512];
+        float ratio = stats.bytesAfter ? float(stats.bytesBefore) / float(stats.bytesAfter) : 0;
+        snprintf(str, arraysize(str), "Vertex data %llu -> %llu bytes (%.2fx smaller). Max error: position %g, direction %.4f degrees, texture coordinate %g. %u texture coordinate streams kept as floats.",
+            (unsigned long long)stats.bytesBefore, (unsigned long long)stats.bytesAfter, ratio, stats.maxPositionError, stats.maxDirectionError, stats.maxTexCoordError, stats.floatTexCoordStreams);
+        return str;
+    }
+
+    static float signNotZero(float f)
+    {
+        return (f >= 0) ? 1.0f : -1.0f;
+    }
+
+    glm::vec2 encodeOctahedral(const glm::vec3& dir)
+    {
+        // Project on the octahedron, then fold the lower hemisphere over the diagonals
+        float l1 = std::abs(dir.x) + std::abs(dir.y) + std::abs(dir.z);
+        if(l1 == 0)
+        {
+            return glm::vec2(0);
+        }
+        glm::vec2 oct = glm::vec2(dir.x, dir.y) / l1;
+        if(dir.z < 0)
+        {
+            oct = glm::vec2((1 - std::abs(oct.y)) * signNotZero(oct.x), (1 - std::abs(oct.x)) * signNotZero(oct.y));
+        }
+        return oct;
+    }
+
+    glm::vec3 decodeOctahedral(const glm::vec2& oct)
+    {
+        glm::vec3 dir(oct.x, oct.y, 1 - std::abs(oct.x) - std::abs(oct.y));
+        if(dir.z < 0)
+        {
+            dir.x = (1 - std::abs(oct.y)) * signNotZero(oct.x);
+            dir.y = (1 - std::abs(oct.x)) * signNotZero(oct.y);
+        }
+        return glm::normalize(dir);
+    }
+
+    static const glm::vec3& getVec3(const uint8_t* pSrc, uint32_t stride, uint32_t index)
+    {
+        return *(const glm::vec3*)(pSrc + size_t(index) * stride);
+    }
+
+    void quantizePositions(const uint8_t* pSrc, uint32_t srcStride, uint32_t vertexCount, std::vector<uint8_t>& dst, VertexQuantization& quantization, VertexQuantizationStats& stats)
+    {
+        glm::vec3 boxMin(std::numeric_limits<float>::max());
+        glm::vec3 boxMax(-std::numeric_limits<float>::max());
+        for(uint32_t i = 0; i < vertexCount; i++)
+        {
+            boxMin = glm::min(boxMin, getVec3(pSrc, srcStride, i));
+            boxMax = glm::max(boxMax, getVec3(pSrc, srcStride, i));
+        }
+        if(vertexCount == 0)
+        {
+            boxMin = boxMax = glm::vec3(0);
+        }
+
+        quantization.positionOffset = boxMin;
+        quantization.positionScale = (boxMax - boxMin) / 65535.0f;
+
+        dst.resize(size_t(vertexCount) * 4 * sizeof(uint16_t));
+        uint16_t* pDst = (uint16_t*)dst.data();
+        for(uint32_t i = 0; i < vertexCount; i++)
+        {
+            const glm::vec3& pos = getVec3(pSrc, srcStride, i);
+            glm::vec3 decoded;
+            for(uint32_t c = 0; c < 3; c++)
+            {
+                float scale = quantization.positionScale[c];
+                float q = (scale > 0) ? (pos[c] - boxMin[c]) / scale : 0;
+                pDst[i * 4 + c] = (uint16_t)glm::clamp(q + 0.5f, 0.0f, 65535.0f);
+                decoded[c] = float(pDst[i * 4 + c]) * scale + boxMin[c];
+            }
+            pDst[i * 4 + 3] = 0xFFFF;   // w = 1
+            stats.maxPositionError = std::max(stats.maxPositionError, glm::length(decoded - pos));
+        }
+
+        stats.bytesBefore += uint64_t(srcStride) * vertexCount;
+        stats.bytesAfter += dst.size();
+    }
+
+    void quantizeDirections(const uint8_t* pSrc, uint32_t srcStride, uint32_t vertexCount, std::vector<uint8_t>& dst, VertexQuantizationStats& stats)
+    {
+        dst.resize(size_t(vertexCount) * 2 * sizeof(int16_t));
+        int16_t* pDst = (int16_t*)dst.data();
+        for(uint32_t i = 0; i < vertexCount; i++)
+        {
+            const glm::vec3& dir = getVec3(pSrc, srcStride, i);
+            glm::vec2 oct = encodeOctahedral(dir);
+            glm::vec2 decodedOct;
+            for(uint32_t c = 0; c < 2; c++)
+            {
+                float q = glm::clamp(oct[c], -1.0f, 1.0f) * 32767.0f;
+                pDst[i * 2 + c] = (int16_t)(q >= 0 ? q + 0.5f : q - 0.5f);
+                decodedOct[c] = std::max(float(pDst[i * 2 + c]) / 32767.0f, -1.0f);
+            }
+
+            float length = glm::length(dir);
+            if(length > 0)
+            {
+                float cosAngle = glm::clamp(glm::dot(decodeOctahedral(decodedOct), dir / length), -1.0f, 1.0f);
+                stats.maxDirectionError = std::max(stats.maxDirectionError, glm::degrees(std::acos(cosAngle)));
+            }
+        }
+
+        stats.bytesBefore += uint64_t(srcStride) * vertexCount;
+        stats.bytesAfter += dst.size();
+    }
+
+    bool quantizeTexCoords(const uint8_t* pSrc, uint32_t srcStride, uint32_t vertexCount, std::vector<uint8_t>& dst, VertexQuantizationStats& stats)
+    {
+        std::vector<uint8_t> converted(size_t(vertexCount) * sizeof(uint32_t));
+        uint32_t* pDst = (uint32_t*)converted.data();
+        float maxError = 0;
+        for(uint32_t i = 0; i < vertexCount; i++)
+        {
+            const glm::vec2& texC = *(const glm::vec2*)(pSrc + size_t(i) * srcStride);
+            pDst[i] = glm::packHalf2x16(texC);
+            glm::vec2 error = glm::abs(glm::unpackHalf2x16(pDst[i]) - texC);
+            maxError = std::max(maxError, std::max(error.x, error.y));
+        }
+
+        if(maxError > kMaxTexCoordError)
+        {
+            stats.floatTexCoordStreams++;
+            return false;
+        }
+
+        stats.maxTexCoordError = std::max(stats.maxTexCoordError, maxError);
+        stats.bytesBefore += uint64_t(srcStride) * vertexCount;
+        stats.bytesAfter += converted.size();
+        dst = std::move(converted);
+        return true;
+    }
+
+    bool quantizeVertexStream(Vao::VertexBufferDesc& vbDesc, std::vector<uint8_t>& data, uint32_t vertexCount, bool quantizePositionStream, bool quantizeAttributeStream, VertexQuantization& quantization, VertexQuantizationStats& stats)
+    {
+        const VertexLayout* pLayout = vbDesc.pLayout.get();
+        const uint32_t stride = pLayout->getTotalStride();
+        bool quantized = false;
+        std::vector<uint8_t> quantizedData;
+        ResourceFormat format = ResourceFormat::Unknown;
+
+        // Only streams of a single float element, which is what the importers create
+        if(pLayout->getElementCount() == 1 && pLayout->getElementArraySize(0) == 1 && data.size() >= size_t(stride) * vertexCount)
+        {
+            ResourceFormat srcFormat = pLayout->getElementFormat(0);
+            bool isVec3 = (srcFormat == ResourceFormat::RGB32Float) || (srcFormat == ResourceFormat::RGBA32Float);
+            bool isVec2 = isVec3 || (srcFormat == ResourceFormat::RG32Float);
+
+            switch(pLayout->getElementShaderLocation(0))
+            {
+            case VERTEX_POSITION_LOC:
+                if(quantizePositionStream && isVec3)
+                {
+                    quantizePositions(data.data(), stride, vertexCount, quantizedData, quantization, stats);
+                    format = kQuantizedPositionFormat;
+                    quantized = true;
+                }
+                break;
+            case VERTEX_NORMAL_LOC:
+            case VERTEX_TANGENT_LOC:
+            case VERTEX_BITANGENT_LOC:
+                if(quantizeAttributeStream && isVec3)
+                {
+                    quantizeDirections(data.data(), stride, vertexCount, quantizedData, stats);
+                    quantization.octahedralDirections = true;
+                    format = kQuantizedDirectionFormat;
+                    quantized = true;
+                }
+                break;
+            case VERTEX_TEXCOORD_LOC:
+                if(quantizeAttributeStream && isVec2)
+                {
+                    quantized = quantizeTexCoords(data.data(), stride, vertexCount, quantizedData, stats);
+                    format = kQuantizedTexCoordFormat;
+                }
+                break;
+            }
+        }
+
+        if(quantized == false)
+        {
+            stats.bytesBefore += data.size();
+            stats.bytesAfter += data.size();
+            return false;
+        }
+
+        VertexLayout::SharedPtr pNewLayout = VertexLayout::create();
+        pNewLayout->addElement(pLayout->getElementName(0), 0, format, 1, pLayout->getElementShaderLocation(0));
+        vbDesc.pLayout = pNewLayout;
+        vbDesc.stride = pNewLayout->getTotalStride();
+        data = std::move(quantizedData);
+        return true;
+    }
+}
@@ -0,0 +1,128 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <vector>
+#include <string>
+#include "glm/vec3.hpp"
+#include "glm/mat4x4.hpp"
+#include "Core/VAO.h"
+
+namespace Falcor
+{
+    /** Describes how the vertex shader decodes the vertex attributes of a mesh. See Model::QuantizeVertices.
+    */
+    struct VertexQuantization
+    {
+        glm::vec3 positionScale = glm::vec3(1);     ///< Object-space position = stored position * positionScale + positionOffset
+        glm::vec3 positionOffset = glm::vec3(0);
+        bool octahedralDirections = false;          ///< Normals, tangents and bitangents are stored as octahedral-encoded 2D vectors
+
+        /** Get the matrix which transforms the stored positions into object space
+        */
+        glm::mat4 getPositionDequantMatrix() const;
+
+        /** Check if any attribute needs decoding
+        */
+        bool isQuantized() const { return octahedralDirections || positionScale != glm::vec3(1) || positionOffset != glm::vec3(0); }
+    };
+
+    /** Size and error statistics of vertex quantization
+    */
+    struct VertexQuantizationStats
+    {
+        uint64_t bytesBefore = 0;           ///< Size of the vertex buffers before quantization
+        uint64_t bytesAfter = 0;            ///< Size of the vertex buffers after quantization
+        float maxPositionError = 0;         ///< In object-space units
+        float maxDirectionError = 0;        ///< In degrees
+        float maxTexCoordError = 0;         ///< In texture coordinate units
+        uint32_t floatTexCoordStreams = 0;  ///< Number of texture coordinate streams kept as floats because half floats exceeded kMaxTexCoordError
+
+        VertexQuantizationStats& operator+=(const VertexQuantizationStats& other);
+    };
+
+    /** Format the statistics for logging
+    */
+    std::string to_string(const VertexQuantizationStats& stats);
+
+    static const ResourceFormat kQuantizedPositionFormat = ResourceFormat::RGBA16Unorm;
+    static const ResourceFormat kQuantizedDirectionFormat = ResourceFormat::RG16Snorm;
+    static const ResourceFormat kQuantizedTexCoordFormat = ResourceFormat::RG16Float;
+
+    /** Texture coordinates are only stored as half floats if the conversion error is below this bound, which covers coordinates in [-2, 2]
+    */
+    static const float kMaxTexCoordError = 1.0f / 2048.0f;
+
+    /** Encode a unit vector using the octahedral mapping. The result is in [-1, 1]^2.
+    */
+    glm::vec2 encodeOctahedral(const glm::vec3& dir);
+
+    /** Decode an octahedral-encoded vector. Matches decodeOctahedral() in VertexAttrib.h.
+    */
+    glm::vec3 decodeOctahedral(const glm::vec2& oct);
+
+    /** Quantize positions to 16-bit unsigned normalized values, relative to their bounding-box
+        \param[in] pSrc Positions. Every position starts with 3 floats.
+        \param[in] srcStride Distance in bytes between consecutive positions
+        \param[in] vertexCount Number of positions
+        \param[out] dst The quantized positions, in kQuantizedPositionFormat. The 4th component is 1.
+        \param[in, out] quantization Receives the dequantization scale and offset
+        \param[in, out] stats Receives the buffer sizes and error
+    */
+    void quantizePositions(const uint8_t* pSrc, uint32_t srcStride, uint32_t vertexCount, std::vector<uint8_t>& dst, VertexQuantization& quantization, VertexQuantizationStats& stats);
+
+    /** Quantize normals, tangents or bitangents to 16-bit octahedral vectors
+        \param[in] pSrc Vectors. Every vector starts with 3 floats.
+        \param[in] srcStride Distance in bytes between consecutive vectors
+        \param[in] vertexCount Number of vectors
+        \param[out] dst The quantized vectors, in kQuantizedDirectionFormat
+        \param[in, out] stats Receives the buffer sizes and error
+    */
+    void quantizeDirections(const uint8_t* pSrc, uint32_t srcStride, uint32_t vertexCount, std::vector<uint8_t>& dst, VertexQuantizationStats& stats);
+
+    /** Convert texture coordinates to half floats, unless that exceeds kMaxTexCoordError
+        \param[in] pSrc Texture coordinates. Every coordinate starts with 2 floats.
+        \param[in] srcStride Distance in bytes between consecutive coordinates
+        \param[in] vertexCount Number of coordinates
+        \param[out] dst The converted coordinates, in kQuantizedTexCoordFormat
+        \param[in, out] stats Receives the buffer sizes and error
+        \return false if the error is too large. dst and the buffer sizes are not changed in that case.
+    */
+    bool quantizeTexCoords(const uint8_t* pSrc, uint32_t srcStride, uint32_t vertexCount, std::vector<uint8_t>& dst, VertexQuantizationStats& stats);
+
+    /** Quantize a vertex stream which holds a single float element, based on the element's shader location. Other streams are left unchanged.
+        \param[in, out] vbDesc The stream's descriptor. If the stream was quantized, its layout and stride are replaced.
+        \param[in, out] data The stream's data
+        \param[in] vertexCount Number of vertices in the stream
+        \param[in] quantizePositionStream Whether to quantize positions
+        \param[in] quantizeAttributeStream Whether to quantize normals, tangents, bitangents and texture coordinates
+        \param[in, out] quantization Receives the decoding parameters of the quantized attributes
+        \param[in, out] stats Receives the buffer sizes and error. Streams which are left unchanged are counted as well.
+        \return true if the stream was quantized
+    */
+    bool quantizeVertexStream(Vao::VertexBufferDesc& vbDesc, std::vector<uint8_t>& data, uint32_t vertexCount, bool quantizePositionStream, bool quantizeAttributeStream, VertexQuantization& quantization, VertexQuantizationStats& stats);
+}
@@ -0,0 +1,274 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "AnimationScheduler.h"
+#include "Graphics/Camera/Camera.h"
+#include "Utils/ThreadPool.h"
+#include "Utils/CpuTimer.h"
+#include <algorithm>
+
+namespace Falcor
+{
+    static float calcInterpolationFactor(double currentTime, double keyStartTime, double keyTime)
+    {
+        if(keyTime <= keyStartTime)
+        {
+            return 1;
+        }
+        double factor = (currentTime - keyStartTime) / (keyTime - keyStartTime);
+        return (float)std::min(std::max(factor, 0.0), 1.0);
+    }
+
+    AnimationScheduler::UniquePtr AnimationScheduler::create(const Scene::SharedConstPtr& pScene)
+    {
+        return UniquePtr(new AnimationScheduler(pScene));
+    }
+
+    AnimationScheduler::AnimationScheduler(const Scene::SharedConstPtr& pScene) : mpScene(pScene)
+    {
+    }
+
+    float AnimationScheduler::calcScreenSize(const Camera* pCamera, uint32_t modelID) const
+    {
+        const Model* pModel = mpScene->getModel(modelID).get();
+        const glm::vec3& cameraPos = pCamera->getPosition();
+        const float tanHalfFovY = tanf(pCamera->getFovY() * 0.5f);
+        float screenSize = 0;
+
+        for(uint32_t instanceID = 0; instanceID < mpScene->getModelInstanceCount(modelID); instanceID++)
+        {
+            const Scene::ModelInstance& instance = mpScene->getModelInstance(modelID, instanceID);
+            if(instance.isVisible == false || mVisibility[modelID][instanceID] == 0)
+            {
+                continue;
+            }
+
+            // Orthographic projection. The screen size doesn't depend on the distance, so always update at the full rate.
+            if(tanHalfFovY == 0)
+            {
+                return 1;
+            }
+
+            const glm::mat4& m = instance.transformMatrix;
+            glm::vec3 center = glm::vec3(m * glm::vec4(pModel->getCenter(), 1));
+            float scale = std::max(glm::length(glm::vec3(m[0])), std::max(glm::length(glm::vec3(m[1])), glm::length(glm::vec3(m[2]))));
+            float radius = pModel->getRadius() * scale;
+            float distance = glm::length(center - cameraPos);
+            if(distance <= radius)
+            {
+                return 1;
+            }
+            screenSize = std::max(screenSize, radius / (distance * tanHalfFovY));
+        }
+        return screenSize;
+    }
+
+    void AnimationScheduler::animateAll(double currentTime)
+    {
+        mAnimatedModels.clear();
+        for(uint32_t modelID = 0; modelID < mpScene->getModelCount(); modelID++)
+        {
+            Model* pModel = mpScene->getModel(modelID).get();
+            if(pModel->hasAnimations())
+            {
+                mAnimatedModels.push_back(pModel);
+                mStats.evaluatedBones += pModel->getBonesCount();
+            }
+        }
+
+        CpuTimer::TimePoint start = CpuTimer::getCurrentTimePoint();
+        Model::animateModels(mAnimatedModels, currentTime);
+        mStats.evaluationTime = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+        mStats.animatedModels = (uint32_t)mAnimatedModels.size();
+        mStats.evaluatedModels = mStats.animatedModels;
+
+        // The models are not interpolated anymore, so their key poses are stale
+        mModelStates.clear();
+    }
+
+    void AnimationScheduler::update(const Camera* pCamera, double currentTime)
+    {
+        mStats = Statistics();
+        mFrameCount++;
+
+        // Key poses are evaluated at the time the next update is due, which is predicted from the average frame duration
+        const double lastTime = (mFrameCount > 1) ? mLastTime : currentTime - mFrameTime;
+        if(currentTime > lastTime)
+        {
+            mFrameTime += (std::min(currentTime - lastTime, 0.1) - mFrameTime) * 0.1;
+        }
+        mLastTime = currentTime;
+
+        if(mLodEnabled == false)
+        {
+            animateAll(currentTime);
+            return;
+        }
+
+        mpScene->cullModelInstances(pCamera, mVisibility);
+        mUpdates.clear();
+        mInterpolations.clear();
+
+        for(uint32_t modelID = 0; modelID < mpScene->getModelCount(); modelID++)
+        {
+            Model* pModel = mpScene->getModel(modelID).get();
+            if(pModel->hasAnimations() == false)
+            {
+                continue;
+            }
+            mStats.animatedModels++;
+
+            ModelState& state = mModelStates[pModel];
+            state.lastFrame = mFrameCount;
+
+            // Models which aren't visible are still updated at the lowest rate. Their priority is zero, so they only take the budget left by the visible ones until they are forced.
+            float screenSize = calcScreenSize(pCamera, modelID);
+            Update update;
+            update.pModel = pModel;
+            update.pState = &state;
+            if(screenSize == 0)
+            {
+                update.interval = kCulledInterval;
+                mStats.culledModels++;
+            }
+            else
+            {
+                update.interval = (screenSize >= mFullRateSize) ? 1 : ((screenSize >= mHalfRateSize) ? 2 : 4);
+            }
+            state.framesSinceUpdate++;
+            mStats.maxFramesSinceUpdate = std::max(mStats.maxFramesSinceUpdate, state.framesSinceUpdate);
+
+            if(state.interval == 0)
+            {
+                update.forced = true;
+                update.priority = screenSize;
+                mUpdates.push_back(update);
+            }
+            else if(state.framesSinceUpdate >= std::min(state.interval, update.interval))
+            {
+                // Models which were deferred get a higher priority, so that large models can't starve the small ones
+                uint32_t deferredFrames = state.framesSinceUpdate - std::min(state.interval, update.interval);
+                update.forced = (deferredFrames >= kMaxDeferredFrames);
+                update.priority = screenSize * float(1 + deferredFrames);
+                mUpdates.push_back(update);
+            }
+            else
+            {
+                mInterpolations.push_back({pModel, calcInterpolationFactor(currentTime, state.keyStartTime, state.keyTime)});
+            }
+        }
+
+        // Release the state of models which were removed from the scene
+        for(auto it = mModelStates.begin(); it != mModelStates.end();)
+        {
+            it = (it->second.lastFrame == mFrameCount) ? std::next(it) : mModelStates.erase(it);
+        }
+
+        // Select the updates which fit in the budget. The first update is always evaluated, so that progress is made even with a tiny budget.
+        // Forced updates first, then from the largest model on screen to the smallest
+        std::sort(mUpdates.begin(), mUpdates.end(), [](const Update& a, const Update& b)
+        {
+            return (a.forced != b.forced) ? a.forced : (a.priority > b.priority);
+        });
+        uint32_t updateCount = 0;
+        float estimatedTime = 0;
+        for(const Update& update : mUpdates)
+        {
+            const uint32_t boneCount = update.pModel->getBonesCount();
+            const float cost = float(boneCount) * mCostPerBone;
+            if(update.forced || mTimeBudget <= 0 || updateCount == 0 || estimatedTime + cost <= mTimeBudget)
+            {
+                mUpdates[updateCount++] = update;
+                estimatedTime += cost;
+                mStats.evaluatedBones += boneCount;
+            }
+            else
+            {
+                // Keep moving towards the last key pose. Once it's reached, the model holds it until it's updated.
+                const ModelState& state = *update.pState;
+                mInterpolations.push_back({update.pModel, calcInterpolationFactor(currentTime, state.keyStartTime, state.keyTime)});
+                mStats.deferredModels++;
+            }
+        }
+        mUpdates.resize(updateCount);
+        mStats.evaluatedModels = updateCount;
+        mStats.interpolatedModels = (uint32_t)mInterpolations.size() - mStats.deferredModels;
+
+        auto evaluate = [this, currentTime, lastTime](uint32_t updateID)
+        {
+            Update& update = mUpdates[updateID];
+            ModelState& state = *update.pState;
+            state.keyStartTime = lastTime;
+            if(update.interval == 1 || state.interval == 0)
+            {
+                // Full rate, or the model was just added. Evaluate the exact pose.
+                update.pModel->animate(currentTime);
+                state.keyTime = currentTime;
+            }
+            else
+            {
+                // The key pose is reached on the last frame before the next update
+                state.keyTime = currentTime + double(update.interval - 1) * mFrameTime;
+                update.pModel->animateKeyPose(state.keyTime);
+                update.pModel->interpolateKeyPose(calcInterpolationFactor(currentTime, state.keyStartTime, state.keyTime));
+            }
+            state.interval = update.interval;
+            state.framesSinceUpdate = 0;
+        };
+
+        CpuTimer::TimePoint start = CpuTimer::getCurrentTimePoint();
+        if(updateCount > 1)
+        {
+            ThreadPool::getGlobalPool()->run(updateCount, evaluate);
+        }
+        else if(updateCount == 1)
+        {
+            evaluate(0);
+        }
+        mStats.evaluationTime = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+        if(mStats.evaluatedBones)
+        {
+            mCostPerBone += (mStats.evaluationTime / float(mStats.evaluatedBones) - mCostPerBone) * 0.1f;
+        }
+
+        auto interpolate = [this](uint32_t interpolationID)
+        {
+            mInterpolations[interpolationID].pModel->interpolateKeyPose(mInterpolations[interpolationID].factor);
+        };
+
+        if(mInterpolations.size() > 1)
+        {
+            ThreadPool::getGlobalPool()->run((uint32_t)mInterpolations.size(), interpolate);
+        }
+        else if(mInterpolations.size() == 1)
+        {
+            interpolate(0);
+        }
+    }
+}
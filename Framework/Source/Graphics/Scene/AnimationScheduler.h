@@ -0,0 +1,147 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include "Graphics/Scene/Scene.h"
+
+namespace Falcor
+{
+    class Model;
+    class Camera;
+
+    /** Schedules the animation updates of a scene's models.\n
+        Each animated model is assigned an update interval from the projected screen size of its largest visible instance: every frame, every second frame or every fourth frame. Models updated at a reduced rate are evaluated at the time the next update is due, and their bone matrices are interpolated towards that pose on the frames in between.
+        Models with no visible instance are updated at the lowest rate, every kCulledInterval frames and with the lowest priority. They can still be seen indirectly, in shadows for example, and their pose doesn't drift away from the current time.\n
+        The bone evaluations are limited by a per-frame time budget. Due models are evaluated from the largest on screen to the smallest, and the ones which don't fit in the budget are deferred to the next frame. A model is never deferred for more than kMaxDeferredFrames frames, which bounds the visual error.
+    */
+    class AnimationScheduler
+    {
+    public:
+        using UniquePtr = std::unique_ptr<AnimationScheduler>;
+        using UniqueConstPtr = std::unique_ptr<const AnimationScheduler>;
+
+        /** The maximum number of frames a due update can be deferred because of the time budget
+        */
+        static const uint32_t kMaxDeferredFrames = 4;
+
+        /** The update interval of models with no visible instance, in frames. Together with kMaxDeferredFrames, it bounds the age of a culled model's pose.
+        */
+        static const uint32_t kCulledInterval = 4;
+
+        struct Statistics
+        {
+            uint32_t animatedModels = 0;        ///< Number of models with animations
+            uint32_t culledModels = 0;          ///< Animated models with no visible instance, updated at the lowest rate
+            uint32_t evaluatedModels = 0;       ///< Models whose animation was evaluated this frame
+            uint32_t interpolatedModels = 0;    ///< Models whose bones were interpolated between key poses
+            uint32_t deferredModels = 0;        ///< Models which were due for an update, but didn't fit in the time budget
+            uint32_t evaluatedBones = 0;        ///< Number of bones evaluated this frame
+            uint32_t maxFramesSinceUpdate = 0;  ///< The largest number of frames since an animated model was last evaluated, before this frame's updates
+            float evaluationTime = 0;           ///< The time spent evaluating animations this frame, in milliseconds
+        };
+
+        /** Create a new scheduler
+            \param[in] pScene The scene whose models should be animated
+        */
+        static UniquePtr create(const Scene::SharedConstPtr& pScene);
+
+        /** Update the animated models of the scene
+            \param[in] pCamera The camera used to compute the screen size and visibility of the model instances
+            \param[in] currentTime The current global time
+        */
+        void update(const Camera* pCamera, double currentTime);
+
+        /** Set the screen size thresholds used to select a model's update interval. The screen size is the projected radius of the model instance's bounding sphere, divided by half the viewport height.
+            \param[in] fullRateSize Models with an instance larger than this are updated every frame
+            \param[in] halfRateSize Models with an instance larger than this are updated every second frame. Smaller models are updated every fourth frame.
+        */
+        void setLodThresholds(float fullRateSize, float halfRateSize) { mFullRateSize = fullRateSize; mHalfRateSize = halfRateSize; }
+
+        /** Set the time budget for evaluating animations in a single frame, in milliseconds. Zero disables the budget.
+        */
+        void setTimeBudget(float budget) { mTimeBudget = budget; }
+        float getTimeBudget() const { return mTimeBudget; }
+
+        /** Enable/disable the update rate selection. When disabled, all the animated models are evaluated every frame, regardless of their visibility and of the time budget.
+        */
+        void setLodEnabled(bool enable) { mLodEnabled = enable; }
+        bool isLodEnabled() const { return mLodEnabled; }
+
+        /** Get the statistics of the last update() call
+        */
+        const Statistics& getStatistics() const { return mStats; }
+
+    private:
+        AnimationScheduler(const Scene::SharedConstPtr& pScene);
+
+        struct ModelState
+        {
+            uint32_t interval = 0;          ///< The current update interval in frames. Zero means the model is out of sync and must be evaluated at the current time.
+            uint32_t framesSinceUpdate = 0;
+            double keyStartTime = 0;        ///< The time of the frame before the last key pose evaluation
+            double keyTime = 0;             ///< The time the last key pose was evaluated at
+            uint64_t lastFrame = 0;         ///< The last frame the model was in the scene. Used to release the state of deleted models.
+        };
+
+        struct Update
+        {
+            Model* pModel;
+            ModelState* pState;
+            float priority;
+            uint32_t interval;
+            bool forced;
+        };
+
+        struct Interpolation
+        {
+            Model* pModel;
+            float factor;
+        };
+
+        float calcScreenSize(const Camera* pCamera, uint32_t modelID) const;
+        void animateAll(double currentTime);
+
+        Scene::SharedConstPtr mpScene;
+        std::unordered_map<const Model*, ModelState> mModelStates;
+        std::vector<std::vector<uint8_t>> mVisibility;
+        std::vector<Update> mUpdates;
+        std::vector<Interpolation> mInterpolations;
+        std::vector<Model*> mAnimatedModels;
+        Statistics mStats;
+
+        float mFullRateSize = 0.25f;
+        float mHalfRateSize = 0.08f;
+        float mTimeBudget = 2.0f;
+        float mCostPerBone = 0.0005f;   ///< Running estimate of the evaluation time of a single bone, in milliseconds
+        double mLastTime = 0;
+        double mFrameTime = 1.0 / 60.0; ///< Running average of the frame duration, in seconds
+        uint64_t mFrameCount = 0;
+        bool mLodEnabled = true;
+    };
+}
@@ -28,6 +28,7 @@
 #include "Framework.h"
 #include "Scene.h"
 #include "SceneImporter.h"
+#include "Utils/ThreadPool.h"
 #include "glm/gtx/euler_angles.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 
@@ -44,6 +45,13 @@ namespace Falcor
         return SceneImporter::loadScene(filename, modelLoadFlags, sceneLoadFlags);
     }
 
+    Scene::LoadHandle::SharedPtr Scene::loadFromFileAsync(const std::string& filename, const uint32_t& modelLoadFlags, uint32_t sceneLoadFlags)
+    {
+        uint32_t flags = modelLoadFlags;
+        std::function<SharedPtr()> load = [filename, flags, sceneLoadFlags]() {return SceneImporter::loadScene(filename, flags, sceneLoadFlags); };
+        return AsyncLoader::start(load);
+    }
+
     Scene::SharedPtr Scene::create(float cameraAspectRatio)
     {
         return SharedPtr(new Scene(cameraAspectRatio));
@@ -90,6 +98,8 @@ namespace Falcor
         instance.translation = translate;
         instance.name = name;
         mModels[modelID].instances.push_back(instance);
+        mModels[modelID].instancesChangeCount++;
+        mInstancesBvhDirty = true;
         calculateModelInstanceMatrix(modelID, (uint32_t)mModels[modelID].instances.size() - 1);
 
         return (uint32_t)mModels[modelID].instances.size() - 1;
@@ -99,6 +109,8 @@ namespace Falcor
     {
         auto& instances = mModels[modelID].instances;
         instances.erase(instances.begin() + instanceID);
+        mModels[modelID].instancesChangeCount++;
+        mInstancesBvhDirty = true;
     }
 
     void Scene::calculateModelInstanceMatrix(uint32_t modelID, uint32_t instanceID)
@@ -109,6 +121,123 @@ namespace Falcor
         glm::mat4 rotation = glm::yawPitchRoll(instance.rotation[0], instance.rotation[1], instance.rotation[2]);
 
         instance.transformMatrix = translation * scaling * rotation;
+
+        // Moving an instance doesn't change the hierarchy topology, so just update the leaf. It will be refitted on the next query.
+        if(mInstancesBvhDirty == false)
+        {
+            const BoundingBox& modelBox = mModels[modelID].pModel->getBoundingBox();
+            mInstancesBvh.setBox(mInstancesBvhOffsets[modelID] + instanceID, modelBox.transform(instance.transformMatrix));
+        }
+    }
+
+    void Scene::updateInstancesBvh() const
+    {
+        // Changes to the models geometry change the instances bounding-boxes, so rebuild
+        for(size_t i = 0; (i < mModels.size()) && (mInstancesBvhDirty == false); i++)
+        {
+            mInstancesBvhDirty = (mModels[i].pModel->getGeometryChangeCount() != mInstancesBvhGeometryVersions[i]);
+        }
+
+        if(mInstancesBvhDirty)
+        {
+            std::vector<BoundingBox> boxes;
+            mInstancesBvhOffsets.resize(mModels.size());
+            mInstancesBvhGeometryVersions.resize(mModels.size());
+            for(size_t modelID = 0; modelID < mModels.size(); modelID++)
+            {
+                const ModelData& model = mModels[modelID];
+                const BoundingBox& modelBox = model.pModel->getBoundingBox();
+                mInstancesBvhOffsets[modelID] = (uint32_t)boxes.size();
+                mInstancesBvhGeometryVersions[modelID] = model.pModel->getGeometryChangeCount();
+                for(const auto& instance : model.instances)
+                {
+                    boxes.push_back(modelBox.transform(instance.transformMatrix));
+                }
+            }
+            mInstancesBvh.build(boxes);
+            mInstancesBvhDirty = false;
+        }
+        else
+        {
+            mInstancesBvh.refit();
+        }
+    }
+
+    void Scene::cullModelInstances(const Camera* pCamera, std::vector<std::vector<uint8_t>>& visibility) const
+    {
+        updateInstancesBvh();
+        mInstancesBvh.cull(pCamera, mVisibleInstances);
+
+        visibility.resize(mModels.size());
+        for(size_t modelID = 0; modelID < mModels.size(); modelID++)
+        {
+            visibility[modelID].assign(mModels[modelID].instances.size(), 0);
+        }
+
+        // Primitive IDs are sorted by model, so find the model with a binary search on the offsets
+        for(uint32_t primitiveID : mVisibleInstances)
+        {
+            auto it = std::upper_bound(mInstancesBvhOffsets.begin(), mInstancesBvhOffsets.end(), primitiveID);
+            uint32_t modelID = (uint32_t)(it - mInstancesBvhOffsets.begin()) - 1;
+            visibility[modelID][primitiveID - mInstancesBvhOffsets[modelID]] = 1;
+        }
+    }
+
+    void Scene::cullMeshInstances(const Camera* pCamera, const std::vector<std::vector<uint8_t>>& modelInstanceVisibility, std::vector<std::vector<uint8_t>>& visibility, ThreadPool* pPool) const
+    {
+        static const uint32_t kInstancesPerTask = 64;
+
+        visibility.resize(mModels.size());
+        mMeshCullInstances.clear();
+        for(uint32_t modelID = 0; modelID < (uint32_t)mModels.size(); modelID++)
+        {
+            const ModelData& model = mModels[modelID];
+            visibility[modelID].assign(model.instances.size() * model.pModel->getInstanceCount(), 0);
+            for(uint32_t instanceID = 0; instanceID < (uint32_t)model.instances.size(); instanceID++)
+            {
+                if(modelInstanceVisibility[modelID][instanceID])
+                {
+                    mMeshCullInstances.push_back({modelID, instanceID});
+                }
+            }
+        }
+
+        // Every model instance writes its own range of its model's vector, so the tasks don't overlap
+        const uint32_t cullCount = (uint32_t)mMeshCullInstances.size();
+        auto cullTask = [&](uint32_t taskID)
+        {
+            const uint32_t first = taskID * kInstancesPerTask;
+            const uint32_t last = std::min(first + kInstancesPerTask, cullCount);
+            for(uint32_t i = first; i < last; i++)
+            {
+                const uint32_t modelID = mMeshCullInstances[i].first;
+                const uint32_t instanceID = mMeshCullInstances[i].second;
+                const Model* pModel = mModels[modelID].pModel.get();
+                uint8_t* pMask = visibility[modelID].data() + size_t(instanceID) * pModel->getInstanceCount();
+                pModel->getMeshInstancesBvh().cull(pCamera, mModels[modelID].instances[instanceID].transformMatrix, pMask);
+            }
+        };
+
+        // The camera lazily updates its frustum planes. Make sure they are up-to-date before sharing it between threads.
+        pCamera->getViewProjMatrix();
+        const uint32_t taskCount = (cullCount + kInstancesPerTask - 1) / kInstancesPerTask;
+        if(pPool && taskCount > 1)
+        {
+            pPool->run(taskCount, cullTask);
+        }
+        else
+        {
+            for(uint32_t taskID = 0; taskID < taskCount; taskID++)
+            {
+                cullTask(taskID);
+            }
+        }
+    }
+
+    BoundingBox Scene::getBoundingBox() const
+    {
+        updateInstancesBvh();
+        return mInstancesBvh.getBoundingBox();
     }
 
     const Scene::UserVariable& Scene::getUserVariable(const std::string& name)
@@ -145,6 +274,8 @@ namespace Falcor
     uint32_t Scene::addModel(const Model::SharedPtr& pModel, const std::string& filename, bool createIdentityInstance)
     {
         mModels.push_back(ModelData(pModel, filename)); 
+        mModelsChangeCount++;
+        mInstancesBvhDirty = true;
 		uint32_t modelID = (uint32_t)mModels.size() - 1;
 		if (createIdentityInstance)
 		{
@@ -156,6 +287,8 @@ namespace Falcor
     void Scene::deleteModel(uint32_t modelID)
     {
         mModels.erase(mModels.begin() + modelID);
+        mModelsChangeCount++;
+        mInstancesBvhDirty = true;
     }
 
     uint32_t Scene::addLight(const Light::SharedPtr& pLight)
@@ -271,6 +404,8 @@ namespace Falcor
         merge(mpMaterials);
         merge(mCameras);
 #undef merge
+        mModelsChangeCount++;
+        mInstancesBvhDirty = true;
         mUserVars.insert(pFrom->mUserVars.begin(), pFrom->mUserVars.end());
     }
 
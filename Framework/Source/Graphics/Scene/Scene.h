@@ -35,14 +35,18 @@
 #include "Graphics/Camera/Camera.h"
 #include "Graphics/Camera/CameraController.h"
 #include "Graphics/Paths/ObjectPath.h"
+#include "Utils/BoundingVolumeHierarchy.h"
 
 namespace Falcor
 {
+    class ThreadPool;
+
     class Scene : public std::enable_shared_from_this<Scene>
     {
     public:
         using SharedPtr = std::shared_ptr<Scene>;
         using SharedConstPtr = std::shared_ptr<const Scene>;
+        using LoadHandle = AsyncLoader::Handle<SharedPtr>;
         static const char* kFileFormatString;
 
         struct UserVariable
@@ -105,6 +109,11 @@ namespace Falcor
 		};
 
         static Scene::SharedPtr loadFromFile(const std::string& filename, const uint32_t& modelLoadFlags, uint32_t sceneLoadFlags = 0);
+
+        /** Start loading a scene on a background thread. The models are loaded one after the other, and all API resources are created on the render thread by AsyncLoader::processUploads().
+            \return A handle to poll. Its result is nullptr if loading failed.
+        */
+        static LoadHandle::SharedPtr loadFromFileAsync(const std::string& filename, const uint32_t& modelLoadFlags, uint32_t sceneLoadFlags = 0);
         static Scene::SharedPtr create(float cameraAspectRatio = 1.0f);
 
         ~Scene();
@@ -117,6 +126,10 @@ namespace Falcor
         const Model::SharedPtr& getModel(uint32_t index) const { return mModels[index].pModel; }
         const std::string& getModelFilename(uint32_t index) const { return mModels[index].Filename; }
 
+        /** Get a counter which is incremented every time a model is added or removed. Can be used to detect changes to the scene's model list.
+        */
+        uint32_t getModelsChangeCount() const { return mModelsChangeCount; }
+
         // Model instances
         uint32_t getModelInstanceCount(uint32_t modelID) const { return (uint32_t)mModels[modelID].instances.size(); }
         const ModelInstance& getModelInstance(uint32_t modelID, uint32_t instanceID) const { return mModels[modelID].instances[instanceID]; }
@@ -128,6 +141,29 @@ namespace Falcor
         uint32_t addModelInstance(uint32_t modelID, const std::string& name, const glm::vec3& rotate, const glm::vec3& scale, const glm::vec3& translate);
         void deleteModelInstance(uint32_t modelID, uint32_t instanceID);
 
+        /** Get a counter which is incremented every time an instance is added to or removed from a model. Can be used to detect changes to a model's instance list.
+        */
+        uint32_t getModelInstancesChangeCount(uint32_t modelID) const { return mModels[modelID].instancesChangeCount; }
+
+        /** Find the model instances which intersect the camera frustum. Uses a bounding volume hierarchy over all the instances, which is updated lazily when instances change.
+            Doesn't take ModelInstance#isVisible into account.
+            \param[in] pCamera The camera to cull against
+            \param[out] visibility One vector per model, with one entry per model instance. Non-zero means the instance is potentially visible.
+        */
+        void cullModelInstances(const Camera* pCamera, std::vector<std::vector<uint8_t>>& visibility) const;
+
+        /** Find the mesh instances of the visible model instances which intersect the camera frustum. Each model instance culls the hierarchy its model keeps over its mesh instances, see Model::getMeshInstancesBvh().
+            \param[in] pCamera The camera to cull against
+            \param[in] modelInstanceVisibility The model instance visibility returned by cullModelInstances()
+            \param[out] visibility One vector per model. The mesh instances of model instance I start at I * Model::getInstanceCount(), in the order of Model::getMeshInstanceOffset(). Non-zero means the mesh instance is potentially visible.
+            \param[in] pPool If not null, the model instances are split between the pool's threads
+        */
+        void cullMeshInstances(const Camera* pCamera, const std::vector<std::vector<uint8_t>>& modelInstanceVisibility, std::vector<std::vector<uint8_t>>& visibility, ThreadPool* pPool = nullptr) const;
+
+        /** Get the world-space bounding-box of all the model instances
+        */
+        BoundingBox getBoundingBox() const;
+
         // Light sources
         uint32_t addLight(const Light::SharedPtr& pLight);
         void deleteLight(uint32_t lightID);
@@ -208,6 +244,7 @@ namespace Falcor
 		uint32_t mId;
 
         void calculateModelInstanceMatrix(uint32_t modelID, uint32_t instanceID);
+        void updateInstancesBvh() const;
         void detachActiveCameraFromPath();
         void attachActiveCameraToPath();
 
@@ -216,6 +253,7 @@ namespace Falcor
             Model::SharedPtr pModel;
             std::string Filename;
             std::vector<ModelInstance> instances;
+            uint32_t instancesChangeCount = 0;
 
             ModelData(const Model::SharedPtr& pModel, const std::string& _Filename) : pModel(pModel), Filename(_Filename) {}
         };
@@ -232,6 +270,15 @@ namespace Falcor
         float mCameraSpeed = 1;
         float mLightingScale = 1.0f;
         uint32_t mVersion = 0;
+        uint32_t mModelsChangeCount = 0;
+
+        // Instances hierarchy. Primitive IDs are allocated contiguously per model, starting at mInstancesBvhOffsets[modelID].
+        mutable BoundingVolumeHierarchy mInstancesBvh;
+        mutable std::vector<uint32_t> mInstancesBvhOffsets;
+        mutable std::vector<uint32_t> mInstancesBvhGeometryVersions;
+        mutable std::vector<uint32_t> mVisibleInstances;
+        mutable std::vector<std::pair<uint32_t, uint32_t>> mMeshCullInstances;  // Model and instance IDs of the model instances whose mesh instances are culled
+        mutable bool mInstancesBvhDirty = true;
 
         using string_uservar_map = std::map<const std::string, UserVariable>;
         string_uservar_map mUserVars;
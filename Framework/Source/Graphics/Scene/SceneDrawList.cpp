@@ -0,0 +1,125 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "SceneDrawList.h"
+#include <algorithm>
+#include <tuple>
+
+namespace Falcor
+{
+    // Items are ordered by program variant first, since switching it requires patching the program. Skinned models are grouped by model, since they set the bone matrices per model.
+    static bool compareItems(const SceneDrawList::Item& a, const SceneDrawList::Item& b)
+    {
+        const bool aBones = a.pModel->hasBones();
+        const bool bBones = b.pModel->hasBones();
+        const uint32_t aBoneModel = aBones ? a.modelID : 0;
+        const uint32_t bBoneModel = bBones ? b.modelID : 0;
+
+        return std::make_tuple(aBones, aBoneModel, a.materialDescId, a.pMesh->getMaterial().get(), a.pMesh, a.modelID, a.instanceID) <
+            std::make_tuple(bBones, bBoneModel, b.materialDescId, b.pMesh->getMaterial().get(), b.pMesh, b.modelID, b.instanceID);
+    }
+
+    SceneDrawList::UniquePtr SceneDrawList::create(const Scene::SharedConstPtr& pScene)
+    {
+        return UniquePtr(new SceneDrawList(pScene));
+    }
+
+    SceneDrawList::SceneDrawList(const Scene::SharedConstPtr& pScene) : mpScene(pScene)
+    {
+    }
+
+    void SceneDrawList::createModelItems(uint32_t modelID, std::vector<Item>& items) const
+    {
+        const Model* pModel = mpScene->getModel(modelID).get();
+        for(uint32_t instanceID = 0; instanceID < mpScene->getModelInstanceCount(modelID); instanceID++)
+        {
+            for(uint32_t meshID = 0; meshID < pModel->getMeshCount(); meshID++)
+            {
+                Item item;
+                item.pModel = pModel;
+                item.pMesh = pModel->getMesh(meshID).get();
+                item.modelID = modelID;
+                item.instanceID = instanceID;
+                item.meshID = meshID;
+                item.materialDescId = item.pMesh->getMaterial()->getDescIdentifier();
+                items.push_back(item);
+            }
+        }
+    }
+
+    void SceneDrawList::rebuild()
+    {
+        mItems.clear();
+        mInstancesChangeCount.resize(mpScene->getModelCount());
+        mGeometryChangeCount.resize(mpScene->getModelCount());
+
+        for(uint32_t modelID = 0; modelID < mpScene->getModelCount(); modelID++)
+        {
+            createModelItems(modelID, mItems);
+            mInstancesChangeCount[modelID] = mpScene->getModelInstancesChangeCount(modelID);
+            mGeometryChangeCount[modelID] = mpScene->getModel(modelID)->getGeometryChangeCount();
+        }
+
+        std::sort(mItems.begin(), mItems.end(), compareItems);
+        mModelsChangeCount = mpScene->getModelsChangeCount();
+        mDirty = false;
+    }
+
+    void SceneDrawList::rebuildModel(uint32_t modelID)
+    {
+        // Remove the model's items. The rest of the list stays sorted.
+        auto newEnd = std::remove_if(mItems.begin(), mItems.end(), [modelID](const Item& item) {return item.modelID == modelID; });
+        mItems.erase(newEnd, mItems.end());
+
+        // Create the new items and merge them into the list
+        size_t mergeStart = mItems.size();
+        createModelItems(modelID, mItems);
+        std::sort(mItems.begin() + mergeStart, mItems.end(), compareItems);
+        std::inplace_merge(mItems.begin(), mItems.begin() + mergeStart, mItems.end(), compareItems);
+
+        mInstancesChangeCount[modelID] = mpScene->getModelInstancesChangeCount(modelID);
+        mGeometryChangeCount[modelID] = mpScene->getModel(modelID)->getGeometryChangeCount();
+    }
+
+    void SceneDrawList::update()
+    {
+        if(mDirty || mModelsChangeCount != mpScene->getModelsChangeCount())
+        {
+            rebuild();
+            return;
+        }
+
+        for(uint32_t modelID = 0; modelID < mpScene->getModelCount(); modelID++)
+        {
+            if(mInstancesChangeCount[modelID] != mpScene->getModelInstancesChangeCount(modelID) || mGeometryChangeCount[modelID] != mpScene->getModel(modelID)->getGeometryChangeCount())
+            {
+                rebuildModel(modelID);
+            }
+        }
+    }
+}
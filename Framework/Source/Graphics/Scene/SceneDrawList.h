@@ -0,0 +1,88 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <vector>
+#include "Graphics/Scene/Scene.h"
+
+namespace Falcor
+{
+    class Model;
+    class Mesh;
+
+    /** A flattened, sorted list of the scene's draws.\n
+        Each item represents a single mesh of a single model instance. Items are sorted by program variant, material descriptor, material and VAO, so that consecutive items share as much state as possible.
+        The list is built once and is patched incrementally when models or model instances are added or removed. Instance transforms and visibility are not cached and should be read from the scene when rendering.
+    */
+    class SceneDrawList
+    {
+    public:
+        using UniquePtr = std::unique_ptr<SceneDrawList>;
+        using UniqueConstPtr = std::unique_ptr<const SceneDrawList>;
+
+        struct Item
+        {
+            const Model* pModel = nullptr;
+            const Mesh* pMesh = nullptr;
+            uint32_t modelID = 0;
+            uint32_t instanceID = 0;
+            uint32_t meshID = 0;
+            uint64_t materialDescId = 0;    ///< The material's desc identifier at the time the item was created. Used for sorting.
+        };
+
+        /** Create a new draw list
+            \param[in] pScene The scene to build the list from
+        */
+        static UniquePtr create(const Scene::SharedConstPtr& pScene);
+
+        /** Synchronize the list with the scene. Only models whose instance list or meshes changed since the last call are rebuilt.
+        */
+        void update();
+
+        /** Force a full rebuild on the next update() call. Use it after changing the materials of models which are already in the scene.
+        */
+        void invalidate() { mDirty = true; }
+
+        /** Get the sorted list of draw items
+        */
+        const std::vector<Item>& getItems() const { return mItems; }
+
+    private:
+        SceneDrawList(const Scene::SharedConstPtr& pScene);
+
+        void rebuild();
+        void rebuildModel(uint32_t modelID);
+        void createModelItems(uint32_t modelID, std::vector<Item>& items) const;
+
+        Scene::SharedConstPtr mpScene;
+        std::vector<Item> mItems;
+        std::vector<uint32_t> mInstancesChangeCount;
+        std::vector<uint32_t> mGeometryChangeCount;
+        uint32_t mModelsChangeCount = 0;
+        bool mDirty = true;
+    };
+}
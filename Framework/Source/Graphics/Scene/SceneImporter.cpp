@@ -382,7 +382,9 @@ namespace Falcor
         }
 
         bool isSrgb = (mModelLoadFlags & Model::AssumeLinearSpaceTextures) == 0;
-        pTexture = createTextureFromFile(filename, true, isSrgb);
+        auto pData = loadTextureDataFromFile(filename, true, isSrgb);
+        AsyncLoader::addItems(1);
+        AsyncLoader::upload([&]() {pTexture = createTextureFromData(pData); });
         return (pTexture != nullptr);
     }
 
@@ -1079,10 +1081,12 @@ namespace Falcor
         if(findFileInDataDirectories(filename, fullpath))
         {
             // Load the file
+            uint64_t fileSize = AsyncLoader::addFile(fullpath);
             std::ifstream fileStream(fullpath);
             std::stringstream strStream;
             strStream << fileStream.rdbuf();
             std::string jsonData = strStream.str();
+            AsyncLoader::reportBytesLoaded(fileSize);
             rapidjson::StringStream JStream(jsonData.c_str());
 
             // Get the file directory
@@ -1112,7 +1116,8 @@ namespace Falcor
 			{
 				case Scene::GenerateAreaLights:
 					// Create area light(s) in the scene
-					mpScene->createAreaLights();
+					AsyncLoader::addItems(1);
+					AsyncLoader::upload([this]() {mpScene->createAreaLights(); });
 					break;
 			}
 			
@@ -37,6 +37,8 @@
 #include "Core/Window.h"
 #include "glm/matrix.hpp"
 #include "Graphics/Material/MaterialSystem.h"
+#include "Utils/ThreadPool.h"
+#include "Utils/RenderStats.h"
 
 namespace Falcor
 {
@@ -44,16 +46,27 @@ namespace Falcor
     UniformBuffer::SharedPtr SceneRenderer::sPerFrameCB;
     UniformBuffer::SharedPtr SceneRenderer::sPerStaticMeshCB;
     UniformBuffer::SharedPtr SceneRenderer::sPerSkinnedMeshCB;
-    size_t SceneRenderer::sBonesOffset = 0;
+    UniformBuffer::Handle<glm::mat4> SceneRenderer::sBonesHandle;
     size_t SceneRenderer::sCameraDataOffset = 0;
-    size_t SceneRenderer::sWorldMatOffset = 0;
-    size_t SceneRenderer::sMeshIdOffset = 0;
+    size_t SceneRenderer::sMaterialOffset = 0;
+    UniformBuffer::Handle<glm::mat4> SceneRenderer::sWorldMatHandle;
+    UniformBuffer::Handle<uint32_t> SceneRenderer::sMeshIdHandle;
+    UniformBuffer::Handle<uint32_t> SceneRenderer::sInstanceBaseHandle;
+    UniformBuffer::Handle<glm::mat4> SceneRenderer::sPositionDequantMatHandle;
+    UniformBuffer::Handle<uint32_t> SceneRenderer::sOctahedralDirectionsHandle;
+    ShaderStorageBuffer::SharedPtr SceneRenderer::sInstanceDataSB;
+    GpuRingBuffer::UniquePtr SceneRenderer::spInstanceDataRing;
+    size_t SceneRenderer::sFrameInstanceCount = 0;
     
 
     static const std::string kPerMaterialCbName = "InternalPerMaterialCB";
     static const std::string kPerFrameCbName = "InternalPerFrameCB";
     static const std::string kPerStaticMeshCbName = "InternalPerStaticMeshCB";
     static const std::string kPerSkinnedMeshCbName = "InternalPerSkinnedMeshCB";
+    static const std::string kInstanceDataSbName = "InternalInstanceDataSB";
+    static const uint32_t kInstanceDataSbBinding = 7;           // Must match the binding in ShaderCommon.h
+    static const uint32_t kInstanceDataFramesInFlight = 3;
+    static const size_t kMinStreamedInstanceCount = 16 * 1024;  // Initial per-frame capacity of the instance data buffer
 
     SceneRenderer::UniquePtr SceneRenderer::create(const Scene::SharedPtr& pScene)
     {
@@ -62,6 +75,8 @@ namespace Falcor
 
     SceneRenderer::SceneRenderer(const Scene::SharedPtr& pScene) : mpScene(pScene)
     {
+        mpDrawList = SceneDrawList::create(pScene);
+        mpAnimationScheduler = AnimationScheduler::create(pScene);
         setCameraControllerType(CameraControllerType::SixDof);
     }
 
@@ -76,10 +91,29 @@ namespace Falcor
             sPerStaticMeshCB = UniformBuffer::create(pProgVer, kPerStaticMeshCbName);
             sPerSkinnedMeshCB = UniformBuffer::create(pProgVer, kPerSkinnedMeshCbName);
 
-            sBonesOffset = sPerSkinnedMeshCB->getVariableOffset("gBones");
-            sWorldMatOffset = sPerStaticMeshCB->getVariableOffset("gWorldMat");
-            sMeshIdOffset = sPerStaticMeshCB->getVariableOffset("gMeshId");
+            sBonesHandle = sPerSkinnedMeshCB->getHandle<glm::mat4>("gBones");
+            sWorldMatHandle = sPerStaticMeshCB->getHandle<glm::mat4>("gWorldMat");
+            sMeshIdHandle = sPerStaticMeshCB->getHandle<uint32_t>("gMeshId");
+            sInstanceBaseHandle = sPerStaticMeshCB->getHandle<uint32_t>("gInstanceBase");
+            sPositionDequantMatHandle = sPerStaticMeshCB->getHandle<glm::mat4>("gPositionDequantMat");
+            sOctahedralDirectionsHandle = sPerStaticMeshCB->getHandle<uint32_t>("gOctahedralDirections");
+
+            // The handles are resolved once, from the first program. Setting a variable through an invalid handle does nothing, so report the ones which are missing.
+            auto checkHandle = [](bool isValid, const std::string& name, const std::string& cbName)
+            {
+                if(isValid == false)
+                {
+                    Logger::log(Logger::Level::Warning, "SceneRenderer: \"" + name + "\" wasn't found in \"" + cbName + "\" when creating the uniform buffers. The renderer won't set it.");
+                }
+            };
+            checkHandle(sBonesHandle.isValid(), "gBones", kPerSkinnedMeshCbName);
+            checkHandle(sWorldMatHandle.isValid(), "gWorldMat", kPerStaticMeshCbName);
+            checkHandle(sMeshIdHandle.isValid(), "gMeshId", kPerStaticMeshCbName);
+            checkHandle(sInstanceBaseHandle.isValid(), "gInstanceBase", kPerStaticMeshCbName);
+            checkHandle(sPositionDequantMatHandle.isValid(), "gPositionDequantMat", kPerStaticMeshCbName);
+            checkHandle(sOctahedralDirectionsHandle.isValid(), "gOctahedralDirections", kPerStaticMeshCbName);
             sCameraDataOffset = sPerFrameCB->getVariableOffset("gCam.viewMat");
+            sMaterialOffset = sPerMaterialCB->getVariableOffset("gMaterial.desc.layers[0].type");
         }
     }
 
@@ -119,7 +153,7 @@ namespace Falcor
         // Set bones
         if(currentData.pModel->hasBones())
         {
-            sPerSkinnedMeshCB->setVariableArray(sBonesOffset, currentData.pModel->getBonesMatrices(), currentData.pModel->getBonesCount());
+            sPerSkinnedMeshCB->setVariableArray(sBonesHandle, currentData.pModel->getBonesMatrices(), currentData.pModel->getBonesCount());
         }
 		return true;
     }
@@ -129,28 +163,27 @@ namespace Falcor
 		return true;
     }
 
-    bool SceneRenderer::setPerMeshInstanceData(RenderContext* pContext, const glm::mat4& translation, uint32_t meshInstanceID, uint32_t drawInstanceID, const CurrentWorkingData& currentData)
+    bool SceneRenderer::setPerMeshInstanceWorldMatrix(RenderContext* pContext, const glm::mat4& worldMat, uint32_t meshInstanceID, uint32_t drawInstanceID, const CurrentWorkingData& currentData)
     {
-        glm::mat4 worldMat = translation;
-        if(currentData.pMesh->hasBones() == false)
-        {
-            worldMat = worldMat * currentData.pMesh->getInstanceMatrix(meshInstanceID);
-        }
-        sPerStaticMeshCB->setBlob(&worldMat, sWorldMatOffset + drawInstanceID*sizeof(glm::mat4), sizeof(glm::mat4));
+        sPerStaticMeshCB->setVariable(sWorldMatHandle, drawInstanceID, worldMat);
 
         // Set mesh id
-        sPerStaticMeshCB->setVariable(sMeshIdOffset, currentData.pMesh->getId());
+        sPerStaticMeshCB->setVariable(sMeshIdHandle, currentData.pMesh->getId());
 
 		return true;
     }
 
     bool SceneRenderer::setPerMaterialData(RenderContext* pContext, const CurrentWorkingData& currentData)
     {
-        currentData.pMaterial->setIntoUniformBuffer(sPerMaterialCB.get(), "gMaterial");
+        if(sMaterialOffset == UniformBuffer::kInvalidUniformOffset)
+        {
+            return false;
+        }
+        currentData.pMaterial->setIntoUniformBuffer(sPerMaterialCB.get(), sMaterialOffset);
 		return true;
     }
 
-    void SceneRenderer::flushDraw(RenderContext* pContext, const Mesh* pMesh, uint32_t instanceCount, CurrentWorkingData& currentData)
+    void SceneRenderer::flushDraw(RenderContext* pContext, const Mesh* pMesh, uint32_t instanceCount, CurrentWorkingData& currentData, const uint32_t* pRangeFirstIndices, const uint32_t* pRangeIndexCounts, uint32_t rangeCount)
     {
 		currentData.pMaterial = pMesh->getMaterial().get();
         // Bind material
@@ -162,6 +195,7 @@ namespace Falcor
             }
             mpLastMaterial = pMesh->getMaterial().get();
             setPerMaterialData(pContext, currentData);
+            RenderStats::recordMaterialSwitch();
 
             if(mCompileMaterialWithProgram)
             {
@@ -170,8 +204,22 @@ namespace Falcor
             }
         }
 
+        if(mInstanceDataStreaming)
+        {
+            sPerStaticMeshCB->setVariable(sMeshIdHandle, pMesh->getId());
+            sPerStaticMeshCB->setVariable(sInstanceBaseHandle, mStreamedInstanceBase);
+        }
+
         // Draw
-        pContext->drawIndexedInstanced(pMesh->getIndexCount(), instanceCount, 0, 0, 0);
+        if(rangeCount)
+        {
+            assert(instanceCount == 1);
+            pContext->multiDrawIndexed(pRangeIndexCounts, pRangeFirstIndices, rangeCount, pMesh->getBaseVertex());
+        }
+        else
+        {
+            pContext->drawIndexedInstanced(pMesh->getIndexCount(), instanceCount, pMesh->getFirstIndex(), pMesh->getBaseVertex(), 0);
+        }
         postFlushDraw(pContext, currentData);
     }
 
@@ -180,86 +228,451 @@ namespace Falcor
 
     }
 
-    void SceneRenderer::renderMesh(RenderContext* pContext, const Mesh* pMesh, const glm::mat4& translation, Camera* pCamera, CurrentWorkingData& currentData)
+    uint32_t SceneRenderer::cullMeshClusters(const Mesh* pMesh, const glm::mat4& worldMat, TraversalChunk& chunk) const
     {
-		currentData.pMesh = pMesh;
-
-		if (setPerMeshData(pContext, currentData))
-		{
-			// Bind VAO and set topology
-			pContext->setVao(pMesh->getVao());
-			pContext->setTopology(pMesh->getTopology());
-
-			uint32_t InstanceCount = pMesh->getInstanceCount();
-
-			uint32_t activeInstances = 0;
-			//auto pCamera = mpScene->getActiveCamera();
-
-			for (uint32_t instanceID = 0; instanceID < InstanceCount; instanceID++)
-			{
-				BoundingBox box = pMesh->getInstanceBoundingBox(instanceID).transform(translation);
-
-				if ((mCullEnabled == false) || (pCamera->isObjectCulled(box) == false))
-				{
-					if (setPerMeshInstanceData(pContext, translation, instanceID, activeInstances, currentData))
-					{
-						activeInstances++;
-
-						if (activeInstances == mMaxInstanceCount)
-						{
-
-							pContext->setProgram(currentData.pProgram->getActiveProgramVersion());
-							flushDraw(pContext, pMesh, activeInstances, currentData);
-							activeInstances = 0;
-						}
-					}
-				}
-			}
-			if(activeInstances != 0)
-			{
-				pContext->setProgram(currentData.pProgram->getActiveProgramVersion());
-				flushDraw(pContext, currentData.pMesh, activeInstances, currentData);
-			}
-		}
+        const std::vector<MeshCluster>& clusters = pMesh->getClusters();
+        const uint32_t clusterCount = (uint32_t)clusters.size();
+        chunk.worldClusters.resize(clusterCount);
+        transformMeshClusters(clusters.data(), clusterCount, worldMat, chunk.worldClusters.data());
+
+        // Frustum-cull the cubes bounding the spheres, using the batched box test
+        chunk.cullBoxes.resize(clusterCount);
+        for(uint32_t i = 0; i < clusterCount; i++)
+        {
+            BoundingBox box;
+            box.center = chunk.worldClusters[i].center;
+            box.extent = glm::vec3(chunk.worldClusters[i].radius);
+            chunk.cullBoxes.set(i, box);
+        }
+        chunk.clusterVisibility.resize(clusterCount);
+        mpCurrentCamera->cullBoxes(chunk.cullBoxes, chunk.clusterVisibility.data());
+
+        // Clusters are contiguous in the index buffer, so runs of visible clusters are merged into a single range
+        uint32_t rangeCount = 0;
+        uint32_t rangeEnd = 0;
+        for(uint32_t i = 0; i < clusterCount; i++)
+        {
+            const MeshCluster& cluster = chunk.worldClusters[i];
+            const bool backfacing = mOrthographicView ? isClusterBackfacingParallel(cluster, mViewDirection, mClockwiseFront) : isClusterBackfacing(cluster, mViewPosition, mClockwiseFront);
+            if(chunk.clusterVisibility[i] == 0 || (mCullBackfacingClusters && backfacing))
+            {
+                chunk.culledClusters++;
+                continue;
+            }
+
+            uint32_t firstIndex = pMesh->getFirstIndex() + cluster.firstIndex;
+            if(rangeCount && firstIndex == rangeEnd)
+            {
+                chunk.rangeIndexCounts.back() += cluster.indexCount;
+            }
+            else
+            {
+                chunk.rangeFirstIndices.push_back(firstIndex);
+                chunk.rangeIndexCounts.push_back(cluster.indexCount);
+                rangeCount++;
+            }
+            rangeEnd = firstIndex + cluster.indexCount;
+        }
+        return rangeCount;
     }
 
-    void SceneRenderer::renderModel(RenderContext* pContext, Program* pProgram, const Model* pModel, const glm::mat4& instanceMatrix, Camera* pCamera, CurrentWorkingData& currentData)
-    {        
-		currentData.pModel = pModel;
-		if (setPerModelData(pContext, currentData))
-		{
-			// Bind the program
-			if(pModel->hasBones())
-			{
-				pProgram->addDefine("_VERTEX_BLENDING");
-			}
-
-
-			mpLastMaterial = nullptr;
-
-			// Loop over the meshes
-			for (uint32_t meshID = 0; meshID < pModel->getMeshCount(); meshID++)
-			{
-				renderMesh(pContext, pModel->getMesh(meshID).get(), instanceMatrix, pCamera, currentData);
-			}
-
-			// Restore the program state
-			if(pModel->hasBones())
-			{
-                pProgram->removeDefine("_VERTEX_BLENDING");
+    void SceneRenderer::generateDrawPackets(uint32_t firstItem, uint32_t itemCount, TraversalChunk& chunk) const
+    {
+        chunk.packets.clear();
+        chunk.worldMats.clear();
+        chunk.meshInstanceIDs.clear();
+        chunk.rangeFirstIndices.clear();
+        chunk.rangeIndexCounts.clear();
+        chunk.culledInstances = 0;
+        chunk.culledClusters = 0;
+
+        const auto& items = mpDrawList->getItems();
+        for(uint32_t i = firstItem; i < firstItem + itemCount; i++)
+        {
+            const auto& item = items[i];
+            const auto& instance = mpScene->getModelInstance(item.modelID, item.instanceID);
+            if(instance.isVisible == false)
+            {
+                continue;
+            }
+
+            const Mesh* pMesh = item.pMesh;
+            const uint32_t instanceCount = pMesh->getInstanceCount();
+            if(mCullEnabled && mModelInstanceVisibility[item.modelID][item.instanceID] == 0)
+            {
+                chunk.culledInstances += instanceCount;
+                continue;
+            }
+
+            // The mesh instances were culled for the whole model instance before the traversal
+            const uint8_t* pMeshInstanceVisibility = nullptr;
+            if(mCullEnabled)
+            {
+                pMeshInstanceVisibility = mMeshInstanceVisibility[item.modelID].data() + size_t(item.instanceID) * item.pModel->getInstanceCount() + item.pModel->getMeshInstanceOffset(item.meshID);
+            }
+
+            DrawPacket packet;
+            packet.pModel = item.pModel;
+            packet.pMesh = pMesh;
+            packet.pMaterial = pMesh->getMaterial().get();
+            packet.vertexBlending = item.pModel->hasBones();
+            packet.firstInstance = (uint32_t)chunk.worldMats.size();
+            packet.firstRange = 0;
+            packet.rangeCount = 0;
+
+            // Skinned meshes move away from the bounds their clusters were built for
+            const bool cullClusters = mCullEnabled && mClusterCullEnabled && pMesh->getClusters().size() && (pMesh->hasBones() == false);
+            chunk.partialInstances.clear();
+
+            for(uint32_t meshInstanceID = 0; meshInstanceID < instanceCount; meshInstanceID++)
+            {
+                if((mCullEnabled == false) || pMeshInstanceVisibility[meshInstanceID])
+                {
+                    glm::mat4 worldMat = instance.transformMatrix;
+                    if(pMesh->hasBones() == false)
+                    {
+                        worldMat = worldMat * pMesh->getInstanceMatrix(meshInstanceID);
+                    }
+
+                    if(cullClusters)
+                    {
+                        uint32_t firstRange = (uint32_t)chunk.rangeFirstIndices.size();
+                        uint32_t rangeCount = cullMeshClusters(pMesh, worldMat, chunk);
+                        if(rangeCount == 0)
+                        {
+                            chunk.culledInstances++;
+                            continue;
+                        }
+                        if(chunk.rangeIndexCounts[firstRange] != pMesh->getIndexCount())
+                        {
+                            chunk.partialInstances.push_back({worldMat, meshInstanceID, firstRange, rangeCount});
+                            continue;
+                        }
+
+                        // Nothing was culled, the instance is batched with the others
+                        chunk.rangeFirstIndices.resize(firstRange);
+                        chunk.rangeIndexCounts.resize(firstRange);
+                    }
+
+                    chunk.worldMats.push_back(worldMat);
+                    chunk.meshInstanceIDs.push_back(meshInstanceID);
+                }
+                else
+                {
+                    chunk.culledInstances++;
+                }
             }
-		}
 
+            packet.instanceCount = (uint32_t)chunk.worldMats.size() - packet.firstInstance;
+            if(packet.instanceCount)
+            {
+                chunk.packets.push_back(packet);
+            }
+
+            for(const PartialInstance& partial : chunk.partialInstances)
+            {
+                DrawPacket rangePacket = packet;
+                rangePacket.firstInstance = (uint32_t)chunk.worldMats.size();
+                rangePacket.instanceCount = 1;
+                rangePacket.firstRange = partial.firstRange;
+                rangePacket.rangeCount = partial.rangeCount;
+                chunk.worldMats.push_back(partial.worldMat);
+                chunk.meshInstanceIDs.push_back(partial.meshInstanceID);
+                chunk.packets.push_back(rangePacket);
+            }
+        }
     }
 
-    bool SceneRenderer::update(double currentTime)
+    void SceneRenderer::generateDrawPackets(const Camera* pCamera)
+    {
+        // The chunk size doesn't depend on the number of threads, and chunks cover contiguous ranges of the sorted draw list.
+        // Submitting the chunks in order produces the same packet stream as a single-threaded traversal.
+        const uint32_t itemCount = (uint32_t)mpDrawList->getItems().size();
+        const uint32_t chunkCount = (itemCount + kItemsPerTraversalChunk - 1) / kItemsPerTraversalChunk;
+        if(mTraversalChunks.size() < chunkCount)
+        {
+            mTraversalChunks.resize(chunkCount);
+        }
+        mTraversalChunkCount = chunkCount;
+
+        // The camera lazily updates its frustum planes. Make sure they are up-to-date before sharing it between threads.
+        pCamera->getViewProjMatrix();
+        mpCurrentCamera = pCamera;
+
+        // The back-facing cluster test needs the viewer in world space. The view matrix alone isn't enough, shadow passes for example fold the light's view into the projection.
+        // All the view rays meet at the point which projects to infinity along the clip-space depth axis. It's the eye with a perspective projection, and a direction with an orthographic one.
+        const glm::mat4& viewProj = pCamera->getViewProjMatrix();
+        mOrthographicView = (viewProj[0][3] == 0) && (viewProj[1][3] == 0) && (viewProj[2][3] == 0);
+        if(mOrthographicView)
+        {
+            // Orient the rays away from the viewer. Mirroring the screen or the depth flips the winding of the projected triangles, so it flips the rays too.
+            const glm::mat3 linear(viewProj);
+            mViewDirection = glm::normalize(glm::inverse(linear) * glm::vec3(0, 0, 1)) * ((glm::determinant(linear) > 0) ? -1.0f : 1.0f);
+        }
+        else
+        {
+            const glm::vec4 eye = pCamera->getInvViewProjMatrix() * glm::vec4(0, 0, 1, 0);
+            mViewPosition = glm::vec3(eye) / eye.w;
+        }
+
+        auto traverseChunk = [this, itemCount](uint32_t chunkID)
+        {
+            uint32_t firstItem = chunkID * kItemsPerTraversalChunk;
+            generateDrawPackets(firstItem, std::min(itemCount - firstItem, (uint32_t)kItemsPerTraversalChunk), mTraversalChunks[chunkID]);
+        };
+
+        if(mMultithreadedTraversal)
+        {
+            ThreadPool::getGlobalPool()->run(chunkCount, traverseChunk);
+        }
+        else
+        {
+            for(uint32_t chunkID = 0; chunkID < chunkCount; chunkID++)
+            {
+                traverseChunk(chunkID);
+            }
+        }
+        mpCurrentCamera = nullptr;
+    }
+
+    void SceneRenderer::submitDrawPackets(RenderContext* pContext, CurrentWorkingData& currentData)
+    {
+        Program* pProgram = currentData.pProgram;
+        const Model* pActiveModel = nullptr;
+        const Mesh* pActiveMesh = nullptr;
+        bool modelValid = false;
+        bool meshValid = false;
+        bool vertexBlending = false;
+        uint32_t activeInstances = 0;
+        mpLastMaterial = nullptr;
+
+        // Packets are sorted, so consecutive packets of the same mesh are batched into the same draw call, even if they belong to different model instances
+        for(uint32_t chunkID = 0; chunkID < mTraversalChunkCount; chunkID++)
+        {
+            const TraversalChunk& chunk = mTraversalChunks[chunkID];
+            RenderStats::recordCulledInstances(chunk.culledInstances);
+            RenderStats::recordCulledClusters(chunk.culledClusters);
+            for(const auto& packet : chunk.packets)
+            {
+                if(packet.pModel != pActiveModel || packet.pMesh != pActiveMesh)
+                {
+                    if(activeInstances != 0)
+                    {
+                        pContext->setProgram(pProgram->getActiveProgramVersion());
+                        flushDraw(pContext, pActiveMesh, activeInstances, currentData);
+                        activeInstances = 0;
+                    }
+                    pActiveMesh = nullptr;
+                }
+
+                if(packet.pModel != pActiveModel)
+                {
+                    pActiveModel = packet.pModel;
+                    currentData.pModel = pActiveModel;
+                    modelValid = setPerModelData(pContext, currentData);
+
+                    // Switch the program variant. The patched program depends on the active version, so force a material rebind.
+                    if(packet.vertexBlending != vertexBlending)
+                    {
+                        vertexBlending = packet.vertexBlending;
+                        if(vertexBlending)
+                        {
+                            pProgram->addDefine("_VERTEX_BLENDING");
+                        }
+                        else
+                        {
+                            pProgram->removeDefine("_VERTEX_BLENDING");
+                        }
+                        mpLastMaterial = nullptr;
+                    }
+                }
+
+                if(modelValid == false)
+                {
+                    continue;
+                }
+
+                if(packet.pMesh != pActiveMesh)
+                {
+                    pActiveMesh = packet.pMesh;
+                    currentData.pMesh = pActiveMesh;
+                    meshValid = setPerMeshData(pContext, currentData);
+                    if(meshValid)
+                    {
+                        // Bind VAO and set topology
+                        pContext->setVao(pActiveMesh->getVao());
+                        pContext->setTopology(pActiveMesh->getTopology());
+
+                        // Tell the vertex shader how to decode the VAO's attributes
+                        const VertexQuantization& quantization = pActiveMesh->getVertexQuantization();
+                        sPerStaticMeshCB->setVariable(sPositionDequantMatHandle, quantization.getPositionDequantMatrix());
+                        sPerStaticMeshCB->setVariable(sOctahedralDirectionsHandle, quantization.octahedralDirections ? 1u : 0u);
+                    }
+                }
+
+                if(meshValid == false)
+                {
+                    continue;
+                }
+
+                if(packet.rangeCount)
+                {
+                    // An instance with culled clusters. Flush the batch, then draw the visible ranges.
+                    if(activeInstances != 0)
+                    {
+                        pContext->setProgram(pProgram->getActiveProgramVersion());
+                        flushDraw(pContext, pActiveMesh, activeInstances, currentData);
+                        activeInstances = 0;
+                    }
+
+                    if(mInstanceDataStreaming)
+                    {
+                        mStreamedInstanceBase = mChunkInstanceBase[chunkID] + packet.firstInstance;
+                    }
+                    else if(setPerMeshInstanceWorldMatrix(pContext, chunk.worldMats[packet.firstInstance], chunk.meshInstanceIDs[packet.firstInstance], 0, currentData) == false)
+                    {
+                        continue;
+                    }
+
+                    pContext->setProgram(pProgram->getActiveProgramVersion());
+                    flushDraw(pContext, pActiveMesh, 1, currentData, &chunk.rangeFirstIndices[packet.firstRange], &chunk.rangeIndexCounts[packet.firstRange], packet.rangeCount);
+                    continue;
+                }
+
+                if(mInstanceDataStreaming)
+                {
+                    // Packets of the same mesh are adjacent in the instance data buffer, so the entire batch is a single draw
+                    if(activeInstances == 0)
+                    {
+                        mStreamedInstanceBase = mChunkInstanceBase[chunkID] + packet.firstInstance;
+                    }
+                    activeInstances += packet.instanceCount;
+                    continue;
+                }
+
+                for(uint32_t i = packet.firstInstance; i < packet.firstInstance + packet.instanceCount; i++)
+                {
+                    if(setPerMeshInstanceWorldMatrix(pContext, chunk.worldMats[i], chunk.meshInstanceIDs[i], activeInstances, currentData))
+                    {
+                        activeInstances++;
+
+                        if(activeInstances == mMaxInstanceCount)
+                        {
+                            pContext->setProgram(pProgram->getActiveProgramVersion());
+                            flushDraw(pContext, pActiveMesh, activeInstances, currentData);
+                            activeInstances = 0;
+                        }
+                    }
+                }
+            }
+        }
+
+        if(activeInstances != 0)
+        {
+            pContext->setProgram(pProgram->getActiveProgramVersion());
+            flushDraw(pContext, pActiveMesh, activeInstances, currentData);
+        }
+
+        // Restore the program state
+        if(vertexBlending)
+        {
+            pProgram->removeDefine("_VERTEX_BLENDING");
+        }
+    }
+
+    void SceneRenderer::renderDrawList(RenderContext* pContext, CurrentWorkingData& currentData)
+    {
+        mpDrawList->update();
+        if(mCullEnabled)
+        {
+            // Hierarchical culling of the model instances, then of the mesh instances of the visible ones. Clusters are culled when generating the draw packets.
+            mpScene->cullModelInstances(currentData.pCamera, mModelInstanceVisibility);
+            mpScene->cullMeshInstances(currentData.pCamera, mModelInstanceVisibility, mMeshInstanceVisibility, mMultithreadedTraversal ? ThreadPool::getGlobalPool() : nullptr);
+        }
+
+        // Back-facing clusters can only be skipped if the rasterizer culls them anyway. The test uses a single viewer, so it's disabled for stereo.
+        const RasterizerState* pRastState = pContext->getRasterizerState().get();
+        mCullBackfacingClusters = (mRenderMode == RenderMode::Mono) && (pRastState->getCullMode() != RasterizerState::CullMode::None);
+        mClockwiseFront = (pRastState->getCullMode() == RasterizerState::CullMode::Front) == pRastState->isFrontCounterCW();
+
+        generateDrawPackets(currentData.pCamera);
+        if(mInstanceDataStreaming)
+        {
+            streamInstanceData(currentData.pProgram);
+            pContext->setShaderStorageBuffer(kInstanceDataSbBinding, sInstanceDataSB);
+        }
+
+        submitDrawPackets(pContext, currentData);
+    }
+
+    void SceneRenderer::endFrame()
     {
-        return mpScene->updateCamera(currentTime, mpCameraController.get());
+        // A scene is usually rendered several times per frame (shadow maps, reflections, etc.), so the ranges are fenced once per frame and not once per renderScene() call
+        if(spInstanceDataRing)
+        {
+            spInstanceDataRing->endFrame();
+        }
+        sFrameInstanceCount = 0;
+    }
+
+    void SceneRenderer::createInstanceDataBuffer(Program* pProgram, size_t instanceCount)
+    {
+        // The buffer is only declared when _INSTANCE_DATA_STREAMING is defined, so it has to be created from the streaming program version
+        size_t frameSize = max(instanceCount, kMinStreamedInstanceCount) * sizeof(glm::mat4);
+        sInstanceDataSB = ShaderStorageBuffer::create(pProgram->getActiveProgramVersion().get(), kInstanceDataSbName, frameSize * kInstanceDataFramesInFlight);
+        // The data is written directly into the GPU buffer. Clear the CPU copy's dirty flag, otherwise the first draw will overwrite the buffer.
+        sInstanceDataSB->uploadToGPU();
+        spInstanceDataRing = GpuRingBuffer::create(sInstanceDataSB->getBuffer());
+    }
+
+    void SceneRenderer::streamInstanceData(Program* pProgram)
+    {
+        mChunkInstanceBase.resize(mTraversalChunkCount);
+        uint32_t instanceCount = 0;
+        for(uint32_t chunkID = 0; chunkID < mTraversalChunkCount; chunkID++)
+        {
+            mChunkInstanceBase[chunkID] = instanceCount;
+            instanceCount += (uint32_t)mTraversalChunks[chunkID].worldMats.size();
+        }
+
+        // Grow the buffer if the data written so far in this frame doesn't fit into a third of it
+        sFrameInstanceCount += instanceCount;
+        if(spInstanceDataRing == nullptr || (sFrameInstanceCount * sizeof(glm::mat4) * kInstanceDataFramesInFlight > spInstanceDataRing->getBuffer()->getSize()))
+        {
+            createInstanceDataBuffer(pProgram, sFrameInstanceCount);
+        }
+
+        if(instanceCount == 0)
+        {
+            return;
+        }
+
+        size_t offset;
+        glm::mat4* pDst = (glm::mat4*)spInstanceDataRing->map(instanceCount * sizeof(glm::mat4), sizeof(glm::mat4), offset);
+        if(pDst == nullptr)
+        {
+            return;
+        }
 
-        for(uint32_t modelID = 0; modelID < mpScene->getModelCount(); modelID++)
+        // All the chunks are written into one contiguous range, in submission order
+        for(uint32_t chunkID = 0; chunkID < mTraversalChunkCount; chunkID++)
         {
-            mpScene->getModel(modelID)->animate(currentTime);
+            const auto& worldMats = mTraversalChunks[chunkID].worldMats;
+            if(worldMats.size())
+            {
+                memcpy(pDst + mChunkInstanceBase[chunkID], worldMats.data(), worldMats.size() * sizeof(glm::mat4));
+            }
+            mChunkInstanceBase[chunkID] += (uint32_t)(offset / sizeof(glm::mat4));
         }
+        spInstanceDataRing->unmap();
+    }
+
+    bool SceneRenderer::update(double currentTime)
+    {
+        // Update the camera first, so that the animation update rates are selected from the camera used to render this frame
+        bool cameraChanged = mpScene->updateCamera(currentTime, mpCameraController.get());
+        mpAnimationScheduler->update(mpScene->getActiveCamera().get(), currentTime);
+        return cameraChanged;
     }
 
     void SceneRenderer::renderScene(RenderContext* pContext, Program* pProgram)
@@ -284,6 +697,10 @@ namespace Falcor
 
     void SceneRenderer::renderScene(RenderContext* pContext, Program* pProgram, Camera* pCamera)
     {
+        if(mInstanceDataStreaming)
+        {
+            pProgram->addDefine("_INSTANCE_DATA_STREAMING");
+        }
         bindUniformBuffers(pContext, pProgram);
 		CurrentWorkingData currentData;
 		currentData.pProgram = pProgram;
@@ -293,17 +710,11 @@ namespace Falcor
 		currentData.pModel = nullptr;
         setupVR();
         setPerFrameData(pContext, currentData);
+        renderDrawList(pContext, currentData);
 
-        for (uint32_t modelID = 0; modelID < mpScene->getModelCount(); modelID++)
+        if(mInstanceDataStreaming)
         {
-            for (uint32_t InstanceID = 0; InstanceID < mpScene->getModelInstanceCount(modelID); InstanceID++)
-            {
-                auto& Instance = mpScene->getModelInstance(modelID, InstanceID);
-                if (Instance.isVisible)
-                {
-                    renderModel(pContext, pProgram, mpScene->getModel(modelID).get(), Instance.transformMatrix, pCamera, currentData);
-                }
-            }
+            pProgram->removeDefine("_INSTANCE_DATA_STREAMING");
         }
     }
 
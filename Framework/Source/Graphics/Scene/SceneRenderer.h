@@ -30,9 +30,14 @@
 #include "Utils/Gui.h"
 #include "Graphics/Camera/CameraController.h"
 #include "Graphics/Scene/Scene.h"
+#include "Graphics/Scene/SceneDrawList.h"
+#include "Graphics/Scene/AnimationScheduler.h"
+#include "Graphics/Model/MeshClusters.h"
 #include "SceneEditor.h"
 #include "utils/CpuTimer.h"
 #include "Core/UniformBuffer.h"
+#include "Core/ShaderStorageBuffer.h"
+#include "Core/GpuRingBuffer.h"
 
 namespace Falcor
 {
@@ -69,21 +74,44 @@ namespace Falcor
         void renderScene(RenderContext* pContext, Program* pProgram, Camera* pCamera);
         
         /** Update the camera and model animation.
-            Should be called before renderScene(), unless not animations are used and you update the camera manualy
+            Should be called before renderScene(), unless not animations are used and you update the camera manualy.\n
+            The animated models are updated by the animation scheduler, using the active camera. Use getAnimationScheduler() to configure the update rates and time budget.
         */
         bool update(double currentTime);
 
         bool onKeyEvent(const KeyboardEvent& keyEvent);
         bool onMouseEvent(const MouseEvent& mouseEvent);
 
-        /** Enable/disable mesh culling. Culling does not always result in performance gain, especially when there are a lot of meshes to process with low rejection rate.
+        /** Enable/disable culling. Model instances are culled using the scene's bounding volume hierarchy, and the mesh instances of the remaining model instances are culled using their model's hierarchy, see Scene::cullMeshInstances().
+            Culling does not always result in performance gain, especially when there are a lot of meshes to process with low rejection rate.
         */
         void setObjectCullState(bool enable) { mCullEnabled = enable; }
 
+        /** Enable/disable culling of mesh clusters. Applies to meshes which were split into clusters (see Model::GenerateMeshClusters), when object culling is enabled.\n
+            The clusters of the visible mesh instances are frustum-culled, and clusters which are entirely back-facing are rejected if the bound rasterizer state culls them anyway. Mesh instances
+            with culled clusters are drawn on their own, with a single multi-draw of the remaining index ranges. Back-facing clusters are only rejected in RenderMode::Mono.
+        */
+        void setClusterCullState(bool enable) { mClusterCullEnabled = enable; }
+
         /** Set the maximal number of mesh instance to dispatch in a single draw call.
         */
         void setMaxInstanceCount(uint32_t instanceCount) { mMaxInstanceCount = instanceCount; }
 
+        /** Enable/disable multi-threaded scene traversal. When enabled, culling and draw packet generation are split across the global thread pool. Draw calls are always submitted from the calling thread.\n
+            The packets are generated per fixed-size range of the draw list and submitted in order, so both modes produce the exact same draw calls.
+        */
+        void setMultithreadedTraversal(bool enable) { mMultithreadedTraversal = enable; }
+
+        /** Enable/disable instance data streaming. When enabled, the world matrices of all the visible instances are written once per renderScene() call into a shader storage buffer, and each batch of instances of the same mesh is rendered with a single draw call, regardless of the max instance count.\n
+            The program is compiled with _INSTANCE_DATA_STREAMING defined. Shaders which use getWorldMat() from VertexAttrib.h work in both modes. setPerMeshInstanceWorldMatrix() is not called in this mode.\n
+            The streamed data is shared by all the renderers and is reused only after the GPU finished the frame which used it, so endFrame() must be called once per frame.
+        */
+        void setInstanceDataStreaming(bool enable) { mInstanceDataStreaming = enable; }
+
+        /** Close the current frame of streamed instance data. Sample calls it at the end of every frame. Applications which don't use Sample's message loop must call it after submitting the frame.
+        */
+        static void endFrame();
+
         /** This setting controls whether to unload textures from GPU memory before binding a new material.\n
         Useful for rendering very large models with many textures that can't fit into GPU memory at once. Setting this to true usually results in performance loss.
         */
@@ -103,6 +131,15 @@ namespace Falcor
 
         void setRenderMode(RenderMode mode);
         void toggleStaticMaterialCompilation(bool on) { mCompileMaterialWithProgram = on; }
+
+        /** Force the renderer to rebuild its draw list on the next frame. The draw list tracks models, model instances and model geometry changes automatically.\n
+            Call this after changing the materials of a model which is already in the scene.
+        */
+        void invalidateDrawList() { mpDrawList->invalidate(); }
+
+        /** Get the scheduler which updates the animated models
+        */
+        AnimationScheduler* getAnimationScheduler() { return mpAnimationScheduler.get(); }
     protected:
 
 		struct CurrentWorkingData
@@ -121,10 +158,17 @@ namespace Falcor
         static UniformBuffer::SharedPtr sPerFrameCB;
         static UniformBuffer::SharedPtr sPerStaticMeshCB;
         static UniformBuffer::SharedPtr sPerSkinnedMeshCB;
-        static size_t sBonesOffset;
+        static UniformBuffer::Handle<glm::mat4> sBonesHandle;
         static size_t sCameraDataOffset;
-        static size_t sWorldMatOffset;
-        static size_t sMeshIdOffset;
+        static size_t sMaterialOffset;
+        static UniformBuffer::Handle<glm::mat4> sWorldMatHandle;
+        static UniformBuffer::Handle<uint32_t> sMeshIdHandle;
+        static UniformBuffer::Handle<uint32_t> sInstanceBaseHandle;
+        static UniformBuffer::Handle<glm::mat4> sPositionDequantMatHandle;
+        static UniformBuffer::Handle<uint32_t> sOctahedralDirectionsHandle;
+        static ShaderStorageBuffer::SharedPtr sInstanceDataSB;
+        static GpuRingBuffer::UniquePtr spInstanceDataRing;
+        static size_t sFrameInstanceCount;          ///< The number of instances streamed since the last endFrame()
 
     private:
         void createUniformBuffers(Program* pProgram);
@@ -133,23 +177,100 @@ namespace Falcor
         virtual void setPerFrameData(RenderContext* pContext, const CurrentWorkingData& currentData);
         virtual bool setPerModelData(RenderContext* pContext, const CurrentWorkingData& currentData);
         virtual bool setPerMeshData(RenderContext* pContext,  const CurrentWorkingData& currentData);
-        virtual bool setPerMeshInstanceData(RenderContext* pContext, const glm::mat4& translation, uint32_t meshInstanceID, uint32_t drawInstanceID, const CurrentWorkingData& currentData);
+
+        /** Set the data of a single mesh instance of the current draw. Not called with instance data streaming.
+            \param[in] worldMat The mesh instance's world matrix. It already includes the mesh instance matrix, and it's the model instance's transform alone for meshes with bones.
+            \param[in] meshInstanceID The index of the mesh instance in the mesh
+            \param[in] drawInstanceID The index of the instance in the current draw call
+            \return false to skip the instance
+        */
+        virtual bool setPerMeshInstanceWorldMatrix(RenderContext* pContext, const glm::mat4& worldMat, uint32_t meshInstanceID, uint32_t drawInstanceID, const CurrentWorkingData& currentData);
+
+        /** Replaced by setPerMeshInstanceWorldMatrix(). Its matrix used to be the model instance's transform, and overrides composed the mesh instance matrix themselves.
+            It's deleted so that such overrides fail to compile, instead of applying the mesh instance matrix twice.
+        */
+        virtual bool setPerMeshInstanceData(RenderContext* pContext, const glm::mat4& translation, uint32_t meshInstanceID, uint32_t drawInstanceID, const CurrentWorkingData& currentData) = delete;
         virtual bool setPerMaterialData(RenderContext* pContext, const CurrentWorkingData& currentData);
         virtual void postFlushDraw(RenderContext* pContext, const CurrentWorkingData& currentData);
 
-        void renderModel(RenderContext* pContext, Program* pProgram, const Model* pModel, const glm::mat4& instanceMatrix, Camera* pCamera, CurrentWorkingData& currentData);
-        void renderMesh(RenderContext* pContext, const Mesh* pMesh, const glm::mat4& translation, Camera* pCamera, CurrentWorkingData& currentData);
-        void flushDraw(RenderContext* pContext, const Mesh* pMesh, uint32_t instanceCount, CurrentWorkingData& currentData);
+        /** A visible mesh of a single model instance, with the world matrices of its visible mesh instances
+        */
+        struct DrawPacket
+        {
+            const Model* pModel;
+            const Mesh* pMesh;
+            const Material* pMaterial;
+            bool vertexBlending;        ///< The program variant
+            uint32_t firstInstance;     ///< Index of the first instance in the chunk's instance arrays
+            uint32_t instanceCount;
+            uint32_t firstRange;        ///< Index of the first index range in the chunk's range arrays. Packets with ranges have a single instance.
+            uint32_t rangeCount;        ///< 0 to draw the entire mesh
+        };
+
+        /** A mesh instance with some of its clusters culled. It's drawn on its own, after the mesh's fully visible instances.
+        */
+        struct PartialInstance
+        {
+            glm::mat4 worldMat;
+            uint32_t meshInstanceID;
+            uint32_t firstRange;
+            uint32_t rangeCount;
+        };
+
+        /** The output of traversing a range of the draw list. Each chunk is written by a single thread.
+        */
+        struct TraversalChunk
+        {
+            std::vector<DrawPacket> packets;
+            std::vector<glm::mat4> worldMats;
+            std::vector<uint32_t> meshInstanceIDs;
+            BoundingBoxArray cullBoxes;             ///< Scratch space for the world-space cluster bounding-boxes of the mesh instance being culled
+            std::vector<uint32_t> rangeFirstIndices;    ///< Index ranges of the visible clusters, referenced by the packets
+            std::vector<uint32_t> rangeIndexCounts;
+            std::vector<MeshCluster> worldClusters;     ///< Scratch space for the world-space clusters of the mesh instance being culled
+            std::vector<uint8_t> clusterVisibility;     ///< Scratch space for the cluster culling results
+            std::vector<PartialInstance> partialInstances;  ///< Scratch space for the partially visible instances of the mesh being culled
+            uint32_t culledInstances = 0;           ///< Number of mesh instances rejected by culling
+            uint32_t culledClusters = 0;            ///< Number of clusters rejected by culling
+        };
+
+        static const uint32_t kItemsPerTraversalChunk = 256;
+
+        void renderDrawList(RenderContext* pContext, CurrentWorkingData& currentData);
+        void generateDrawPackets(const Camera* pCamera);
+        void generateDrawPackets(uint32_t firstItem, uint32_t itemCount, TraversalChunk& chunk) const;
+        uint32_t cullMeshClusters(const Mesh* pMesh, const glm::mat4& worldMat, TraversalChunk& chunk) const;
+        void submitDrawPackets(RenderContext* pContext, CurrentWorkingData& currentData);
+        void createInstanceDataBuffer(Program* pProgram, size_t instanceCount);
+        void streamInstanceData(Program* pProgram);
+        void flushDraw(RenderContext* pContext, const Mesh* pMesh, uint32_t instanceCount, CurrentWorkingData& currentData, const uint32_t* pRangeFirstIndices = nullptr, const uint32_t* pRangeIndexCounts = nullptr, uint32_t rangeCount = 0);
 
     protected:
         void setupVR();
 
         CameraControllerType mCamControllerType = CameraControllerType::SixDof;
         CameraController::SharedPtr mpCameraController;
+        SceneDrawList::UniquePtr mpDrawList;
+        std::vector<std::vector<uint8_t>> mModelInstanceVisibility; ///< Model instances culling results for the current frame
+        std::vector<std::vector<uint8_t>> mMeshInstanceVisibility;  ///< Mesh instances culling results for the current frame, see Scene::cullMeshInstances()
+        std::vector<TraversalChunk> mTraversalChunks;
+        uint32_t mTraversalChunkCount = 0;
+        std::vector<uint32_t> mChunkInstanceBase;   ///< Index of each chunk's first instance in the instance data buffer
+        uint32_t mStreamedInstanceBase = 0;         ///< Index of the pending draw's first instance in the instance data buffer
+        const Camera* mpCurrentCamera = nullptr;    ///< The camera used by the traversal threads
+        glm::vec3 mViewPosition;                    ///< The viewer's position used by the traversal threads, with perspective projections
+        glm::vec3 mViewDirection;                   ///< The direction of the view rays used by the traversal threads, with orthographic projections
+        bool mOrthographicView = false;             ///< Whether the traversal threads test the clusters against mViewDirection rather than mViewPosition
+        bool mCullBackfacingClusters = false;       ///< Whether the traversal rejects back-facing clusters, set from the bound rasterizer state
+        bool mClockwiseFront = false;               ///< Whether the traversal treats clockwise triangles as front-facing
+        AnimationScheduler::UniquePtr mpAnimationScheduler;
 
         uint32_t mMaxInstanceCount = 64;
         const Material* mpLastMaterial = nullptr;
         bool mCullEnabled = true;
+        bool mClusterCullEnabled = true;
+        bool mMultithreadedTraversal = true;
+        bool mInstanceDataStreaming = false;
         bool mUnloadTexturesOnMaterialChange = false;
         RenderMode mRenderMode = RenderMode::Mono;
         bool mCompileMaterialWithProgram = true;
@@ -0,0 +1,362 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "TextureCache.h"
+#include "Utils/OS.h"
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+
+namespace Falcor
+{
+    const char* TextureCache::kDisableArg = "-noTextureCache";
+
+    static const uint64_t kFnvPrime = 1099511628211ull;
+
+    // Expired entries are removed once the maps hold this many entries, and again whenever their size doubles
+    static const size_t kMinSweepThreshold = 256;
+
+    using PathKey = std::tuple<std::string, time_t, bool, bool>;
+
+    struct CacheState
+    {
+        std::mutex mutex;       // Guards the members
+        bool enabled;
+        std::map<PathKey, std::weak_ptr<Texture>> paths;
+        std::unordered_map<uint64_t, std::weak_ptr<Texture>> contents;
+        size_t sweepThreshold = kMinSweepThreshold;
+        TextureCache::Stats stats;
+
+        CacheState()
+        {
+            enabled = (hasCommandLineArg(TextureCache::kDisableArg) == false);
+        }
+    };
+
+    static CacheState& getState()
+    {
+        static CacheState state;
+        return state;
+    }
+
+    static PathKey getPathKey(const TextureCache::FileKey& key)
+    {
+        return PathKey(key.path, key.modifiedTime, key.generateMipLevels, key.loadAsSrgb);
+    }
+
+    /** Size of the texture's memory, without padding or alignment
+    */
+    static uint64_t getTextureSize(const Texture* pTexture)
+    {
+        const ResourceFormat format = pTexture->getFormat();
+        const uint32_t blockWidth = getFormatWidthCompressionRatio(format);
+        const uint32_t blockHeight = getFormatHeightCompressionRatio(format);
+
+        uint64_t size = 0;
+        for(uint32_t mip = 0; mip < pTexture->getMipLevels(); mip++)
+        {
+            uint64_t width = std::max(1u, pTexture->getWidth() >> mip);
+            uint64_t height = std::max(1u, pTexture->getHeight() >> mip);
+            uint64_t depth = std::max(1u, pTexture->getDepth() >> mip);
+            size += ((width + blockWidth - 1) / blockWidth) * ((height + blockHeight - 1) / blockHeight) * depth * getFormatBytesPerBlock(format);
+        }
+
+        uint32_t faceCount = (pTexture->getType() == Texture::Type::TextureCube) ? 6 : 1;
+        return size * pTexture->getArraySize() * faceCount * pTexture->getSampleCount();
+    }
+
+    /** Find a live texture. Removes the entry if the texture was released.
+    */
+    template<typename MapType>
+    static Texture::SharedPtr findEntry(MapType& map, const typename MapType::key_type& key)
+    {
+        auto it = map.find(key);
+        if(it == map.end())
+        {
+            return nullptr;
+        }
+
+        Texture::SharedPtr pTexture = it->second.lock();
+        if(pTexture == nullptr)
+        {
+            map.erase(it);
+        }
+        return pTexture;
+    }
+
+    template<typename MapType>
+    static void removeExpiredEntries(MapType& map)
+    {
+        for(auto it = map.begin(); it != map.end();)
+        {
+            it = it->second.expired() ? map.erase(it) : std::next(it);
+        }
+    }
+
+    static void addEntries(CacheState& state, const PathKey* pPathKey, uint64_t contentHash, const Texture::SharedPtr& pTexture)
+    {
+        if(pPathKey)
+        {
+            state.paths[*pPathKey] = pTexture;
+        }
+        state.contents[contentHash] = pTexture;
+
+        // Lookups only remove the entries they find, so textures which are never loaded again would stay in the maps
+        if(state.paths.size() + state.contents.size() >= state.sweepThreshold)
+        {
+            removeExpiredEntries(state.paths);
+            removeExpiredEntries(state.contents);
+            state.sweepThreshold = std::max(kMinSweepThreshold, 2 * (state.paths.size() + state.contents.size()));
+        }
+    }
+
+    /** Check a texture found by its content hash. The hash could collide with the one of other data.
+    */
+    static bool matchesDesc(const Texture* pTexture, const TextureCache::Desc& desc)
+    {
+        uint32_t mipLevels = desc.mipLevels;
+        if(mipLevels == Texture::kEntireMipChain)
+        {
+            // Same count as the Texture constructor
+            mipLevels = 1;
+            for(uint32_t dims = (desc.width | desc.height | pTexture->getDepth()) >> 1; dims; dims >>= 1)
+            {
+                mipLevels++;
+            }
+        }
+        return pTexture->getWidth() == desc.width && pTexture->getHeight() == desc.height && pTexture->getFormat() == desc.format && pTexture->getMipLevels() == mipLevels;
+    }
+
+    static void recordHit(CacheState& state, uint32_t& hitCount, const Texture::SharedPtr& pTexture)
+    {
+        hitCount++;
+        state.stats.bytesSaved += getTextureSize(pTexture.get());
+    }
+
+    /** Hash the file's content together with the load parameters, so that the same file loaded with different parameters gets a different hash
+    */
+    static bool calcContentHash(TextureCache::FileKey& key)
+    {
+        if(key.hasContentHash)
+        {
+            return true;
+        }
+
+        size_t size = 0;
+        const void* pFile = mapFileForRead(key.path, size);
+        if(pFile == nullptr)
+        {
+            return false;
+        }
+        uint64_t hash = TextureCache::hashData(pFile, size);
+        unmapFile(pFile);
+
+        const uint64_t params[] = { size, key.generateMipLevels ? 1u : 0u, key.loadAsSrgb ? 1u : 0u };
+        key.contentHash = TextureCache::hashData(params, sizeof(params), hash);
+        key.hasContentHash = true;
+        return true;
+    }
+
+    bool TextureCache::createFileKey(const std::string& filename, bool generateMipLevels, bool loadAsSrgb, FileKey& key)
+    {
+        std::string fullpath;
+        if(findFileInDataDirectories(filename, fullpath) == false)
+        {
+            return false;
+        }
+
+        // File names are case-insensitive
+        key.path = canonicalizeFilename(fullpath);
+        std::transform(key.path.begin(), key.path.end(), key.path.begin(), ::tolower);
+        key.modifiedTime = getFileModifiedTime(fullpath);
+        key.generateMipLevels = generateMipLevels;
+        key.loadAsSrgb = loadAsSrgb;
+        key.contentHash = 0;
+        key.hasContentHash = false;
+        return true;
+    }
+
+    Texture::SharedPtr TextureCache::findFile(FileKey& key)
+    {
+        CacheState& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if(state.enabled == false)
+        {
+            return nullptr;
+        }
+
+        Texture::SharedPtr pTexture = findEntry(state.paths, getPathKey(key));
+        if(pTexture)
+        {
+            recordHit(state, state.stats.pathHits, pTexture);
+        }
+        return pTexture;
+    }
+
+    Texture::SharedPtr TextureCache::findFileContent(FileKey& key, const Desc& desc)
+    {
+        if(isEnabled() == false)
+        {
+            return nullptr;
+        }
+
+        // Hash the file without holding the lock, other threads keep using the cache meanwhile
+        bool hasContentHash = calcContentHash(key);
+
+        CacheState& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        Texture::SharedPtr pTexture = hasContentHash ? findEntry(state.contents, key.contentHash) : nullptr;
+        if(pTexture && matchesDesc(pTexture.get(), desc) == false)
+        {
+            pTexture = nullptr;
+        }
+
+        if(pTexture)
+        {
+            // Remember the path, so the next lookup doesn't hash the file again
+            state.paths[getPathKey(key)] = pTexture;
+            recordHit(state, state.stats.contentHits, pTexture);
+        }
+        else
+        {
+            state.stats.misses++;
+        }
+        return pTexture;
+    }
+
+    void TextureCache::addFile(FileKey& key, const Texture::SharedPtr& pTexture)
+    {
+        if(pTexture == nullptr || isEnabled() == false || calcContentHash(key) == false)
+        {
+            return;
+        }
+
+        CacheState& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        PathKey pathKey = getPathKey(key);
+        addEntries(state, &pathKey, key.contentHash, pTexture);
+    }
+
+    uint64_t TextureCache::hashData(const void* pData, size_t size, uint64_t hash)
+    {
+        // FNV-1a on 8-byte words instead of bytes, since textures are large. The multiplication only carries bits upwards, so the high half is folded back after each word.
+        const uint8_t* pBytes = (const uint8_t*)pData;
+        const size_t wordCount = size / sizeof(uint64_t);
+        for(size_t i = 0; i < wordCount; i++)
+        {
+            uint64_t word;
+            std::memcpy(&word, pBytes + i * sizeof(uint64_t), sizeof(word));
+            hash = (hash ^ word) * kFnvPrime;
+            hash ^= hash >> 32;
+        }
+
+        for(size_t i = wordCount * sizeof(uint64_t); i < size; i++)
+        {
+            hash = (hash ^ pBytes[i]) * kFnvPrime;
+        }
+        return hash;
+    }
+
+    Texture::SharedPtr TextureCache::findData(uint64_t dataHash, const Desc& desc)
+    {
+        CacheState& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if(state.enabled == false)
+        {
+            return nullptr;
+        }
+
+        Texture::SharedPtr pTexture = findEntry(state.contents, dataHash);
+        if(pTexture && matchesDesc(pTexture.get(), desc) == false)
+        {
+            pTexture = nullptr;
+        }
+
+        if(pTexture)
+        {
+            recordHit(state, state.stats.contentHits, pTexture);
+        }
+        else
+        {
+            state.stats.misses++;
+        }
+        return pTexture;
+    }
+
+    void TextureCache::addData(uint64_t dataHash, const Texture::SharedPtr& pTexture)
+    {
+        CacheState& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if(state.enabled && pTexture)
+        {
+            addEntries(state, nullptr, dataHash, pTexture);
+        }
+    }
+
+    void TextureCache::setEnabled(bool enabled)
+    {
+        CacheState& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.enabled = enabled;
+    }
+
+    bool TextureCache::isEnabled()
+    {
+        CacheState& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        return state.enabled;
+    }
+
+    void TextureCache::clear()
+    {
+        CacheState& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.paths.clear();
+        state.contents.clear();
+        state.sweepThreshold = kMinSweepThreshold;
+        state.stats = Stats();
+    }
+
+    TextureCache::Stats TextureCache::getStats()
+    {
+        CacheState& state = getState();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        return state.stats;
+    }
+
+    std::string to_string(const TextureCache::Stats& stats)
+    {
+        char str[256];
+        snprintf(str, arraysize(str), "%u path hits, %u content hits, %u misses, %.1f MB saved",
+            stats.pathHits, stats.contentHits, stats.misses, double(stats.bytesSaved) / (1024.0 * 1024.0));
+        return str;
+    }
+}
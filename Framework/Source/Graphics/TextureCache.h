@@ -0,0 +1,131 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <string>
+#include "Core/Texture.h"
+
+namespace Falcor
+{
+    /** Process-wide cache of the textures created from files or from data embedded in model files, which lets models and scenes share textures instead of creating copies.\n
+        A texture loaded from a file is found by its canonical path, modification time, sRGB flag and mip flag. When the path doesn't match, the file's content hash is used instead,
+        so identical files in different directories share one texture. Textures which don't come from a file of their own are found by a hash of their data.
+        A texture found by its content hash is only returned if its dimensions, format and mip count match the texture the caller would create, so that a hash collision can't hand out another texture.\n
+        The cache only holds weak references. A texture is released as soon as nothing else uses it, and is created again the next time it is loaded.
+        Sharing is opt-in. Only the model importers and createSharedTextureFromFile() use the cache, and the textures they return must not be modified. All functions are thread-safe.
+    */
+    class TextureCache
+    {
+    public:
+        /** Usage statistics since the application started, or since the last call to clear()
+        */
+        struct Stats
+        {
+            uint32_t pathHits = 0;          ///< Lookups which found a texture created from the same file
+            uint32_t contentHits = 0;       ///< Lookups which found a texture created from identical data
+            uint32_t misses = 0;            ///< For files, counted by findFileContent()
+            uint64_t bytesSaved = 0;        ///< Size of the textures which were shared instead of created again
+        };
+
+        /** Identifies a texture loaded from a file. Created by createFileKey().
+        */
+        struct FileKey
+        {
+            std::string path;               ///< Canonical full path, in lower case
+            time_t modifiedTime = 0;
+            bool generateMipLevels = false;
+            bool loadAsSrgb = false;
+            uint64_t contentHash = 0;       ///< Computed by findFile() when the path doesn't match, so that addFile() doesn't hash the file again
+            bool hasContentHash = false;
+        };
+
+        /** The properties a texture found by its content hash must have
+        */
+        struct Desc
+        {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            uint32_t mipLevels = 0;         ///< Texture::kEntireMipChain for the full mip chain
+            ResourceFormat format = ResourceFormat::Unknown;
+        };
+
+        /** Create the key of a texture file
+            \param[in] filename The texture's filename. Looked for in the data directories.
+            \param[in] generateMipLevels, loadAsSrgb The load parameters. See createSharedTextureFromFile().
+            \param[out] key The key
+            \return false if the file wasn't found
+        */
+        static bool createFileKey(const std::string& filename, bool generateMipLevels, bool loadAsSrgb, FileKey& key);
+
+        /** Find a texture created from the same file with the same load parameters. Cheap, the file isn't read.
+            \return The texture, or nullptr on a miss or if the cache is disabled
+        */
+        static Texture::SharedPtr findFile(FileKey& key);
+
+        /** Find a texture created from a file with the same content and load parameters. Call it after findFile() missed and the file was decoded. Hashes the file.
+            \param[in] key The file's key
+            \param[in] desc The properties of the texture the decoded file creates
+            \return The texture, or nullptr on a miss, if the texture doesn't match desc, or if the cache is disabled
+        */
+        static Texture::SharedPtr findFileContent(FileKey& key, const Desc& desc);
+
+        /** Add a texture created from a file. Replaces an expired texture with the same key.
+        */
+        static void addFile(FileKey& key, const Texture::SharedPtr& pTexture);
+
+        /** Hash texture data. Callers include everything which affects the created texture, like the dimensions and format, by chaining calls.
+        */
+        static uint64_t hashData(const void* pData, size_t size, uint64_t hash = kHashSeed);
+
+        /** Find a texture created from data with the given hash. See hashData().
+            \param[in] dataHash The data's hash
+            \param[in] desc The properties of the texture the data creates
+            \return The texture, or nullptr on a miss, if the texture doesn't match desc, or if the cache is disabled
+        */
+        static Texture::SharedPtr findData(uint64_t dataHash, const Desc& desc);
+
+        /** Add a texture created from data with the given hash
+        */
+        static void addData(uint64_t dataHash, const Texture::SharedPtr& pTexture);
+
+        /** Enable or disable the cache. When disabled, lookups always miss and nothing is added.
+        */
+        static void setEnabled(bool enabled);
+        static bool isEnabled();
+
+        /** Forget all the textures and reset the statistics. Textures which are in use aren't affected.
+        */
+        static void clear();
+
+        static Stats getStats();
+
+        static const uint64_t kHashSeed = 14695981039346656037ull;
+        static const char* kDisableArg;     ///< The command-line argument which disables the cache
+    };
+
+    std::string to_string(const TextureCache::Stats& stats);
+}
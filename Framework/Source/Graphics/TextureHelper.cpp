@@ -27,13 +27,14 @@
 ***************************************************************************/
 #include "Framework.h"
 #include "TextureHelper.h"
+#include "TextureCache.h"
 #include "Core/Texture.h"
 #include "Utils/Bitmap.h"
 #include "Core/DDSHeader.h"
 #include "Utils/BinaryFileStream.h"
 #include "Utils/StringUtils.h"
 
-#ifdef FALCOR_GL
+#if defined FALCOR_GL || defined FALCOR_NULL
 static const bool kTopDown = false;
 #elif defined FALCOR_DX11
 static const bool kTopDown = true;
@@ -636,11 +637,19 @@ namespace Falcor
         return nullptr;
     }
 
-	Texture::SharedPtr createTextureFromDDSFile(const std::string filename, bool generateMips)
+    struct TextureFileData
+    {
+        using SharedPtr = std::shared_ptr<TextureFileData>;
+        std::string filename;
+        bool generateMipLevels = false;
+        bool isDds = false;
+        DdsData ddsData;
+        Bitmap::UniqueConstPtr pBitmap;
+        ResourceFormat format = ResourceFormat::Unknown;
+    };
+
+	Texture::SharedPtr createTextureFromDdsData(DdsData& ddsData, const std::string& filename, bool generateMips)
 	{
-		DdsData ddsData;
-		loadDDSDataFromFile(filename, ddsData);
-		
 		ResourceFormat format = getDdsResourceFormat(ddsData);
 
         // One reason to hit this assertion is files that use an old header with R10G10B10A2 format.
@@ -673,62 +682,138 @@ namespace Falcor
 		return nullptr;
 	}
 
-	Texture::SharedPtr createTextureFromFile(const std::string& filename, bool generateMipLevels, bool loadAsSrgb)
+    TextureFileData::SharedPtr loadTextureDataFromFile(const std::string& filename, bool generateMipLevels, bool loadAsSrgb)
     {
 #define no_srgb()   \
     if(loadAsSrgb)  \
     {               \
         Logger::log(Logger::Level::Warning, "createTexture2DFromFile() warning. " + std::to_string(pBitmap->getBytesPerPixel()) + " channel images doesn't have a matching sRGB format. Loading in linear space.");  \
     }
-			
+
+        TextureFileData::SharedPtr pData = std::make_shared<TextureFileData>();
+        pData->filename = filename;
+        pData->generateMipLevels = generateMipLevels;
+
 		if (hasSuffix(filename, ".dds"))
 		{
-			return createTextureFromDDSFile(filename, generateMipLevels);
+            pData->isDds = true;
+            loadDDSDataFromFile(filename, pData->ddsData);
+            return pData;
 		}
 
-        Bitmap::UniqueConstPtr pBitmap = Bitmap::createFromFile(filename, kTopDown);
-        Texture::SharedPtr pTex;
+        pData->pBitmap = Bitmap::createFromFile(filename, kTopDown);
+        const Bitmap* pBitmap = pData->pBitmap.get();
+        if(pBitmap == nullptr)
+        {
+            return nullptr;
+        }
+
+        ResourceFormat& texFormat = pData->format;
+        switch(pBitmap->getBytesPerPixel())
+        {
+        case 16:
+            texFormat = ResourceFormat::RGBA32Float;
+            break;
+        case 12:
+            texFormat = ResourceFormat::RGB32Float;
+            break;
+        case 8:
+            texFormat = ResourceFormat::RGBA16Float;
+            break;
+        case 6:
+            texFormat = ResourceFormat::RGB16Float;
+            break;
+        case 4:
+            texFormat = loadAsSrgb ? ResourceFormat::BGRA8UnormSrgb : ResourceFormat::BGRA8Unorm;
+            break;
+        case 3:
+            texFormat = loadAsSrgb ? ResourceFormat::BGRX8UnormSrgb : ResourceFormat::BGRX8Unorm;
+            break;
+        case 2:
+            no_srgb();
+            texFormat = ResourceFormat::RG8Unorm;
+            break;
+        case 1:
+            no_srgb();
+            texFormat = ResourceFormat::R8Unorm;
+            break;
+        default:
+            should_not_get_here();
+            break;
+        }
+        return pData;
+    }
+#undef no_srgb
+
+    Texture::SharedPtr createTextureFromData(const TextureFileData::SharedPtr& pData)
+    {
+        if(pData == nullptr)
+        {
+            return nullptr;
+        }
+
+        if(pData->isDds)
+        {
+            return createTextureFromDdsData(pData->ddsData, pData->filename, pData->generateMipLevels);
+        }
+
+        const Bitmap* pBitmap = pData->pBitmap.get();
+        Texture::SharedPtr pTex = Texture::create2D(pBitmap->getWidth(), pBitmap->getHeight(), pData->format, 1, pData->generateMipLevels ? Texture::kEntireMipChain : 1, pBitmap->getData());
+        pTex->setSourceFilename(pData->filename);
+        return pTex;
+    }
 
-        if(pBitmap)
+    TextureCache::Desc getTextureCacheDesc(const TextureFileData::SharedPtr& pData)
+    {
+        TextureCache::Desc desc;
+        if(pData->isDds)
+        {
+            const DdsHeader& header = pData->ddsData.header;
+            desc.width = header.width;
+            desc.height = header.height;
+            desc.format = getDdsResourceFormat(pData->ddsData);
+            desc.mipLevels = pData->generateMipLevels ? Texture::kEntireMipChain : ((header.flags & DdsHeader::kMipCountMask) ? max(header.mipCount, 1U) : 1);
+        }
+        else
         {
-            ResourceFormat texFormat;
-            switch(pBitmap->getBytesPerPixel())
+            desc.width = pData->pBitmap->getWidth();
+            desc.height = pData->pBitmap->getHeight();
+            desc.format = pData->format;
+            desc.mipLevels = pData->generateMipLevels ? Texture::kEntireMipChain : 1;
+        }
+        return desc;
+    }
+
+	Texture::SharedPtr createTextureFromFile(const std::string& filename, bool generateMipLevels, bool loadAsSrgb)
+    {
+        return createTextureFromData(loadTextureDataFromFile(filename, generateMipLevels, loadAsSrgb));
+    }
+
+    Texture::SharedPtr createSharedTextureFromFile(const std::string& filename, bool generateMipLevels, bool loadAsSrgb)
+    {
+        TextureCache::FileKey key;
+        bool hasKey = TextureCache::createFileKey(filename, generateMipLevels, loadAsSrgb, key);
+        Texture::SharedPtr pTex = hasKey ? TextureCache::findFile(key) : nullptr;
+        if(pTex)
+        {
+            return pTex;
+        }
+
+        // A file with the same content may have been loaded from another directory. The decoded data tells what the texture must look like.
+        TextureFileData::SharedPtr pData = loadTextureDataFromFile(filename, generateMipLevels, loadAsSrgb);
+        if(pData == nullptr)
+        {
+            return nullptr;
+        }
+        pTex = hasKey ? TextureCache::findFileContent(key, getTextureCacheDesc(pData)) : nullptr;
+        if(pTex == nullptr)
+        {
+            pTex = createTextureFromData(pData);
+            if(hasKey)
             {
-            case 16:
-                texFormat = ResourceFormat::RGBA32Float;
-                break;
-            case 12:
-                texFormat = ResourceFormat::RGB32Float;
-                break;
-            case 8:
-                texFormat = ResourceFormat::RGBA16Float;
-                break;
-            case 6:
-                texFormat = ResourceFormat::RGB16Float;
-                break;
-            case 4:
-                texFormat = loadAsSrgb ? ResourceFormat::BGRA8UnormSrgb : ResourceFormat::BGRA8Unorm;
-                break;
-            case 3:
-                texFormat = loadAsSrgb ? ResourceFormat::BGRX8UnormSrgb : ResourceFormat::BGRX8Unorm;
-                break;
-            case 2:
-                no_srgb();
-                texFormat = ResourceFormat::RG8Unorm;
-                break;
-            case 1:
-                no_srgb();
-                texFormat = ResourceFormat::R8Unorm;
-                break;
-            default:
-                should_not_get_here();
-                break;
+                TextureCache::addFile(key, pTex);
             }
-
-            pTex = Texture::create2D(pBitmap->getWidth(), pBitmap->getHeight(), texFormat, 1, generateMipLevels ? Texture::kEntireMipChain : 1, pBitmap->getData());
-            pTex->setSourceFilename(filename);
         }
         return pTex;
     }
-#undef no_srgb
 }
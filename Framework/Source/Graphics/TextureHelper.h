@@ -28,6 +28,7 @@
 #pragma once
 #include <string>
 #include "Core/Texture.h"
+#include "Graphics/TextureCache.h"
 namespace Falcor
 {
     /*!
@@ -35,12 +36,38 @@ namespace Falcor
     *  @{
     */
 
+    /** Image data decoded from a file, before it is uploaded into a texture. Created by loadTextureDataFromFile().
+    */
+    struct TextureFileData;
+
+    /** Decode a texture file into system memory, without creating any API resources. Can be called from any thread.
+        \param[in] filename Filename
+        \param[in] generateMipLevels true if the texture created from the data should have a mip-chain
+        \param[in] loadAsSrgb Load the texture using sRGB format. Only valid for 3/4 component textures.
+        \return nullptr if the file couldn't be decoded, otherwise the decoded data
+    */
+    std::shared_ptr<TextureFileData> loadTextureDataFromFile(const std::string& filename, bool generateMipLevels, bool loadAsSrgb);
+
+    /** Create a texture from data decoded by loadTextureDataFromFile(). Must be called from the thread that owns the rendering device.
+        \return nullptr if pData is nullptr, otherwise a new texture
+    */
+    Texture::SharedPtr createTextureFromData(const std::shared_ptr<TextureFileData>& pData);
+
+    /** Get the dimensions, format and mip count of the texture createTextureFromData() creates from the data. Used to check textures found in the TextureCache by their content.
+    */
+    TextureCache::Desc getTextureCacheDesc(const std::shared_ptr<TextureFileData>& pData);
+
     /** create a new texture from an a file
         \param[in] Filename Filename
         \param[in] bCreateMipChain true is mip-chain should be generated, otherwise false
         \param[in] bSrgb Load the texture using sRGB format. Only valid for 3/4 component textures.
     */
 	Texture::SharedPtr createTextureFromFile(const std::string& filename, bool generateMipLevels, bool loadAsSrgb);
+
+    /** Get the texture already created from a file, or create it and share it through the TextureCache. Same parameters as createTextureFromFile().
+        The texture can be shared with other models and callers, so it must not be modified. Use createTextureFromFile() for a private texture.
+    */
+    Texture::SharedPtr createSharedTextureFromFile(const std::string& filename, bool generateMipLevels, bool loadAsSrgb);
     
     /*! @} */
 }
\ No newline at end of file
@@ -368,9 +368,12 @@ void RTContext::addGeometryToGroup(ObjectHandle groupToAddGeometry, const Model:
         const Mesh::SharedPtr& mesh = model->getMesh(i);
         const Vao::SharedPtr vao = mesh->getVao();
         Buffer::SharedConstPtr ib = vao->getIndexBuffer();
-        const size_t vtxCount = mesh->getVertexCount();
+        const size_t vtxCount = mesh->getBaseVertex() + mesh->getVertexCount();    // Packed meshes share the vertex buffers, the OptiX buffers cover everything up to the mesh's last vertex
         const size_t triCount = mesh->getPrimitiveCount();
 
+        // OptiX reads the index buffer as 32-bit triangles, starting at the beginning of the buffer. Meshes with 16-bit indices or packed meshes get a converted copy.
+        const bool shareIndices = vao->getIndexBufferFormat() == ResourceFormat::R32Uint && mesh->getFirstIndex() == 0 && mesh->getBaseVertex() == 0;
+
         // Validate the Mesh
         if(mesh->getTopology() != RenderContext::Topology::TriangleList)
         {
@@ -378,12 +381,12 @@ void RTContext::addGeometryToGroup(ObjectHandle groupToAddGeometry, const Model:
             continue;
         }
         if(vao->getVertexBuffer(0)->getSize() % vao->getVertexBufferStride(0) != 0 ||
-            vao->getVertexBuffer(0)->getSize() / vao->getVertexBufferStride(0) != vtxCount)
+            vao->getVertexBuffer(0)->getSize() / vao->getVertexBufferStride(0) < vtxCount)
         {
             Logger::log(Logger::Level::Error, "Vertex buffer of a submesh in model '" + model->getName() + "' had wrong stride or size");
             continue;
         }
-        if(ib->getSize() % (sizeof(uint32_t) * 3) != 0 || triCount != ib->getSize() / (sizeof(uint32_t) * 3))
+        if(shareIndices && (ib->getSize() % (sizeof(uint32_t) * 3) != 0 || triCount != ib->getSize() / (sizeof(uint32_t) * 3)))
         {
             Logger::log(Logger::Level::Error, "Index buffer of a submesh in model '" + model->getName() + "' had wrong stride or size");
             continue;
@@ -429,8 +432,22 @@ void RTContext::addGeometryToGroup(ObjectHandle groupToAddGeometry, const Model:
                 assert(vao->getVertexBufferLayout(uvIdx)->getElementFormat(0) == ResourceFormat::RGB32Float);  // Assuming at least float2 for texcoords
         }
 
-        // Share index buffer
-        inst.geo.indices = createSharedBuffer(ib->getApiHandle(), RT_FORMAT_INT3, triCount);
+        // Share index buffer, or convert it
+        if(shareIndices)
+        {
+            inst.geo.indices = createSharedBuffer(ib->getApiHandle(), RT_FORMAT_INT3, triCount);
+        }
+        else
+        {
+            std::vector<uint32_t> indices = mesh->getIndices();
+            inst.geo.indices = mpContext->createBuffer(RT_BUFFER_INPUT, RT_FORMAT_INT3, triCount);
+            uint32_t* pIndices = (uint32_t*)inst.geo.indices->map();
+            for(size_t i = 0; i < indices.size(); i++)
+            {
+                pIndices[i] = indices[i] + mesh->getBaseVertex();
+            }
+            inst.geo.indices->unmap();
+        }
 
         // Share vertex buffers, or create if needed
         inst.geo.positions = createSharedBuffer(vao->getVertexBuffer(posIdx)->getApiHandle(), RT_FORMAT_FLOAT3, vtxCount);
@@ -453,8 +470,10 @@ void RTContext::addGeometryToGroup(ObjectHandle groupToAddGeometry, const Model:
                 inst.geo.bitangents = mpContext->createBuffer(RT_BUFFER_INPUT, RT_FORMAT_FLOAT3, vtxCount);
                 tg_data = (vec3*)inst.geo.tangents->map();
                 bt_data = (vec3*)inst.geo.bitangents->map();
-                nrmData.resize(vao->getVertexBuffer(VERTEX_NORMAL_LOC)->getSize() / sizeof(vec3));
-                vao->getVertexBuffer(VERTEX_NORMAL_LOC)->readData(nrmData.data(), 0, nrmData.size() * sizeof(vec3));
+                // Vertices outside of the mesh's range belong to other meshes, they only need valid values
+                const std::vector<vec3> normals = mesh->getNormals();
+                nrmData.assign(vtxCount, vec3(0, 0, 1));
+                std::copy(normals.begin(), normals.end(), nrmData.begin() + mesh->getBaseVertex());
             }
             if(hasUv)
                 inst.geo.texcoord = createSharedBuffer(vao->getVertexBuffer(uvIdx)->getApiHandle(), RT_FORMAT_FLOAT3, vtxCount);
@@ -33,6 +33,8 @@
 #include "Graphics/Program.h"
 #include "Utils/OS.h"
 #include "Core/FBO.h"
+#include "Utils/RenderStats.h"
+#include "Graphics/Scene/SceneRenderer.h"
 #include "VR\OpenVR\VRSystem.h"
 
 namespace Falcor
@@ -160,6 +162,7 @@ namespace Falcor
     {
         mTimeScale = config.timeScale;
         mFreezeTime = config.freezeTimeOnStartup;
+        mUploadBudget = config.uploadBudget;
 
         // Start the logger
         Logger::init();
@@ -222,6 +225,10 @@ namespace Falcor
     void Sample::renderFrame()
     {
         mFrameRate.newFrame();
+        {
+            PROFILE(AsyncUploads);
+            AsyncLoader::processUploads(mUploadBudget);
+        }
         {
             PROFILE(onFrameRender);
             calculateTime();
@@ -247,6 +254,8 @@ namespace Falcor
             captureScreen();
         }
         printProfileData();
+        SceneRenderer::endFrame();
+        mpRenderContext->endFrame();
     }
 
     void Sample::captureScreen()
@@ -278,6 +287,7 @@ namespace Falcor
         mpGui->addCheckBox("Freeze Time", &mFreezeTime, sampleGroup);
         mpGui->addButton("Screen Capture", &Sample::captureScreenCB, this, sampleGroup);
         mpGui->addButton("Video Capture", &Sample::initVideoCaptureCB, this, sampleGroup);
+        mpGui->addButton("Start/Stop Render Stats Capture", &Sample::renderStatsCaptureCB, this, sampleGroup);
         mpGui->addSeparator();
 
         // Set the UI size
@@ -354,16 +364,46 @@ namespace Falcor
 
     void Sample::printProfileData()
     {
+        // Close the render statistics frame. Anything drawn from here on is counted in the next frame.
+        RenderStats::recordStateBinds(mpRenderContext->getBindStats());
+        mpRenderContext->resetBindStats();
+        RenderStats::endFrame();
+
 #if _PROFILING_ENABLED
         if(gProfileEnabled)
         {
             std::string profileMsg;
             Profiler::endFrame(profileMsg);
-            renderText(profileMsg, glm::vec2(10, 300));
+            renderText(profileMsg + "\n" + RenderStats::getLastFrameString(), glm::vec2(10, 300));
         }
 #endif
     }
 
+    void Sample::toggleRenderStatsCapture()
+    {
+        if(RenderStats::isCapturingCsv())
+        {
+            RenderStats::endCsvCapture();
+            return;
+        }
+
+        std::string csvFile;
+        if(findAvailableFilename(getExecutableName() + ".RenderStats", getExecutableDirectory(), "csv", csvFile))
+        {
+            RenderStats::startCsvCapture(csvFile);
+        }
+        else
+        {
+            Logger::log(Logger::Level::Error, "Could not find available filename when capturing render statistics");
+        }
+    }
+
+    void Sample::renderStatsCaptureCB(void* pUserData)
+    {
+        Sample* pSample = (Sample*)pUserData;
+        pSample->toggleRenderStatsCapture();
+    }
+
     void Sample::captureScreenCB(void* pUserData)
     {
         Sample* pSample = (Sample*)pUserData;
@@ -55,6 +55,7 @@ namespace Falcor
         float timeScale = 1;                ///< A scaling factor for the time elapsed between frames.
         bool freezeTimeOnStartup = false;   ///< Control whether or not to start the clock when the sample start running.
         bool enableVR            = false;   ///< If you need VR support, set it to true to let Sample control the VR calls. Alternatively, if you want better control, you can call the VRSystem yourself
+        float uploadBudget = 2;             ///< Time in milliseconds spent every frame creating the API resources of asynchronous loads. See AsyncLoader.
     };
 
     /** Bootstrapper class for Falcor.
@@ -168,6 +169,10 @@ namespace Falcor
         void captureScreen();
         void setTextMode(TextMode mode);
 
+        /** Start writing the render statistics of every frame into a CSV file in the executable directory, or stop an ongoing capture
+        */
+        void toggleRenderStatsCapture();
+
     private:
         // Private functions
         void initUI();
@@ -197,6 +202,7 @@ namespace Falcor
 
         FrameRate mFrameRate;
         float mTimeScale;
+        float mUploadBudget = 2;
         TextMode mTextMode = TextMode::All;
 
         TextRenderer::UniquePtr mpTextRenderer;
@@ -207,5 +213,6 @@ namespace Falcor
         static void GUI_CALL initVideoCaptureCB(void* pUserData);
         static void GUI_CALL startVideoCaptureCB(void* pUserData);
         static void GUI_CALL endVideoCaptureCB(void* pUserData);
+        static void GUI_CALL renderStatsCaptureCB(void* pUserData);
     };
 };
\ No newline at end of file
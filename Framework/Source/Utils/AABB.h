@@ -26,7 +26,9 @@
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ***************************************************************************/
 #pragma once
+#include <vector>
 #include "glm/vec3.hpp"
+#include "glm/mat3x3.hpp"
 #include "glm/mat4x4.hpp"
 #include "glm/common.hpp"
 
@@ -77,4 +79,62 @@ namespace Falcor
             return box;
         }
     };
-}
\ No newline at end of file
+
+    /** A list of bounding boxes stored as a structure-of-arrays. Used for batch processing of many boxes, such as frustum culling.
+    */
+    struct BoundingBoxArray
+    {
+        std::vector<float> centerX;
+        std::vector<float> centerY;
+        std::vector<float> centerZ;
+        std::vector<float> extentX;
+        std::vector<float> extentY;
+        std::vector<float> extentZ;
+
+        size_t size() const { return centerX.size(); }
+
+        void resize(size_t count)
+        {
+            centerX.resize(count); centerY.resize(count); centerZ.resize(count);
+            extentX.resize(count); extentY.resize(count); extentZ.resize(count);
+        }
+
+        void clear() { resize(0); }
+
+        void set(size_t index, const BoundingBox& box)
+        {
+            centerX[index] = box.center.x; centerY[index] = box.center.y; centerZ[index] = box.center.z;
+            extentX[index] = box.extent.x; extentY[index] = box.extent.y; extentZ[index] = box.extent.z;
+        }
+
+        void push_back(const BoundingBox& box)
+        {
+            resize(size() + 1);
+            set(size() - 1, box);
+        }
+
+        BoundingBox get(size_t index) const
+        {
+            BoundingBox box;
+            box.center = glm::vec3(centerX[index], centerY[index], centerZ[index]);
+            box.extent = glm::vec3(extentX[index], extentY[index], extentZ[index]);
+            return box;
+        }
+
+        /** Transform all the boxes in src and store the result. Equivalent to calling BoundingBox#transform() for each box.
+        */
+        void transform(const BoundingBoxArray& src, const glm::mat4& mat)
+        {
+            resize(src.size());
+            // center' = M * center, extent' = |M| * extent
+            const glm::mat3 absMat(glm::abs(glm::vec3(mat[0])), glm::abs(glm::vec3(mat[1])), glm::abs(glm::vec3(mat[2])));
+            for(size_t i = 0; i < src.size(); i++)
+            {
+                glm::vec3 c = glm::vec3(mat * glm::vec4(src.centerX[i], src.centerY[i], src.centerZ[i], 1));
+                glm::vec3 e = absMat * glm::vec3(src.extentX[i], src.extentY[i], src.extentZ[i]);
+                centerX[i] = c.x; centerY[i] = c.y; centerZ[i] = c.z;
+                extentX[i] = e.x; extentY[i] = e.y; extentZ[i] = e.z;
+            }
+        }
+    };
+}
@@ -0,0 +1,183 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "AsyncLoader.h"
+#include "Utils/ThreadPool.h"
+#include "Utils/CpuTimer.h"
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <condition_variable>
+
+namespace Falcor
+{
+    struct PendingUpload
+    {
+        const std::function<void()>* pFunc;
+        std::atomic<uint32_t>* pItemsLoaded;
+        bool done;
+    };
+
+    static std::mutex gUploadMutex;
+    static std::condition_variable gUploadDoneCondition;
+    static std::condition_variable gUploadQueuedCondition;
+    static std::deque<PendingUpload*> gUploadQueue;
+    static uint32_t gActiveLoaderCount = 0;        // Protected by gUploadMutex
+
+    // The longest time processUploads() waits for a loader thread to queue its next upload, in milliseconds
+    static const float kMaxUploadWait = 1.0f;
+
+    thread_local AsyncLoader::Counters* AsyncLoader::spCurrentLoad = nullptr;
+
+    AsyncLoader::Progress AsyncLoader::Counters::getProgress() const
+    {
+        Progress progress;
+        progress.bytesLoaded = bytesLoaded;
+        progress.bytesTotal = bytesTotal;
+        progress.itemsLoaded = itemsLoaded;
+        progress.itemsTotal = itemsTotal;
+        return progress;
+    }
+
+    void AsyncLoader::setLoaderThread(Counters* pCounters)
+    {
+        std::lock_guard<std::mutex> lock(gUploadMutex);
+        if(pCounters)
+        {
+            gActiveLoaderCount++;
+        }
+        else if(spCurrentLoad)
+        {
+            gActiveLoaderCount--;
+        }
+        spCurrentLoad = pCounters;
+    }
+
+    bool AsyncLoader::isLoaderThread()
+    {
+        return spCurrentLoad != nullptr;
+    }
+
+    void AsyncLoader::upload(const std::function<void()>& func)
+    {
+        if(spCurrentLoad == nullptr)
+        {
+            func();
+            return;
+        }
+
+        // The upload lives on this thread's stack, which is fine since we wait until it was executed
+        PendingUpload upload = {&func, &spCurrentLoad->itemsLoaded, false};
+        std::unique_lock<std::mutex> lock(gUploadMutex);
+        gUploadQueue.push_back(&upload);
+        gUploadQueuedCondition.notify_one();
+        gUploadDoneCondition.wait(lock, [&upload]() {return upload.done; });
+    }
+
+    bool AsyncLoader::processUploads(float budget)
+    {
+        // A loader thread can't execute uploads, it would create the resources on the wrong thread
+        assert(isLoaderThread() == false);
+
+        CpuTimer::TimePoint start = CpuTimer::getCurrentTimePoint();
+        bool executed = false;
+        while(true)
+        {
+            PendingUpload* pUpload;
+            {
+                std::unique_lock<std::mutex> lock(gUploadMutex);
+                if(gUploadQueue.empty())
+                {
+                    // The loader thread released by the last upload usually queues its next one right away. Wait a little for it instead of leaving the rest of the budget unused.
+                    float remaining = budget - CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+                    if(executed == false || gActiveLoaderCount == 0 || remaining <= 0)
+                    {
+                        break;
+                    }
+                    auto timeout = std::chrono::microseconds(uint64_t(std::min(remaining, kMaxUploadWait) * 1000));
+                    if(gUploadQueuedCondition.wait_for(lock, timeout, []() {return gUploadQueue.empty() == false; }) == false)
+                    {
+                        break;
+                    }
+                }
+                pUpload = gUploadQueue.front();
+                gUploadQueue.pop_front();
+            }
+
+            (*pUpload->pFunc)();
+            (*pUpload->pItemsLoaded)++;
+            {
+                std::lock_guard<std::mutex> lock(gUploadMutex);
+                pUpload->done = true;
+            }
+            gUploadDoneCondition.notify_all();
+            executed = true;
+
+            if(CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint()) >= budget)
+            {
+                break;
+            }
+        }
+        return executed;
+    }
+
+    ThreadPool* AsyncLoader::getDecodePool()
+    {
+        static ThreadPool::UniquePtr spPool = ThreadPool::create(std::max(std::thread::hardware_concurrency() / 2, 1u));
+        return spPool.get();
+    }
+
+    uint64_t AsyncLoader::addFile(const std::string& fullpath)
+    {
+        if(spCurrentLoad == nullptr)
+        {
+            return 0;
+        }
+
+        std::ifstream file(fullpath, std::ios::binary | std::ios::ate);
+        std::streamoff size = file.good() ? std::streamoff(file.tellg()) : 0;
+        spCurrentLoad->bytesTotal += uint64_t(size);
+        return uint64_t(size);
+    }
+
+    void AsyncLoader::reportBytesLoaded(uint64_t bytes)
+    {
+        if(spCurrentLoad)
+        {
+            spCurrentLoad->bytesLoaded += bytes;
+        }
+    }
+
+    void AsyncLoader::addItems(uint32_t count)
+    {
+        if(spCurrentLoad)
+        {
+            spCurrentLoad->itemsTotal += count;
+        }
+    }
+}
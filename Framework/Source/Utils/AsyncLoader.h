@@ -0,0 +1,177 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace Falcor
+{
+    class ThreadPool;
+
+    /** Runs loading code on a background thread while the application keeps rendering.\n
+        Loading code creates API resources through upload(). On a loader thread, upload() hands the work to the render thread and waits for it, and the render thread executes it
+        in processUploads() under a per-frame time budget. Outside of a loader thread upload() executes the work immediately, so the same loading code serves synchronous and asynchronous loads.
+    */
+    class AsyncLoader
+    {
+    public:
+        /** A snapshot of the progress of a load
+        */
+        struct Progress
+        {
+            uint64_t bytesLoaded = 0;   ///< Number of bytes read from the source files
+            uint64_t bytesTotal = 0;    ///< Size of the source files discovered so far
+            uint32_t itemsLoaded = 0;   ///< Number of uploads executed
+            uint32_t itemsTotal = 0;    ///< Number of uploads announced so far
+        };
+
+    private:
+        struct Counters
+        {
+            std::atomic<uint64_t> bytesLoaded;
+            std::atomic<uint64_t> bytesTotal;
+            std::atomic<uint32_t> itemsLoaded;
+            std::atomic<uint32_t> itemsTotal;
+
+            Counters() : bytesLoaded(0), bytesTotal(0), itemsLoaded(0), itemsTotal(0) {}
+            Progress getProgress() const;
+        };
+
+        /** Marks the calling thread as a loader thread while in scope. The thread is unmarked even if the load throws, otherwise processUploads() would wait for a loader which doesn't exist anymore.
+        */
+        class LoaderThreadScope
+        {
+        public:
+            LoaderThreadScope(Counters* pCounters) { setLoaderThread(pCounters); }
+            ~LoaderThreadScope() { setLoaderThread(nullptr); }
+            LoaderThreadScope(const LoaderThreadScope&) = delete;
+            LoaderThreadScope& operator=(const LoaderThreadScope&) = delete;
+        };
+
+    public:
+        /** A handle to a load running in the background. The result is available once isReady() returns true.\n
+            Destroying a handle of an unfinished load waits for it to finish, so it should be kept alive until it is ready.
+        */
+        template<typename T>
+        class Handle
+        {
+        public:
+            using SharedPtr = std::shared_ptr<Handle>;
+            ~Handle() { wait(); }
+
+            /** Check if the load finished. Never blocks.
+            */
+            bool isReady() const { return mResult.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }
+
+            /** Get the progress of the load
+            */
+            Progress getProgress() const { return mpCounters->getProgress(); }
+
+            /** Get the result of the load. If the load didn't finish yet, this blocks and executes the load's uploads on the calling thread, which must be the render thread.
+            */
+            const T& get() { wait(); return mResult.get(); }
+
+        private:
+            friend class AsyncLoader;
+            Handle() = default;
+
+            void wait()
+            {
+                while(mResult.valid() && isReady() == false)
+                {
+                    if(processUploads(0) == false)
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+
+            std::shared_future<T> mResult;
+            std::shared_ptr<Counters> mpCounters;
+        };
+
+        /** Run a load function on a new thread
+            \param[in] load The function to execute. It should create its API resources using upload().
+            \return A handle for polling the load
+        */
+        template<typename T>
+        static typename Handle<T>::SharedPtr start(const std::function<T()>& load)
+        {
+            typename Handle<T>::SharedPtr pHandle = typename Handle<T>::SharedPtr(new Handle<T>);
+            std::shared_ptr<Counters> pCounters = std::make_shared<Counters>();
+            pHandle->mpCounters = pCounters;
+            pHandle->mResult = std::async(std::launch::async, [load, pCounters]()
+            {
+                LoaderThreadScope scope(pCounters.get());
+                return load();
+            }).share();
+            return pHandle;
+        }
+
+        /** Execute a function which creates API resources. Counts as one loaded item.\n
+            On a loader thread the function is queued for the render thread and this call blocks until it was executed. Otherwise, it is executed immediately.
+        */
+        static void upload(const std::function<void()>& func);
+
+        /** Execute queued uploads. Should be called once per frame by the render thread. Sample does that before calling onFrameRender().\n
+            A loader thread waits for each of its uploads, so the queue is often empty right after an upload was executed. While budget is left, the function waits up to a millisecond for the next upload to be queued, so loads keep moving at more than one item per frame.
+            \param[in] budget Time budget in milliseconds. At least one upload is executed if the queue isn't empty, and no new upload starts after the budget was exceeded.
+            \return true if any upload was executed
+        */
+        static bool processUploads(float budget);
+
+        /** Check if the calling thread is running an asynchronous load
+        */
+        static bool isLoaderThread();
+
+        /** Get a thread pool for decoding data on loader threads. It is separate from the global pool, so that loads don't stall the systems which use it every frame.
+        */
+        static ThreadPool* getDecodePool();
+
+        /** Report that the current load reads a file. The file's size is added to the total number of bytes. Does nothing outside of a loader thread.
+            \return The size of the file in bytes, or 0 outside of a loader thread
+        */
+        static uint64_t addFile(const std::string& fullpath);
+
+        /** Report that the current load read some bytes. Does nothing outside of a loader thread.
+        */
+        static void reportBytesLoaded(uint64_t bytes);
+
+        /** Report that the current load is going to execute a number of uploads. Does nothing outside of a loader thread.
+        */
+        static void addItems(uint32_t count);
+
+    private:
+        static void setLoaderThread(Counters* pCounters);
+        static thread_local Counters* spCurrentLoad;
+    };
+}
@@ -0,0 +1,225 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "BoundingVolumeHierarchy.h"
+#include "Graphics/Camera/Camera.h"
+#include <algorithm>
+#include <cfloat>
+#include "glm/common.hpp"
+
+namespace Falcor
+{
+    void BoundingVolumeHierarchy::build(const std::vector<BoundingBox>& boxes)
+    {
+        uint32_t count = (uint32_t)boxes.size();
+        mBoxMin.resize(count);
+        mBoxMax.resize(count);
+        mPrimitives.resize(count);
+        mPrimitiveNode.resize(count);
+        for(uint32_t i = 0; i < count; i++)
+        {
+            mBoxMin[i] = boxes[i].center - boxes[i].extent;
+            mBoxMax[i] = boxes[i].center + boxes[i].extent;
+            mPrimitives[i] = i;
+        }
+
+        mNodes.clear();
+        mDirty = false;
+        if(count)
+        {
+            mNodes.reserve(2 * (count / kMaxLeafSize + 1));
+            mNodes.emplace_back();
+            buildNode(0, 0, count);
+        }
+    }
+
+    void BoundingVolumeHierarchy::buildNode(uint32_t nodeID, uint32_t first, uint32_t count)
+    {
+        if(count <= kMaxLeafSize)
+        {
+            Node& node = mNodes[nodeID];
+            node.first = first;
+            node.count = count;
+            for(uint32_t i = first; i < first + count; i++)
+            {
+                mPrimitiveNode[mPrimitives[i]] = nodeID;
+            }
+            updateNodeBox(node);
+            return;
+        }
+
+        // Split at the median along the longest axis of the centers bounds. Centers are kept multiplied by 2.
+        glm::vec3 centerMin(FLT_MAX);
+        glm::vec3 centerMax(-FLT_MAX);
+        for(uint32_t i = first; i < first + count; i++)
+        {
+            glm::vec3 c = mBoxMin[mPrimitives[i]] + mBoxMax[mPrimitives[i]];
+            centerMin = glm::min(centerMin, c);
+            centerMax = glm::max(centerMax, c);
+        }
+        glm::vec3 size = centerMax - centerMin;
+        int axis = (size.x > size.y) ? ((size.x > size.z) ? 0 : 2) : ((size.y > size.z) ? 1 : 2);
+
+        uint32_t half = count / 2;
+        auto begin = mPrimitives.begin() + first;
+        std::nth_element(begin, begin + half, begin + count, [this, axis](uint32_t a, uint32_t b)
+        {
+            return (mBoxMin[a][axis] + mBoxMax[a][axis]) < (mBoxMin[b][axis] + mBoxMax[b][axis]);
+        });
+
+        // Siblings are stored next to each other
+        uint32_t left = (uint32_t)mNodes.size();
+        mNodes.resize(left + 2);
+        mNodes[nodeID].left = left;
+        mNodes[left].parent = nodeID;
+        mNodes[left + 1].parent = nodeID;
+        buildNode(left, first, half);
+        buildNode(left + 1, first + half, count - half);
+        updateNodeBox(mNodes[nodeID]);
+    }
+
+    void BoundingVolumeHierarchy::updateNodeBox(Node& node)
+    {
+        node.boxMin = glm::vec3(FLT_MAX);
+        node.boxMax = glm::vec3(-FLT_MAX);
+        if(node.left == kInvalidNode)
+        {
+            for(uint32_t i = node.first; i < node.first + node.count; i++)
+            {
+                node.boxMin = glm::min(node.boxMin, mBoxMin[mPrimitives[i]]);
+                node.boxMax = glm::max(node.boxMax, mBoxMax[mPrimitives[i]]);
+            }
+        }
+        else
+        {
+            const Node& left = mNodes[node.left];
+            const Node& right = mNodes[node.left + 1];
+            node.boxMin = glm::min(left.boxMin, right.boxMin);
+            node.boxMax = glm::max(left.boxMax, right.boxMax);
+        }
+        node.dirty = false;
+    }
+
+    void BoundingVolumeHierarchy::setBox(uint32_t primitiveID, const BoundingBox& box)
+    {
+        assert(primitiveID < mPrimitiveNode.size());
+        mBoxMin[primitiveID] = box.center - box.extent;
+        mBoxMax[primitiveID] = box.center + box.extent;
+
+        // Mark the path to the root. Stop when reaching a node which was already marked by a previous call.
+        uint32_t nodeID = mPrimitiveNode[primitiveID];
+        while(nodeID != kInvalidNode && mNodes[nodeID].dirty == false)
+        {
+            mNodes[nodeID].dirty = true;
+            nodeID = mNodes[nodeID].parent;
+        }
+        mDirty = true;
+    }
+
+    void BoundingVolumeHierarchy::refit()
+    {
+        if(mDirty == false)
+        {
+            return;
+        }
+
+        // Children are always created after their parent, so iterating backwards updates the children before the parents
+        for(size_t i = mNodes.size(); i > 0; i--)
+        {
+            Node& node = mNodes[i - 1];
+            if(node.dirty)
+            {
+                updateNodeBox(node);
+            }
+        }
+        mDirty = false;
+    }
+
+    template<typename IsCulled, typename Output>
+    void BoundingVolumeHierarchy::cullNodes(const IsCulled& isCulled, const Output& output) const
+    {
+        assert(mDirty == false);
+        if(mNodes.empty())
+        {
+            return;
+        }
+
+        uint32_t stack[64];
+        uint32_t stackSize = 0;
+        stack[stackSize++] = 0;
+        while(stackSize)
+        {
+            const Node& node = mNodes[stack[--stackSize]];
+            if(isCulled(BoundingBox::fromMinMax(node.boxMin, node.boxMax)))
+            {
+                continue;
+            }
+
+            if(node.left == kInvalidNode)
+            {
+                for(uint32_t i = node.first; i < node.first + node.count; i++)
+                {
+                    uint32_t primitiveID = mPrimitives[i];
+                    if(node.count == 1 || isCulled(BoundingBox::fromMinMax(mBoxMin[primitiveID], mBoxMax[primitiveID])) == false)
+                    {
+                        output(primitiveID);
+                    }
+                }
+            }
+            else
+            {
+                // Median splits keep the tree balanced, so its depth is log2(count / kMaxLeafSize)
+                assert(stackSize + 2 <= arraysize(stack));
+                stack[stackSize++] = node.left + 1;
+                stack[stackSize++] = node.left;
+            }
+        }
+    }
+
+    void BoundingVolumeHierarchy::cull(const Camera* pCamera, std::vector<uint32_t>& visiblePrimitives) const
+    {
+        visiblePrimitives.clear();
+        cullNodes([pCamera](const BoundingBox& box) { return pCamera->isObjectCulled(box); }, [&visiblePrimitives](uint32_t primitiveID) { visiblePrimitives.push_back(primitiveID); });
+    }
+
+    void BoundingVolumeHierarchy::cull(const Camera* pCamera, const glm::mat4& transform, uint8_t* visibleMask) const
+    {
+        // The world-space box of a node still bounds the world-space boxes of its primitives, so the test stays conservative
+        cullNodes([pCamera, &transform](const BoundingBox& box) { return pCamera->isObjectCulled(box.transform(transform)); }, [visibleMask](uint32_t primitiveID) { visibleMask[primitiveID] = 1; });
+    }
+
+    BoundingBox BoundingVolumeHierarchy::getBoundingBox() const
+    {
+        assert(mDirty == false);
+        if(mNodes.empty())
+        {
+            return BoundingBox::fromMinMax(glm::vec3(0), glm::vec3(0));
+        }
+        return BoundingBox::fromMinMax(mNodes[0].boxMin, mNodes[0].boxMax);
+    }
+}
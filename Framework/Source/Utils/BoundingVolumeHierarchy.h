@@ -0,0 +1,106 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <vector>
+#include "glm/vec3.hpp"
+#include "glm/mat4x4.hpp"
+#include "Utils/AABB.h"
+
+namespace Falcor
+{
+    class Camera;
+
+    /** A bounding volume hierarchy over a list of axis-aligned bounding boxes.\n
+        The hierarchy is built top-down by splitting the primitives at the median of their centers along the longest axis.
+        Boxes can be updated after the hierarchy was built. The hierarchy is then refitted, without changing its topology. If primitives move a lot, it's better to rebuild the hierarchy.
+    */
+    class BoundingVolumeHierarchy
+    {
+    public:
+        /** Build the hierarchy
+            \param[in] boxes The primitives bounding-boxes. A primitive ID is the index of its box in this vector.
+        */
+        void build(const std::vector<BoundingBox>& boxes);
+
+        /** Update the bounding-box of a primitive. The hierarchy will be refitted when calling refit().
+        */
+        void setBox(uint32_t primitiveID, const BoundingBox& box);
+
+        /** Propagate the changes made by setBox() to the root. Only nodes affected by the changes are updated.
+        */
+        void refit();
+
+        /** Find the primitives which intersect the camera frustum. Subtrees outside the frustum are rejected with a single test.
+            \param[in] pCamera The camera
+            \param[out] visiblePrimitives The IDs of the primitives which are potentially visible. The vector is cleared first.
+        */
+        void cull(const Camera* pCamera, std::vector<uint32_t>& visiblePrimitives) const;
+
+        /** Find the primitives which intersect the camera frustum, with the hierarchy placed in the world by a transform. Every tested box is transformed first, so a hierarchy built in object space can be shared by all the instances of an object.
+            \param[in] pCamera The camera
+            \param[in] transform The object-to-world transform
+            \param[out] visibleMask Has getPrimitiveCount() elements. The elements of the potentially visible primitives are set to 1, the others are not changed.
+        */
+        void cull(const Camera* pCamera, const glm::mat4& transform, uint8_t* visibleMask) const;
+
+        /** Get the bounding-box of all the primitives
+        */
+        BoundingBox getBoundingBox() const;
+
+        /** Get the number of primitives in the hierarchy
+        */
+        uint32_t getPrimitiveCount() const { return (uint32_t)mPrimitiveNode.size(); }
+
+    private:
+        static const uint32_t kMaxLeafSize = 4;
+        static const uint32_t kInvalidNode = (uint32_t)-1;
+
+        struct Node
+        {
+            glm::vec3 boxMin;
+            glm::vec3 boxMax;
+            uint32_t parent = kInvalidNode;
+            uint32_t left = kInvalidNode;    ///< Index of the left child. The right child is at left+1. kInvalidNode for leaves.
+            uint32_t first = 0;              ///< Leaves only. Index of the first primitive in mPrimitives.
+            uint32_t count = 0;              ///< Leaves only. Number of primitives.
+            bool dirty = false;
+        };
+
+        void buildNode(uint32_t nodeID, uint32_t first, uint32_t count);
+        template<typename IsCulled, typename Output>
+        void cullNodes(const IsCulled& isCulled, const Output& output) const;
+        void updateNodeBox(Node& node);
+
+        std::vector<Node> mNodes;
+        std::vector<uint32_t> mPrimitives;       ///< Primitive IDs, ordered so that the primitives of each leaf are contiguous
+        std::vector<uint32_t> mPrimitiveNode;    ///< The leaf containing each primitive
+        std::vector<glm::vec3> mBoxMin;          ///< Primitives boxes, indexed by primitive ID
+        std::vector<glm::vec3> mBoxMax;
+        bool mDirty = false;
+    };
+}
@@ -202,6 +202,9 @@ namespace Falcor
             TwInit(TW_OPENGL_CORE, nullptr);
 #elif defined FALCOR_DX11
             TwInit(TW_DIRECT3D11, getD3D11Device());
+#elif defined FALCOR_NULL
+            // AntTweakBar has no headless backend. The GUI calls are ignored.
+            return;
 #endif
             TwDefine(" TW_HELP visible=false ");
             TwWindowSize(windowWidth, windowHeight);
@@ -238,6 +241,9 @@ namespace Falcor
 
     void Gui::displayTwError(const std::string& prefix)
     {
+#ifdef FALCOR_NULL
+        return;     // AntTweakBar isn't initialized, so every call fails
+#endif
         std::string error(TwGetLastError());
         Logger::log(Logger::Level::Error, prefix + "\n" + error);
     }
@@ -274,6 +280,8 @@ namespace Falcor
         spRenderContext->pushState();
         spRenderContext->setRasterizerState(nullptr);
         TwDraw();
+        // AntTweakBar binds its own state through the API, so the render-context can't trust what it thinks is bound
+        spRenderContext->invalidateApiState();
         spRenderContext->popState();
     }
 
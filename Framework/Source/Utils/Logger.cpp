@@ -28,6 +28,7 @@
 #include "Framework.h"
 #include "Logger.h"
 #include "Utils/OS.h"
+#include <mutex>
 
 namespace Falcor
 {
@@ -40,6 +41,7 @@ namespace Falcor
     // FIXME: global variables...
     static bool gInit = false;
     static FILE* gLogFile = nullptr;
+    static std::mutex gLogMutex;    // Messages can come from worker threads, e.g. during parallel model import
 
     static FILE* openLogFile()
     {
@@ -111,6 +113,7 @@ namespace Falcor
 #if _LOG_ENABLED
         if(gInit)
         {
+            std::lock_guard<std::mutex> lock(gLogMutex);
             fprintf_s(gLogFile, "%-12s", getLogLevelString(L));
             fprintf_s(gLogFile, msg.c_str());
             fprintf_s(gLogFile, "\n");
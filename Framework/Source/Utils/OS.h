@@ -188,6 +188,31 @@ namespace Falcor
     */
     time_t getFileModifiedTime(const std::string& filename);
 
+    /** Map a file into the process address space for read-only access. The file's pages are loaded on demand when they are first accessed.
+        \param[in] fullpath The full path of the file. This function doesn't look in the data directories.
+        \param[out] size On successful return, the size of the file in bytes
+        \return A pointer to the start of the file, or nullptr if the file couldn't be mapped. Release it with unmapFile().
+    */
+    const void* mapFileForRead(const std::string& fullpath, size_t& size);
+
+    /** Release a file mapping created by mapFileForRead()
+    */
+    void unmapFile(const void* pData);
+
+    /** Get the size of a file in bytes. If the file is not found will return 0
+    */
+    uint64_t getFileSize(const std::string& filename);
+
+    /** Create a directory, including its missing parent directories
+        eturn true if the directory exists when the function returns
+    */
+    bool createDirectory(const std::string& path);
+
+    /** Check if the process was started with a command-line argument. The comparison is case-insensitive.
+        \param[in] arg The argument to look for, including its prefix. For example "-noModelCache".
+    */
+    bool hasCommandLineArg(const std::string& arg);
+
     enum class ThreadPriorityType : int32_t
     {
         BackgroundBegin     = -2,   //< Indicates I/O-intense thread
@@ -0,0 +1,170 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "PerfectHash.h"
+#include <algorithm>
+
+namespace Falcor
+{
+    static const uint32_t kKeysPerBucket = 4;
+    static const uint32_t kMaxSeed = 1 << 16;
+
+    uint64_t StringPerfectHash::hashString(const std::string& str)
+    {
+        // 64-bit FNV-1a
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for(char c : str)
+        {
+            hash ^= (uint8_t)c;
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    uint32_t StringPerfectHash::getSlot(uint64_t hash, uint32_t seed, uint32_t slotCount)
+    {
+        uint64_t x = hash ^ (seed * 0x9e3779b97f4a7c15ull);
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdull;
+        x ^= x >> 33;
+        return (uint32_t)(x % slotCount);
+    }
+
+    void StringPerfectHash::clear()
+    {
+        mSeeds.clear();
+        mSlots.clear();
+        mKeys.clear();
+    }
+
+    bool StringPerfectHash::build(const std::vector<std::string>& keys)
+    {
+        clear();
+        if(keys.empty())
+        {
+            return true;
+        }
+
+        const uint32_t keyCount = (uint32_t)keys.size();
+        std::vector<uint64_t> hashes(keyCount);
+        for(uint32_t i = 0; i < keyCount; i++)
+        {
+            hashes[i] = hashString(keys[i]);
+        }
+
+        // Keys with the same 64-bit hash can't be separated by any seed
+        std::vector<uint64_t> sortedHashes = hashes;
+        std::sort(sortedHashes.begin(), sortedHashes.end());
+        if(std::adjacent_find(sortedHashes.begin(), sortedHashes.end()) != sortedHashes.end())
+        {
+            Logger::log(Logger::Level::Error, "StringPerfectHash::build() - duplicate keys");
+            return false;
+        }
+
+        // Keep growing the table until every bucket finds a seed. With a load factor of 0.8 the first attempt almost always succeeds.
+        uint32_t slotCount = keyCount + keyCount / 4 + 1;
+        while(true)
+        {
+            mSeeds.assign((keyCount + kKeysPerBucket - 1) / kKeysPerBucket, 0);
+            mSlots.assign(slotCount, (uint32_t)kInvalidIndex);
+
+            std::vector<std::vector<uint32_t>> buckets(mSeeds.size());
+            for(uint32_t i = 0; i < keyCount; i++)
+            {
+                buckets[getBucket(hashes[i])].push_back(i);
+            }
+
+            // Place the largest buckets first, while the table is still mostly empty
+            std::vector<uint32_t> order(buckets.size());
+            for(uint32_t i = 0; i < (uint32_t)order.size(); i++)
+            {
+                order[i] = i;
+            }
+            std::stable_sort(order.begin(), order.end(), [&buckets](uint32_t a, uint32_t b) { return buckets[a].size() > buckets[b].size(); });
+
+            bool success = true;
+            std::vector<uint32_t> bucketSlots;
+            for(uint32_t b : order)
+            {
+                const auto& bucket = buckets[b];
+                bool placed = bucket.empty();
+                for(uint32_t seed = 0; (seed < kMaxSeed) && (placed == false); seed++)
+                {
+                    bucketSlots.clear();
+                    placed = true;
+                    for(uint32_t key : bucket)
+                    {
+                        uint32_t slot = getSlot(hashes[key], seed, slotCount);
+                        if(mSlots[slot] != kInvalidIndex || std::find(bucketSlots.begin(), bucketSlots.end(), slot) != bucketSlots.end())
+                        {
+                            placed = false;
+                            break;
+                        }
+                        bucketSlots.push_back(slot);
+                    }
+
+                    if(placed)
+                    {
+                        mSeeds[b] = seed;
+                        for(size_t i = 0; i < bucket.size(); i++)
+                        {
+                            mSlots[bucketSlots[i]] = bucket[i];
+                        }
+                    }
+                }
+
+                if(placed == false)
+                {
+                    success = false;
+                    break;
+                }
+            }
+
+            if(success)
+            {
+                break;
+            }
+            slotCount += slotCount / 4 + 1;
+        }
+
+        mKeys = keys;
+        return true;
+    }
+
+    uint32_t StringPerfectHash::lookup(const std::string& key) const
+    {
+        if(mKeys.empty())
+        {
+            return kInvalidIndex;
+        }
+
+        uint64_t hash = hashString(key);
+        uint32_t index = mSlots[getSlot(hash, mSeeds[getBucket(hash)], (uint32_t)mSlots.size())];
+        return (index != kInvalidIndex && mKeys[index] == key) ? index : kInvalidIndex;
+    }
+}
@@ -0,0 +1,69 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <string>
+#include <vector>
+
+namespace Falcor
+{
+    /** Perfect hash over a fixed set of strings.\n
+        The table is built once using hash-and-displace - keys are split into small buckets, and each bucket gets a seed which sends its keys to empty slots. A lookup hashes the key once, reads the bucket seed and compares a single stored key, so unknown keys are rejected without probing.
+    */
+    class StringPerfectHash
+    {
+    public:
+        static const uint32_t kInvalidIndex = (uint32_t)-1;
+
+        /** Build the table
+            \param[in] keys The keys. Keys must be unique.
+            \return true if the table was built, false if the keys contain duplicates. In that case the table is empty.
+        */
+        bool build(const std::vector<std::string>& keys);
+
+        /** Find a key
+            \return The key's index in the array passed to build(), or kInvalidIndex if the key is not in the table
+        */
+        uint32_t lookup(const std::string& key) const;
+
+        /** Remove all the keys
+        */
+        void clear();
+
+        /** Get the number of keys in the table
+        */
+        uint32_t getKeyCount() const { return (uint32_t)mKeys.size(); }
+    private:
+        static uint64_t hashString(const std::string& str);
+        static uint32_t getSlot(uint64_t hash, uint32_t seed, uint32_t slotCount);
+        uint32_t getBucket(uint64_t hash) const { return (uint32_t)(hash >> 32) % (uint32_t)mSeeds.size(); }
+
+        std::vector<uint32_t> mSeeds;       ///< Per-bucket displacement seed
+        std::vector<uint32_t> mSlots;       ///< Key index per slot, kInvalidIndex for empty slots
+        std::vector<std::string> mKeys;
+    };
+}
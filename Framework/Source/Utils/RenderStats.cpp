@@ -0,0 +1,106 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "RenderStats.h"
+#include <fstream>
+
+namespace Falcor
+{
+    RenderStats::FrameData RenderStats::sFrameData[2];
+    uint32_t RenderStats::sCurrentFrame = 0;
+    uint64_t RenderStats::sFrameCount = 0;
+    static std::ofstream sCsvFile;
+
+    void RenderStats::recordStateBinds(const RenderContext::BindStats& bindStats)
+    {
+        FrameData& frame = sFrameData[sCurrentFrame];
+        for(uint32_t i = 0; i < (uint32_t)RenderContext::StateBind::Count; i++)
+        {
+            frame.stateBindsIssued += bindStats.issued[i];
+            frame.stateBindsSkipped += bindStats.skipped[i];
+        }
+        frame.programSwitches += bindStats.issued[(uint32_t)RenderContext::StateBind::Program];
+    }
+
+    void RenderStats::endFrame()
+    {
+        const FrameData& frame = sFrameData[sCurrentFrame];
+        if(sCsvFile.is_open())
+        {
+            sCsvFile << sFrameCount << ',' << frame.drawCalls << ',' << frame.instances << ',' << frame.triangles << ',' << frame.culledInstances << ',' << frame.culledClusters << ',';
+            sCsvFile << frame.programSwitches << ',' << frame.materialSwitches << ',' << frame.stateBindsIssued << ',' << frame.stateBindsSkipped << ',' << frame.uniformBytesUploaded << '\n';
+        }
+
+        sFrameCount++;
+        sCurrentFrame = 1 - sCurrentFrame;
+        sFrameData[sCurrentFrame] = FrameData();
+    }
+
+    std::string RenderStats::getLastFrameString()
+    {
+        const FrameData& frame = getLastFrame();
+        std::string s;
+        s += "Draw calls           " + std::to_string(frame.drawCalls) + "\n";
+        s += "Instances            " + std::to_string(frame.instances) + "\n";
+        s += "Triangles            " + std::to_string(frame.triangles) + "\n";
+        s += "Culled instances     " + std::to_string(frame.culledInstances) + "\n";
+        s += "Culled clusters      " + std::to_string(frame.culledClusters) + "\n";
+        s += "Program switches     " + std::to_string(frame.programSwitches) + "\n";
+        s += "Material switches    " + std::to_string(frame.materialSwitches) + "\n";
+        s += "State binds          " + std::to_string(frame.stateBindsIssued) + " (" + std::to_string(frame.stateBindsSkipped) + " skipped)\n";
+        s += "Uniform upload (KB)  " + std::to_string((frame.uniformBytesUploaded + 1023) / 1024) + "\n";
+        return s;
+    }
+
+    bool RenderStats::startCsvCapture(const std::string& filename)
+    {
+        endCsvCapture();
+        sCsvFile.open(filename.c_str(), std::ios::out | std::ios::trunc);
+        if(sCsvFile.is_open() == false)
+        {
+            Logger::log(Logger::Level::Error, "RenderStats::startCsvCapture() - can't open file " + filename);
+            return false;
+        }
+
+        sCsvFile << "Frame,Draw Calls,Instances,Triangles,Culled Instances,Culled Clusters,Program Switches,Material Switches,State Binds Issued,State Binds Skipped,Uniform Bytes Uploaded\n";
+        return true;
+    }
+
+    void RenderStats::endCsvCapture()
+    {
+        if(sCsvFile.is_open())
+        {
+            sCsvFile.close();
+        }
+    }
+
+    bool RenderStats::isCapturingCsv()
+    {
+        return sCsvFile.is_open();
+    }
+}
@@ -0,0 +1,120 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <string>
+#include "Core/RenderContext.h"
+
+namespace Falcor
+{
+    /** Per-frame render statistics.
+        The counters are accumulated by the render-context, the scene renderer and the uniform buffers. Like the Profiler, the class is double-buffered - endFrame() closes the frame being recorded and the results are read from the last completed frame.\n
+        The statistics can be written into a CSV file, one row per frame, to track the cost of scene content over time.
+        The counters are not thread-safe and should only be updated from the rendering thread.
+    */
+    class RenderStats
+    {
+    public:
+        struct FrameData
+        {
+            uint32_t drawCalls = 0;             ///< Number of draw calls
+            uint32_t instances = 0;             ///< Number of instances drawn. A non-instanced draw counts as a single instance.
+            uint64_t triangles = 0;             ///< Number of triangles drawn, including all the instances
+            uint32_t culledInstances = 0;       ///< Number of mesh instances rejected by culling
+            uint32_t culledClusters = 0;        ///< Number of mesh clusters rejected by culling. Instances with all their clusters rejected also count as culled instances.
+            uint32_t programSwitches = 0;       ///< Number of program binds which reached the API
+            uint32_t materialSwitches = 0;      ///< Number of material changes in the scene renderer
+            uint32_t stateBindsIssued = 0;      ///< Number of state binds which reached the API
+            uint32_t stateBindsSkipped = 0;     ///< Number of redundant state binds filtered by the render-context
+            uint64_t uniformBytesUploaded = 0;  ///< Number of bytes copied from uniform and shader storage buffers' CPU copies into GPU memory
+        };
+
+        /** Record a draw call
+            \param[in] instanceCount Number of instances drawn
+            \param[in] triangleCount Number of triangles per instance
+        */
+        static void recordDraw(uint32_t instanceCount, uint32_t triangleCount)
+        {
+            FrameData& frame = sFrameData[sCurrentFrame];
+            frame.drawCalls++;
+            frame.instances += instanceCount;
+            frame.triangles += (uint64_t)triangleCount * instanceCount;
+        }
+
+        /** Record mesh instances rejected by culling
+        */
+        static void recordCulledInstances(uint32_t count) { sFrameData[sCurrentFrame].culledInstances += count; }
+
+        /** Record mesh clusters rejected by culling
+        */
+        static void recordCulledClusters(uint32_t count) { sFrameData[sCurrentFrame].culledClusters += count; }
+
+        /** Record a material change
+        */
+        static void recordMaterialSwitch() { sFrameData[sCurrentFrame].materialSwitches++; }
+
+        /** Record a uniform data upload
+            \param[in] bytes Number of bytes copied into GPU memory
+        */
+        static void recordUniformUpload(size_t bytes) { sFrameData[sCurrentFrame].uniformBytesUploaded += bytes; }
+
+        /** Record the render-context bind statistics for the current frame
+        */
+        static void recordStateBinds(const RenderContext::BindStats& bindStats);
+
+        /** Finish recording the current frame. The frame becomes the one returned by getLastFrame() and is appended to the CSV file if a capture is in progress.
+        */
+        static void endFrame();
+
+        /** Get the statistics of the last completed frame
+        */
+        static const FrameData& getLastFrame() { return sFrameData[1 - sCurrentFrame]; }
+
+        /** Get a printable string of the last completed frame statistics
+        */
+        static std::string getLastFrameString();
+
+        /** Start writing the statistics of every completed frame into a CSV file. If a capture is already in progress, it will be closed first.
+            \param[in] filename The CSV file name
+            \return true if the file was opened successfully, otherwise false
+        */
+        static bool startCsvCapture(const std::string& filename);
+
+        /** Stop writing the statistics into the CSV file
+        */
+        static void endCsvCapture();
+
+        /** Check if a CSV capture is in progress
+        */
+        static bool isCapturingCsv();
+
+    private:
+        static FrameData sFrameData[2];
+        static uint32_t sCurrentFrame;
+        static uint64_t sFrameCount;
+    };
+}
@@ -0,0 +1,87 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "RingBufferAllocator.h"
+
+namespace Falcor
+{
+    size_t RingBufferAllocator::allocate(size_t size, size_t alignment)
+    {
+        assert(alignment && ((alignment & (alignment - 1)) == 0));
+        if(size == 0 || size > mCapacity)
+        {
+            return kInvalidOffset;
+        }
+
+        size_t offset = (mHead + alignment - 1) & ~(alignment - 1);
+        if(offset + size > mCapacity)
+        {
+            // Skip the end of the buffer. The skipped bytes belong to the current frame, so they are released together with it.
+            offset = 0;
+        }
+
+        size_t required = (offset >= mHead) ? (offset + size - mHead) : (mCapacity - mHead + size);
+        if(mUsedSize + required > mCapacity)
+        {
+            return kInvalidOffset;
+        }
+
+        mHead = offset + size;
+        mUsedSize += required;
+        mFrameSize += required;
+        return offset;
+    }
+
+    void RingBufferAllocator::endFrame(uint64_t fenceValue)
+    {
+        assert(mFrames.empty() || mFrames.back().fenceValue < fenceValue);
+        Frame frame;
+        frame.fenceValue = fenceValue;
+        frame.size = mFrameSize;
+        mFrames.push_back(frame);
+        mFrameSize = 0;
+    }
+
+    void RingBufferAllocator::releaseFrames(uint64_t completedFenceValue)
+    {
+        while(mFrames.size() && mFrames.front().fenceValue <= completedFenceValue)
+        {
+            mUsedSize -= mFrames.front().size;
+            mFrames.pop_front();
+        }
+    }
+
+    void RingBufferAllocator::reset(size_t capacity)
+    {
+        mCapacity = capacity;
+        mHead = 0;
+        mUsedSize = 0;
+        mFrameSize = 0;
+        mFrames.clear();
+    }
+}
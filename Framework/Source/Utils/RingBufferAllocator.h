@@ -0,0 +1,101 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <deque>
+#include <cstdint>
+
+namespace Falcor
+{
+    /** Bookkeeping for a ring buffer which is written by the CPU and consumed by the GPU.\n
+        Allocations are linear. Every frame, the allocations made since the previous frame are tagged with a fence value. The space is reclaimed when the caller reports that the fence was reached.
+        Allocations never wrap around the end of the buffer, so each allocation is a contiguous range.\n
+        This class doesn't access any GPU resources. The caller is responsible for creating the buffer and the fences.
+    */
+    class RingBufferAllocator
+    {
+    public:
+        static const size_t kInvalidOffset = (size_t)-1;
+
+        /** Constructor
+            \param[in] capacity The size of the buffer in bytes
+        */
+        RingBufferAllocator(size_t capacity = 0) : mCapacity(capacity) {}
+
+        /** Allocate a contiguous range.
+            \param[in] size The number of bytes to allocate
+            \param[in] alignment The required alignment of the range's offset. Must be a power of 2.
+            \return The offset of the allocated range, or kInvalidOffset if there's not enough free space. In that case, the caller should wait for the oldest frame's fence and call releaseFrames().
+        */
+        size_t allocate(size_t size, size_t alignment = 1);
+
+        /** Tag all the allocations made since the last call with a fence value. Fence values must increase monotonically.
+        */
+        void endFrame(uint64_t fenceValue);
+
+        /** Release the space used by all frames with a fence value less than or equal to completedFenceValue
+        */
+        void releaseFrames(uint64_t completedFenceValue);
+
+        /** Release all the allocations and reset the allocator. Use it only when the GPU is no longer using the buffer.
+        */
+        void reset(size_t capacity);
+
+        /** Get the fence value of the oldest frame which wasn't released. Returns 0 if there are no frames in flight.
+        */
+        uint64_t getOldestFenceValue() const { return mFrames.empty() ? 0 : mFrames.front().fenceValue; }
+
+        /** Get the number of frames which weren't released
+        */
+        uint32_t getFramesInFlight() const { return (uint32_t)mFrames.size(); }
+
+        /** Get the number of bytes in use, including alignment padding and space skipped when wrapping around
+        */
+        size_t getUsedSize() const { return mUsedSize; }
+
+        /** Get the number of bytes allocated since the last call to endFrame()
+        */
+        size_t getFrameSize() const { return mFrameSize; }
+
+        /** Get the buffer size
+        */
+        size_t getCapacity() const { return mCapacity; }
+
+    private:
+        struct Frame
+        {
+            uint64_t fenceValue;
+            size_t size;
+        };
+
+        size_t mCapacity = 0;
+        size_t mHead = 0;           ///< The offset of the next allocation
+        size_t mUsedSize = 0;       ///< Bytes used by all frames, including the current one
+        size_t mFrameSize = 0;      ///< Bytes used by the current frame
+        std::deque<Frame> mFrames;
+    };
+}
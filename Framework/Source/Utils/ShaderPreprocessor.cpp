@@ -875,7 +875,7 @@ namespace Falcor
         verStart = code.find("#version");
         if(verStart == npos)
         {
-#ifdef FALCOR_GL
+#if defined FALCOR_GL || defined FALCOR_NULL
             mErrorStr += "Can't find version directive\n";
             return false;
 #endif
@@ -901,7 +901,7 @@ namespace Falcor
 #ifdef FALCOR_DX11
         static const std::string api = "FALCOR_HLSL";
         static const std::string extensions;
-#elif defined FALCOR_GL
+#elif defined FALCOR_GL || defined FALCOR_NULL
         static const std::string api = "FALCOR_GLSL";
         static const std::string extensions("#extension GL_ARB_bindless_texture : enable");
 #endif
@@ -0,0 +1,128 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "ThreadPool.h"
+
+namespace Falcor
+{
+    ThreadPool::UniquePtr ThreadPool::create(uint32_t workerCount)
+    {
+        return UniquePtr(new ThreadPool(workerCount));
+    }
+
+    ThreadPool* ThreadPool::getGlobalPool()
+    {
+        static UniquePtr spPool = create(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+        return spPool.get();
+    }
+
+    ThreadPool::ThreadPool(uint32_t workerCount) : mNextTask(0)
+    {
+        for(uint32_t i = 0; i < workerCount; i++)
+        {
+            mWorkers.push_back(std::thread(&ThreadPool::workerMain, this));
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mShutdown = true;
+        }
+        mWakeCondition.notify_all();
+        for(auto& worker : mWorkers)
+        {
+            worker.join();
+        }
+    }
+
+    void ThreadPool::executeTasks()
+    {
+        uint32_t taskID;
+        while((taskID = mNextTask.fetch_add(1)) < mTaskCount)
+        {
+            (*mpTask)(taskID);
+        }
+    }
+
+    void ThreadPool::workerMain()
+    {
+        uint64_t lastJobID = 0;
+        while(true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mWakeCondition.wait(lock, [this, lastJobID]() {return mShutdown || mJobID != lastJobID; });
+                if(mShutdown)
+                {
+                    return;
+                }
+                lastJobID = mJobID;
+            }
+
+            executeTasks();
+
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mPendingWorkers--;
+            }
+            mDoneCondition.notify_one();
+        }
+    }
+
+    void ThreadPool::run(uint32_t taskCount, const Task& task)
+    {
+        if(mWorkers.empty() || taskCount <= 1)
+        {
+            for(uint32_t i = 0; i < taskCount; i++)
+            {
+                task(i);
+            }
+            return;
+        }
+
+        std::lock_guard<std::mutex> runLock(mRunMutex);
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mpTask = &task;
+            mTaskCount = taskCount;
+            mNextTask = 0;
+            mPendingWorkers = (uint32_t)mWorkers.size();
+            mJobID++;
+        }
+        mWakeCondition.notify_all();
+
+        executeTasks();
+
+        // Wait for all the workers to check in, so that none of them is left holding the task when we return
+        std::unique_lock<std::mutex> lock(mMutex);
+        mDoneCondition.wait(lock, [this]() {return mPendingWorkers == 0; });
+        mpTask = nullptr;
+    }
+}
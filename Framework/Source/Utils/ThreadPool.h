@@ -0,0 +1,92 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+namespace Falcor
+{
+    /** A pool of persistent worker threads, used to split CPU work into tasks which run in parallel.\n
+        The calling thread participates in the work, so a pool with N workers runs up to N+1 tasks concurrently.
+    */
+    class ThreadPool
+    {
+    public:
+        using UniquePtr = std::unique_ptr<ThreadPool>;
+        using UniqueConstPtr = std::unique_ptr<const ThreadPool>;
+
+        /** A task function. Receives the index of the task being executed.
+        */
+        using Task = std::function<void(uint32_t taskID)>;
+
+        /** Create a new thread pool
+            \param[in] workerCount The number of worker threads to create. If zero, the pool runs all tasks on the calling thread.
+        */
+        static UniquePtr create(uint32_t workerCount);
+
+        /** Get a pool shared by the framework's systems. It has one worker less than the number of hardware threads.
+        */
+        static ThreadPool* getGlobalPool();
+
+        ~ThreadPool();
+
+        /** Execute a set of tasks and wait for all of them to finish. Tasks are executed in no particular order and on any thread, so they shouldn't depend on each other.\n
+            Calls to run() from different threads are serialized. Don't call run() from inside a task.
+            \param[in] taskCount The number of tasks
+            \param[in] task The function to execute for each task index in [0, taskCount)
+        */
+        void run(uint32_t taskCount, const Task& task);
+
+        /** Get the number of worker threads, not including the calling thread
+        */
+        uint32_t getWorkerCount() const { return (uint32_t)mWorkers.size(); }
+
+    private:
+        ThreadPool(uint32_t workerCount);
+        void workerMain();
+        void executeTasks();
+
+        std::vector<std::thread> mWorkers;
+        std::mutex mRunMutex;
+        std::mutex mMutex;
+        std::condition_variable mWakeCondition;
+        std::condition_variable mDoneCondition;
+
+        const Task* mpTask = nullptr;
+        uint32_t mTaskCount = 0;
+        std::atomic<uint32_t> mNextTask;
+        uint32_t mPendingWorkers = 0;
+        uint64_t mJobID = 0;
+        bool mShutdown = false;
+    };
+}
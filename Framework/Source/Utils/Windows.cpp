@@ -260,6 +260,39 @@ namespace Falcor
         return false;
     }
 
+    const void* mapFileForRead(const std::string& fullpath, size_t& size)
+    {
+        HANDLE hFile = CreateFileA(fullpath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if(hFile == INVALID_HANDLE_VALUE)
+        {
+            return nullptr;
+        }
+
+        LARGE_INTEGER fileSize;
+        const void* pData = nullptr;
+        if(GetFileSizeEx(hFile, &fileSize) && fileSize.QuadPart > 0)
+        {
+            HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if(hMapping)
+            {
+                pData = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+                // The view keeps a reference to the mapping object
+                CloseHandle(hMapping);
+            }
+            size = (size_t)fileSize.QuadPart;
+        }
+        CloseHandle(hFile);
+        return pData;
+    }
+
+    void unmapFile(const void* pData)
+    {
+        if(pData)
+        {
+            UnmapViewOfFile(pData);
+        }
+    }
+
     bool findAvailableFilename(const std::string& prefix, const std::string& directory, const std::string& extension, std::string& filename)
     {
         for(UINT32 i = 0; i < UINT32_MAX; i++)
@@ -448,4 +481,38 @@ namespace Falcor
 
         return s.st_mtime;
     }
-}
\ No newline at end of file
+
+    uint64_t getFileSize(const std::string& filename)
+    {
+        struct _stat64 s;
+        if(_stat64(filename.c_str(), &s) != 0)
+        {
+            return 0;
+        }
+        return (uint64_t)s.st_size;
+    }
+
+    bool createDirectory(const std::string& path)
+    {
+        // SHCreateDirectoryExA() requires a full path
+        char fullpath[MAX_PATH];
+        if(GetFullPathNameA(path.c_str(), MAX_PATH, fullpath, nullptr) == 0)
+        {
+            return false;
+        }
+        int result = SHCreateDirectoryExA(nullptr, fullpath, nullptr);
+        return result == ERROR_SUCCESS || result == ERROR_ALREADY_EXISTS || result == ERROR_FILE_EXISTS;
+    }
+
+    bool hasCommandLineArg(const std::string& arg)
+    {
+        for(int i = 1; i < __argc; i++)
+        {
+            if(_stricmp(__argv[i], arg.c_str()) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}
@@ -79,7 +79,7 @@ namespace Falcor
         ctrl->mOffsetMats[(uint32_t)Eye::Left] = glm::inverse(convertOpenVRMatrix34(vrSys->GetEyeToHeadTransform(vr::Eye_Left)));
         ctrl->mOffsetMats[(uint32_t)Eye::Right] = glm::inverse(convertOpenVRMatrix34(vrSys->GetEyeToHeadTransform(vr::Eye_Right)));
 
-#if defined(FALCOR_GL)
+#if defined(FALCOR_GL) || defined(FALCOR_NULL)
         vr::GraphicsAPIConvention curRenderAPI = vr::GraphicsAPIConvention::API_OpenGL;
 #elif defined(FALCOR_DX11)
         vr::GraphicsAPIConvention curRenderAPI = vr::GraphicsAPIConvention::API_DirectX;
@@ -128,7 +128,7 @@ namespace Falcor
 
     void VRDisplay::setDepthRange(float nearZ, float farZ)
     {
-#if defined(FALCOR_GL)
+#if defined(FALCOR_GL) || defined(FALCOR_NULL)
         vr::GraphicsAPIConvention curRenderAPI = vr::GraphicsAPIConvention::API_OpenGL;
 #elif defined(FALCOR_DX11)
         vr::GraphicsAPIConvention curRenderAPI = vr::GraphicsAPIConvention::API_DirectX;
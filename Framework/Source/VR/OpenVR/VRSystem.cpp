@@ -52,7 +52,7 @@ namespace Falcor
 
         // Create our VRSystem object and apply developer-specified parameters
         spVrSystem = new VRSystem;
-#if defined(FALCOR_GL)
+#if defined(FALCOR_GL) || defined(FALCOR_NULL)
         spVrSystem->mRenderAPI = vr::API_OpenGL;
 #elif defined(FALCOR_DX11)
         spVrSystem->mRenderAPI = vr::API_DirectX;
@@ -374,6 +374,9 @@ namespace Falcor
         mpCompositor->Submit((whichEye == VRDisplay::Eye::Right) ? vr::Eye_Right : vr::Eye_Left,       // Left or right eye?
             &subTex,                                                                  // Our API handle
             NULL);                                                                   // No cropping of input texture
+
+        // The compositor may change API state behind the render-context's back
+        mpContext->invalidateApiState();
         return true;
     }
     bool VRSystem::submit(VRDisplay::Eye whichEye, Fbo::SharedConstPtr displayFbo)
@@ -388,6 +391,9 @@ namespace Falcor
         mpCompositor->Submit((whichEye == VRDisplay::Eye::Right) ? vr::Eye_Right : vr::Eye_Left,        // Left or right eye?
             &subTex,                                                                  // Submitted texture
             NULL);                                                                   // No cropping of input texture
+
+        // The compositor may change API state behind the render-context's back
+        mpContext->invalidateApiState();
         return true;
     }
 
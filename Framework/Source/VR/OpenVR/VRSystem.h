@@ -66,8 +66,8 @@
 #include "VRPlayArea.h"
 #include "VROverlay.h"
 
-#if !defined( FALCOR_GL ) && !defined( FALCOR_DX11 )
-#error VRWrapper.h requires preprocessor definitions of *either* FALCOR_GL or FALCOR_DX11
+#if !defined( FALCOR_GL ) && !defined( FALCOR_DX11 ) && !defined( FALCOR_NULL )
+#error VRWrapper.h requires preprocessor definitions of FALCOR_GL, FALCOR_DX11 or FALCOR_NULL
 #endif
 
 #pragma comment(lib, "openvr_api.lib")
@@ -56,7 +56,7 @@ int main(int argc, char* argv[])
 
     if(argc != 4)
     {
-        printf("Usage:\nPatchFalcorPropertySheet <Solution file> <property sheet> <Backend [FALCOR_DX11, FALCOR_GL]>");
+        printf("Usage:\nPatchFalcorPropertySheet <Solution file> <property sheet> <Backend [FALCOR_DX11, FALCOR_GL, FALCOR_NULL]>");
         return 1;
     }
 
@@ -114,7 +114,7 @@ int main(int argc, char* argv[])
     
     // Patch the backend
     std::string Backend(argv[3]);
-    if(Backend != "FALCOR_DX11" && Backend != "FALCOR_GL")
+    if(Backend != "FALCOR_DX11" && Backend != "FALCOR_GL" && Backend != "FALCOR_NULL")
     {
         printf("Error. Unknown backend '%s'\n", Backend.c_str());
         return -1;
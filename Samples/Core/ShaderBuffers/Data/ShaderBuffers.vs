@@ -27,6 +27,9 @@
 ***************************************************************************/
 #version 420
 #include "hlslglslcommon.h"
+#ifdef FALCOR_GLSL
+#define _COMPILE_DEFAULT_VS
+#endif
 #include "VertexAttrib.h"
 
 struct Matrices
@@ -42,15 +45,15 @@ UNIFORM_BUFFER (PerFrameCB, 0)
 };
 
 #ifdef FALCOR_GLSL
-out vec3 normalW;
-layout(location = VERTEX_POSITION_LOC) in vec4 posL;
-layout(location = VERTEX_NORMAL_LOC)   in vec3 normalL;
-
+// The vertex inputs and normalW are declared in VertexAttrib.h. The attributes are decoded, so quantized models work too.
 void main()
+{
+    vec4 posL = getPositionL();
+    vec3 normalL = getDirectionL(vNormal);
 #elif defined FALCOR_HLSL
 void main(in vec4 posL : POSITION, in vec3 normalL : NORMAL, out vec3 normalW : NORMAL, out vec4 gl_Position : SV_POSITION)
-#endif
 {
+#endif
 	gl_Position = mul(m.wvpMat,posL);
 	normalW = (mul(m.worldMat, vec4(normalL, 0))).xyz;
 }
@@ -35,6 +35,41 @@ void ShaderBuffersSample::initUI()
     mpGui->addRgbColor("Light intensity", &mLightData.intensity);
     mpGui->addRgbColor("Surface Color", &mSurfaceColor);
     mpGui->addCheckBox("Count FS invocations", &mCountPixelShaderInvocations);
+    mpGui->addButton("Benchmark Uniform Handles", &ShaderBuffersSample::runUniformBenchmarkCB, this);
+}
+
+void ShaderBuffersSample::runUniformBenchmarkCB(void* pUserData)
+{
+    ShaderBuffersSample* pSample = (ShaderBuffersSample*)pUserData;
+    pSample->runUniformBenchmark();
+}
+
+void ShaderBuffersSample::runUniformBenchmark()
+{
+    // Compare setting the same variable through its name and through a handle
+    static const uint32_t kIterations = 4 * 1000 * 1000;
+    UniformBuffer::SharedPtr pBuffer = mpProgram->getUniformBuffer("PerFrameCB");
+    glm::mat4 worldMat;
+
+    CpuTimer::TimePoint start = CpuTimer::getCurrentTimePoint();
+    for(uint32_t i = 0; i < kIterations; i++)
+    {
+        worldMat[3][0] = (float)i;
+        pBuffer->setVariable("m.worldMat", worldMat);
+    }
+    float nameTime = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+    start = CpuTimer::getCurrentTimePoint();
+    UniformBuffer::Handle<glm::mat4> worldMatHandle = pBuffer->getHandle<glm::mat4>("m.worldMat");
+    for(uint32_t i = 0; i < kIterations; i++)
+    {
+        worldMat[3][0] = (float)i;
+        pBuffer->setVariable(worldMatHandle, worldMat);
+    }
+    float handleTime = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+    mBenchmarkResults = std::to_string(kIterations / 1000000) + "M mat4 sets - by name: " + std::to_string(nameTime) + "ms, by handle: " + std::to_string(handleTime) + "ms";
+    Logger::log(Logger::Level::Info, mBenchmarkResults);
 }
 
 Vao::SharedConstPtr ShaderBuffersSample::getVao()
@@ -106,6 +141,11 @@ void ShaderBuffersSample::onFrameRender()
     mpProgram["PerFrameCB"]["m.wvpMat"] = mpCamera->getProjMatrix() * mpCamera->getViewMatrix();
     mpProgram["PerFrameCB"]["surfaceColor"] = mSurfaceColor;
 
+    // The vertex shader decodes the attributes using the mesh's quantization parameters
+    const VertexQuantization& quantization = mpModel->getMesh(0)->getVertexQuantization();
+    mpProgram["InternalPerStaticMeshCB"]["gPositionDequantMat"] = quantization.getPositionDequantMatrix();
+    mpProgram["InternalPerStaticMeshCB"]["gOctahedralDirections"] = quantization.octahedralDirections ? 1u : 0u;
+
     mpProgram["LightCB"]["worldDir"] = mLightData.worldDir;
     mpProgram["LightCB"]["intensity"] = mLightData.intensity;
     
@@ -119,6 +159,10 @@ void ShaderBuffersSample::onFrameRender()
     mpRenderContext->drawIndexed(mIndexCount, 0, 0);
 
     std::string Txt = getGlobalSampleMessage(true) + '\n';
+    if(mBenchmarkResults.size())
+    {
+        Txt += mBenchmarkResults + '\n';
+    }
     if(mCountPixelShaderInvocations)
     {
 #ifndef FALCOR_DX11
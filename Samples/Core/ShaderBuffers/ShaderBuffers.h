@@ -43,6 +43,8 @@ public:
 
 private:
     void initUI();
+    void runUniformBenchmark();
+    static void GUI_CALL runUniformBenchmarkCB(void* pUserData);
 
     Program::SharedPtr mpProgram;
     Model::SharedPtr mpModel;
@@ -68,5 +70,6 @@ private:
     Light mLightData;
 
     glm::vec3 mSurfaceColor = glm::vec3(1,1,1);
+    std::string mBenchmarkResults;
     Vao::SharedConstPtr getVao();
 };
\ No newline at end of file
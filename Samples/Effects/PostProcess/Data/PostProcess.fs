@@ -32,7 +32,7 @@
 
 UNIFORM_BUFFER (PerFrameCB, 0)
 {
-    mat4 gWorldMat;
+    mat4 gMeshWorldMat;
     mat4 gWvpMat;
     sampler2D gEnvMap;
     vec3 gEyePosW;
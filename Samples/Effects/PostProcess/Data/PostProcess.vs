@@ -27,11 +27,14 @@
 ***************************************************************************/
 #version 420
 #include "hlslglslcommon.h"
+#ifdef FALCOR_GLSL
+#define _COMPILE_DEFAULT_VS
+#endif
 #include "VertexAttrib.h"
 
 UNIFORM_BUFFER (PerFrameCB, 0)
 {
-    mat4 gWorldMat;
+    mat4 gMeshWorldMat;
     mat4 gWvpMat;
     sampler2D gEnvMap;
     vec3 gEyePosW;
@@ -40,17 +43,16 @@ UNIFORM_BUFFER (PerFrameCB, 0)
 };
 
 #ifdef FALCOR_GLSL
-out vec3 normalW;
-out vec3 posW;
-layout(location = VERTEX_POSITION_LOC) in vec4 posL;
-layout(location = VERTEX_NORMAL_LOC)   in vec3 normalL;
-
+// The vertex inputs, normalW and posW are declared in VertexAttrib.h. The attributes are decoded, so quantized models work too.
 void main()
+{
+    vec4 posL = getPositionL();
+    vec3 normalL = getDirectionL(vNormal);
 #elif defined FALCOR_HLSL
 void main(in vec4 posL : POSITION, in vec3 normalL : NORMAL, out vec3 normalW : NORMAL, out vec4 gl_Position : SV_POSITION)
-#endif
 {
+#endif
     posW = (mul(gWvpMat,posL)).xyz;
 	gl_Position = mul(gWvpMat,posL);
-	normalW = (mul(gWorldMat, vec4(normalL, 0))).xyz;
+	normalW = (mul(gMeshWorldMat, vec4(normalL, 0))).xyz;
 }
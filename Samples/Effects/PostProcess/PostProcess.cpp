@@ -48,6 +48,7 @@ void PostProcess::onLoad()
     mSkybox.pProgram = Program::createFromFile("postprocess.vs", "postprocess.fs");
     mSkybox.pProgram->addDefine("_TEXTURE_ONLY");
     mpPerFrameCB = UniformBuffer::create(mSkybox.pProgram->getActiveProgramVersion().get(), "PerFrameCB");
+    mpPerMeshCB = UniformBuffer::create(mSkybox.pProgram->getActiveProgramVersion().get(), "InternalPerStaticMeshCB");
     mpEnvMapProgram = Program::createFromFile("postprocess.vs", "postprocess.fs");
 
     // Create the rasterizer state
@@ -115,23 +116,29 @@ void PostProcess::renderMesh(const Mesh* pMesh, const Program* pProgram, Rasteri
     // Update uniform-buffers data
     glm::mat4 world = glm::scale(glm::mat4(), glm::vec3(scale));
     glm::mat4 wvp = mpCamera->getProjMatrix() * mpCamera->getViewMatrix() * world;
-    mpPerFrameCB->setVariable("gWorldMat", world);
+    mpPerFrameCB->setVariable("gMeshWorldMat", world);
     mpPerFrameCB->setVariable("gWvpMat", wvp);
     mpPerFrameCB->setVariable("gEyePosW", mpCamera->getPosition());
     mpPerFrameCB->setTexture("gEnvMap", mHdrImage.get(), mpTriLinearSampler.get());
     mpPerFrameCB->setVariable("gLightIntensity", mLightIntensity);
     mpPerFrameCB->setVariable("gSurfaceRoughness", mSurfaceRoughness);
 
+    // The vertex shader decodes the attributes using the mesh's quantization parameters
+    const VertexQuantization& quantization = pMesh->getVertexQuantization();
+    mpPerMeshCB->setVariable("gPositionDequantMat", quantization.getPositionDequantMatrix());
+    mpPerMeshCB->setVariable("gOctahedralDirections", quantization.octahedralDirections ? 1u : 0u);
+
     // Set uniform buffers
     mpRenderContext->setProgram(pProgram->getActiveProgramVersion());
 
     // Just for the sake of the example, we fetch the buffer location from the program here. We could have cached it, or better yet, just use "layout(binding = <someindex>" in the shader
     mpRenderContext->setUniformBuffer(0, mpPerFrameCB);
+    mpRenderContext->setUniformBuffer(pProgram->getUniformBufferBinding("InternalPerStaticMeshCB"), mpPerMeshCB);
     mpRenderContext->setRasterizerState(pRastState);
 
     mpRenderContext->setVao(pMesh->getVao());
     mpRenderContext->setTopology(RenderContext::Topology::TriangleList);
-    mpRenderContext->drawIndexed(pMesh->getIndexCount(), 0, 0);
+    mpRenderContext->drawIndexed(pMesh->getIndexCount(), pMesh->getFirstIndex(), pMesh->getBaseVertex());
 }
 
 void PostProcess::onFrameRender()
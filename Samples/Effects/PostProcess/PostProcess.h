@@ -61,6 +61,7 @@ private:
 
     Program::SharedPtr mpEnvMapProgram;
     UniformBuffer::SharedPtr mpPerFrameCB;
+    UniformBuffer::SharedPtr mpPerMeshCB;
 
     enum HdrImage
     {
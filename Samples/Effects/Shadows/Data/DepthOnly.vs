@@ -40,5 +40,5 @@ layout(binding = 0) uniform PerFrameCB
 void main()
 {
 	mat4 worldMat = gWorldMat[gl_InstanceID];
-	gl_Position = gLightMat * worldMat * posL;
+	gl_Position = gLightMat * worldMat * gPositionDequantMat * posL;
 }
\ No newline at end of file
@@ -0,0 +1,586 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "FrameworkTests.h"
+#include <fstream>
+#include "Utils/RingBufferAllocator.h"
+#include "Utils/RenderStats.h"
+#include "Graphics/Model/Loaders/BinaryModelExporter.h"
+#include "Graphics/Model/Loaders/NativeModelSpec.h"
+#ifdef FALCOR_NULL
+#include "Core/Null/NullCommandStream.h"
+#endif
+
+/** Records what SceneRenderer submits, in submission order. The per-instance hook is called for every instance of every draw packet, and the post-draw hook after every draw call,
+    so the recording is the draw packet stream as it reaches the render-context.
+*/
+class RecordingSceneRenderer : public SceneRenderer
+{
+public:
+    using UniquePtr = std::unique_ptr<RecordingSceneRenderer>;
+
+    static const uint32_t kDrawEvent = (uint32_t)-1;
+
+    struct Event
+    {
+        const Model* pModel;
+        const Mesh* pMesh;
+        uint32_t meshInstanceID;        ///< kDrawEvent for the end of a draw call
+        uint32_t drawInstanceID;
+        glm::mat4 worldMat;
+
+        bool operator==(const Event& other) const
+        {
+            return pModel == other.pModel && pMesh == other.pMesh && meshInstanceID == other.meshInstanceID && drawInstanceID == other.drawInstanceID && worldMat == other.worldMat;
+        }
+    };
+
+    static UniquePtr create(const Scene::SharedPtr& pScene)
+    {
+        return UniquePtr(new RecordingSceneRenderer(pScene));
+    }
+
+    std::vector<Event> mEvents;
+
+private:
+    RecordingSceneRenderer(const Scene::SharedPtr& pScene) : SceneRenderer(pScene) {}
+
+    bool setPerMeshInstanceWorldMatrix(RenderContext* pContext, const glm::mat4& worldMat, uint32_t meshInstanceID, uint32_t drawInstanceID, const CurrentWorkingData& currentData) override
+    {
+        mEvents.push_back({currentData.pModel, currentData.pMesh, meshInstanceID, drawInstanceID, worldMat});
+        return true;
+    }
+
+    void postFlushDraw(RenderContext* pContext, const CurrentWorkingData& currentData) override
+    {
+        mEvents.push_back({currentData.pModel, currentData.pMesh, kDrawEvent, 0, glm::mat4()});
+    }
+};
+
+void FrameworkTests::runTest(const std::string& name, TestFunc test)
+{
+    std::string error;
+    bool passed = (this->*test)(error);
+    if(passed)
+    {
+        printf("[PASSED] %s\n", name.c_str());
+    }
+    else
+    {
+        printf("[FAILED] %s - %s\n", name.c_str(), error.c_str());
+        mFailedCount++;
+    }
+}
+
+bool FrameworkTests::testTraversalDeterminism(std::string& error)
+{
+    static const uint32_t kGridSize = 24;
+    static const uint32_t kMultithreadedRunCount = 4;
+
+    // A grid of two interleaved models, large enough to be split into several traversal chunks. The models are split into clusters, so that cluster culling produces partial instances too.
+    Scene::SharedPtr pScene = Scene::create(1.0f);
+    const std::string filenames[] = {"teapot.obj", "sphere.obj"};
+    Model::SharedPtr pModels[arraysize(filenames)];
+    uint32_t modelIDs[arraysize(filenames)];
+    float spacing = 0;
+    for(uint32_t i = 0; i < arraysize(filenames); i++)
+    {
+        pModels[i] = Model::createFromFile(filenames[i], Model::GenerateMeshClusters);
+        if(pModels[i] == nullptr)
+        {
+            error = "Can't load " + filenames[i];
+            return false;
+        }
+        modelIDs[i] = pScene->addModel(pModels[i], filenames[i], false);
+        spacing = std::max(spacing, pModels[i]->getRadius() * 3);
+    }
+
+    uint32_t meshInstanceCount = 0;
+    for(uint32_t y = 0; y < kGridSize; y++)
+    {
+        for(uint32_t x = 0; x < kGridSize; x++)
+        {
+            uint32_t i = (x + y) % arraysize(filenames);
+            pScene->addModelInstance(modelIDs[i], "Instance" + std::to_string(y * kGridSize + x), glm::vec3(0), glm::vec3(1), glm::vec3(x, 0, y) * spacing);
+            for(uint32_t meshID = 0; meshID < pModels[i]->getMeshCount(); meshID++)
+            {
+                meshInstanceCount += pModels[i]->getMesh(meshID)->getInstanceCount();
+            }
+        }
+    }
+
+    // Look across the grid from one corner, so that part of it is culled
+    Camera::SharedPtr pCamera = Camera::create();
+    pCamera->setAspectRatio(1.0f);
+    pCamera->setPosition(glm::vec3(-1, 1, -1) * spacing);
+    pCamera->setTarget(glm::vec3(kGridSize * 0.5f, 0, kGridSize * 0.25f) * spacing);
+    pCamera->setDepthRange(spacing * 0.01f, spacing * kGridSize * 0.75f);
+
+    Program::SharedPtr pProgram = Program::createFromFile("", "FrameworkTests.fs");
+    RecordingSceneRenderer::UniquePtr pRenderer = RecordingSceneRenderer::create(pScene);
+    mpRenderContext->setRasterizerState(nullptr);
+
+    struct Recording
+    {
+        std::vector<RecordingSceneRenderer::Event> events;
+        std::vector<std::string> draws;     // Draw commands recorded by the null backend
+    };
+
+    auto render = [&](bool multithreaded, Recording& recording)
+    {
+        pRenderer->setMultithreadedTraversal(multithreaded);
+        pRenderer->mEvents.clear();
+#ifdef FALCOR_NULL
+        getNullCommandStream()->clear();
+#endif
+        pRenderer->renderScene(mpRenderContext.get(), pProgram.get(), pCamera.get());
+        SceneRenderer::endFrame();
+        recording.events = pRenderer->mEvents;
+        recording.draws.clear();
+#ifdef FALCOR_NULL
+        for(const auto& cmd : getNullCommandStream()->getCommands())
+        {
+            if(cmd.type == NullCommandStream::CommandType::Draw || cmd.type == NullCommandStream::CommandType::DrawIndexed || cmd.type == NullCommandStream::CommandType::DrawIndexedInstanced)
+            {
+                recording.draws.push_back(to_string(cmd.type) + " " + std::to_string(cmd.elementCount) + " " + std::to_string(cmd.instanceCount) + " " + std::to_string(cmd.startLocation) + " " +
+                    std::to_string(cmd.baseVertexLocation) + " " + std::to_string(cmd.startInstanceLocation));
+            }
+        }
+#endif
+    };
+
+    for(uint32_t streaming = 0; streaming < 2; streaming++)
+    {
+        const std::string mode = streaming ? "With instance data streaming: " : "Without instance data streaming: ";
+        pRenderer->setInstanceDataStreaming(streaming != 0);
+
+        Recording reference;
+        render(false, reference);
+
+        // Instances are only submitted one by one without streaming
+        uint32_t drawCount = 0;
+        for(const auto& event : reference.events)
+        {
+            drawCount += (event.meshInstanceID == RecordingSceneRenderer::kDrawEvent) ? 1 : 0;
+        }
+        const uint32_t submittedInstanceCount = (uint32_t)reference.events.size() - drawCount;
+        if(drawCount == 0 || (streaming == 0 && submittedInstanceCount >= meshInstanceCount))
+        {
+            error = mode + "the test scene isn't partially visible";
+            return false;
+        }
+
+        // Threads finish their chunks in a different order every run, so the multithreaded traversal is repeated
+        for(uint32_t run = 0; run < kMultithreadedRunCount; run++)
+        {
+            Recording recording;
+            render(true, recording);
+            if(recording.events.size() != reference.events.size() || std::equal(reference.events.begin(), reference.events.end(), recording.events.begin()) == false)
+            {
+                error = mode + "the multithreaded traversal submitted different instances or draws";
+                return false;
+            }
+            if(recording.draws != reference.draws)
+            {
+                error = mode + "the multithreaded traversal issued different draw calls";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool FrameworkTests::testOrthographicClusterCulling(std::string& error)
+{
+    Model::SharedPtr pModel = Model::createFromFile("sphere.obj", Model::GenerateMeshClusters | Model::KeepCpuGeometry);
+    if(pModel == nullptr)
+    {
+        error = "Can't load sphere.obj";
+        return false;
+    }
+    Scene::SharedPtr pScene = Scene::create(1.0f);
+    pScene->addModel(pModel, "sphere.obj", true);
+
+    // Like the shadow pass, the camera has an identity view matrix and the light's view is folded into an orthographic projection. The sphere surrounds the origin.
+    const float radius = pModel->getRadius();
+    const glm::vec3 lightPos = glm::vec3(1, 2, 3) * radius;
+    Camera::SharedPtr pCamera = Camera::create();
+    pCamera->setViewMatrix(glm::mat4());
+    pCamera->setProjectionMatrix(glm::ortho(-2 * radius, 2 * radius, -2 * radius, 2 * radius, 0.0f, glm::length(lightPos) * 2) * glm::lookAt(lightPos, glm::vec3(0), glm::vec3(0, 1, 0)));
+
+    // Count the triangles facing the light and the ones facing away from it
+    const glm::vec3 lightDir = -glm::normalize(lightPos);
+    uint32_t frontCount = 0;
+    uint32_t backCount = 0;
+    for(uint32_t meshID = 0; meshID < pModel->getMeshCount(); meshID++)
+    {
+        const Mesh* pMesh = pModel->getMesh(meshID).get();
+        const glm::vec3* pPositions = pMesh->getCpuPositions();
+        const uint32_t* pIndices = pMesh->getCpuIndices();
+        if(pPositions == nullptr || pMesh->getClusters().empty())
+        {
+            error = "The mesh has no CPU geometry or no clusters";
+            return false;
+        }
+        for(uint32_t instanceID = 0; instanceID < pMesh->getInstanceCount(); instanceID++)
+        {
+            const glm::mat4& instanceMat = pMesh->getInstanceMatrix(instanceID);
+            for(uint32_t i = 0; i + 2 < pMesh->getIndexCount(); i += 3)
+            {
+                glm::vec3 v[3];
+                for(uint32_t j = 0; j < 3; j++)
+                {
+                    v[j] = glm::vec3(instanceMat * glm::vec4(pPositions[pIndices[i + j]], 1));
+                }
+                float facing = glm::dot(glm::cross(v[1] - v[0], v[2] - v[0]), lightDir);
+                frontCount += (facing < 0) ? 1 : 0;
+                backCount += (facing > 0) ? 1 : 0;
+            }
+        }
+    }
+
+    // Cluster culling is conservative, so every triangle facing the kept side has to be drawn. Some clusters have to be culled, otherwise the test doesn't check anything.
+    Program::SharedPtr pProgram = Program::createFromFile("", "FrameworkTests.fs");
+    SceneRenderer::UniquePtr pRenderer = SceneRenderer::create(pScene);
+    const RasterizerState::CullMode cullModes[] = {RasterizerState::CullMode::Back, RasterizerState::CullMode::Front};
+    const uint32_t keptCounts[] = {frontCount, backCount};
+    bool passed = true;
+    for(uint32_t i = 0; i < arraysize(cullModes) && passed; i++)
+    {
+        const std::string mode = (i == 0) ? "Culling back faces: " : "Culling front faces: ";
+        mpRenderContext->setRasterizerState(RasterizerState::create(RasterizerState::Desc().setCullMode(cullModes[i])));
+        pRenderer->renderScene(mpRenderContext.get(), pProgram.get(), pCamera.get());
+        SceneRenderer::endFrame();
+        RenderStats::endFrame();
+        const RenderStats::FrameData& stats = RenderStats::getLastFrame();
+        if(stats.triangles < keptCounts[i])
+        {
+            error = mode + std::to_string(stats.triangles) + " triangles drawn, " + std::to_string(keptCounts[i]) + " face the kept side";
+            passed = false;
+        }
+        else if(stats.culledClusters == 0)
+        {
+            error = mode + "no cluster was culled";
+            passed = false;
+        }
+    }
+    mpRenderContext->setRasterizerState(nullptr);
+    return passed;
+}
+
+bool FrameworkTests::testRingBufferAllocator(std::string& error)
+{
+    auto check = [&error](bool condition, const std::string& msg)
+    {
+        if(condition == false)
+        {
+            error = msg;
+        }
+        return condition;
+    };
+
+    RingBufferAllocator allocator(100);
+
+    // Two frames in flight, 80 bytes used
+    if(!check(allocator.allocate(40) == 0, "first allocation isn't at the start of the buffer")) return false;
+    allocator.endFrame(1);
+    if(!check(allocator.allocate(40) == 40, "second allocation isn't contiguous")) return false;
+    allocator.endFrame(2);
+    if(!check(allocator.getFramesInFlight() == 2 && allocator.getOldestFenceValue() == 1 && allocator.getUsedSize() == 80, "wrong state after two frames")) return false;
+
+    // The next allocation has to wrap around. The 20 bytes at the end are skipped, so it doesn't fit until frame 1 is retired.
+    if(!check(allocator.allocate(40) == RingBufferAllocator::kInvalidOffset, "allocation overwrites a frame in flight")) return false;
+    allocator.releaseFrames(1);
+    if(!check(allocator.getFramesInFlight() == 1 && allocator.getOldestFenceValue() == 2 && allocator.getUsedSize() == 40, "frame 1 wasn't retired")) return false;
+    if(!check(allocator.allocate(40) == 0, "allocation didn't wrap around")) return false;
+    if(!check(allocator.getUsedSize() == 100, "the space skipped by the wrap around isn't accounted for")) return false;
+    allocator.endFrame(3);
+
+    // Retiring frame 2 frees 40 bytes after the head. Frame 3 keeps the skipped bytes until it's retired.
+    allocator.releaseFrames(2);
+    if(!check(allocator.getUsedSize() == 60 && allocator.getOldestFenceValue() == 3, "frame 2 wasn't retired")) return false;
+    if(!check(allocator.allocate(40) == 40, "allocation after the wrap around isn't contiguous")) return false;
+    if(!check(allocator.allocate(1, 16) == RingBufferAllocator::kInvalidOffset, "allocation overwrites a frame in flight after the wrap around")) return false;
+
+    // Retiring a fence value which wasn't reached yet doesn't release the frame being recorded
+    allocator.releaseFrames(100);
+    if(!check(allocator.getFramesInFlight() == 0 && allocator.getUsedSize() == 40, "the current frame was released")) return false;
+    if(!check(allocator.allocate(10, 16) == 80, "aligned allocation has the wrong offset")) return false;
+    if(!check(allocator.allocate(101) == RingBufferAllocator::kInvalidOffset, "allocation larger than the buffer succeeded")) return false;
+    allocator.endFrame(101);
+    allocator.releaseFrames(101);
+    if(!check(allocator.getFramesInFlight() == 0 && allocator.getOldestFenceValue() == 0 && allocator.getUsedSize() == 0, "the buffer isn't empty after retiring all the frames")) return false;
+    return true;
+}
+
+/** Writes a native model with two meshes, each drawing one triangle out of the same 4 vertices. The meshes share their vertex buffers, and their CPU copy when loaded with Model::KeepCpuGeometry.
+*/
+static bool writeSharedVertexModel(const std::string& filename, const glm::vec3 positions[4], const glm::vec3 normals[4])
+{
+    static const uint32_t kSectionCount = 8;
+    static const uint32_t kIndices[] = {0, 1, 2, 0, 2, 3};
+    static const char kStrings[] = VERTEX_POSITION_NAME "\0" VERTEX_NORMAL_NAME;
+    static const uint32_t kNormalNameOffset = sizeof(VERTEX_POSITION_NAME);
+
+    auto align = [](size_t offset) { return (offset + kNativeModelAlignment - 1) & ~size_t(kNativeModelAlignment - 1); };
+
+    std::vector<uint8_t> file(align(sizeof(NativeModelHeader) + kSectionCount * sizeof(NativeSectionDesc)));
+    std::vector<NativeSectionDesc> toc;
+    auto addSection = [&](NativeSectionType type, uint32_t elementCount, const void* pData, size_t size)
+    {
+        file.resize(align(file.size()));
+        toc.push_back({(uint32_t)type, elementCount, file.size(), size});
+        file.insert(file.end(), (const uint8_t*)pData, (const uint8_t*)pData + size);
+        return toc.back().offset;
+    };
+
+    // The positions, the normals and the indices, one after the other. Their sizes keep each of them 16-byte aligned.
+    std::vector<uint8_t> data(sizeof(glm::vec3) * 8 + sizeof(kIndices));
+    memcpy(data.data(), positions, sizeof(glm::vec3) * 4);
+    memcpy(data.data() + sizeof(glm::vec3) * 4, normals, sizeof(glm::vec3) * 4);
+    memcpy(data.data() + sizeof(glm::vec3) * 8, kIndices, sizeof(kIndices));
+    const uint64_t dataOffset = addSection(NativeSectionType::Data, 0, data.data(), data.size());
+
+    const NativeBufferDesc buffers[] =
+    {
+        {dataOffset, sizeof(glm::vec3) * 4, (uint32_t)Buffer::BindFlags::Vertex, (uint32_t)Buffer::AccessFlags::None, {}},
+        {dataOffset + sizeof(glm::vec3) * 4, sizeof(glm::vec3) * 4, (uint32_t)Buffer::BindFlags::Vertex, (uint32_t)Buffer::AccessFlags::None, {}},
+        {dataOffset + sizeof(glm::vec3) * 8, sizeof(kIndices), (uint32_t)Buffer::BindFlags::Index, (uint32_t)Buffer::AccessFlags::None, {}},
+    };
+    addSection(NativeSectionType::Buffers, arraysize(buffers), buffers, sizeof(buffers));
+    addSection(NativeSectionType::Strings, 0, kStrings, sizeof(kStrings));
+
+    NativeMaterialDesc material = {};
+    material.diffuseColor = glm::vec3(1);
+    material.opacity = 1;
+    std::fill(std::begin(material.textureIDs), std::end(material.textureIDs), kNativeModelInvalidID);
+    addSection(NativeSectionType::Materials, 1, &material, sizeof(material));
+
+    const NativeVertexStreamDesc streams[] = {{0, sizeof(glm::vec3), 0, 1}, {1, sizeof(glm::vec3), 1, 1}};
+    addSection(NativeSectionType::VertexStreams, arraysize(streams), streams, sizeof(streams));
+    const NativeVertexElementDesc elements[] =
+    {
+        {0, 0, (uint32_t)ResourceFormat::RGB32Float, 1, VERTEX_POSITION_LOC, {}},
+        {kNormalNameOffset, 0, (uint32_t)ResourceFormat::RGB32Float, 1, VERTEX_NORMAL_LOC, {}},
+    };
+    addSection(NativeSectionType::VertexElements, arraysize(elements), elements, sizeof(elements));
+
+    BoundingBox box = BoundingBox::fromMinMax(glm::min(positions[0], positions[2]), glm::max(positions[0], positions[2]));
+    NativeMeshDesc meshes[2] = {};
+    for(uint32_t i = 0; i < arraysize(meshes); i++)
+    {
+        meshes[i].streamCount = arraysize(streams);
+        meshes[i].vertexCount = 4;
+        meshes[i].indexBufferID = 2;
+        meshes[i].indexCount = 3;
+        meshes[i].topology = (uint32_t)RenderContext::Topology::TriangleList;
+        meshes[i].instanceCount = 1;
+        meshes[i].boundingBoxCenter = box.center;
+        meshes[i].boundingBoxExtent = box.extent;
+        meshes[i].positionScale = glm::vec3(1);
+        meshes[i].indexFormat = (uint32_t)ResourceFormat::R32Uint;
+        meshes[i].firstIndex = i * 3;
+    }
+    addSection(NativeSectionType::Meshes, arraysize(meshes), meshes, sizeof(meshes));
+    const glm::mat4 instance;
+    addSection(NativeSectionType::Instances, 1, &instance, sizeof(instance));
+
+    NativeModelHeader header;
+    memcpy(header.formatID, kNativeModelFormatID, sizeof(header.formatID));
+    header.version = kNativeModelVersion;
+    header.sectionCount = (uint32_t)toc.size();
+    header.fileSize = file.size();
+    assert(toc.size() == kSectionCount);
+    memcpy(file.data(), &header, sizeof(header));
+    memcpy(file.data() + sizeof(header), toc.data(), toc.size() * sizeof(NativeSectionDesc));
+
+    std::ofstream stream(filename, std::ios::binary);
+    stream.write((const char*)file.data(), file.size());
+    return stream.good();
+}
+
+// Read a mesh's positions back from its vertex buffer
+static std::vector<glm::vec3> readPositions(const Mesh* pMesh)
+{
+    const Vao* pVao = pMesh->getVao().get();
+    const uint32_t vbIndex = pVao->getElementIndexByLocation(VERTEX_POSITION_LOC).vbIndex;
+    std::vector<glm::vec3> positions(pMesh->getVertexCount());
+    pVao->getVertexBuffer(vbIndex)->readData(positions.data(), size_t(pMesh->getBaseVertex()) * sizeof(glm::vec3), positions.size() * sizeof(glm::vec3));
+    return positions;
+}
+
+static bool areNear(const glm::vec3* pA, const glm::vec3* pB, size_t count)
+{
+    for(size_t i = 0; i < count; i++)
+    {
+        if(glm::any(glm::greaterThan(glm::abs(pA[i] - pB[i]), glm::vec3(1e-4f))))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FrameworkTests::testCpuGeometryConsumers(std::string& error)
+{
+    // A 2x1 quad, split into one triangle per mesh
+    const glm::vec3 positions[] = {glm::vec3(0, 0, 0), glm::vec3(2, 0, 0), glm::vec3(2, 1, 0), glm::vec3(0, 1, 0)};
+    const glm::vec3 normals[] = {glm::vec3(0, 0, 1), glm::vec3(0, 0, 1), glm::vec3(0, 0, 1), glm::vec3(0, 0, 1)};
+    const std::string filename = "FrameworkTestsSharedVertices.bin";
+    const std::string exportFilenames[] = {"FrameworkTestsNativeExport.bin", "FrameworkTestsLegacyExport.bin"};
+    const BinaryModelExporter::FileFormat exportFormats[] = {BinaryModelExporter::FileFormat::Native, BinaryModelExporter::FileFormat::Legacy};
+    if(writeSharedVertexModel(filename, positions, normals) == false)
+    {
+        error = "Can't write " + filename;
+        return false;
+    }
+
+    const glm::mat4 transform = glm::translate(glm::mat4(), glm::vec3(1, 2, 3)) * glm::rotate(glm::mat4(), 0.5f, glm::vec3(0, 1, 0)) * glm::scale(glm::mat4(), glm::vec3(2, 3, 4));
+    glm::vec3 transformedPositions[4];
+    glm::vec3 transformedNormals[4];
+    for(uint32_t i = 0; i < 4; i++)
+    {
+        transformedPositions[i] = glm::vec3(transform * glm::vec4(positions[i], 1));
+        transformedNormals[i] = glm::vec3(glm::transpose(glm::inverse(transform)) * glm::vec4(normals[i], 0));
+    }
+
+    // Checks the geometry of both meshes of a model. The CPU copy, when there is one, must match the vertex buffers.
+    auto checkModel = [&error](const Model* pModel, const glm::vec3* pPositions, const glm::vec3* pNormals, const std::string& name)
+    {
+        if(pModel == nullptr || pModel->getMeshCount() != 2)
+        {
+            error = name + ": the model wasn't loaded";
+            return false;
+        }
+        for(uint32_t meshID = 0; meshID < 2; meshID++)
+        {
+            const Mesh* pMesh = pModel->getMesh(meshID).get();
+            const std::vector<glm::vec3> bufferPositions = readPositions(pMesh);
+            const std::vector<glm::vec3> meshNormals = pMesh->getNormals();
+            const std::vector<uint32_t> indices = pMesh->getIndices();
+            if(pMesh->getVertexCount() != 4 || areNear(bufferPositions.data(), pPositions, 4) == false || (pMesh->hasCpuGeometry() && areNear(pMesh->getCpuPositions(), pPositions, 4) == false))
+            {
+                error = name + ": wrong positions";
+                return false;
+            }
+            if(meshNormals.size() != 4 || areNear(meshNormals.data(), pNormals, 4) == false)
+            {
+                error = name + ": wrong normals";
+                return false;
+            }
+            if(indices.size() != 3 || indices[0] != 0 || indices[1] != meshID + 1 || indices[2] != meshID + 2)
+            {
+                error = name + ": wrong indices";
+                return false;
+            }
+        }
+        return true;
+    };
+
+    bool passed = true;
+    for(uint32_t keepCpu = 0; keepCpu < 2 && passed; keepCpu++)
+    {
+        const uint32_t flags = keepCpu ? Model::KeepCpuGeometry : 0;
+        const std::string mode = keepCpu ? "With a CPU copy" : "Without a CPU copy";
+
+        Model::SharedPtr pModel = Model::createFromFile(filename, flags);
+        passed = checkModel(pModel.get(), positions, normals, mode);
+        if(passed && pModel->getMesh(0)->getVao() != pModel->getMesh(1)->getVao())
+        {
+            error = mode + ": the meshes don't share their vertices";
+            passed = false;
+        }
+
+        // Both triangles have an area of 1. The light faces the triangle's normal.
+        for(uint32_t meshID = 0; meshID < 2 && passed; meshID++)
+        {
+            AreaLight::SharedPtr pLight = AreaLight::create();
+            pLight->setMeshData(pModel->getMesh(meshID), 0);
+            if(std::abs(pLight->getSurfaceArea() - 1.0f) > 1e-4f || areNear(&pLight->getData().worldDir, &normals[0], 1) == false)
+            {
+                error = mode + ": wrong area light surface or direction";
+                passed = false;
+            }
+        }
+
+        // The shared vertices must be transformed once
+        if(passed)
+        {
+            pModel->applyTransform(transform);
+            passed = checkModel(pModel.get(), transformedPositions, transformedNormals, mode + ", after applyTransform()");
+        }
+
+        // Round trip through the exporter. The CPU copy and the GPU readback must export the same data.
+        for(uint32_t i = 0; i < arraysize(exportFormats) && passed; i++)
+        {
+            BinaryModelExporter::exportToFile(exportFilenames[i], pModel.get(), exportFormats[i]);
+            Model::SharedPtr pImported = Model::createFromFile(exportFilenames[i], flags);
+            passed = checkModel(pImported.get(), transformedPositions, transformedNormals, mode + ", exported to " + exportFilenames[i]);
+
+            // The legacy format stores the meshes as submeshes of one mesh, so they share their vertices again
+            if(passed)
+            {
+                pImported->applyTransform(glm::inverse(transform));
+                passed = checkModel(pImported.get(), positions, normals, mode + ", " + exportFilenames[i] + " after applyTransform()");
+            }
+        }
+    }
+
+    std::remove(filename.c_str());
+    for(const auto& exportFilename : exportFilenames)
+    {
+        std::remove(exportFilename.c_str());
+    }
+    return passed;
+}
+
+void FrameworkTests::onLoad()
+{
+    runTest("RingBufferAllocator wrap around and frame retirement", &FrameworkTests::testRingBufferAllocator);
+    runTest("CPU geometry consumers match the GPU readback", &FrameworkTests::testCpuGeometryConsumers);
+    runTest("SceneRenderer multithreaded traversal determinism", &FrameworkTests::testTraversalDeterminism);
+    runTest("SceneRenderer back-facing cluster culling with an orthographic camera", &FrameworkTests::testOrthographicClusterCulling);
+    printf("%u tests failed\n", mFailedCount);
+    shutdownApp();
+}
+
+void FrameworkTests::onShutdown()
+{
+
+}
+
+int main(int argc, char* argv[])
+{
+    FrameworkTests tests;
+    SampleConfig config;
+    config.windowDesc.swapChainDesc.width = 256;
+    config.windowDesc.swapChainDesc.height = 256;
+    config.windowDesc.title = "FrameworkTests";
+    config.showMessageBoxOnError = false;
+    tests.run(config);
+    return (int)tests.getFailedCount();
+}
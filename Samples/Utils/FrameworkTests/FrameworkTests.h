@@ -0,0 +1,56 @@
+/***************************************************************************
+# Copyright (c) 2015, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "Falcor.h"
+
+using namespace Falcor;
+
+/** Runs the framework tests, prints the results and exits. The process returns the number of failed tests.\n
+    Tests which inspect the recorded commands only run with the null backend (the DebugNull/ReleaseNull configurations). They are skipped with the other backends.
+*/
+class FrameworkTests : public Sample
+{
+public:
+    void onLoad() override;
+    void onShutdown() override;
+
+    uint32_t getFailedCount() const { return mFailedCount; }
+
+private:
+    /** A test returns false and describes the failure in error if it fails
+    */
+    using TestFunc = bool(FrameworkTests::*)(std::string& error);
+    void runTest(const std::string& name, TestFunc test);
+
+    bool testRingBufferAllocator(std::string& error);
+    bool testCpuGeometryConsumers(std::string& error);
+    bool testTraversalDeterminism(std::string& error);
+    bool testOrthographicClusterCulling(std::string& error);
+
+    uint32_t mFailedCount = 0;
+};
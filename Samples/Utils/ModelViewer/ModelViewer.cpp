@@ -26,6 +26,7 @@
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ***************************************************************************/
 #include "ModelViewer.h"
+#include <random>
 
 void GUI_CALL ModelViewer::loadModelCallback(void* pUserData)
 {
@@ -53,6 +54,340 @@ void GUI_CALL ModelViewer::deleteCulledMeshesCallback(void* pUserData)
     }
 }
 
+void GUI_CALL ModelViewer::runAnimationBenchmarkCB(void* pUserData)
+{
+    ModelViewer* pViewer = reinterpret_cast<ModelViewer*>(pUserData);
+    pViewer->runAnimationBenchmark();
+}
+
+void ModelViewer::runAnimationBenchmark()
+{
+    // A synthetic mocap-like clip - a chain of bones, every bone is keyed on every frame
+    static const uint32_t kBoneCount = 64;
+    static const uint32_t kKeyCount = 30 * 60;
+    static const uint32_t kIterations = 2000;
+
+    std::vector<Bone> bones(kBoneCount);
+    std::vector<Animation::AnimationSet> animationSets(kBoneCount);
+    for(uint32_t i = 0; i < kBoneCount; i++)
+    {
+        bones[i].boneID = i;
+        bones[i].parentID = (i == 0) ? INVALID_BONE_ID : i - 1;
+        bones[i].name = "Bone" + std::to_string(i);
+        bones[i].localTransform[3] = glm::vec4(0, 1, 0, 1);
+        bones[i].originalLocalTransform = bones[i].localTransform;
+
+        Animation::AnimationSet& set = animationSets[i];
+        set.boneID = i;
+        const float phase = float(i) * 0.37f;
+        for(uint32_t k = 0; k < kKeyCount; k++)
+        {
+            const float time = float(k);
+            const float angle = sinf(time * 0.05f + phase) * 0.8f + sinf(time * 0.31f + phase) * 0.05f;
+            set.translation.keys.push_back({glm::vec3(0, 1, 0) + glm::vec3(sinf(time * 0.02f + phase), 0, 0) * 0.1f, time});
+            set.scaling.keys.push_back({glm::vec3(1), time});
+            set.rotation.keys.push_back({glm::angleAxis(angle, glm::normalize(glm::vec3(1, 0.5f, 0.25f))), time});
+        }
+    }
+
+    std::string results = "Animation compression - " + std::to_string(kBoneCount) + " bones, " + std::to_string(kKeyCount) + " keys per track\n";
+    for(uint32_t compress = 0; compress < 2; compress++)
+    {
+        Animation::UniquePtr pAnimation;
+        if(compress)
+        {
+            pAnimation = Animation::createCompressed("Benchmark", animationSets, float(kKeyCount), 30, Animation::CompressionDesc());
+        }
+        else
+        {
+            pAnimation = Animation::create("Benchmark", animationSets, float(kKeyCount), 30);
+        }
+        size_t memorySize = pAnimation->getKeysMemorySize();
+
+        AnimationController::UniquePtr pController = AnimationController::create(bones);
+        pController->addAnimation(std::move(pAnimation));
+        pController->setActiveAnimation(0);
+
+        CpuTimer::TimePoint start = CpuTimer::getCurrentTimePoint();
+        for(uint32_t i = 0; i < kIterations; i++)
+        {
+            pController->animate(double(i) * 0.0167);
+        }
+        float time = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+        results += compress ? "Compressed" : "Raw";
+        results += ": " + std::to_string(memorySize / 1024) + "KB, " + std::to_string(time * 1000 / kIterations) + "us per evaluation\n";
+    }
+
+    mBenchmarkResults = results;
+    Logger::log(Logger::Level::Info, mBenchmarkResults);
+}
+
+void GUI_CALL ModelViewer::runCrowdBenchmarkCB(void* pUserData)
+{
+    ModelViewer* pViewer = reinterpret_cast<ModelViewer*>(pUserData);
+    pViewer->runCrowdBenchmark();
+}
+
+void ModelViewer::runCrowdBenchmark()
+{
+    static const uint32_t kCrowdSize = 64;
+    static const uint32_t kRowSize = 8;
+    static const uint32_t kFrameCount = 600;
+
+    if(mpModel == nullptr || mpModel->hasAnimations() == false)
+    {
+        msgBox("Load an animated model first");
+        return;
+    }
+
+    // Every member of the crowd is a separate copy of the model, so that it has its own animation state. The rows move away from the camera.
+    // The last quarter of the crowd stands behind the camera, so that the updates of the culled models are measured too.
+    Scene::SharedPtr pScene = Scene::create(mpCamera->getAspectRatio());
+    const glm::vec3 forward = glm::normalize(mpCamera->getTargetPosition() - mpCamera->getPosition());
+    const glm::vec3 right = glm::normalize(glm::cross(forward, mpCamera->getUpVector()));
+    const float spacing = mpModel->getRadius() * 2.5f;
+    for(uint32_t i = 0; i < kCrowdSize; i++)
+    {
+        Model::SharedPtr pModel = Model::createFromFile(mModelFilename, mModelLoadFlags);
+        if(pModel == nullptr)
+        {
+            return;
+        }
+        pModel->setActiveAnimation((mActiveAnimationID == sBindPoseAnimationID) ? 0 : mActiveAnimationID);
+
+        uint32_t modelID = pScene->addModel(pModel, mModelFilename, false);
+        glm::vec3 position = right * (float(i % kRowSize) - float(kRowSize - 1) * 0.5f) * spacing;
+        if(i < kCrowdSize * 3 / 4)
+        {
+            position += mpCamera->getTargetPosition() + forward * float(i / kRowSize) * spacing * 4.0f;
+        }
+        else
+        {
+            position += mpCamera->getPosition() - forward * (mpModel->getRadius() + float((i - kCrowdSize * 3 / 4) / kRowSize) * spacing);
+        }
+        pScene->addModelInstance(modelID, "Crowd" + std::to_string(i), glm::vec3(0), glm::vec3(1), position - mpModel->getCenter());
+    }
+
+    std::string results = "Crowd animation - " + std::to_string(kCrowdSize) + " models, " + std::to_string(mpModel->getBonesCount()) + " bones each\n";
+    AnimationScheduler::UniquePtr pScheduler = AnimationScheduler::create(pScene);
+    for(uint32_t lod = 0; lod < 2; lod++)
+    {
+        pScheduler->setLodEnabled(lod != 0);
+        float evaluationTime = 0;
+        uint64_t evaluatedBones = 0;
+        uint64_t culledModels = 0;
+        uint32_t maxFramesSinceUpdate = 0;
+        CpuTimer::TimePoint start = CpuTimer::getCurrentTimePoint();
+        for(uint32_t frame = 0; frame < kFrameCount; frame++)
+        {
+            pScheduler->update(mpCamera.get(), double(frame) / 60.0);
+            evaluationTime += pScheduler->getStatistics().evaluationTime;
+            evaluatedBones += pScheduler->getStatistics().evaluatedBones;
+            culledModels += pScheduler->getStatistics().culledModels;
+            maxFramesSinceUpdate = std::max(maxFramesSinceUpdate, pScheduler->getStatistics().maxFramesSinceUpdate);
+        }
+        float time = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+        results += lod ? "Animation LOD" : "Full rate";
+        results += ": " + std::to_string(time / kFrameCount) + "ms per frame, " + std::to_string(evaluationTime / kFrameCount) + "ms evaluating ";
+        results += std::to_string(evaluatedBones / kFrameCount) + " bones per frame";
+        if(lod)
+        {
+            results += ", " + std::to_string(culledModels / kFrameCount) + " culled models, at most " + std::to_string(maxFramesSinceUpdate) + " frames between updates";
+        }
+        results += "\n";
+    }
+
+    mBenchmarkResults = results;
+    Logger::log(Logger::Level::Info, mBenchmarkResults);
+}
+
+void GUI_CALL ModelViewer::runImportBenchmarkCB(void* pUserData)
+{
+    ModelViewer* pViewer = reinterpret_cast<ModelViewer*>(pUserData);
+    pViewer->runImportBenchmark();
+}
+
+void ModelViewer::runImportBenchmark()
+{
+    static const uint32_t kRepeatCount = 3;
+
+    if(mpModel == nullptr)
+    {
+        msgBox("Load a model first");
+        return;
+    }
+
+    // Reload the model with a growing number of decode workers. The calling thread also decodes, so N workers means N+1 threads.
+    // The model import cache is disabled, otherwise the first load would cook the model and the others would only map the cooked file.
+    const bool cacheEnabled = ModelImportCache::isEnabled();
+    ModelImportCache::setEnabled(false);
+    std::string results = "Model import - " + mModelFilename + "\n";
+    const uint32_t maxWorkers = std::max(std::thread::hardware_concurrency(), 1u) - 1;
+    for(uint32_t workers = 0; ; workers = std::min(std::max(workers * 2, 1u), maxWorkers))
+    {
+        ThreadPool::UniquePtr pPool = ThreadPool::create(workers);
+        Model::setImportThreadPool(pPool.get());
+
+        float bestTime = FLT_MAX;
+        for(uint32_t i = 0; i < kRepeatCount; i++)
+        {
+            CpuTimer::TimePoint start = CpuTimer::getCurrentTimePoint();
+            Model::SharedPtr pModel = Model::createFromFile(mModelFilename, mModelLoadFlags);
+            bestTime = std::min(bestTime, CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint()));
+        }
+        Model::setImportThreadPool(nullptr);
+
+        results += std::to_string(workers + 1) + " threads: " + std::to_string(bestTime) + "ms\n";
+        if(workers == maxWorkers)
+        {
+            break;
+        }
+    }
+    ModelImportCache::setEnabled(cacheEnabled);
+
+    mBenchmarkResults = results;
+    Logger::log(Logger::Level::Info, mBenchmarkResults);
+}
+
+void GUI_CALL ModelViewer::runImportCacheBenchmarkCB(void* pUserData)
+{
+    ModelViewer* pViewer = reinterpret_cast<ModelViewer*>(pUserData);
+    pViewer->runImportCacheBenchmark();
+}
+
+void ModelViewer::runImportCacheBenchmark()
+{
+    static const uint32_t kRepeatCount = 3;
+
+    if(mpModel == nullptr)
+    {
+        msgBox("Load a model first");
+        return;
+    }
+    if(hasSuffix(mModelFilename, ".bin", false))
+    {
+        msgBox("Binary models are loaded directly, they don't go through the model import cache");
+        return;
+    }
+
+    auto timeLoad = [this]()
+    {
+        CpuTimer::TimePoint start = CpuTimer::getCurrentTimePoint();
+        Model::SharedPtr pModel = Model::createFromFile(mModelFilename, mModelLoadFlags);
+        return CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+    };
+
+    // Cook into an empty directory, so that the first load through the cache is a miss and the application's cache isn't touched
+    const bool cacheEnabled = ModelImportCache::isEnabled();
+    const std::string cacheDirectory = ModelImportCache::getDirectory();
+    ModelImportCache::setDirectory(cacheDirectory + "\\Benchmark");
+    ModelImportCache::clear();
+
+    ModelImportCache::setEnabled(false);
+    float importTime = FLT_MAX;
+    for(uint32_t i = 0; i < kRepeatCount; i++)
+    {
+        importTime = std::min(importTime, timeLoad());
+    }
+
+    ModelImportCache::setEnabled(true);
+    const ModelImportCache::Stats statsBefore = ModelImportCache::getStats();
+    const float coldTime = timeLoad();
+    float hitTime = FLT_MAX;
+    for(uint32_t i = 0; i < kRepeatCount; i++)
+    {
+        hitTime = std::min(hitTime, timeLoad());
+    }
+    const ModelImportCache::Stats statsAfter = ModelImportCache::getStats();
+
+    ModelImportCache::clear();
+    ModelImportCache::setDirectory(cacheDirectory);
+    ModelImportCache::setEnabled(cacheEnabled);
+
+    std::string results = "Model import cache - " + mModelFilename + "\n";
+    results += "Import without the cache: " + std::to_string(importTime) + "ms\n";
+    results += "Cold import (miss, writes the cooked file): " + std::to_string(coldTime) + "ms\n";
+    if(statsAfter.hits - statsBefore.hits == kRepeatCount)
+    {
+        results += "Cache hit: " + std::to_string(hitTime) + "ms\n";
+    }
+    else
+    {
+        results += "The model wasn't loaded from the cache. Models with bones or animations aren't cached.\n";
+    }
+
+    mBenchmarkResults = results;
+    Logger::log(Logger::Level::Info, mBenchmarkResults);
+}
+
+void GUI_CALL ModelViewer::runCullingBenchmarkCB(void* pUserData)
+{
+    ModelViewer* pViewer = reinterpret_cast<ModelViewer*>(pUserData);
+    pViewer->runCullingBenchmark();
+}
+
+void ModelViewer::runCullingBenchmark()
+{
+    static const uint32_t kBoxCount = 64 * 1024;
+    static const uint32_t kIterations = 100;
+
+    // Random boxes around the camera, so that some are inside the frustum, some outside and some intersect its planes
+    std::mt19937 rng(0);
+    const float range = mpCamera->getFarPlane();
+    std::uniform_real_distribution<float> offset(-range, range);
+    std::uniform_real_distribution<float> extent(0, range * 0.05f);
+    BoundingBoxArray boxes;
+    boxes.resize(kBoxCount);
+    for(uint32_t i = 0; i < kBoxCount; i++)
+    {
+        BoundingBox box;
+        box.center = mpCamera->getPosition() + glm::vec3(offset(rng), offset(rng), offset(rng));
+        box.extent = glm::vec3(extent(rng), extent(rng), extent(rng));
+        boxes.set(i, box);
+    }
+
+    std::vector<uint8_t> batchMask(kBoxCount);
+    CpuTimer::TimePoint start = CpuTimer::getCurrentTimePoint();
+    for(uint32_t iteration = 0; iteration < kIterations; iteration++)
+    {
+        mpCamera->cullBoxes(boxes, batchMask.data());
+    }
+    float batchTime = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+    std::vector<uint8_t> scalarMask(kBoxCount);
+    start = CpuTimer::getCurrentTimePoint();
+    for(uint32_t iteration = 0; iteration < kIterations; iteration++)
+    {
+        for(uint32_t i = 0; i < kBoxCount; i++)
+        {
+            scalarMask[i] = mpCamera->isObjectCulled(boxes.get(i)) ? 0 : 1;
+        }
+    }
+    float scalarTime = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+    // The batch path must give exactly the same visibility as the scalar reference
+    uint32_t visibleCount = 0;
+    uint32_t mismatchCount = 0;
+    for(uint32_t i = 0; i < kBoxCount; i++)
+    {
+        visibleCount += scalarMask[i];
+        mismatchCount += (batchMask[i] != scalarMask[i]) ? 1 : 0;
+    }
+
+    std::string results = "Frustum culling - " + std::to_string(kBoxCount) + " boxes, " + std::to_string(visibleCount) + " visible\n";
+    results += "SSE batch: " + std::to_string(batchTime * 1000 / kIterations) + "us per pass\n";
+    results += "Scalar: " + std::to_string(scalarTime * 1000 / kIterations) + "us per pass\n";
+    if(mismatchCount)
+    {
+        results += "Error: the results differ for " + std::to_string(mismatchCount) + " boxes\n";
+    }
+
+    mBenchmarkResults = results;
+    Logger::log(mismatchCount ? Logger::Level::Error : Logger::Level::Info, mBenchmarkResults);
+}
+
 CameraController& ModelViewer::getActiveCameraController()
 {
     switch(mCameraType)
@@ -80,6 +415,20 @@ void ModelViewer::setModelString(bool isAfterCull, float loadTime)
     mModelString += std::to_string(mpModel->getMaterialCount()) + " materials, ";
     mModelString += std::to_string(mpModel->getTextureCount()) + " textures, ";
     mModelString += std::to_string(mpModel->getBufferCount()) + " buffers.\n";
+
+    const MeshOptimizationStats& stats = mpModel->getMeshOptimizationStats();
+    if(stats.before.triangleCount > 0)
+    {
+        mModelString += "Mesh optimization: " + to_string(stats) + "\n";
+    }
+
+    const VertexQuantizationStats& quantStats = mpModel->getVertexQuantizationStats();
+    if(quantStats.bytesBefore > 0)
+    {
+        mModelString += "Vertex quantization: " + to_string(quantStats) + "\n";
+    }
+
+    mModelString += "Texture cache: " + to_string(TextureCache::getStats()) + "\n";
 }
 
 void ModelViewer::loadModelFromFile(const std::string& filename)
@@ -89,9 +438,18 @@ void ModelViewer::loadModelFromFile(const std::string& filename)
 
     uint32_t flags = mCompressTextures ? Model::CompressTextures : 0;
     flags |= mGenerateTangentSpace ? Model::GenerateTangentSpace : 0;
+    flags |= mCompressAnimations ? Model::CompressAnimations : 0;
+    flags |= mOptimizeMeshes ? Model::OptimizeMeshes : 0;
+    flags |= mQuantizeVertices ? Model::QuantizeVertices : 0;
+    flags |= mQuantizePositions ? Model::QuantizePositions : 0;
+    flags |= mPackGeometry ? Model::PackGeometry : 0;
+    flags |= mKeepCpuGeometry ? Model::KeepCpuGeometry : 0;
+    flags |= mGenerateMeshClusters ? Model::GenerateMeshClusters : 0;
     auto fboFormat = mpDefaultFBO->getColorTexture(0)->getFormat();
     flags |= isSrgbFormat(fboFormat) ? 0 : Model::AssumeLinearSpaceTextures;
     mpModel = Model::createFromFile(filename, flags);
+    mModelFilename = filename;
+    mModelLoadFlags = flags;
 
     if(mpModel == nullptr)
     {
@@ -141,8 +499,20 @@ void ModelViewer::initUI()
     const std::string LoadOptions = "Load Options";
     mpGui->addCheckBox("Compress Textures", &mCompressTextures, LoadOptions);
     mpGui->addCheckBox("Generate Tangent Space", &mGenerateTangentSpace, LoadOptions);
+    mpGui->addCheckBox("Compress Animations", &mCompressAnimations, LoadOptions);
+    mpGui->addCheckBox("Optimize Meshes", &mOptimizeMeshes, LoadOptions);
+    mpGui->addCheckBox("Quantize Vertices", &mQuantizeVertices, LoadOptions);
+    mpGui->addCheckBox("Quantize Positions", &mQuantizePositions, LoadOptions);
+    mpGui->addCheckBox("Pack Geometry", &mPackGeometry, LoadOptions);
+    mpGui->addCheckBox("Keep CPU Geometry", &mKeepCpuGeometry, LoadOptions);
+    mpGui->addCheckBox("Generate Mesh Clusters", &mGenerateMeshClusters, LoadOptions);
     mpGui->addButton("Export Model To Binary File", &ModelViewer::saveModelCallback, this);
     mpGui->addButton("Delete Culled Meshes", &ModelViewer::deleteCulledMeshesCallback, this);
+    mpGui->addButton("Benchmark Animation Compression", &ModelViewer::runAnimationBenchmarkCB, this);
+    mpGui->addButton("Benchmark Crowd Animation", &ModelViewer::runCrowdBenchmarkCB, this);
+    mpGui->addButton("Benchmark Model Import", &ModelViewer::runImportBenchmarkCB, this);
+    mpGui->addButton("Benchmark Model Import Cache", &ModelViewer::runImportCacheBenchmarkCB, this);
+    mpGui->addButton("Benchmark Frustum Culling", &ModelViewer::runCullingBenchmarkCB, this);
 
     mpGui->addSeparator();
     mpGui->addCheckBox("Wireframe", &mDrawWireframe);
@@ -308,7 +678,7 @@ void ModelViewer::onFrameRender()
         ModelRenderer::render(mpRenderContext.get(), mpProgram.get(), mpModel, mpCamera.get());
     }
 
-    std::string Msg = getGlobalSampleMessage(true) + '\n' + mModelString;
+    std::string Msg = getGlobalSampleMessage(true) + '\n' + mModelString + mBenchmarkResults;
     renderText(Msg, glm::vec2(10, 10));
 }
 
@@ -44,10 +44,20 @@ private:
     static void GUI_CALL loadModelCallback(void* pUserData);
     static void GUI_CALL saveModelCallback(void* pUserData);
     static void GUI_CALL deleteCulledMeshesCallback(void* pUserData);
+    static void GUI_CALL runAnimationBenchmarkCB(void* pUserData);
+    static void GUI_CALL runCrowdBenchmarkCB(void* pUserData);
+    static void GUI_CALL runImportBenchmarkCB(void* pUserData);
+    static void GUI_CALL runImportCacheBenchmarkCB(void* pUserData);
+    static void GUI_CALL runCullingBenchmarkCB(void* pUserData);
 
     void initUI();
     void loadModel();
     void saveModel();
+    void runAnimationBenchmark();
+    void runCrowdBenchmark();
+    void runImportBenchmark();
+    void runImportCacheBenchmark();
+    void runCullingBenchmark();
 
     void loadModelFromFile(const std::string& Filename);
     void resetCamera();
@@ -55,6 +65,8 @@ private:
     void setModelString(bool isAfterCull, float LoadTime);
 
     Model::SharedPtr mpModel = nullptr;
+    std::string mModelFilename;
+    uint32_t mModelLoadFlags = 0;
     ModelViewCameraController mModelViewCameraController;
     FirstPersonCameraController mFirstPersonCameraController;
     SixDoFCameraController m6DoFCameraController;
@@ -82,6 +94,13 @@ private:
     bool mAnimate = false;
     bool mCompressTextures = false;
     bool mGenerateTangentSpace = true;
+    bool mCompressAnimations = false;
+    bool mOptimizeMeshes = false;
+    bool mQuantizeVertices = false;
+    bool mQuantizePositions = false;
+    bool mPackGeometry = false;
+    bool mKeepCpuGeometry = false;
+    bool mGenerateMeshClusters = false;
     glm::vec3 mAmbientIntensity = glm::vec3(0.1f, 0.1f, 0.1f);
 
     uint32_t mActiveAnimationID = sBindPoseAnimationID;
@@ -102,6 +121,7 @@ private:
     static void GUI_CALL GetActiveAnimationCB(void* pVal, void* pUserData);
 
     std::string mModelString;
+    std::string mBenchmarkResults;
 
     float mNearZ;
     float mFarZ;
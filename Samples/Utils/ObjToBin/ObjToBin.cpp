@@ -27,18 +27,25 @@
 ***************************************************************************/
 #include "ObjToBin.h"
 
-ObjToBin::ObjToBin(std::vector<std::string> objFiles)
+ObjToBin::ObjToBin(std::vector<std::string> objFiles, bool optimizeMeshes)
 {
     mObjFiles = objFiles;
+    mOptimizeMeshes = optimizeMeshes;
 }
 
 void ObjToBin::convertObjToBin(const std::string& objFile)
 {
     printf("Converting %s ...\n", objFile.c_str());
-    auto pModel = Model::createFromFile(objFile, Model::GenerateTangentSpace);
+    uint32_t flags = Model::GenerateTangentSpace;
+    flags |= mOptimizeMeshes ? Model::OptimizeMeshes : 0;
+    auto pModel = Model::createFromFile(objFile, flags);
 
     if (pModel)
     {
+        if (mOptimizeMeshes)
+        {
+            printf("    Optimized meshes. %s\n", to_string(pModel->getMeshOptimizationStats()).c_str());
+        }
 
         std::string fullpath;
         if (findFileInDataDirectories(objFile, fullpath) == false)
@@ -81,16 +88,23 @@ void ObjToBin::onShutdown()
 
 int main(int argc, char* argv[])
 {
-    if (argc >= 2)
+    std::vector<std::string> objFiles;
+    bool optimizeMeshes = false;
+    for (int argi = 1; argi < argc; ++argi)
     {
-        std::vector<std::string> objFiles;
-
-        for (int argi = 1; argi < argc; ++argi)
+        if (std::string(argv[argi]) == "-optimize")
+        {
+            optimizeMeshes = true;
+        }
+        else
         {
             objFiles.push_back(std::string(argv[argi]));
         }
+    }
 
-        ObjToBin ObjToBin(objFiles);
+    if (objFiles.size() > 0)
+    {
+        ObjToBin ObjToBin(objFiles, optimizeMeshes);
         SampleConfig config;
         config.windowDesc.swapChainDesc.width = 256;
         config.windowDesc.swapChainDesc.height = 256;
@@ -99,6 +113,7 @@ int main(int argc, char* argv[])
     }
     else
     {
-        printf("Syntax: ObjToBin <list of obj files>\n");
+        printf("Syntax: ObjToBin [-optimize] <list of obj files>\n");
+        printf("    -optimize  Reorder triangles and vertices for the vertex cache, overdraw and vertex fetch, and print the ACMR/ATVR before and after\n");
     }
 }
\ No newline at end of file